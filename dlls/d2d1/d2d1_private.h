@@ -159,6 +159,37 @@ enum d2d_device_context_target_type
     D2D_TARGET_COMMAND_LIST,
 };
 
+#define D2D_GEOMETRY_CACHE_SIZE 256
+#define D2D_GEOMETRY_CACHE_WAYS 4
+
+enum d2d_geometry_buffer
+{
+    D2D_GEOMETRY_BUFFER_FILL_FACES,
+    D2D_GEOMETRY_BUFFER_FILL_VERTICES,
+    D2D_GEOMETRY_BUFFER_FILL_BEZIER_VERTICES,
+    D2D_GEOMETRY_BUFFER_FILL_ARC_VERTICES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_FACES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_VERTICES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_BEZIER_FACES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_BEZIERS,
+    D2D_GEOMETRY_BUFFER_OUTLINE_ARC_FACES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_ARCS,
+    D2D_GEOMETRY_BUFFER_COUNT,
+};
+
+struct d2d_geometry_cache_entry
+{
+    UINT64 geometry_id;
+    unsigned int last_used;
+    ID3D11Buffer *buffers[D2D_GEOMETRY_BUFFER_COUNT];
+};
+
+struct d2d_geometry_cache
+{
+    struct d2d_geometry_cache_entry entries[D2D_GEOMETRY_CACHE_SIZE];
+    unsigned int clock;
+};
+
 struct d2d_device_context
 {
     ID2D1DeviceContext1 ID2D1DeviceContext1_iface;
@@ -198,6 +229,7 @@ struct d2d_device_context
             [D2D_SAMPLER_INTERPOLATION_MODE_COUNT]
             [D2D_SAMPLER_EXTEND_MODE_COUNT]
             [D2D_SAMPLER_EXTEND_MODE_COUNT];
+    struct d2d_geometry_cache geometry_cache;
 
     struct d2d_error_state error;
     D2D1_DRAWING_STATE_DESCRIPTION1 drawing_state;
@@ -490,6 +522,11 @@ struct d2d_geometry
 
     ID2D1Factory *factory;
 
+    /* Identifies the fill and outline meshes below in device context
+     * geometry caches. The meshes don't change once built, and transformed
+     * geometries share the identifier of their source geometry. */
+    UINT64 id;
+    LONG draw_count;
     D2D_MATRIX_3X2_F transform;
 
     struct
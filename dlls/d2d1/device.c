@@ -248,6 +248,21 @@ static ULONG STDMETHODCALLTYPE d2d_device_context_inner_AddRef(IUnknown *iface)
     return refcount;
 }
 
+static void d2d_geometry_cache_entry_cleanup(struct d2d_geometry_cache_entry *entry)
+{
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(entry->buffers); ++i)
+    {
+        if (entry->buffers[i])
+        {
+            ID3D11Buffer_Release(entry->buffers[i]);
+            entry->buffers[i] = NULL;
+        }
+    }
+    entry->geometry_id = 0;
+}
+
 static ULONG STDMETHODCALLTYPE d2d_device_context_inner_Release(IUnknown *iface)
 {
     struct d2d_device_context *context = impl_from_IUnknown(iface);
@@ -287,6 +302,8 @@ static ULONG STDMETHODCALLTYPE d2d_device_context_inner_Release(IUnknown *iface)
                 }
             }
         }
+        for (i = 0; i < ARRAY_SIZE(context->geometry_cache.entries); ++i)
+            d2d_geometry_cache_entry_cleanup(&context->geometry_cache.entries[i]);
         if (context->d3d_state)
             ID3DDeviceContextState_Release(context->d3d_state);
         if (context->target.object)
@@ -817,11 +834,76 @@ static HRESULT d2d_device_context_update_vs_cb(struct d2d_device_context *contex
     return S_OK;
 }
 
-static void d2d_device_context_draw_geometry(struct d2d_device_context *render_target,
-        const struct d2d_geometry *geometry, struct d2d_brush *brush, float stroke_width)
+static struct d2d_geometry_cache_entry *d2d_device_context_get_geometry_cache_entry(
+        struct d2d_device_context *context, struct d2d_geometry *geometry)
+{
+    struct d2d_geometry_cache *cache = &context->geometry_cache;
+    struct d2d_geometry_cache_entry *entries, *lru = NULL;
+    unsigned int i;
+
+    entries = &cache->entries[geometry->id % (D2D_GEOMETRY_CACHE_SIZE / D2D_GEOMETRY_CACHE_WAYS)
+            * D2D_GEOMETRY_CACHE_WAYS];
+    for (i = 0; i < D2D_GEOMETRY_CACHE_WAYS; ++i)
+    {
+        if (entries[i].geometry_id == geometry->id)
+        {
+            entries[i].last_used = ++cache->clock;
+            return &entries[i];
+        }
+        if (!lru || entries[i].last_used < lru->last_used)
+            lru = &entries[i];
+    }
+
+    /* Geometries only get an entry the second time they're drawn, so that
+     * temporary geometries, like the ones created by FillRectangle(), don't
+     * push out the ones that get drawn every frame. */
+    if (geometry->draw_count < 2 && InterlockedIncrement(&geometry->draw_count) < 2)
+        return NULL;
+
+    d2d_geometry_cache_entry_cleanup(lru);
+    lru->geometry_id = geometry->id;
+    lru->last_used = ++cache->clock;
+
+    return lru;
+}
+
+static HRESULT d2d_device_context_get_geometry_buffer(struct d2d_device_context *context,
+        struct d2d_geometry_cache_entry *entry, enum d2d_geometry_buffer idx, UINT bind_flags,
+        const void *data, size_t size, ID3D11Buffer **buffer)
 {
     D3D11_SUBRESOURCE_DATA buffer_data;
     D3D11_BUFFER_DESC buffer_desc;
+    HRESULT hr;
+
+    if (entry && (*buffer = entry->buffers[idx]))
+    {
+        ID3D11Buffer_AddRef(*buffer);
+        return S_OK;
+    }
+
+    buffer_desc.ByteWidth = size;
+    buffer_desc.Usage = D3D11_USAGE_IMMUTABLE;
+    buffer_desc.BindFlags = bind_flags;
+    buffer_desc.CPUAccessFlags = 0;
+    buffer_desc.MiscFlags = 0;
+
+    buffer_data.pSysMem = data;
+    buffer_data.SysMemPitch = 0;
+    buffer_data.SysMemSlicePitch = 0;
+
+    if (FAILED(hr = ID3D11Device1_CreateBuffer(context->d3d_device, &buffer_desc, &buffer_data, buffer)))
+        return hr;
+
+    if (entry)
+        ID3D11Buffer_AddRef(entry->buffers[idx] = *buffer);
+
+    return S_OK;
+}
+
+static void d2d_device_context_draw_geometry(struct d2d_device_context *render_target,
+        struct d2d_geometry *geometry, struct d2d_brush *brush, float stroke_width)
+{
+    struct d2d_geometry_cache_entry *entry;
     ID3D11Buffer *ib, *vb;
     HRESULT hr;
 
@@ -837,30 +919,21 @@ static void d2d_device_context_draw_geometry(struct d2d_device_context *render_t
         return;
     }
 
-    buffer_desc.Usage = D3D11_USAGE_DEFAULT;
-    buffer_desc.CPUAccessFlags = 0;
-    buffer_desc.MiscFlags = 0;
-
-    buffer_data.SysMemPitch = 0;
-    buffer_data.SysMemSlicePitch = 0;
+    entry = d2d_device_context_get_geometry_cache_entry(render_target, geometry);
 
     if (geometry->outline.face_count)
     {
-        buffer_desc.ByteWidth = geometry->outline.face_count * sizeof(*geometry->outline.faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, entry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_FACES, D3D11_BIND_INDEX_BUFFER, geometry->outline.faces,
+                geometry->outline.face_count * sizeof(*geometry->outline.faces), &ib)))
         {
             WARN("Failed to create index buffer, hr %#lx.\n", hr);
             return;
         }
 
-        buffer_desc.ByteWidth = geometry->outline.vertex_count * sizeof(*geometry->outline.vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, entry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_VERTICES, D3D11_BIND_VERTEX_BUFFER, geometry->outline.vertices,
+                geometry->outline.vertex_count * sizeof(*geometry->outline.vertices), &vb)))
         {
             ERR("Failed to create vertex buffer, hr %#lx.\n", hr);
             ID3D11Buffer_Release(ib);
@@ -876,21 +949,17 @@ static void d2d_device_context_draw_geometry(struct d2d_device_context *render_t
 
     if (geometry->outline.bezier_face_count)
     {
-        buffer_desc.ByteWidth = geometry->outline.bezier_face_count * sizeof(*geometry->outline.bezier_faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.bezier_faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, entry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_BEZIER_FACES, D3D11_BIND_INDEX_BUFFER, geometry->outline.bezier_faces,
+                geometry->outline.bezier_face_count * sizeof(*geometry->outline.bezier_faces), &ib)))
         {
             WARN("Failed to create curves index buffer, hr %#lx.\n", hr);
             return;
         }
 
-        buffer_desc.ByteWidth = geometry->outline.bezier_count * sizeof(*geometry->outline.beziers);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.beziers;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, entry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_BEZIERS, D3D11_BIND_VERTEX_BUFFER, geometry->outline.beziers,
+                geometry->outline.bezier_count * sizeof(*geometry->outline.beziers), &vb)))
         {
             ERR("Failed to create curves vertex buffer, hr %#lx.\n", hr);
             ID3D11Buffer_Release(ib);
@@ -907,21 +976,17 @@ static void d2d_device_context_draw_geometry(struct d2d_device_context *render_t
 
     if (geometry->outline.arc_face_count)
     {
-        buffer_desc.ByteWidth = geometry->outline.arc_face_count * sizeof(*geometry->outline.arc_faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.arc_faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, entry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_ARC_FACES, D3D11_BIND_INDEX_BUFFER, geometry->outline.arc_faces,
+                geometry->outline.arc_face_count * sizeof(*geometry->outline.arc_faces), &ib)))
         {
             WARN("Failed to create arcs index buffer, hr %#lx.\n", hr);
             return;
         }
 
-        buffer_desc.ByteWidth = geometry->outline.arc_count * sizeof(*geometry->outline.arcs);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.arcs;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, entry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_ARCS, D3D11_BIND_VERTEX_BUFFER, geometry->outline.arcs,
+                geometry->outline.arc_count * sizeof(*geometry->outline.arcs), &vb)))
         {
             ERR("Failed to create arcs vertex buffer, hr %#lx.\n", hr);
             ID3D11Buffer_Release(ib);
@@ -941,7 +1006,7 @@ static void d2d_device_context_draw_geometry(struct d2d_device_context *render_t
 static void STDMETHODCALLTYPE d2d_device_context_DrawGeometry(ID2D1DeviceContext1 *iface,
         ID2D1Geometry *geometry, ID2D1Brush *brush, float stroke_width, ID2D1StrokeStyle *stroke_style)
 {
-    const struct d2d_geometry *geometry_impl = unsafe_impl_from_ID2D1Geometry(geometry);
+    struct d2d_geometry *geometry_impl = unsafe_impl_from_ID2D1Geometry(geometry);
     struct d2d_device_context *context = impl_from_ID2D1DeviceContext(iface);
     struct d2d_brush *brush_impl = unsafe_impl_from_ID2D1Brush(brush);
 
@@ -962,20 +1027,12 @@ static void STDMETHODCALLTYPE d2d_device_context_DrawGeometry(ID2D1DeviceContext
 }
 
 static void d2d_device_context_fill_geometry(struct d2d_device_context *render_target,
-        const struct d2d_geometry *geometry, struct d2d_brush *brush, struct d2d_brush *opacity_brush)
+        struct d2d_geometry *geometry, struct d2d_brush *brush, struct d2d_brush *opacity_brush)
 {
-    D3D11_SUBRESOURCE_DATA buffer_data;
-    D3D11_BUFFER_DESC buffer_desc;
+    struct d2d_geometry_cache_entry *entry;
     ID3D11Buffer *ib, *vb;
     HRESULT hr;
 
-    buffer_desc.Usage = D3D11_USAGE_DEFAULT;
-    buffer_desc.CPUAccessFlags = 0;
-    buffer_desc.MiscFlags = 0;
-
-    buffer_data.SysMemPitch = 0;
-    buffer_data.SysMemSlicePitch = 0;
-
     if (FAILED(hr = d2d_device_context_update_vs_cb(render_target, &geometry->transform, 0.0f)))
     {
         WARN("Failed to update vs constant buffer, hr %#lx.\n", hr);
@@ -988,23 +1045,21 @@ static void d2d_device_context_fill_geometry(struct d2d_device_context *render_t
         return;
     }
 
+    entry = d2d_device_context_get_geometry_cache_entry(render_target, geometry);
+
     if (geometry->fill.face_count)
     {
-        buffer_desc.ByteWidth = geometry->fill.face_count * sizeof(*geometry->fill.faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, entry,
+                D2D_GEOMETRY_BUFFER_FILL_FACES, D3D11_BIND_INDEX_BUFFER, geometry->fill.faces,
+                geometry->fill.face_count * sizeof(*geometry->fill.faces), &ib)))
         {
             WARN("Failed to create index buffer, hr %#lx.\n", hr);
             return;
         }
 
-        buffer_desc.ByteWidth = geometry->fill.vertex_count * sizeof(*geometry->fill.vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, entry,
+                D2D_GEOMETRY_BUFFER_FILL_VERTICES, D3D11_BIND_VERTEX_BUFFER, geometry->fill.vertices,
+                geometry->fill.vertex_count * sizeof(*geometry->fill.vertices), &vb)))
         {
             ERR("Failed to create vertex buffer, hr %#lx.\n", hr);
             ID3D11Buffer_Release(ib);
@@ -1020,11 +1075,9 @@ static void d2d_device_context_fill_geometry(struct d2d_device_context *render_t
 
     if (geometry->fill.bezier_vertex_count)
     {
-        buffer_desc.ByteWidth = geometry->fill.bezier_vertex_count * sizeof(*geometry->fill.bezier_vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.bezier_vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, entry,
+                D2D_GEOMETRY_BUFFER_FILL_BEZIER_VERTICES, D3D11_BIND_VERTEX_BUFFER, geometry->fill.bezier_vertices,
+                geometry->fill.bezier_vertex_count * sizeof(*geometry->fill.bezier_vertices), &vb)))
         {
             ERR("Failed to create curves vertex buffer, hr %#lx.\n", hr);
             return;
@@ -1038,11 +1091,9 @@ static void d2d_device_context_fill_geometry(struct d2d_device_context *render_t
 
     if (geometry->fill.arc_vertex_count)
     {
-        buffer_desc.ByteWidth = geometry->fill.arc_vertex_count * sizeof(*geometry->fill.arc_vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.arc_vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, entry,
+                D2D_GEOMETRY_BUFFER_FILL_ARC_VERTICES, D3D11_BIND_VERTEX_BUFFER, geometry->fill.arc_vertices,
+                geometry->fill.arc_vertex_count * sizeof(*geometry->fill.arc_vertices), &vb)))
         {
             ERR("Failed to create arc vertex buffer, hr %#lx.\n", hr);
             return;
@@ -1059,7 +1110,7 @@ static void d2d_device_context_fill_geometry(struct d2d_device_context *render_t
 static void STDMETHODCALLTYPE d2d_device_context_FillGeometry(ID2D1DeviceContext1 *iface,
         ID2D1Geometry *geometry, ID2D1Brush *brush, ID2D1Brush *opacity_brush)
 {
-    const struct d2d_geometry *geometry_impl = unsafe_impl_from_ID2D1Geometry(geometry);
+    struct d2d_geometry *geometry_impl = unsafe_impl_from_ID2D1Geometry(geometry);
     struct d2d_brush *opacity_brush_impl = unsafe_impl_from_ID2D1Brush(opacity_brush);
     struct d2d_device_context *context = impl_from_ID2D1DeviceContext(iface);
     struct d2d_brush *brush_impl = unsafe_impl_from_ID2D1Brush(brush);
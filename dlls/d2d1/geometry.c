@@ -2722,9 +2722,12 @@ static void d2d_geometry_cleanup(struct d2d_geometry *geometry)
 static void d2d_geometry_init(struct d2d_geometry *geometry, ID2D1Factory *factory,
         const D2D1_MATRIX_3X2_F *transform, const struct ID2D1GeometryVtbl *vtbl)
 {
+    static LONG64 next_id;
+
     geometry->ID2D1Geometry_iface.lpVtbl = vtbl;
     geometry->refcount = 1;
     ID2D1Factory_AddRef(geometry->factory = factory);
+    geometry->id = InterlockedIncrement64(&next_id);
     geometry->transform = *transform;
 }
 
@@ -5223,6 +5226,10 @@ void d2d_transformed_geometry_init(struct d2d_geometry *geometry, ID2D1Factory *
     d2d_geometry_init(geometry, factory, &g, (ID2D1GeometryVtbl *)&d2d_transformed_geometry_vtbl);
     ID2D1Geometry_AddRef(geometry->u.transformed.src_geometry = src_geometry);
     geometry->u.transformed.transform = *transform;
+    /* Transformed geometries are often created for a single draw, but the
+     * meshes they share usually outlive them; cache those on first use. */
+    geometry->id = src_impl->id;
+    geometry->draw_count = 1;
     geometry->fill = src_impl->fill;
     geometry->outline = src_impl->outline;
 }
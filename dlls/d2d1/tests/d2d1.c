@@ -10687,6 +10687,134 @@ static void test_geometry_group(BOOL d3d11)
     release_test_context(&ctx);
 }
 
+static void create_triangle_geometry(ID2D1Factory *factory, float size, ID2D1PathGeometry **geometry)
+{
+    ID2D1GeometrySink *sink;
+    D2D1_POINT_2F point;
+    HRESULT hr;
+
+    hr = ID2D1Factory_CreatePathGeometry(factory, geometry);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    hr = ID2D1PathGeometry_Open(*geometry, &sink);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    set_point(&point, 0.0f, 0.0f);
+    ID2D1GeometrySink_BeginFigure(sink, point, D2D1_FIGURE_BEGIN_FILLED);
+    set_point(&point, size, 0.0f);
+    ID2D1GeometrySink_AddLine(sink, point);
+    set_point(&point, 0.0f, size);
+    ID2D1GeometrySink_AddLine(sink, point);
+    ID2D1GeometrySink_EndFigure(sink, D2D1_FIGURE_END_CLOSED);
+    hr = ID2D1GeometrySink_Close(sink);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    ID2D1GeometrySink_Release(sink);
+}
+
+static void test_geometry_reuse(BOOL d3d11)
+{
+    ID2D1TransformedGeometry *transformed_geometry;
+    ID2D1SolidColorBrush *brush;
+    struct d2d1_test_context ctx;
+    ID2D1PathGeometry *geometry;
+    struct resource_readback rb;
+    D2D1_MATRIX_3X2_F matrix;
+    D2D1_COLOR_F color;
+    unsigned int i;
+    DWORD colour;
+    HRESULT hr;
+
+    if (!init_test_context(&ctx, d3d11))
+        return;
+
+    set_color(&color, 1.0f, 0.0f, 0.0f, 1.0f);
+    hr = ID2D1RenderTarget_CreateSolidColorBrush(ctx.rt, &color, NULL, &brush);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    /* Draw the same geometry several times, with different transforms, and
+     * through a transformed geometry sharing its meshes. */
+    create_triangle_geometry(ctx.factory, 40.0f, &geometry);
+    for (i = 0; i < 4; ++i)
+    {
+        winetest_push_context("Draw %u", i);
+
+        ID2D1RenderTarget_BeginDraw(ctx.rt);
+        set_color(&color, 1.0f, 1.0f, 1.0f, 1.0f);
+        ID2D1RenderTarget_Clear(ctx.rt, &color);
+        set_matrix_identity(&matrix);
+        translate_matrix(&matrix, 50.0f * i, 0.0f);
+        ID2D1RenderTarget_SetTransform(ctx.rt, &matrix);
+        ID2D1RenderTarget_FillGeometry(ctx.rt, (ID2D1Geometry *)geometry, (ID2D1Brush *)brush, NULL);
+        hr = ID2D1RenderTarget_EndDraw(ctx.rt, NULL, NULL);
+        ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+        get_surface_readback(&ctx, &rb);
+        colour = get_readback_colour(&rb, 50 * i + 5, 5);
+        ok(compare_colour(colour, 0xffff0000, 1), "Got unexpected colour %#lx.\n", colour);
+        colour = get_readback_colour(&rb, 50 * i + 35, 35);
+        ok(compare_colour(colour, 0xffffffff, 1), "Got unexpected colour %#lx.\n", colour);
+        release_resource_readback(&rb);
+
+        winetest_pop_context();
+    }
+
+    set_matrix_identity(&matrix);
+    scale_matrix(&matrix, 2.0f, 2.0f);
+    hr = ID2D1Factory_CreateTransformedGeometry(ctx.factory, (ID2D1Geometry *)geometry,
+            &matrix, &transformed_geometry);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    ID2D1PathGeometry_Release(geometry);
+
+    for (i = 0; i < 2; ++i)
+    {
+        winetest_push_context("Transformed draw %u", i);
+
+        ID2D1RenderTarget_BeginDraw(ctx.rt);
+        ID2D1RenderTarget_Clear(ctx.rt, &color);
+        set_matrix_identity(&matrix);
+        ID2D1RenderTarget_SetTransform(ctx.rt, &matrix);
+        ID2D1RenderTarget_FillGeometry(ctx.rt, (ID2D1Geometry *)transformed_geometry, (ID2D1Brush *)brush, NULL);
+        hr = ID2D1RenderTarget_EndDraw(ctx.rt, NULL, NULL);
+        ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+        get_surface_readback(&ctx, &rb);
+        colour = get_readback_colour(&rb, 35, 35);
+        ok(compare_colour(colour, 0xffff0000, 1), "Got unexpected colour %#lx.\n", colour);
+        colour = get_readback_colour(&rb, 75, 75);
+        ok(compare_colour(colour, 0xffffffff, 1), "Got unexpected colour %#lx.\n", colour);
+        release_resource_readback(&rb);
+
+        winetest_pop_context();
+    }
+    ID2D1TransformedGeometry_Release(transformed_geometry);
+
+    /* A new geometry may be allocated at the same address as a released
+     * one; it should still be drawn with its own shape. */
+    for (i = 0; i < 4; ++i)
+    {
+        winetest_push_context("Geometry %u", i);
+
+        create_triangle_geometry(ctx.factory, 10.0f + 20.0f * i, &geometry);
+        ID2D1RenderTarget_BeginDraw(ctx.rt);
+        ID2D1RenderTarget_Clear(ctx.rt, &color);
+        ID2D1RenderTarget_FillGeometry(ctx.rt, (ID2D1Geometry *)geometry, (ID2D1Brush *)brush, NULL);
+        ID2D1RenderTarget_FillGeometry(ctx.rt, (ID2D1Geometry *)geometry, (ID2D1Brush *)brush, NULL);
+        hr = ID2D1RenderTarget_EndDraw(ctx.rt, NULL, NULL);
+        ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+        ID2D1PathGeometry_Release(geometry);
+
+        get_surface_readback(&ctx, &rb);
+        colour = get_readback_colour(&rb, 4 + 10 * i, 4 + 10 * i);
+        ok(compare_colour(colour, 0xffff0000, 1), "Got unexpected colour %#lx.\n", colour);
+        colour = get_readback_colour(&rb, 6 + 10 * i, 6 + 10 * i);
+        ok(compare_colour(colour, 0xffffffff, 1), "Got unexpected colour %#lx.\n", colour);
+        release_resource_readback(&rb);
+
+        winetest_pop_context();
+    }
+
+    ID2D1SolidColorBrush_Release(brush);
+    release_test_context(&ctx);
+}
+
 static DWORD WINAPI mt_factory_test_thread_func(void *param)
 {
     ID2D1Multithread *multithread = param;
@@ -14126,6 +14254,7 @@ START_TEST(d2d1)
     queue_d3d10_test(test_math);
     queue_d3d10_test(test_colour_space);
     queue_test(test_geometry_group);
+    queue_test(test_geometry_reuse);
     queue_test(test_mt_factory);
     queue_test(test_effect_register);
     queue_test(test_effect_context);
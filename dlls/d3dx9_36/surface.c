@@ -1875,6 +1875,107 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
     }
 }
 
+/* Compressed surfaces with at least this many pixels are split across threads. */
+#define DXTN_THREAD_PIXELS (256 * 256)
+#define DXTN_MAX_THREADS 8
+
+struct dxtn_compress_context
+{
+    const BYTE *src;
+    BYTE *dst;
+    UINT width, height, dst_pitch;
+    GLenum format;
+    GLint quality;
+    UINT tile_rows;
+    LONG next_tile;
+};
+
+static BOOL WINAPI init_dxtn_quality(INIT_ONCE *once, void *param, void **context)
+{
+    GLint *quality = param;
+    WCHAR buffer[16];
+    DWORD size = sizeof(buffer);
+
+    /* HKCU\Software\Wine\Direct3D, "DXTnCompressionQuality" = "fast", "normal" or "high". */
+    *quality = TXC_QUALITY_NORMAL;
+    if (RegGetValueW(HKEY_CURRENT_USER, L"Software\\Wine\\Direct3D", L"DXTnCompressionQuality",
+            RRF_RT_REG_SZ, NULL, buffer, &size))
+        return TRUE;
+
+    if (!wcsicmp(buffer, L"fast"))
+        *quality = TXC_QUALITY_FAST;
+    else if (!wcsicmp(buffer, L"high"))
+        *quality = TXC_QUALITY_HIGH;
+    else if (wcsicmp(buffer, L"normal"))
+        WARN("Unknown DXTn compression quality %s.\n", debugstr_w(buffer));
+    TRACE("Using DXTn compression quality %d.\n", *quality);
+    return TRUE;
+}
+
+static void dxtn_compress_tiles(struct dxtn_compress_context *ctx)
+{
+    UINT tiles = (ctx->height + ctx->tile_rows - 1) / ctx->tile_rows, tile, y;
+
+    /* Every tile is a horizontal strip of whole blocks, so it can be encoded on its own. */
+    while ((tile = InterlockedIncrement(&ctx->next_tile) - 1) < tiles)
+    {
+        y = tile * ctx->tile_rows;
+        tx_compress_dxtn(4, ctx->width, min(ctx->tile_rows, ctx->height - y), ctx->src + y * ctx->width * 4,
+                ctx->format, ctx->dst + (y / 4) * ctx->dst_pitch, ctx->dst_pitch, ctx->quality);
+    }
+}
+
+static void CALLBACK dxtn_compress_work_callback(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work)
+{
+    dxtn_compress_tiles(context);
+}
+
+/* Compresses tightly packed A8B8G8R8 data with block aligned dimensions. */
+static void compress_dxtn(const BYTE *src, UINT width, UINT height, GLenum format, BYTE *dst, UINT dst_pitch)
+{
+    static INIT_ONCE init_once = INIT_ONCE_STATIC_INIT;
+    static GLint quality;
+    struct dxtn_compress_context ctx;
+    UINT threads = 1, block_rows, i;
+    TP_WORK *work = NULL;
+    SYSTEM_INFO info;
+
+    InitOnceExecuteOnce(&init_once, init_dxtn_quality, &quality, NULL);
+
+    ctx.src = src;
+    ctx.dst = dst;
+    ctx.width = width;
+    ctx.height = height;
+    ctx.dst_pitch = dst_pitch;
+    ctx.format = format;
+    ctx.quality = quality;
+    ctx.next_tile = 0;
+
+    if (width * height >= DXTN_THREAD_PIXELS)
+    {
+        GetSystemInfo(&info);
+        threads = min(info.dwNumberOfProcessors, DXTN_MAX_THREADS);
+        if (threads > 1)
+            work = CreateThreadpoolWork(dxtn_compress_work_callback, &ctx, NULL);
+    }
+
+    if (!work)
+    {
+        ctx.tile_rows = height;
+        dxtn_compress_tiles(&ctx);
+        return;
+    }
+
+    TRACE("Compressing on %u threads.\n", threads);
+    block_rows = (height + 3) / 4;
+    ctx.tile_rows = (block_rows + threads * 4 - 1) / (threads * 4) * 4;
+    for (i = 1; i < threads; i++)
+        SubmitThreadpoolWork(work);
+    dxtn_compress_tiles(&ctx);
+    WaitForThreadpoolWorkCallbacks(work, FALSE);
+    CloseThreadpoolWork(work);
+}
+
 /************************************************************
  * D3DXLoadSurfaceFromMemory
  *
@@ -2146,9 +2247,8 @@ HRESULT WINAPI D3DXLoadSurfaceFromMemory(IDirect3DSurface9 *dst_surface,
                 default:
                     ERR("Unexpected destination compressed format %u.\n", surfdesc.Format);
             }
-            tx_compress_dxtn(4, dst_size_aligned.width, dst_size_aligned.height,
-                    dst_uncompressed, gl_format, lockrect.pBits,
-                    lockrect.Pitch);
+            compress_dxtn(dst_uncompressed, dst_size_aligned.width, dst_size_aligned.height,
+                    gl_format, lockrect.pBits, lockrect.Pitch);
             heap_free(dst_uncompressed);
         }
     }
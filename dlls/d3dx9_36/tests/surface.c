@@ -1548,6 +1548,67 @@ static void test_D3DXLoadSurface(IDirect3DDevice9 *device)
     if(testbitmap_ok) DeleteFileA("testbitmap.bmp");
 }
 
+static void test_D3DXLoadSurface_dxtn(IDirect3DDevice9 *device)
+{
+    static const D3DFORMAT formats[] = {D3DFMT_DXT1, D3DFMT_DXT3, D3DFMT_DXT5};
+    static const unsigned int size = 512;
+    IDirect3DSurface9 *surface;
+    D3DLOCKED_RECT lockrect;
+    IDirect3DTexture9 *tex;
+    unsigned int i, x, y;
+    DWORD *pixels;
+    HRESULT hr;
+    RECT rect;
+
+    pixels = HeapAlloc(GetProcessHeap(), 0, size * size * sizeof(*pixels));
+    /* Every row of blocks gets the same pixel data, so every row of compressed blocks should be identical
+     * too, however the work is split up. */
+    for (y = 0; y < size; ++y)
+    {
+        for (x = 0; x < size; ++x)
+            pixels[y * size + x] = ((x * 7 + (y & 3) * 40) & 0xff) << 24 | (x & 0xff) << 16
+                    | ((x * 3 + (y & 3) * 64) & 0xff) << 8 | ((x ^ (y & 3)) * 5 & 0xff);
+    }
+
+    SetRect(&rect, 0, 0, size, size);
+
+    for (i = 0; i < ARRAY_SIZE(formats); ++i)
+    {
+        winetest_push_context("Format %#x", formats[i]);
+
+        hr = IDirect3DDevice9_CreateTexture(device, size, size, 1, 0, formats[i], D3DPOOL_SYSTEMMEM, &tex, NULL);
+        if (FAILED(hr))
+        {
+            skip("Failed to create texture, hr %#lx.\n", hr);
+            winetest_pop_context();
+            continue;
+        }
+        hr = IDirect3DTexture9_GetSurfaceLevel(tex, 0, &surface);
+        ok(hr == D3D_OK, "Got unexpected hr %#lx.\n", hr);
+
+        hr = D3DXLoadSurfaceFromMemory(surface, NULL, NULL, pixels, D3DFMT_A8R8G8B8,
+                size * sizeof(*pixels), NULL, &rect, D3DX_FILTER_NONE, 0);
+        ok(hr == D3D_OK, "Got unexpected hr %#lx.\n", hr);
+
+        hr = IDirect3DSurface9_LockRect(surface, &lockrect, NULL, D3DLOCK_READONLY);
+        ok(hr == D3D_OK, "Got unexpected hr %#lx.\n", hr);
+        for (y = 1; y < size / 4; ++y)
+        {
+            if (memcmp(lockrect.pBits, (BYTE *)lockrect.pBits + y * lockrect.Pitch, lockrect.Pitch))
+                break;
+        }
+        ok(y == size / 4, "Block row %u differs.\n", y);
+        hr = IDirect3DSurface9_UnlockRect(surface);
+        ok(hr == D3D_OK, "Got unexpected hr %#lx.\n", hr);
+
+        check_release((IUnknown *)surface, 1);
+        check_release((IUnknown *)tex, 0);
+        winetest_pop_context();
+    }
+
+    HeapFree(GetProcessHeap(), 0, pixels);
+}
+
 static void test_D3DXSaveSurfaceToFileInMemory(IDirect3DDevice9 *device)
 {
     static const struct
@@ -1811,6 +1872,7 @@ START_TEST(surface)
 
     test_D3DXGetImageInfo();
     test_D3DXLoadSurface(device);
+    test_D3DXLoadSurface_dxtn(device);
     test_D3DXSaveSurfaceToFileInMemory(device);
     test_D3DXSaveSurfaceToFile(device);
 
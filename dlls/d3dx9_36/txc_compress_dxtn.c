@@ -24,8 +24,13 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "txc_dxtn.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 /* weights used for error function, basically weights (unsquared 2/4/1) according to rgb->luminance conversion
    not sure if this really reflects visual perception */
 #define REDWEIGHT 4
@@ -34,6 +39,88 @@
 
 #define ALPHACUT 127
 
+/* number of base color refinement passes done for TXC_QUALITY_HIGH */
+#define TXC_HIGH_QUALITY_PASSES 3
+
+/* find the closest of the first numcolors colors in cv for every pixel, using the luminance-weighted
+   distance metric. Ties go to the lower color index, just like a linear search with "<" would */
+static void findbestcolors( GLubyte srccolors[4][4][4], GLubyte cv[4][4], GLint numcolors,
+                           GLint numxpixels, GLint numypixels, GLubyte enc[4][4], GLuint pixerrors[4][4])
+{
+   GLint i, j, colors;
+   GLint colordist;
+   GLuint pixerror, pixerrorbest;
+   GLubyte bestenc = 0;
+
+#ifdef __SSE2__
+   if (numxpixels == 4 && numypixels == 4) {
+      const __m128i weights = _mm_setr_epi16(REDWEIGHT, GREENWEIGHT, BLUEWEIGHT, 0,
+                                             REDWEIGHT, GREENWEIGHT, BLUEWEIGHT, 0);
+      const __m128i zero = _mm_setzero_si128();
+      __m128i cvvec[4], pixels, lo, hi, dlo, dhi, elo, ehi, err, mask, best = zero, encvec = zero;
+      GLuint encbytes;
+
+      for (colors = 0; colors < numcolors; colors++)
+         cvvec[colors] = _mm_setr_epi16(cv[colors][0], cv[colors][1], cv[colors][2], 0,
+                                        cv[colors][0], cv[colors][1], cv[colors][2], 0);
+
+      for (j = 0; j < 4; j++) {
+         /* one block row is 4 rgba pixels, errors of all four pixels are computed at once */
+         pixels = _mm_loadu_si128((const __m128i *)srccolors[j]);
+         lo = _mm_unpacklo_epi8(pixels, zero);
+         hi = _mm_unpackhi_epi8(pixels, zero);
+         for (colors = 0; colors < numcolors; colors++) {
+            dlo = _mm_sub_epi16(lo, cvvec[colors]);
+            dhi = _mm_sub_epi16(hi, cvvec[colors]);
+            /* per pixel: red + green error and blue (+ zero weighted alpha) error */
+            elo = _mm_madd_epi16(dlo, _mm_mullo_epi16(dlo, weights));
+            ehi = _mm_madd_epi16(dhi, _mm_mullo_epi16(dhi, weights));
+            err = _mm_add_epi32(
+               _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(elo), _mm_castsi128_ps(ehi), _MM_SHUFFLE(2, 0, 2, 0))),
+               _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(elo), _mm_castsi128_ps(ehi), _MM_SHUFFLE(3, 1, 3, 1))));
+            if (!colors) {
+               best = err;
+               encvec = zero;
+            }
+            else {
+               mask = _mm_cmplt_epi32(err, best);
+               best = _mm_or_si128(_mm_and_si128(mask, err), _mm_andnot_si128(mask, best));
+               encvec = _mm_or_si128(_mm_and_si128(mask, _mm_set1_epi32(colors)), _mm_andnot_si128(mask, encvec));
+            }
+         }
+         _mm_storeu_si128((__m128i *)pixerrors[j], best);
+         encvec = _mm_packs_epi32(encvec, encvec);
+         encbytes = _mm_cvtsi128_si32(_mm_packus_epi16(encvec, encvec));
+         enc[j][0] = encbytes;
+         enc[j][1] = encbytes >> 8;
+         enc[j][2] = encbytes >> 16;
+         enc[j][3] = encbytes >> 24;
+      }
+      return;
+   }
+#endif
+
+   for (j = 0; j < numypixels; j++) {
+      for (i = 0; i < numxpixels; i++) {
+         pixerrorbest = 0xffffffff;
+         for (colors = 0; colors < numcolors; colors++) {
+            colordist = srccolors[j][i][0] - cv[colors][0];
+            pixerror = colordist * colordist * REDWEIGHT;
+            colordist = srccolors[j][i][1] - cv[colors][1];
+            pixerror += colordist * colordist * GREENWEIGHT;
+            colordist = srccolors[j][i][2] - cv[colors][2];
+            pixerror += colordist * colordist * BLUEWEIGHT;
+            if (pixerror < pixerrorbest) {
+               pixerrorbest = pixerror;
+               bestenc = colors;
+            }
+         }
+         pixerrors[j][i] = pixerrorbest;
+         enc[j][i] = bestenc;
+      }
+   }
+}
+
 static void fancybasecolorsearch( GLubyte *blkaddr, GLubyte srccolors[4][4][4], GLubyte *bestcolor[2],
                            GLint numxpixels, GLint numypixels, GLint type, GLboolean haveAlpha)
 {
@@ -42,12 +129,13 @@ static void fancybasecolorsearch( GLubyte *blkaddr, GLubyte srccolors[4][4][4],
    /* TODO could also try to find a better encoding for the 3-color-encoding type, this really should be done
       if it's rgba_dxt1 and we have alpha in the block, currently even values which will be mapped to black
       due to their alpha value will influence the result */
-   GLint i, j, colors, z;
-   GLuint pixerror, pixerrorred, pixerrorgreen, pixerrorblue, pixerrorbest;
-   GLint colordist, blockerrlin[2][3];
+   GLint i, j, z;
+   GLuint pixerrors[4][4];
+   GLint blockerrlin[2][3];
    GLubyte nrcolor[2];
    GLint pixerrorcolorbest[3];
    GLubyte enc = 0;
+   GLubyte pixenc[4][4];
    GLubyte cv[4][4];
    GLubyte testcolor[2][3];
 
@@ -88,26 +176,13 @@ static void fancybasecolorsearch( GLubyte *blkaddr, GLubyte srccolors[4][4][4],
    nrcolor[0] = 0;
    nrcolor[1] = 0;
 
+   findbestcolors(srccolors, cv, 4, numxpixels, numypixels, pixenc, pixerrors);
+
    for (j = 0; j < numypixels; j++) {
       for (i = 0; i < numxpixels; i++) {
-         pixerrorbest = 0xffffffff;
-         for (colors = 0; colors < 4; colors++) {
-            colordist = srccolors[j][i][0] - (cv[colors][0]);
-            pixerror = colordist * colordist * REDWEIGHT;
-            pixerrorred = colordist;
-            colordist = srccolors[j][i][1] - (cv[colors][1]);
-            pixerror += colordist * colordist * GREENWEIGHT;
-            pixerrorgreen = colordist;
-            colordist = srccolors[j][i][2] - (cv[colors][2]);
-            pixerror += colordist * colordist * BLUEWEIGHT;
-            pixerrorblue = colordist;
-            if (pixerror < pixerrorbest) {
-               enc = colors;
-               pixerrorbest = pixerror;
-               pixerrorcolorbest[0] = pixerrorred;
-               pixerrorcolorbest[1] = pixerrorgreen;
-               pixerrorcolorbest[2] = pixerrorblue;
-            }
+         enc = pixenc[j][i];
+         for (z = 0; z < 3; z++) {
+            pixerrorcolorbest[z] = srccolors[j][i][z] - cv[enc][z];
          }
          if (enc == 0) {
             for (z = 0; z < 3; z++) {
@@ -226,18 +301,20 @@ static void fancybasecolorsearch( GLubyte *blkaddr, GLubyte srccolors[4][4][4],
 
 
 
-static void storedxtencodedblock( GLubyte *blkaddr, GLubyte srccolors[4][4][4], GLubyte *bestcolor[2],
+static GLuint storedxtencodedblock( GLubyte *blkaddr, GLubyte srccolors[4][4][4], GLubyte *bestcolor[2],
                            GLint numxpixels, GLint numypixels, GLuint type, GLboolean haveAlpha)
 {
-   /* use same luminance-weighted distance metric to determine encoding as for finding the base colors */
+   /* use same luminance-weighted distance metric to determine encoding as for finding the base colors,
+      returns the error of the stored encoding */
 
-   GLint i, j, colors;
-   GLuint testerror, testerror2, pixerror, pixerrorbest;
-   GLint colordist;
+   GLint i, j;
+   GLuint testerror, testerror2;
+   GLuint pixerrors[4][4];
    GLushort color0, color1, tempcolor;
    GLuint bits = 0, bits2 = 0;
    GLubyte *colorptr;
    GLubyte enc = 0;
+   GLubyte pixenc[4][4];
    GLubyte cv[4][4];
 
    bestcolor[0][0] = bestcolor[0][0] & 0xf8;
@@ -262,24 +339,12 @@ static void storedxtencodedblock( GLubyte *blkaddr, GLubyte srccolors[4][4][4],
       cv[3][i] = (bestcolor[0][i] + bestcolor[1][i] * 2) / 3;
    }
 
+   findbestcolors(srccolors, cv, 4, numxpixels, numypixels, pixenc, pixerrors);
    testerror = 0;
    for (j = 0; j < numypixels; j++) {
       for (i = 0; i < numxpixels; i++) {
-         pixerrorbest = 0xffffffff;
-         for (colors = 0; colors < 4; colors++) {
-            colordist = srccolors[j][i][0] - cv[colors][0];
-            pixerror = colordist * colordist * REDWEIGHT;
-            colordist = srccolors[j][i][1] - cv[colors][1];
-            pixerror += colordist * colordist * GREENWEIGHT;
-            colordist = srccolors[j][i][2] - cv[colors][2];
-            pixerror += colordist * colordist * BLUEWEIGHT;
-            if (pixerror < pixerrorbest) {
-               pixerrorbest = pixerror;
-               enc = colors;
-            }
-         }
-         testerror += pixerrorbest;
-         bits |= enc << (2 * (j * 4 + i));
+         testerror += pixerrors[j][i];
+         bits |= pixenc[j][i] << (2 * (j * 4 + i));
       }
    }
    /* some hw might disagree but actually decoding should always use 4-color encoding
@@ -293,32 +358,19 @@ static void storedxtencodedblock( GLubyte *blkaddr, GLubyte srccolors[4][4][4],
             it won't get used even then */
          cv[3][i] = 0;
       }
+      /* we're calculating the same what we have done already for colors 0-1 above... */
+      findbestcolors(srccolors, cv, 3, numxpixels, numypixels, pixenc, pixerrors);
       testerror2 = 0;
       for (j = 0; j < numypixels; j++) {
          for (i = 0; i < numxpixels; i++) {
-            pixerrorbest = 0xffffffff;
             if ((type == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) && (srccolors[j][i][3] <= ALPHACUT)) {
                enc = 3;
-               pixerrorbest = 0; /* don't calculate error */
-            }
-            else {
-               /* we're calculating the same what we have done already for colors 0-1 above... */
-               for (colors = 0; colors < 3; colors++) {
-                  colordist = srccolors[j][i][0] - cv[colors][0];
-                  pixerror = colordist * colordist * REDWEIGHT;
-                  colordist = srccolors[j][i][1] - cv[colors][1];
-                  pixerror += colordist * colordist * GREENWEIGHT;
-                  colordist = srccolors[j][i][2] - cv[colors][2];
-                  pixerror += colordist * colordist * BLUEWEIGHT;
-                  if (pixerror < pixerrorbest) {
-                     pixerrorbest = pixerror;
-                     /* need to exchange colors later */
-                     if (colors > 1) enc = colors;
-                     else enc = colors ^ 1;
-                  }
-               }
+               pixerrors[j][i] = 0; /* don't calculate error */
             }
-            testerror2 += pixerrorbest;
+            /* need to exchange colors later */
+            else if (pixenc[j][i] > 1) enc = pixenc[j][i];
+            else enc = pixenc[j][i] ^ 1;
+            testerror2 += pixerrors[j][i];
             bits2 |= enc << (2 * (j * 4 + i));
          }
       }
@@ -336,6 +388,7 @@ static void storedxtencodedblock( GLubyte *blkaddr, GLubyte srccolors[4][4][4],
       *blkaddr++ = ( bits2 >> 8) & 0xff;
       *blkaddr++ = ( bits2 >> 16) & 0xff;
       *blkaddr = bits2 >> 24;
+      return testerror2;
    }
    else {
       *blkaddr++ = color0 & 0xff;
@@ -346,11 +399,12 @@ static void storedxtencodedblock( GLubyte *blkaddr, GLubyte srccolors[4][4][4],
       *blkaddr++ = ( bits >> 8) & 0xff;
       *blkaddr++ = ( bits >> 16) & 0xff;
       *blkaddr = bits >> 24;
+      return testerror;
    }
 }
 
 static void encodedxtcolorblockfaster( GLubyte *blkaddr, GLubyte srccolors[4][4][4],
-                         GLint numxpixels, GLint numypixels, GLuint type )
+                         GLint numxpixels, GLint numypixels, GLuint type, GLint quality )
 {
 /* simplistic approach. We need two base colors, simply use the "highest" and the "lowest" color
    present in the picture as base colors */
@@ -362,8 +416,11 @@ static void encodedxtcolorblockfaster( GLubyte *blkaddr, GLubyte srccolors[4][4]
 
    GLubyte *bestcolor[2];
    GLubyte basecolors[2][3];
-   GLubyte i, j;
-   GLuint lowcv, highcv, testcv;
+   GLubyte refinedcolors[2][3], testcolors[2][3];
+   GLubyte *testcolor[2];
+   GLubyte testblock[8];
+   GLubyte i, j, pass;
+   GLuint lowcv, highcv, testcv, besterror, testerror;
    GLboolean haveAlpha = GL_FALSE;
 
    lowcv = highcv = srccolors[0][0][0] * srccolors[0][0][0] * REDWEIGHT +
@@ -398,10 +455,40 @@ static void encodedxtcolorblockfaster( GLubyte *blkaddr, GLubyte srccolors[4][4]
    bestcolor[0] = basecolors[0];
    bestcolor[1] = basecolors[1];
 
-   /* try to find better base colors */
-   fancybasecolorsearch(blkaddr, srccolors, bestcolor, numxpixels, numypixels, type, haveAlpha);
-   /* find the best encoding for these colors, and store the result */
-   storedxtencodedblock(blkaddr, srccolors, bestcolor, numxpixels, numypixels, type, haveAlpha);
+   if (quality == TXC_QUALITY_FAST) {
+      storedxtencodedblock(blkaddr, srccolors, bestcolor, numxpixels, numypixels, type, haveAlpha);
+      return;
+   }
+
+   if (quality != TXC_QUALITY_HIGH) {
+      /* try to find better base colors */
+      fancybasecolorsearch(blkaddr, srccolors, bestcolor, numxpixels, numypixels, type, haveAlpha);
+      /* find the best encoding for these colors, and store the result */
+      storedxtencodedblock(blkaddr, srccolors, bestcolor, numxpixels, numypixels, type, haveAlpha);
+      return;
+   }
+
+   /* keep refining the base colors, and store whichever candidate (including the unrefined
+      colors) ends up with the lowest error. The first refinement is what the normal mode uses,
+      so this never does worse than that */
+   memcpy(refinedcolors, basecolors, sizeof(refinedcolors));
+   besterror = 0xffffffff;
+   for (pass = 0; pass <= TXC_HIGH_QUALITY_PASSES; pass++) {
+      if (pass == 1) memcpy(testcolors, basecolors, sizeof(testcolors));
+      else {
+         bestcolor[0] = refinedcolors[0];
+         bestcolor[1] = refinedcolors[1];
+         fancybasecolorsearch(blkaddr, srccolors, bestcolor, numxpixels, numypixels, type, haveAlpha);
+         memcpy(testcolors, refinedcolors, sizeof(testcolors));
+      }
+      testcolor[0] = testcolors[0];
+      testcolor[1] = testcolors[1];
+      testerror = storedxtencodedblock(testblock, srccolors, testcolor, numxpixels, numypixels, type, haveAlpha);
+      if (testerror < besterror) {
+         besterror = testerror;
+         memcpy(blkaddr, testblock, sizeof(testblock));
+      }
+   }
 }
 
 static void writedxt5encodedalphablock( GLubyte *blkaddr, GLubyte alphabase1, GLubyte alphabase2,
@@ -756,7 +843,7 @@ static void extractsrccolors( GLubyte srcpixels[4][4][4], const GLchan *srcaddr,
 
 
 void tx_compress_dxtn(GLint srccomps, GLint width, GLint height, const GLubyte *srcPixData,
-                     GLenum destFormat, GLubyte *dest, GLint dstRowStride)
+                     GLenum destFormat, GLubyte *dest, GLint dstRowStride, GLint quality)
 {
       GLubyte *blkaddr = dest;
       GLubyte srcpixels[4][4][4];
@@ -780,7 +867,7 @@ void tx_compress_dxtn(GLint srccomps, GLint width, GLint height, const GLubyte *
             if (width > i + 3) numxpixels = 4;
             else numxpixels = width - i;
             extractsrccolors(srcpixels, srcaddr, width, numxpixels, numypixels, srccomps);
-            encodedxtcolorblockfaster(blkaddr, srcpixels, numxpixels, numypixels, destFormat);
+            encodedxtcolorblockfaster(blkaddr, srcpixels, numxpixels, numypixels, destFormat, quality);
             srcaddr += srccomps * numxpixels;
             blkaddr += 8;
          }
@@ -807,7 +894,7 @@ void tx_compress_dxtn(GLint srccomps, GLint width, GLint height, const GLubyte *
             *blkaddr++ = (srcpixels[2][2][3] >> 4) | (srcpixels[2][3][3] & 0xf0);
             *blkaddr++ = (srcpixels[3][0][3] >> 4) | (srcpixels[3][1][3] & 0xf0);
             *blkaddr++ = (srcpixels[3][2][3] >> 4) | (srcpixels[3][3][3] & 0xf0);
-            encodedxtcolorblockfaster(blkaddr, srcpixels, numxpixels, numypixels, destFormat);
+            encodedxtcolorblockfaster(blkaddr, srcpixels, numxpixels, numypixels, destFormat, quality);
             srcaddr += srccomps * numxpixels;
             blkaddr += 8;
          }
@@ -827,7 +914,7 @@ void tx_compress_dxtn(GLint srccomps, GLint width, GLint height, const GLubyte *
             else numxpixels = width - i;
             extractsrccolors(srcpixels, srcaddr, width, numxpixels, numypixels, srccomps);
             encodedxt5alpha(blkaddr, srcpixels, numxpixels, numypixels);
-            encodedxtcolorblockfaster(blkaddr + 8, srcpixels, numxpixels, numypixels, destFormat);
+            encodedxtcolorblockfaster(blkaddr + 8, srcpixels, numxpixels, numypixels, destFormat, quality);
             srcaddr += srccomps * numxpixels;
             blkaddr += 16;
          }
@@ -45,8 +45,13 @@ void fetch_2d_texel_rgba_dxt3(GLint srcRowStride, const GLubyte *pixdata,
 void fetch_2d_texel_rgba_dxt5(GLint srcRowStride, const GLubyte *pixdata,
 			     GLint i, GLint j, GLvoid *texel);
 
+/* quality / speed tradeoff for tx_compress_dxtn */
+#define TXC_QUALITY_FAST   0
+#define TXC_QUALITY_NORMAL 1
+#define TXC_QUALITY_HIGH   2
+
 void tx_compress_dxtn(GLint srccomps, GLint width, GLint height,
 		      const GLubyte *srcPixData, GLenum destformat,
-		      GLubyte *dest, GLint dstRowStride);
+		      GLubyte *dest, GLint dstRowStride, GLint quality);
 
 #endif /* _TXC_DXTN_H */
@@ -236,6 +236,8 @@ static ULONG DirectSoundDevice_Release(DirectSoundDevice * device)
         CloseHandle(device->sleepev);
         free(device->tmp_buffer);
         free(device->cp_buffer);
+        for (i = 0; i < ARRAY_SIZE(device->fir_tables); ++i)
+            free(device->fir_tables[i].coeffs);
         free(device->buffer);
         device->mixlock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&device->mixlock);
@@ -37,6 +37,9 @@
 
 #include <stdarg.h>
 #include <math.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "windef.h"
 #include "winbase.h"
@@ -111,6 +114,118 @@ float get_mono(const IDirectSoundBufferImpl *dsb, BYTE *base, DWORD channel)
     return val;
 }
 
+/* Block variants of the getters above. They convert "count" frames of one
+ * channel, starting at the frame at "base", into a contiguous float array. */
+static void get8_block(const IDirectSoundBufferImpl *dsb, const BYTE *base, DWORD channel, float *dst, UINT count)
+{
+    UINT stride = dsb->pwfx->nBlockAlign;
+    const BYTE *buf = base + channel;
+
+    while (count--)
+    {
+        *dst++ = (buf[0] - 0x80) / (float)0x80;
+        buf += stride;
+    }
+}
+
+static void get16_block(const IDirectSoundBufferImpl *dsb, const BYTE *base, DWORD channel, float *dst, UINT count)
+{
+    UINT stride = dsb->pwfx->nBlockAlign;
+    const BYTE *buf = base + 2 * channel;
+
+#ifdef __SSE2__
+    /* Mono and stereo are by far the most common formats. Scaling by 1 / 0x8000
+     * is exact, so these give the same results as get16(). */
+    const __m128 scale = _mm_set1_ps(1.0f / 0x8000);
+
+    if (stride == 2)
+    {
+        for (; count >= 8; count -= 8, buf += 16, dst += 8)
+        {
+            __m128i s = _mm_loadu_si128((const __m128i *)buf);
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+
+            _mm_storeu_ps(dst, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(dst + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+    }
+    else if (stride == 4)
+    {
+        for (; count >= 4; count -= 4, buf += 16, dst += 4)
+        {
+            /* Load whole frames, so that nothing past the last one is read. */
+            __m128i s = _mm_loadu_si128((const __m128i *)(buf - 2 * channel));
+
+            if (channel)
+                s = _mm_srai_epi32(s, 16);
+            else
+                s = _mm_srai_epi32(_mm_slli_epi32(s, 16), 16);
+            _mm_storeu_ps(dst, _mm_mul_ps(_mm_cvtepi32_ps(s), scale));
+        }
+    }
+#endif
+
+    while (count--)
+    {
+        SHORT sample = (SHORT)le16(*(const SHORT *)buf);
+        *dst++ = sample / (float)0x8000;
+        buf += stride;
+    }
+}
+
+static void get24_block(const IDirectSoundBufferImpl *dsb, const BYTE *base, DWORD channel, float *dst, UINT count)
+{
+    UINT stride = dsb->pwfx->nBlockAlign;
+    const BYTE *buf = base + 3 * channel;
+
+    while (count--)
+    {
+        LONG sample = (buf[0] << 8) | (buf[1] << 16) | (buf[2] << 24);
+        *dst++ = sample / (float)0x80000000U;
+        buf += stride;
+    }
+}
+
+static void get32_block(const IDirectSoundBufferImpl *dsb, const BYTE *base, DWORD channel, float *dst, UINT count)
+{
+    UINT stride = dsb->pwfx->nBlockAlign;
+    const BYTE *buf = base + 4 * channel;
+
+    while (count--)
+    {
+        LONG sample = le32(*(const LONG *)buf);
+        *dst++ = sample / (float)0x80000000U;
+        buf += stride;
+    }
+}
+
+static void getieee32_block(const IDirectSoundBufferImpl *dsb, const BYTE *base, DWORD channel, float *dst,
+        UINT count)
+{
+    UINT stride = dsb->pwfx->nBlockAlign;
+    const BYTE *buf = base + 4 * channel;
+
+    while (count--)
+    {
+        *dst++ = *(const float *)buf;
+        buf += stride;
+    }
+}
+
+const bitsblockfunc getbpp_block[5] = {get8_block, get16_block, get24_block, get32_block, getieee32_block};
+
+void get_mono_block(const IDirectSoundBufferImpl *dsb, const BYTE *base, DWORD channel, float *dst, UINT count)
+{
+    UINT stride = dsb->pwfx->nBlockAlign;
+
+    while (count--)
+    {
+        *dst++ = get_mono(dsb, (BYTE *)base, channel);
+        base += stride;
+    }
+}
+
 static inline unsigned char f_to_8(float value)
 {
     if(value <= -1.f)
@@ -324,10 +439,49 @@ void put_quad2stereo(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel
 void mixieee32(float *src, float *dst, unsigned samples)
 {
     TRACE("%p - %p %d\n", src, dst, samples);
+#ifdef __SSE2__
+    for (; samples >= 4; samples -= 4, src += 4, dst += 4)
+        _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), _mm_loadu_ps(src)));
+#endif
     while (samples--)
         *(dst++) += *(src++);
 }
 
+/* Same as mixieee32(), but scales each channel of src by vols[channel] on the way. */
+void mixieee32_vol(const float *src, float *dst, const float *vols, unsigned channels, unsigned frames)
+{
+    unsigned samples = frames * channels, i = 0;
+
+    TRACE("%p - %p %u %u\n", src, dst, channels, frames);
+#ifdef __SSE2__
+    {
+        /* The volume pattern repeats every lcm(4, channels) samples, which is
+         * at most five vectors for DS_MAX_CHANNELS channels. */
+        unsigned period = channels % 4 == 0 ? channels : channels % 2 == 0 ? channels * 2 : channels * 4;
+        __m128 v[5];
+        unsigned k;
+
+        if (period <= 4 * ARRAY_SIZE(v))
+        {
+            for (k = 0; k < period / 4; ++k)
+                v[k] = _mm_setr_ps(vols[(4 * k) % channels], vols[(4 * k + 1) % channels],
+                        vols[(4 * k + 2) % channels], vols[(4 * k + 3) % channels]);
+
+            for (; i + period <= samples; i += period)
+            {
+                for (k = 0; k < period / 4; ++k)
+                {
+                    __m128 s = _mm_mul_ps(_mm_loadu_ps(src + i + 4 * k), v[k]);
+                    _mm_storeu_ps(dst + i + 4 * k, _mm_add_ps(_mm_loadu_ps(dst + i + 4 * k), s));
+                }
+            }
+        }
+    }
+#endif
+    for (; i < samples; ++i)
+        dst[i] += src[i] * vols[i % channels];
+}
+
 static void norm8(float *src, unsigned char *dst, unsigned samples)
 {
     TRACE("%p - %p %d\n", src, dst, samples);
@@ -342,6 +496,24 @@ static void norm8(float *src, unsigned char *dst, unsigned samples)
 static void norm16(float *src, SHORT *dst, unsigned samples)
 {
     TRACE("%p - %p %d\n", src, dst, samples);
+#ifdef __SSE2__
+    {
+        /* Clamp first, so that large values don't convert to the integer
+         * indefinite value; packing then saturates like f_to_16() does. */
+        const __m128 one = _mm_set1_ps(1.0f), minus_one = _mm_set1_ps(-1.0f);
+        const __m128 scale = _mm_set1_ps(0x8000);
+
+        for (; samples >= 8; samples -= 8, src += 8, dst += 8)
+        {
+            __m128 lo = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(src), one), minus_one);
+            __m128 hi = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + 4), one), minus_one);
+            __m128i ilo = _mm_cvtps_epi32(_mm_mul_ps(lo, scale));
+            __m128i ihi = _mm_cvtps_epi32(_mm_mul_ps(hi, scale));
+
+            _mm_storeu_si128((__m128i *)dst, _mm_packs_epi32(ilo, ihi));
+        }
+    }
+#endif
     while (samples--)
     {
         *dst = f_to_16(*src);
@@ -45,13 +45,25 @@ typedef struct DirectSoundDevice             DirectSoundDevice;
 /* dsound_convert.h */
 typedef float (*bitsgetfunc)(const IDirectSoundBufferImpl *, BYTE *, DWORD);
 typedef void (*bitsputfunc)(const IDirectSoundBufferImpl *, DWORD, DWORD, float);
+typedef void (*bitsblockfunc)(const IDirectSoundBufferImpl *, const BYTE *, DWORD, float *, UINT);
 extern const bitsgetfunc getbpp[5];
+extern const bitsblockfunc getbpp_block[5];
 void putieee32(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value);
 void putieee32_sum(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value);
 void mixieee32(float *src, float *dst, unsigned samples);
+void mixieee32_vol(const float *src, float *dst, const float *vols, unsigned channels, unsigned frames);
 typedef void (*normfunc)(const void *, void *, unsigned);
 extern const normfunc normfunctions[4];
 
+/* The FIR from fir.h, rearranged for one resampling step. Row p holds the
+ * taps fir[p], fir[p + step], ... which are used together for phase p. */
+struct dsound_fir_table
+{
+    DWORD step;
+    UINT width;
+    float *coeffs;
+};
+
 typedef struct _DSVOLUMEPAN
 {
     DWORD	dwTotalAmpFactor[DS_MAX_CHANNELS];
@@ -90,6 +102,8 @@ struct DirectSoundDevice
     int                         lfe_channel;
     float *tmp_buffer, *cp_buffer;
     DWORD                       tmp_buffer_len, cp_buffer_len;
+    struct dsound_fir_table     fir_tables[4];
+    unsigned int                next_fir_table;
 
     DSVOLUMEPAN                 volpan;
 
@@ -169,6 +183,7 @@ struct IDirectSoundBufferImpl
     /* Used for bit depth conversion */
     int                         mix_channels;
     bitsgetfunc get, get_aux;
+    bitsblockfunc get_block;
     bitsputfunc put, put_aux;
     int                         num_filters;
     DSFilter*                   filters;
@@ -177,6 +192,7 @@ struct IDirectSoundBufferImpl
 };
 
 float get_mono(const IDirectSoundBufferImpl *dsb, BYTE *base, DWORD channel);
+void get_mono_block(const IDirectSoundBufferImpl *dsb, const BYTE *base, DWORD channel, float *dst, UINT count);
 void put_mono2stereo(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value);
 void put_mono2quad(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value);
 void put_stereo2quad(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value);
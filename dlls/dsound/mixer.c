@@ -25,6 +25,9 @@
 #include <assert.h>
 #include <stdarg.h>
 #include <math.h>	/* Insomnia - pow() function */
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #define COBJMACROS
 
@@ -139,6 +142,7 @@ void DSOUND_RecalcFormat(IDirectSoundBufferImpl *dsb)
 	dsb->put_aux = putieee32;
 
 	dsb->get = dsb->get_aux;
+	dsb->get_block = ieee ? getbpp_block[4] : getbpp_block[dsb->pwfx->wBitsPerSample/8 - 1];
 	dsb->put = dsb->put_aux;
 
 	if (ichannels == ochannels)
@@ -164,6 +168,7 @@ void DSOUND_RecalcFormat(IDirectSoundBufferImpl *dsb)
 	{
 		dsb->mix_channels = 1;
 		dsb->get = get_mono;
+		dsb->get_block = get_mono_block;
 	}
 	else if (ichannels == 2 && ochannels == 4)
 	{
@@ -278,42 +283,175 @@ void DSOUND_CheckEvent(const IDirectSoundBufferImpl *dsb, DWORD playpos, int len
     }
 }
 
-static inline float get_current_sample(const IDirectSoundBufferImpl *dsb,
-        BYTE *buffer, DWORD buflen, DWORD mixpos, DWORD channel)
+/**
+ * Convert "count" frames of one channel, starting at mixpos, into a
+ * contiguous float array. Frames past the end of a non-looping buffer
+ * are silent.
+ */
+static void get_current_samples(const IDirectSoundBufferImpl *dsb, BYTE *buffer, DWORD buflen,
+        DWORD mixpos, DWORD channel, float *dst, UINT count)
 {
-    if (mixpos >= buflen && !(dsb->playflags & DSBPLAY_LOOPING))
-        return 0.0f;
-    return dsb->get(dsb, buffer + (mixpos % buflen), channel);
+    UINT istride = dsb->pwfx->nBlockAlign, frames;
+
+    while (count)
+    {
+        if (mixpos >= buflen)
+        {
+            if (!(dsb->playflags & DSBPLAY_LOOPING))
+            {
+                memset(dst, 0, count * sizeof(float));
+                return;
+            }
+            mixpos %= buflen;
+        }
+
+        frames = min(count, (buflen - mixpos) / istride);
+        if (!frames)
+        {
+            /* A partial frame at the end of the buffer. */
+            *dst = dsb->get(dsb, buffer + mixpos, channel);
+            frames = 1;
+        }
+        else
+            dsb->get_block(dsb, buffer + mixpos, channel, dst, frames);
+
+        dst += frames;
+        count -= frames;
+        mixpos += frames * istride;
+    }
+}
+
+/* Get the samples for one channel, reading from the committed copy first. */
+static void get_channel_samples(const IDirectSoundBufferImpl *dsb, DWORD channel, float *dst,
+        UINT committed_samples, UINT count)
+{
+    UINT istride = dsb->pwfx->nBlockAlign;
+
+    get_current_samples(dsb, dsb->committedbuff, dsb->writelead, dsb->committed_mixpos,
+            channel, dst, committed_samples);
+    get_current_samples(dsb, dsb->buffer->memory, dsb->buflen, dsb->sec_mixpos + committed_samples * istride,
+            channel, dst + committed_samples, count - committed_samples);
+}
+
+static float *get_cp_buffer(DirectSoundDevice *device, DWORD len)
+{
+    float *buffer;
+
+    if (device->cp_buffer && len <= device->cp_buffer_len)
+        return device->cp_buffer;
+
+    if (!(buffer = realloc(device->cp_buffer, len)))
+        return NULL;
+    device->cp_buffer = buffer;
+    device->cp_buffer_len = len;
+    return buffer;
 }
 
 static UINT cp_fields_noresample(IDirectSoundBufferImpl *dsb, UINT count)
 {
     UINT istride = dsb->pwfx->nBlockAlign;
-    UINT ostride = dsb->device->pwfx->nChannels * sizeof(float);
+    UINT ochannels = dsb->device->pwfx->nChannels;
+    UINT ostride = ochannels * sizeof(float);
     UINT committed_samples = 0;
     DWORD channel, i;
+    float *samples;
 
     if (!secondarybuffer_is_audible(dsb))
         return count;
 
+    if (!(samples = get_cp_buffer(dsb->device, count * sizeof(float))))
+        return count;
+
     if(dsb->use_committed) {
         committed_samples = (dsb->writelead - dsb->committed_mixpos) / istride;
         committed_samples = committed_samples <= count ? committed_samples : count;
     }
 
-    for (i = 0; i < committed_samples; i++)
-        for (channel = 0; channel < dsb->mix_channels; channel++)
-            dsb->put(dsb, i * ostride, channel, get_current_sample(dsb, dsb->committedbuff,
-                dsb->writelead, dsb->committed_mixpos + i * istride, channel));
+    for (channel = 0; channel < dsb->mix_channels; channel++) {
+        get_channel_samples(dsb, channel, samples, committed_samples, count);
+
+        if (dsb->put == putieee32) {
+            float *out = dsb->device->tmp_buffer + channel;
 
-    for (; i < count; i++)
-        for (channel = 0; channel < dsb->mix_channels; channel++)
-            dsb->put(dsb, i * ostride, channel, get_current_sample(dsb, dsb->buffer->memory,
-                dsb->buflen, dsb->sec_mixpos + i * istride, channel));
+            for (i = 0; i < count; i++)
+                out[i * ochannels] = samples[i];
+        } else {
+            for (i = 0; i < count; i++)
+                dsb->put(dsb, i * ostride, channel, samples[i]);
+        }
+    }
 
     return count;
 }
 
+/**
+ * Get the FIR rearranged for the given step, so that the taps used for any
+ * one phase are contiguous. There is one more row than there are phases,
+ * since interpolating between phases also reads the row after the last one.
+ */
+static const struct dsound_fir_table *get_fir_table(DirectSoundDevice *device, DWORD step)
+{
+    struct dsound_fir_table *table;
+    UINT i, k, width;
+    float *coeffs;
+
+    for (i = 0; i < ARRAY_SIZE(device->fir_tables); ++i)
+    {
+        if (device->fir_tables[i].coeffs && device->fir_tables[i].step == step)
+            return &device->fir_tables[i];
+    }
+
+    width = (fir_len + step - 2) / step;
+    if (!(coeffs = malloc((step + 1) * width * sizeof(*coeffs))))
+        return NULL;
+    for (i = 0; i <= step; ++i)
+        for (k = 0; k < width; ++k)
+            coeffs[i * width + k] = i + k * step < fir_len ? fir[i + k * step] : 0.0f;
+
+    table = &device->fir_tables[device->next_fir_table++ % ARRAY_SIZE(device->fir_tables)];
+    free(table->coeffs);
+    table->step = step;
+    table->width = width;
+    table->coeffs = coeffs;
+    return table;
+}
+
+/* Interpolate between the taps of two neighbouring phases. */
+static inline void fir_interpolate(float *dst, const float *a, const float *b, float rem, int count)
+{
+    int j = 0;
+
+#ifdef __SSE2__
+    const __m128 r = _mm_set1_ps(rem), r1 = _mm_set1_ps(1.0f - rem);
+
+    for (; j + 4 <= count; j += 4)
+        _mm_storeu_ps(dst + j, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + j), r1), _mm_mul_ps(_mm_loadu_ps(b + j), r)));
+#endif
+
+    for (; j < count; j++)
+        dst[j] = a[j] * (1.0f - rem) + b[j] * rem;
+}
+
+static inline float fir_dot(const float *coeffs, const float *samples, int count)
+{
+    float sum = 0.0f;
+    int j = 0;
+
+#ifdef __SSE2__
+    __m128 acc = _mm_setzero_ps();
+
+    for (; j + 4 <= count; j += 4)
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(coeffs + j), _mm_loadu_ps(samples + j)));
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    sum = _mm_cvtss_f32(acc);
+#endif
+
+    for (; j < count; j++)
+        sum += coeffs[j] * samples[j];
+    return sum;
+}
+
 static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *freqAccNum)
 {
     UINT i, channel;
@@ -329,7 +467,9 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
 
     UINT fir_cachesize = (fir_len + dsbfirstep - 2) / dsbfirstep;
     UINT required_input = max_ipos + fir_cachesize;
-    float *intermediate, *fir_copy, *itmp;
+    const struct dsound_fir_table *table;
+    LONG64 fir_pos, fir_div, fir_mod, step_div, step_mod;
+    float *intermediate, *fir_copy;
 
     DWORD len = required_input * channels;
     len += fir_cachesize;
@@ -340,15 +480,10 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
     if (!secondarybuffer_is_audible(dsb))
         return max_ipos;
 
-    if (!dsb->device->cp_buffer) {
-        dsb->device->cp_buffer = malloc(len);
-        dsb->device->cp_buffer_len = len;
-    } else if (len > dsb->device->cp_buffer_len) {
-        dsb->device->cp_buffer = realloc(dsb->device->cp_buffer, len);
-        dsb->device->cp_buffer_len = len;
-    }
-
-    fir_copy = dsb->device->cp_buffer;
+    if (!(table = get_fir_table(dsb->device, dsbfirstep)))
+        return max_ipos;
+    if (!(fir_copy = get_cp_buffer(dsb->device, len)))
+        return max_ipos;
     intermediate = fir_copy + fir_cachesize;
 
     if(dsb->use_committed) {
@@ -356,45 +491,52 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
         committed_samples = committed_samples <= required_input ? committed_samples : required_input;
     }
 
-    /* Important: this buffer MUST be non-interleaved
-     * if you want -msse3 to have any effect.
+    /* Important: this buffer MUST be non-interleaved, so that the
+     * filter below can run over contiguous samples.
      * This is good for CPU cache effects, too.
      */
-    itmp = intermediate;
-    for (channel = 0; channel < channels; channel++) {
-        for (i = 0; i < committed_samples; i++)
-            *(itmp++) = get_current_sample(dsb, dsb->committedbuff,
-                dsb->writelead, dsb->committed_mixpos + i * istride, channel);
-        for (; i < required_input; i++)
-            *(itmp++) = get_current_sample(dsb, dsb->buffer->memory,
-                    dsb->buflen, dsb->sec_mixpos + i * istride, channel);
-    }
+    for (channel = 0; channel < channels; channel++)
+        get_channel_samples(dsb, channel, intermediate + channel * required_input,
+                committed_samples, required_input);
+
+    /* Track the position in FIR steps incrementally, instead of dividing
+     * for each output sample. */
+    fir_pos = freqAcc_start * dsbfirstep;
+    fir_div = fir_pos / dsb->freqAdjustDen;
+    fir_mod = fir_pos % dsb->freqAdjustDen;
+    step_div = dsb->freqAdjustNum * dsbfirstep / dsb->freqAdjustDen;
+    step_mod = dsb->freqAdjustNum * dsbfirstep % dsb->freqAdjustDen;
 
     for(i = 0; i < count; ++i) {
-        UINT int_fir_steps = (freqAcc_start + i * dsb->freqAdjustNum) * dsbfirstep / dsb->freqAdjustDen;
-        float total_fir_steps = (freqAcc_start + i * dsb->freqAdjustNum) * dsbfirstep / (float)dsb->freqAdjustDen;
+        UINT int_fir_steps = fir_div;
+        float total_fir_steps = fir_pos / (float)dsb->freqAdjustDen;
         UINT ipos = int_fir_steps / dsbfirstep;
 
         UINT idx = (ipos + 1) * dsbfirstep - int_fir_steps - 1;
         float rem = int_fir_steps + 1.0 - total_fir_steps;
 
-        int fir_used = 0;
-        while (idx < fir_len - 1) {
-            fir_copy[fir_used++] = fir[idx] * (1.0 - rem) + fir[idx + 1] * rem;
-            idx += dsb->firstep;
-        }
+        /* The taps fir[idx], fir[idx + firstep], ... up to the end of the
+         * FIR, interpolated with the ones of the next phase. */
+        const float *coeffs = table->coeffs + idx * table->width;
+        int fir_used = (fir_len - 2 - idx) / dsbfirstep + 1;
+
+        fir_interpolate(fir_copy, coeffs, coeffs + table->width, rem, fir_used);
 
         assert(fir_used <= fir_cachesize);
         assert(ipos + fir_used <= required_input);
 
         for (channel = 0; channel < dsb->mix_channels; channel++) {
-            int j;
-            float sum = 0.0;
-            float* cache = &intermediate[channel * required_input + ipos];
-            for (j = 0; j < fir_used; j++)
-                sum += fir_copy[j] * cache[j];
+            float sum = fir_dot(fir_copy, &intermediate[channel * required_input + ipos], fir_used);
             dsb->put(dsb, i * ostride, channel, sum * dsb->firgain);
         }
+
+        fir_pos += dsb->freqAdjustNum * dsbfirstep;
+        fir_div += step_div;
+        fir_mod += step_mod;
+        if (fir_mod >= dsb->freqAdjustDen) {
+            fir_mod -= dsb->freqAdjustDen;
+            fir_div++;
+        }
     }
 
     return max_ipos;
@@ -485,35 +627,33 @@ static void DSOUND_MixToTemporary(IDirectSoundBufferImpl *dsb, DWORD frames)
 	}
 }
 
-static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, INT frames)
+/**
+ * Compute the per channel volume of the given secondary buffer.
+ *
+ * Returns FALSE if the samples don't need to be scaled at all.
+ */
+static BOOL DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, float *vols)
 {
-	INT	i;
-	float vols[DS_MAX_CHANNELS];
-	UINT channels = dsb->device->pwfx->nChannels, chan;
+	UINT channels = dsb->device->pwfx->nChannels, i;
 
-	TRACE("(%p,%d)\n",dsb,frames);
+	TRACE("(%p)\n",dsb);
 	TRACE("left = %lx, right = %lx\n", dsb->volpan.dwTotalAmpFactor[0],
 		dsb->volpan.dwTotalAmpFactor[1]);
 
 	if ((!(dsb->dsbd.dwFlags & DSBCAPS_CTRLPAN) || (dsb->volpan.lPan == 0)) &&
 	    (!(dsb->dsbd.dwFlags & DSBCAPS_CTRLVOLUME) || (dsb->volpan.lVolume == 0)) &&
 	     !(dsb->dsbd.dwFlags & DSBCAPS_CTRL3D))
-		return; /* Nothing to do */
+		return FALSE; /* Nothing to do */
 
 	if (channels > DS_MAX_CHANNELS)
 	{
 		FIXME("There is no support for %u channels\n", channels);
-		return;
+		return FALSE;
 	}
 
 	for (i = 0; i < channels; ++i)
 		vols[i] = dsb->volpan.dwTotalAmpFactor[i] / ((float)0xFFFF);
-
-	for(i = 0; i < frames; ++i){
-		for(chan = 0; chan < channels; ++chan){
-			dsb->device->tmp_buffer[i * channels + chan] *= vols[chan];
-		}
-	}
+	return TRUE;
 }
 
 /**
@@ -542,10 +682,14 @@ static DWORD DSOUND_MixInBuffer(IDirectSoundBufferImpl *dsb, float *mix_buffer,
 	ibuf = dsb->device->tmp_buffer;
 
 	if (secondarybuffer_is_audible(dsb)) {
-		/* Apply volume if needed */
-		DSOUND_MixerVol(dsb, frames);
-
-		mixieee32(ibuf, mix_buffer, frames * dsb->device->pwfx->nChannels);
+		UINT channels = dsb->device->pwfx->nChannels;
+		float vols[DS_MAX_CHANNELS];
+
+		/* Apply volume if needed, while mixing */
+		if (DSOUND_MixerVol(dsb, vols))
+			mixieee32_vol(ibuf, mix_buffer, vols, channels, frames);
+		else
+			mixieee32(ibuf, mix_buffer, frames * channels);
 	}
 
 	/* check for notification positions */
@@ -689,8 +833,8 @@ static void DSOUND_WaveQueue(DirectSoundDevice *device, LPBYTE pos, DWORD bytes)
  *
  * secondary->buffer (secondary format)
  *   =[Resample]=> device->tmp_buffer (float format)
- *   =[Volume]=> device->tmp_buffer (float format)
- *   =[Reformat]=> device->buffer (device format, skipped on float)
+ *   =[Volume and mix]=> device->buffer (float format)
+ *   =[Reformat]=> device buffer (device format, skipped on float)
  */
 static void DSOUND_PerformMix(DirectSoundDevice *device)
 {
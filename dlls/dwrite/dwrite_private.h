@@ -269,6 +269,13 @@ struct dwrite_fontface
         size_t max_size;
         size_t size;
     } cache;
+    struct
+    {
+        struct wine_rb_tree tree;
+        struct list mru;
+        size_t max_size;
+        size_t size;
+    } shaped_runs;
     CRITICAL_SECTION cs;
 
     USHORT simulations;
@@ -382,6 +389,44 @@ extern float fontface_get_scaled_design_advance(struct dwrite_fontface *fontface
         float emsize, float ppdip, const DWRITE_MATRIX *transform, UINT16 glyph, BOOL is_sideways) DECLSPEC_HIDDEN;
 extern struct dwrite_fontface *unsafe_impl_from_IDWriteFontFace(IDWriteFontFace *iface) DECLSPEC_HIDDEN;
 
+struct shaped_run_key
+{
+    unsigned int hash;
+    unsigned int size;
+    const void *data;
+};
+
+struct shaped_run
+{
+    unsigned int text_length;
+    unsigned int glyph_count;
+    UINT16 *clustermap;
+    DWRITE_SHAPING_TEXT_PROPERTIES *text_props;
+    UINT16 *glyphs;
+    DWRITE_SHAPING_GLYPH_PROPERTIES *glyph_props;
+};
+
+struct shaped_run_placement_key
+{
+    float emsize;
+    float ppdip;
+    DWRITE_MATRIX transform;
+    BOOL gdi_compatible;
+    BOOL use_gdi_natural;
+};
+
+extern void release_shaped_run(struct shaped_run *run) DECLSPEC_HIDDEN;
+extern BOOL fontface_get_shaped_run(IDWriteFontFace *fontface, const struct shaped_run_key *key,
+        struct shaped_run *run) DECLSPEC_HIDDEN;
+extern void fontface_cache_shaped_run(IDWriteFontFace *fontface, const struct shaped_run_key *key,
+        const struct shaped_run *run) DECLSPEC_HIDDEN;
+extern BOOL fontface_get_shaped_run_placement(IDWriteFontFace *fontface, const struct shaped_run_key *key,
+        const struct shaped_run_placement_key *placement_key, unsigned int glyph_count, float *advances,
+        DWRITE_GLYPH_OFFSET *offsets) DECLSPEC_HIDDEN;
+extern void fontface_cache_shaped_run_placement(IDWriteFontFace *fontface, const struct shaped_run_key *key,
+        const struct shaped_run_placement_key *placement_key, unsigned int glyph_count, const float *advances,
+        const DWRITE_GLYPH_OFFSET *offsets) DECLSPEC_HIDDEN;
+
 struct dwrite_textformat_data
 {
     WCHAR *family_name;
@@ -279,6 +279,290 @@ static void fontface_cache_clear(struct dwrite_fontface *fontface)
     memset(&fontface->cache, 0, sizeof(fontface->cache));
 }
 
+/* Shaped runs are kept per font face, keyed by everything else that affects shaping: the text, script analysis,
+   direction, locale and features. Glyph placements also depend on the font size and measuring mode, a few of them
+   are kept for each run. */
+#define SHAPED_RUN_MAX_PLACEMENTS 4
+
+struct shaped_run_placement
+{
+    struct list entry;
+    struct shaped_run_placement_key key;
+    float *advances;
+    DWRITE_GLYPH_OFFSET *offsets;
+};
+
+struct shaped_run_entry
+{
+    struct wine_rb_entry entry;
+    struct list mru;
+    struct shaped_run_key key;
+    struct shaped_run run;
+    struct list placements;
+    unsigned int placement_count;
+    size_t size;
+};
+
+static void release_shaped_run_placement(struct shaped_run_placement *placement)
+{
+    free(placement->advances);
+    free(placement->offsets);
+    free(placement);
+}
+
+static void fontface_release_shaped_run_entry(struct shaped_run_entry *entry)
+{
+    struct shaped_run_placement *placement, *placement2;
+
+    LIST_FOR_EACH_ENTRY_SAFE(placement, placement2, &entry->placements, struct shaped_run_placement, entry)
+        release_shaped_run_placement(placement);
+    release_shaped_run(&entry->run);
+    free((void *)entry->key.data);
+    free(entry);
+}
+
+static int fontface_shaped_runs_compare(const void *k, const struct wine_rb_entry *e)
+{
+    const struct shaped_run_entry *entry = WINE_RB_ENTRY_VALUE(e, const struct shaped_run_entry, entry);
+    const struct shaped_run_key *key = k, *key2 = &entry->key;
+
+    if (key->hash != key2->hash) return key->hash < key2->hash ? -1 : 1;
+    if (key->size != key2->size) return key->size < key2->size ? -1 : 1;
+    return memcmp(key->data, key2->data, key->size);
+}
+
+static void fontface_shaped_runs_init(struct dwrite_fontface *fontface)
+{
+    wine_rb_init(&fontface->shaped_runs.tree, fontface_shaped_runs_compare);
+    list_init(&fontface->shaped_runs.mru);
+    fontface->shaped_runs.max_size = 0x40000;
+}
+
+static void fontface_shaped_runs_clear(struct dwrite_fontface *fontface)
+{
+    struct shaped_run_entry *entry, *entry2;
+
+    LIST_FOR_EACH_ENTRY_SAFE(entry, entry2, &fontface->shaped_runs.mru, struct shaped_run_entry, mru)
+    {
+        list_remove(&entry->mru);
+        fontface_release_shaped_run_entry(entry);
+    }
+    memset(&fontface->shaped_runs, 0, sizeof(fontface->shaped_runs));
+}
+
+/* Evicts least recently used runs, other than 'keep', until 'size' more bytes fit in the cache. */
+static void fontface_shaped_runs_evict(struct dwrite_fontface *fontface, const struct shaped_run_entry *keep,
+        size_t size)
+{
+    struct shaped_run_entry *entry;
+
+    while (fontface->shaped_runs.size + size > fontface->shaped_runs.max_size
+            && !list_empty(&fontface->shaped_runs.mru))
+    {
+        entry = LIST_ENTRY(list_tail(&fontface->shaped_runs.mru), struct shaped_run_entry, mru);
+        if (entry == keep) break;
+        fontface->shaped_runs.size -= entry->size;
+        wine_rb_remove(&fontface->shaped_runs.tree, &entry->entry);
+        list_remove(&entry->mru);
+        fontface_release_shaped_run_entry(entry);
+    }
+}
+
+static struct shaped_run_entry *fontface_get_shaped_run_entry(struct dwrite_fontface *fontface,
+        const struct shaped_run_key *key)
+{
+    struct shaped_run_entry *entry;
+    struct wine_rb_entry *e;
+
+    if (!(e = wine_rb_get(&fontface->shaped_runs.tree, key)))
+        return NULL;
+
+    entry = WINE_RB_ENTRY_VALUE(e, struct shaped_run_entry, entry);
+    list_remove(&entry->mru);
+    list_add_head(&fontface->shaped_runs.mru, &entry->mru);
+
+    return entry;
+}
+
+static size_t get_shaped_run_size(unsigned int text_length, unsigned int glyph_count)
+{
+    return text_length * (sizeof(UINT16) + sizeof(DWRITE_SHAPING_TEXT_PROPERTIES))
+            + glyph_count * (sizeof(UINT16) + sizeof(DWRITE_SHAPING_GLYPH_PROPERTIES));
+}
+
+static size_t get_shaped_run_placement_size(unsigned int glyph_count)
+{
+    return sizeof(struct shaped_run_placement) + glyph_count * (sizeof(float) + sizeof(DWRITE_GLYPH_OFFSET));
+}
+
+static BOOL copy_shaped_run(struct shaped_run *dst, const struct shaped_run *src)
+{
+    dst->text_length = src->text_length;
+    dst->glyph_count = src->glyph_count;
+    dst->clustermap = malloc(src->text_length * sizeof(*dst->clustermap));
+    dst->text_props = malloc(src->text_length * sizeof(*dst->text_props));
+    dst->glyphs = malloc(max(src->glyph_count, 1) * sizeof(*dst->glyphs));
+    dst->glyph_props = malloc(max(src->glyph_count, 1) * sizeof(*dst->glyph_props));
+    if (!dst->clustermap || !dst->text_props || !dst->glyphs || !dst->glyph_props)
+    {
+        release_shaped_run(dst);
+        return FALSE;
+    }
+
+    memcpy(dst->clustermap, src->clustermap, src->text_length * sizeof(*dst->clustermap));
+    memcpy(dst->text_props, src->text_props, src->text_length * sizeof(*dst->text_props));
+    memcpy(dst->glyphs, src->glyphs, src->glyph_count * sizeof(*dst->glyphs));
+    memcpy(dst->glyph_props, src->glyph_props, src->glyph_count * sizeof(*dst->glyph_props));
+
+    return TRUE;
+}
+
+void release_shaped_run(struct shaped_run *run)
+{
+    free(run->clustermap);
+    free(run->text_props);
+    free(run->glyphs);
+    free(run->glyph_props);
+    memset(run, 0, sizeof(*run));
+}
+
+BOOL fontface_get_shaped_run(IDWriteFontFace *iface, const struct shaped_run_key *key, struct shaped_run *run)
+{
+    struct dwrite_fontface *fontface = unsafe_impl_from_IDWriteFontFace(iface);
+    struct shaped_run_entry *entry;
+    BOOL ret = FALSE;
+
+    EnterCriticalSection(&fontface->cs);
+    if ((entry = fontface_get_shaped_run_entry(fontface, key)))
+        ret = copy_shaped_run(run, &entry->run);
+    LeaveCriticalSection(&fontface->cs);
+
+    return ret;
+}
+
+void fontface_cache_shaped_run(IDWriteFontFace *iface, const struct shaped_run_key *key, const struct shaped_run *run)
+{
+    struct dwrite_fontface *fontface = unsafe_impl_from_IDWriteFontFace(iface);
+    struct shaped_run_entry *entry;
+    void *data;
+    size_t size;
+
+    /* Leave room for all placements of the run, so that a single entry never takes more than a quarter of the cache. */
+    size = sizeof(*entry) + key->size + get_shaped_run_size(run->text_length, run->glyph_count);
+    if (size + SHAPED_RUN_MAX_PLACEMENTS * get_shaped_run_placement_size(run->glyph_count)
+            > fontface->shaped_runs.max_size / 4)
+        return;
+
+    if (!(entry = calloc(1, sizeof(*entry))))
+        return;
+    if (!(data = malloc(key->size)) || !copy_shaped_run(&entry->run, run))
+    {
+        free(data);
+        free(entry);
+        return;
+    }
+    memcpy(data, key->data, key->size);
+    entry->key = *key;
+    entry->key.data = data;
+    entry->size = size;
+    list_init(&entry->placements);
+
+    EnterCriticalSection(&fontface->cs);
+    if (wine_rb_get(&fontface->shaped_runs.tree, key))
+    {
+        fontface_release_shaped_run_entry(entry);
+    }
+    else
+    {
+        fontface_shaped_runs_evict(fontface, NULL, size);
+        wine_rb_put(&fontface->shaped_runs.tree, &entry->key, &entry->entry);
+        list_add_head(&fontface->shaped_runs.mru, &entry->mru);
+        fontface->shaped_runs.size += size;
+    }
+    LeaveCriticalSection(&fontface->cs);
+}
+
+BOOL fontface_get_shaped_run_placement(IDWriteFontFace *iface, const struct shaped_run_key *key,
+        const struct shaped_run_placement_key *placement_key, unsigned int glyph_count, float *advances,
+        DWRITE_GLYPH_OFFSET *offsets)
+{
+    struct dwrite_fontface *fontface = unsafe_impl_from_IDWriteFontFace(iface);
+    struct shaped_run_placement *placement;
+    struct shaped_run_entry *entry;
+    BOOL ret = FALSE;
+
+    EnterCriticalSection(&fontface->cs);
+    if ((entry = fontface_get_shaped_run_entry(fontface, key)) && entry->run.glyph_count == glyph_count)
+    {
+        LIST_FOR_EACH_ENTRY(placement, &entry->placements, struct shaped_run_placement, entry)
+        {
+            if (memcmp(&placement->key, placement_key, sizeof(*placement_key)))
+                continue;
+
+            memcpy(advances, placement->advances, glyph_count * sizeof(*advances));
+            memcpy(offsets, placement->offsets, glyph_count * sizeof(*offsets));
+            list_remove(&placement->entry);
+            list_add_head(&entry->placements, &placement->entry);
+            ret = TRUE;
+            break;
+        }
+    }
+    LeaveCriticalSection(&fontface->cs);
+
+    return ret;
+}
+
+void fontface_cache_shaped_run_placement(IDWriteFontFace *iface, const struct shaped_run_key *key,
+        const struct shaped_run_placement_key *placement_key, unsigned int glyph_count, const float *advances,
+        const DWRITE_GLYPH_OFFSET *offsets)
+{
+    struct dwrite_fontface *fontface = unsafe_impl_from_IDWriteFontFace(iface);
+    struct shaped_run_placement *placement;
+    struct shaped_run_entry *entry;
+    size_t size;
+
+    if (!(placement = calloc(1, sizeof(*placement))))
+        return;
+    placement->key = *placement_key;
+    placement->advances = malloc(max(glyph_count, 1) * sizeof(*placement->advances));
+    placement->offsets = malloc(max(glyph_count, 1) * sizeof(*placement->offsets));
+    if (!placement->advances || !placement->offsets)
+    {
+        release_shaped_run_placement(placement);
+        return;
+    }
+    memcpy(placement->advances, advances, glyph_count * sizeof(*advances));
+    memcpy(placement->offsets, offsets, glyph_count * sizeof(*offsets));
+    size = get_shaped_run_placement_size(glyph_count);
+
+    EnterCriticalSection(&fontface->cs);
+    if ((entry = fontface_get_shaped_run_entry(fontface, key)) && entry->run.glyph_count == glyph_count)
+    {
+        if (entry->placement_count == SHAPED_RUN_MAX_PLACEMENTS)
+        {
+            struct shaped_run_placement *old = LIST_ENTRY(list_tail(&entry->placements),
+                    struct shaped_run_placement, entry);
+
+            list_remove(&old->entry);
+            release_shaped_run_placement(old);
+            entry->placement_count--;
+            entry->size -= size;
+            fontface->shaped_runs.size -= size;
+        }
+
+        fontface_shaped_runs_evict(fontface, entry, size);
+        list_add_head(&entry->placements, &placement->entry);
+        entry->placement_count++;
+        entry->size += size;
+        fontface->shaped_runs.size += size;
+        placement = NULL;
+    }
+    LeaveCriticalSection(&fontface->cs);
+
+    if (placement)
+        release_shaped_run_placement(placement);
+}
+
 struct dwrite_font_propvec {
     FLOAT stretch;
     FLOAT style;
@@ -889,6 +1173,7 @@ static ULONG WINAPI dwritefontface_Release(IDWriteFontFace5 *iface)
             IDWriteFontFileStream_Release(fontface->stream);
         }
         fontface_cache_clear(fontface);
+        fontface_shaped_runs_clear(fontface);
 
         dwrite_cmap_release(&fontface->cmap);
         IDWriteFactory7_Release(fontface->factory);
@@ -5500,6 +5785,7 @@ HRESULT create_fontface(const struct fontface_desc *desc, struct list *cached_li
     IDWriteFontFileStream_AddRef(fontface->stream);
     InitializeCriticalSection(&fontface->cs);
     fontface_cache_init(fontface);
+    fontface_shaped_runs_init(fontface);
 
     stream_desc.stream = fontface->stream;
     stream_desc.face_type = desc->face_type;
@@ -834,6 +834,8 @@ struct shaping_context
         unsigned int *range_lengths;
         unsigned int range_count;
     } user_features;
+
+    struct shaped_run_key cache_key;
 };
 
 static void layout_shape_clear_user_features_context(struct shaping_context *context)
@@ -854,6 +856,7 @@ static void layout_shape_clear_context(struct shaping_context *context)
     layout_shape_clear_user_features_context(context);
     free(context->glyph_props);
     free(context->text_props);
+    free((void *)context->cache_key.data);
 }
 
 static HRESULT layout_shape_add_empty_user_features_range(struct shaping_context *context, unsigned int length)
@@ -944,13 +947,96 @@ failed:
     return hr;
 }
 
+static void layout_shape_append_cache_key(BYTE **ptr, const void *data, size_t size)
+{
+    memcpy(*ptr, data, size);
+    *ptr += size;
+}
+
+/* Everything that affects GetGlyphs() output, other than the font face itself. */
+static void layout_shape_init_cache_key(struct shaping_context *context)
+{
+    struct regular_layout_run *run = context->run;
+    const WCHAR *locale = run->descr.localeName ? run->descr.localeName : L"";
+    unsigned int i, locale_length = wcslen(locale), hash = 2166136261u;
+    struct
+    {
+        UINT32 text_length;
+        UINT32 locale_length;
+        UINT32 script;
+        UINT32 shapes;
+        UINT32 is_sideways;
+        UINT32 is_rtl;
+        UINT32 feature_range_count;
+    } header;
+    size_t size;
+    BYTE *data, *ptr;
+
+    header.text_length = run->descr.stringLength;
+    header.locale_length = locale_length;
+    header.script = run->sa.script;
+    header.shapes = run->sa.shapes;
+    header.is_sideways = run->run.isSideways;
+    header.is_rtl = run->run.bidiLevel & 1;
+    header.feature_range_count = context->user_features.range_count;
+
+    size = sizeof(header) + (header.text_length + locale_length) * sizeof(WCHAR);
+    for (i = 0; i < context->user_features.range_count; ++i)
+    {
+        size += 2 * sizeof(UINT32) + context->user_features.features[i]->featureCount
+                * sizeof(*context->user_features.features[i]->features);
+    }
+
+    if (!(ptr = data = malloc(size)))
+        return;
+
+    layout_shape_append_cache_key(&ptr, &header, sizeof(header));
+    layout_shape_append_cache_key(&ptr, run->descr.string, header.text_length * sizeof(WCHAR));
+    layout_shape_append_cache_key(&ptr, locale, locale_length * sizeof(WCHAR));
+    for (i = 0; i < context->user_features.range_count; ++i)
+    {
+        const DWRITE_TYPOGRAPHIC_FEATURES *features = context->user_features.features[i];
+
+        layout_shape_append_cache_key(&ptr, &context->user_features.range_lengths[i], sizeof(UINT32));
+        layout_shape_append_cache_key(&ptr, &features->featureCount, sizeof(UINT32));
+        layout_shape_append_cache_key(&ptr, features->features, features->featureCount * sizeof(*features->features));
+    }
+
+    for (i = 0; i < size; ++i)
+        hash = (hash ^ data[i]) * 16777619u;
+
+    context->cache_key.hash = hash;
+    context->cache_key.size = size;
+    context->cache_key.data = data;
+}
+
 static HRESULT layout_shape_get_glyphs(struct dwrite_textlayout *layout, struct shaping_context *context)
 {
     struct regular_layout_run *run = context->run;
+    struct shaped_run shaped;
     unsigned int max_count;
     HRESULT hr;
 
     run->descr.localeName = get_layout_range_by_pos(layout, run->descr.textPosition)->locale;
+
+    if (FAILED(hr = layout_shape_get_user_features(layout, context)))
+        return hr;
+
+    layout_shape_init_cache_key(context);
+    if (context->cache_key.data && fontface_get_shaped_run(run->run.fontFace, &context->cache_key, &shaped))
+    {
+        run->clustermap = shaped.clustermap;
+        context->text_props = shaped.text_props;
+        run->glyphs = shaped.glyphs;
+        context->glyph_props = shaped.glyph_props;
+        run->glyphcount = shaped.glyph_count;
+
+        run->run.glyphIndices = run->glyphs;
+        run->descr.clusterMap = run->clustermap;
+
+        return S_OK;
+    }
+
     run->clustermap = calloc(run->descr.stringLength, sizeof(*run->clustermap));
     if (!run->clustermap)
         return E_OUTOFMEMORY;
@@ -965,9 +1051,6 @@ static HRESULT layout_shape_get_glyphs(struct dwrite_textlayout *layout, struct
     if (!context->text_props || !context->glyph_props)
         return E_OUTOFMEMORY;
 
-    if (FAILED(hr = layout_shape_get_user_features(layout, context)))
-        return hr;
-
     for (;;)
     {
         hr = IDWriteTextAnalyzer2_GetGlyphs(context->analyzer, run->descr.string, run->descr.stringLength, run->run.fontFace,
@@ -998,6 +1081,16 @@ static HRESULT layout_shape_get_glyphs(struct dwrite_textlayout *layout, struct
 
     if (FAILED(hr))
         WARN("%s: shaping failed, hr %#lx.\n", debugstr_rundescr(&run->descr), hr);
+    else if (context->cache_key.data)
+    {
+        shaped.text_length = run->descr.stringLength;
+        shaped.glyph_count = run->glyphcount;
+        shaped.clustermap = run->clustermap;
+        shaped.text_props = context->text_props;
+        shaped.glyphs = run->glyphs;
+        shaped.glyph_props = context->glyph_props;
+        fontface_cache_shaped_run(run->run.fontFace, &context->cache_key, &shaped);
+    }
 
     run->run.glyphIndices = run->glyphs;
     run->descr.clusterMap = run->clustermap;
@@ -1085,6 +1178,8 @@ static HRESULT layout_shape_apply_character_spacing(struct dwrite_textlayout *la
 static HRESULT layout_shape_get_positions(struct dwrite_textlayout *layout, struct shaping_context *context)
 {
     struct regular_layout_run *run = context->run;
+    struct shaped_run_placement_key placement_key;
+    BOOL cached = FALSE;
     HRESULT hr;
 
     run->advances = calloc(run->glyphcount, sizeof(*run->advances));
@@ -1092,8 +1187,23 @@ static HRESULT layout_shape_get_positions(struct dwrite_textlayout *layout, stru
     if (!run->advances || !run->offsets)
         return E_OUTOFMEMORY;
 
+    memset(&placement_key, 0, sizeof(placement_key));
+    placement_key.emsize = run->run.fontEmSize;
+    if ((placement_key.gdi_compatible = is_layout_gdi_compatible(layout)))
+    {
+        placement_key.ppdip = layout->ppdip;
+        placement_key.transform = layout->transform;
+        placement_key.use_gdi_natural = layout->measuringmode == DWRITE_MEASURING_MODE_GDI_NATURAL;
+    }
+
     /* Get advances and offsets. */
-    if (is_layout_gdi_compatible(layout))
+    if (context->cache_key.data)
+        cached = fontface_get_shaped_run_placement(run->run.fontFace, &context->cache_key, &placement_key,
+                run->glyphcount, run->advances, run->offsets);
+
+    if (cached)
+        hr = S_OK;
+    else if (is_layout_gdi_compatible(layout))
         hr = IDWriteTextAnalyzer2_GetGdiCompatibleGlyphPlacements(context->analyzer, run->descr.string, run->descr.clusterMap,
                 context->text_props, run->descr.stringLength, run->run.glyphIndices, context->glyph_props, run->glyphcount,
                 run->run.fontFace, run->run.fontEmSize, layout->ppdip, &layout->transform,
@@ -1107,6 +1217,12 @@ static HRESULT layout_shape_get_positions(struct dwrite_textlayout *layout, stru
                 run->descr.localeName, (const DWRITE_TYPOGRAPHIC_FEATURES **)context->user_features.features,
                 context->user_features.range_lengths, context->user_features.range_count, run->advances, run->offsets);
 
+    if (SUCCEEDED(hr) && !cached && context->cache_key.data)
+    {
+        fontface_cache_shaped_run_placement(run->run.fontFace, &context->cache_key, &placement_key,
+                run->glyphcount, run->advances, run->offsets);
+    }
+
     if (FAILED(hr))
     {
         memset(run->advances, 0, run->glyphcount * sizeof(*run->advances));
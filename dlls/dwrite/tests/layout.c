@@ -7052,6 +7052,74 @@ if (SUCCEEDED(hr))
     IDWriteFactory_Release(factory);
 }
 
+static void test_layout_reshaping(void)
+{
+    DWRITE_CLUSTER_METRICS metrics[7], metrics2[7];
+    IDWriteTextLayout *layout, *layout2;
+    IDWriteTextFormat *format;
+    IDWriteFactory *factory;
+    DWRITE_TEXT_RANGE range;
+    unsigned int i;
+    UINT32 count;
+    HRESULT hr;
+
+    factory = create_factory();
+
+    hr = IDWriteFactory_CreateTextFormat(factory, L"Tahoma", NULL, DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL,
+            DWRITE_FONT_STRETCH_NORMAL, 10.0f, L"en-us", &format);
+    ok(hr == S_OK, "Failed to create text format, hr %#lx.\n", hr);
+
+    hr = IDWriteFactory_CreateTextLayout(factory, L"abc def", 7, format, 1000.0f, 1000.0f, &layout);
+    ok(hr == S_OK, "Failed to create text layout, hr %#lx.\n", hr);
+    hr = IDWriteTextLayout_GetClusterMetrics(layout, metrics, ARRAY_SIZE(metrics), &count);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok(count == 7, "Unexpected cluster count %u.\n", count);
+
+    /* Same text and format, shaped again by a new layout. */
+    hr = IDWriteFactory_CreateTextLayout(factory, L"abc def", 7, format, 1000.0f, 1000.0f, &layout2);
+    ok(hr == S_OK, "Failed to create text layout, hr %#lx.\n", hr);
+    hr = IDWriteTextLayout_GetClusterMetrics(layout2, metrics2, ARRAY_SIZE(metrics2), &count);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok(count == 7, "Unexpected cluster count %u.\n", count);
+    for (i = 0; i < count; ++i)
+    {
+        ok(metrics2[i].width == metrics[i].width, "%u: unexpected width %.8e, expected %.8e.\n",
+                i, metrics2[i].width, metrics[i].width);
+    }
+
+    /* Changing the size of a range only changes its clusters. */
+    range.startPosition = 0;
+    range.length = 3;
+    hr = IDWriteTextLayout_SetFontSize(layout2, 20.0f, range);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    hr = IDWriteTextLayout_GetClusterMetrics(layout2, metrics2, ARRAY_SIZE(metrics2), &count);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok(count == 7, "Unexpected cluster count %u.\n", count);
+    for (i = 0; i < count; ++i)
+    {
+        float expected = i < 3 ? 2.0f * metrics[i].width : metrics[i].width;
+
+        ok(fabsf(metrics2[i].width - expected) < 1e-4f, "%u: unexpected width %.8e, expected %.8e.\n",
+                i, metrics2[i].width, expected);
+    }
+
+    hr = IDWriteTextLayout_SetFontSize(layout2, 10.0f, range);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    hr = IDWriteTextLayout_GetClusterMetrics(layout2, metrics2, ARRAY_SIZE(metrics2), &count);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok(count == 7, "Unexpected cluster count %u.\n", count);
+    for (i = 0; i < count; ++i)
+    {
+        ok(metrics2[i].width == metrics[i].width, "%u: unexpected width %.8e, expected %.8e.\n",
+                i, metrics2[i].width, metrics[i].width);
+    }
+
+    IDWriteTextLayout_Release(layout2);
+    IDWriteTextLayout_Release(layout);
+    IDWriteTextFormat_Release(format);
+    IDWriteFactory_Release(factory);
+}
+
 START_TEST(layout)
 {
     IDWriteFactory *factory;
@@ -7108,6 +7176,7 @@ START_TEST(layout)
     test_text_format_axes();
     test_layout_range_length();
     test_HitTestTextRange();
+    test_layout_reshaping();
 
     IDWriteFactory_Release(factory);
 }
@@ -559,6 +559,60 @@ static void test_CreatePolyPolygonRgn(void)
     DeleteObject(region);
 }
 
+static void test_CombineRgn(void)
+{
+    static const RECT top = {0, 0, 10, 10}, bottom = {0, 10, 10, 20}, wide = {0, 10, 20, 20};
+    static const RECT tall = {0, 0, 10, 20}, far = {0, 30, 10, 40};
+    union
+    {
+        RGNDATA data;
+        char buf[sizeof(RGNDATAHEADER) + 4 * sizeof(RECT)];
+    } rgn;
+    HRGN hrgn1, hrgn2, hrgn;
+    const RECT *rects;
+    DWORD size;
+    int ret;
+
+    hrgn = CreateRectRgn(0, 0, 0, 0);
+    hrgn1 = CreateRectRgnIndirect(&top);
+    hrgn2 = CreateRectRgnIndirect(&bottom);
+
+    /* Touching bands with the same horizontal extent are coalesced. */
+    ret = CombineRgn(hrgn, hrgn1, hrgn2, RGN_OR);
+    ok(ret == SIMPLEREGION, "expected SIMPLEREGION, got %d\n", ret);
+    verify_region(hrgn, &tall);
+    ret = CombineRgn(hrgn, hrgn2, hrgn1, RGN_OR);
+    ok(ret == SIMPLEREGION, "expected SIMPLEREGION, got %d\n", ret);
+    verify_region(hrgn, &tall);
+
+    /* Disjoint bands are kept in top to bottom order. */
+    SetRectRgn(hrgn2, far.left, far.top, far.right, far.bottom);
+    ret = CombineRgn(hrgn, hrgn2, hrgn1, RGN_OR);
+    ok(ret == COMPLEXREGION, "expected COMPLEXREGION, got %d\n", ret);
+    size = GetRegionData(hrgn, sizeof(rgn), &rgn.data);
+    ok(size == sizeof(rgn.data.rdh) + 2 * sizeof(RECT), "got size %lu\n", size);
+    ok(rgn.data.rdh.nCount == 2, "got %lu rects\n", rgn.data.rdh.nCount);
+    rects = (const RECT *)rgn.data.Buffer;
+    ok(EqualRect(&rects[0], &top), "got %s\n", wine_dbgstr_rect(&rects[0]));
+    ok(EqualRect(&rects[1], &far), "got %s\n", wine_dbgstr_rect(&rects[1]));
+
+    /* Clipping away the parts where bands differ coalesces them. */
+    SetRectRgn(hrgn2, wide.left, wide.top, wide.right, wide.bottom);
+    ret = CombineRgn(hrgn1, hrgn1, hrgn2, RGN_OR);
+    ok(ret == COMPLEXREGION, "expected COMPLEXREGION, got %d\n", ret);
+    SetRectRgn(hrgn2, tall.left, tall.top, tall.right, tall.bottom);
+    ret = CombineRgn(hrgn, hrgn1, hrgn2, RGN_AND);
+    ok(ret == SIMPLEREGION, "expected SIMPLEREGION, got %d\n", ret);
+    verify_region(hrgn, &tall);
+    ret = CombineRgn(hrgn2, hrgn2, hrgn1, RGN_AND);
+    ok(ret == SIMPLEREGION, "expected SIMPLEREGION, got %d\n", ret);
+    verify_region(hrgn2, &tall);
+
+    DeleteObject(hrgn2);
+    DeleteObject(hrgn1);
+    DeleteObject(hrgn);
+}
+
 START_TEST(clipping)
 {
     test_GetRandomRgn();
@@ -567,4 +621,5 @@ START_TEST(clipping)
     test_memory_dc_clipping();
     test_window_dc_clipping();
     test_CreatePolyPolygonRgn();
+    test_CombineRgn();
 }
@@ -19,6 +19,9 @@
 #include <stdarg.h>
 #include <math.h>
 #include <limits.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "windef.h"
 #include "winbase.h"
@@ -412,6 +415,73 @@ static GpStatus get_clip_hrgn(GpGraphics *graphics, HRGN *hrgn)
     return stat;
 }
 
+static inline void blend_pixel_over(DWORD *dst, ARGB src, BOOL premult, BOOL dst_alpha)
+{
+    ARGB bg = dst_alpha ? *dst : *dst | 0xff000000, color;
+
+    if (!(src & 0xff000000))
+        return;
+
+    color = premult ? color_over_fgpremult(bg, src) : color_over(bg, src);
+    *dst = dst_alpha ? color : color & 0x00ffffff;
+}
+
+/* Blends a row of ARGB pixels over a row of 32bppARGB or 32bppRGB pixels, with
+ * the same results as reading, blending and writing back each pixel. */
+static void blend_row_over(DWORD *dst, const ARGB *src, INT count, BOOL premult, BOOL dst_alpha)
+{
+    INT x = 0;
+
+#ifdef __SSE2__
+    /* Opaque destination pixels need no division by the resulting alpha, which
+     * leaves (bg * (255 - a) + fg * a) / 255 for each channel. */
+    if (!premult)
+    {
+        const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi16(1), full = _mm_set1_epi16(255);
+        const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+        const __m128i fill = dst_alpha ? alpha_mask : zero;
+
+        for (; x + 4 <= count; x += 4)
+        {
+            __m128i s = _mm_loadu_si128((const __m128i *)(src + x));
+            __m128i d = _mm_loadu_si128((const __m128i *)(dst + x));
+            __m128i skip, slo, shi, dlo, dhi, alo, ahi, res;
+
+            if (dst_alpha && _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(d, alpha_mask), alpha_mask)) != 0xffff)
+            {
+                blend_pixel_over(dst + x, src[x], premult, dst_alpha);
+                blend_pixel_over(dst + x + 1, src[x + 1], premult, dst_alpha);
+                blend_pixel_over(dst + x + 2, src[x + 2], premult, dst_alpha);
+                blend_pixel_over(dst + x + 3, src[x + 3], premult, dst_alpha);
+                continue;
+            }
+
+            skip = _mm_cmpeq_epi32(_mm_and_si128(s, alpha_mask), zero);
+
+            slo = _mm_unpacklo_epi8(s, zero);
+            shi = _mm_unpackhi_epi8(s, zero);
+            dlo = _mm_unpacklo_epi8(d, zero);
+            dhi = _mm_unpackhi_epi8(d, zero);
+            alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(slo, 0xff), 0xff);
+            ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(shi, 0xff), 0xff);
+
+            slo = _mm_add_epi16(_mm_mullo_epi16(slo, alo), _mm_mullo_epi16(dlo, _mm_sub_epi16(full, alo)));
+            shi = _mm_add_epi16(_mm_mullo_epi16(shi, ahi), _mm_mullo_epi16(dhi, _mm_sub_epi16(full, ahi)));
+            /* x / 255 == (x + 1 + (x >> 8)) >> 8 for x < 65536 */
+            slo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(slo, one), _mm_srli_epi16(slo, 8)), 8);
+            shi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(shi, one), _mm_srli_epi16(shi, 8)), 8);
+
+            res = _mm_or_si128(_mm_andnot_si128(alpha_mask, _mm_packus_epi16(slo, shi)), fill);
+            res = _mm_or_si128(_mm_and_si128(skip, d), _mm_andnot_si128(skip, res));
+            _mm_storeu_si128((__m128i *)(dst + x), res);
+        }
+    }
+#endif
+
+    for (; x < count; x++)
+        blend_pixel_over(dst + x, src[x], premult, dst_alpha);
+}
+
 /* Draw ARGB data to the given graphics object */
 static GpStatus alpha_blend_bmp_pixels(GpGraphics *graphics, INT dst_x, INT dst_y,
     const BYTE *src, INT src_width, INT src_height, INT src_stride, const PixelFormat fmt)
@@ -420,6 +490,20 @@ static GpStatus alpha_blend_bmp_pixels(GpGraphics *graphics, INT dst_x, INT dst_
     INT x, y;
     CompositingMode comp_mode = graphics->compmode;
 
+    if ((dst_bitmap->format == PixelFormat32bppARGB || dst_bitmap->format == PixelFormat32bppRGB) &&
+        dst_bitmap->bits && comp_mode != CompositingModeSourceCopy)
+    {
+        BOOL dst_alpha = dst_bitmap->format == PixelFormat32bppARGB;
+        INT left = max(dst_x, 0), right = min(dst_x + src_width, dst_bitmap->width);
+
+        for (y = max(dst_y, 0); y < min(dst_y + src_height, dst_bitmap->height) && left < right; y++)
+            blend_row_over((DWORD *)(dst_bitmap->bits + dst_bitmap->stride * y) + left,
+                (const ARGB *)(src + src_stride * (y - dst_y)) + left - dst_x,
+                right - left, fmt & PixelFormatPAlpha, dst_alpha);
+
+        return Ok;
+    }
+
     for (y=0; y<src_height; y++)
     {
         for (x=0; x<src_width; x++)
@@ -1078,6 +1162,50 @@ static ARGB resample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT
     }
 }
 
+/* Resamples count pixels along a destination row, where pixel i maps to the
+ * source point start + i * (dx, dy). Pixels mapping outside bounds, if given,
+ * are left untouched. */
+static void resample_bitmap_row(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT width,
+    UINT height, const GpPointF *start, REAL dx, REAL dy, GDIPCONST GpRectF *bounds,
+    ARGB *dst, INT count, GDIPCONST GpImageAttributes *attributes,
+    InterpolationMode interpolation, PixelOffsetMode offset_mode)
+{
+    const DWORD *src_bits = (const DWORD *)bits;
+    GpPointF point;
+    REAL pixel_offset;
+    INT i, x, y;
+
+    pixel_offset = (offset_mode == PixelOffsetModeHalf || offset_mode == PixelOffsetModeHighQuality) ? 0.0f : 0.5f;
+
+    for (i = 0; i < count; i++)
+    {
+        point.X = start->X + i * dx;
+        point.Y = start->Y + i * dy;
+
+        if (bounds && !(point.X >= bounds->X && point.X < bounds->X + bounds->Width &&
+                        point.Y >= bounds->Y && point.Y < bounds->Y + bounds->Height))
+            continue;
+
+        if (interpolation != InterpolationModeNearestNeighbor)
+        {
+            dst[i] = resample_bitmap_pixel(src_rect, bits, width, height, &point,
+                attributes, interpolation, offset_mode);
+            continue;
+        }
+
+        /* Nearest neighbor sampling of pixels inside the source area, which is
+         * the common case, is done inline. */
+        x = floorf(point.X + pixel_offset);
+        y = floorf(point.Y + pixel_offset);
+
+        if (x >= src_rect->X && y >= src_rect->Y && x < src_rect->X + src_rect->Width &&
+            y < src_rect->Y + src_rect->Height)
+            dst[i] = src_bits[(x - src_rect->X) + (y - src_rect->Y) * src_rect->Width];
+        else
+            dst[i] = sample_bitmap_pixel(src_rect, bits, width, height, x, y, attributes);
+    }
+}
+
 static REAL intersect_line_scanline(const GpPointF *p1, const GpPointF *p2, REAL y)
 {
     return (p1->X - p2->X) * (p2->Y - y) / (p2->Y - p1->Y) + p2->X;
@@ -1201,9 +1329,9 @@ static GpStatus brush_fill_pixels(GpGraphics *graphics, GpBrush *brush,
     {
         int x, y;
         GpSolidFill *fill = (GpSolidFill*)brush;
-        for (x=0; x<fill_area->Width; x++)
-            for (y=0; y<fill_area->Height; y++)
-                argb_pixels[x + y*cdwStride] = fill->color;
+        for (y=0; y<fill_area->Height; y++, argb_pixels += cdwStride)
+            for (x=0; x<fill_area->Width; x++)
+                argb_pixels[x] = fill->color;
         return Ok;
     }
     case BrushTypeHatchFill:
@@ -1374,17 +1502,13 @@ static GpStatus brush_fill_pixels(GpGraphics *graphics, GpBrush *brush,
 
             for (y=0; y<fill_area->Height; y++)
             {
-                for (x=0; x<fill_area->Width; x++)
-                {
-                    GpPointF point;
-                    point.X = draw_points[0].X + x * x_dx + y * y_dx;
-                    point.Y = draw_points[0].Y + x * x_dy + y * y_dy;
-
-                    argb_pixels[x + y*cdwStride] = resample_bitmap_pixel(
-                        &src_area, fill->bitmap_bits, bitmap->width, bitmap->height,
-                        &point, fill->imageattributes, graphics->interpolation,
-                        graphics->pixeloffset);
-                }
+                GpPointF row_start;
+                row_start.X = draw_points[0].X + y * y_dx;
+                row_start.Y = draw_points[0].Y + y * y_dy;
+
+                resample_bitmap_row(&src_area, fill->bitmap_bits, bitmap->width, bitmap->height,
+                    &row_start, x_dx, x_dy, NULL, argb_pixels + y * cdwStride, fill_area->Width,
+                    fill->imageattributes, graphics->interpolation, graphics->pixeloffset);
             }
         }
 
@@ -3151,7 +3275,7 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
             RECT dst_area;
             GpRectF graphics_bounds;
             GpRect src_area;
-            int i, x, y, src_stride, dst_stride;
+            int i, y, src_stride, dst_stride;
             LPBYTE src_data, dst_data, dst_dyn_data=NULL;
             BitmapData lockeddata;
             InterpolationMode interpolation = graphics->interpolation;
@@ -3237,6 +3361,7 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
                 REAL x_dx, x_dy, y_dx, y_dy;
                 ARGB *dst_color;
                 GpPointF src_pointf_row, src_pointf;
+                GpRectF src_bounds;
 
                 m11 = (ptf[1].X - ptf[0].X) / srcwidth;
                 m12 = (ptf[1].Y - ptf[0].Y) / srcwidth;
@@ -3272,18 +3397,20 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
                 src_pointf_row.Y = dst_to_src.matrix[5] +
                                    dst_area.left * x_dy + dst_area.top * y_dy;
 
-                for (y = dst_area.top; y < dst_area.bottom;
-                     y++, src_pointf_row.X += y_dx, src_pointf_row.Y += y_dy)
+                src_bounds.X = srcx;
+                src_bounds.Y = srcy;
+                src_bounds.Width = srcwidth;
+                src_bounds.Height = srcheight;
+
+                for (y = dst_area.top; y < dst_area.bottom; y++)
                 {
-                    for (x = dst_area.left, src_pointf = src_pointf_row; x < dst_area.right;
-                         x++, src_pointf.X += x_dx, src_pointf.Y += x_dy)
-                    {
-                        if (src_pointf.X >= srcx && src_pointf.X < srcx + srcwidth &&
-                            src_pointf.Y >= srcy && src_pointf.Y < srcy + srcheight)
-                            *dst_color = resample_bitmap_pixel(&src_area, src_data, bitmap->width, bitmap->height, &src_pointf,
-                                                               imageAttributes, interpolation, offset_mode);
-                        dst_color++;
-                    }
+                    src_pointf.X = src_pointf_row.X + (y - dst_area.top) * y_dx;
+                    src_pointf.Y = src_pointf_row.Y + (y - dst_area.top) * y_dy;
+
+                    resample_bitmap_row(&src_area, src_data, bitmap->width, bitmap->height, &src_pointf,
+                        x_dx, x_dy, &src_bounds, dst_color, dst_area.right - dst_area.left,
+                        imageAttributes, interpolation, offset_mode);
+                    dst_color += dst_area.right - dst_area.left;
                 }
             }
             else
@@ -4319,6 +4446,307 @@ end:
     return retval;
 }
 
+/* Anti-aliased fills are rasterized on RASTER_SUBSAMPLES sub-scanlines per
+ * pixel row, with exact horizontal coverage along each sub-scanline. */
+#define RASTER_SUBSAMPLES 4
+#define RASTER_SAMPLE_COVERAGE (256 / RASTER_SUBSAMPLES)
+
+struct raster_edge
+{
+    REAL ymin, ymax;
+    REAL x, dxdy; /* x at ymin */
+    INT winding;
+};
+
+struct raster_crossing
+{
+    REAL x;
+    INT winding;
+};
+
+static BOOL is_antialiased(GpGraphics *graphics)
+{
+    return graphics->smoothing == SmoothingModeHighQuality || graphics->smoothing >= SmoothingModeAntiAlias;
+}
+
+static int __cdecl compare_raster_edges(const void *a, const void *b)
+{
+    const struct raster_edge *edge1 = a, *edge2 = b;
+
+    if (edge1->ymin < edge2->ymin) return -1;
+    return edge1->ymin > edge2->ymin;
+}
+
+static void add_raster_edge(struct raster_edge *edges, INT *count, const GpPointF *p1, const GpPointF *p2)
+{
+    struct raster_edge *edge = &edges[*count];
+
+    if (p1->Y == p2->Y)
+        return;
+
+    if (p1->Y < p2->Y)
+    {
+        edge->ymin = p1->Y;
+        edge->ymax = p2->Y;
+        edge->x = p1->X;
+        edge->winding = 1;
+    }
+    else
+    {
+        edge->ymin = p2->Y;
+        edge->ymax = p1->Y;
+        edge->x = p2->X;
+        edge->winding = -1;
+    }
+    edge->dxdy = (p2->X - p1->X) / (p2->Y - p1->Y);
+    (*count)++;
+}
+
+/* Adds the coverage of the span [x1, x2) on one sub-scanline. Whole pixels are
+ * accumulated as differences in run, which is summed up once per row. */
+static void add_raster_span(INT *partial, INT *run, INT width, REAL x1, REAL x2)
+{
+    INT left, right;
+
+    if (x1 < 0.0f) x1 = 0.0f;
+    if (x2 > width) x2 = width;
+    if (x1 >= x2)
+        return;
+
+    left = floorf(x1);
+    right = floorf(x2);
+
+    if (left == right)
+    {
+        partial[left] += gdip_round((x2 - x1) * RASTER_SAMPLE_COVERAGE);
+        return;
+    }
+
+    partial[left] += gdip_round((left + 1 - x1) * RASTER_SAMPLE_COVERAGE);
+    run[left + 1] += RASTER_SAMPLE_COVERAGE;
+    run[right] -= RASTER_SAMPLE_COVERAGE;
+    if (right < width)
+        partial[right] += gdip_round((x2 - right) * RASTER_SAMPLE_COVERAGE);
+}
+
+/* Computes the coverage of a flattened path in device coordinates for every
+ * pixel of area, where pixel (x, y) covers [x, x + 1) x [y, y + 1). */
+static GpStatus rasterize_path(const GpPath *path, const GpRect *area, BYTE *coverage)
+{
+    const GpPointF *points = path->pathdata.Points;
+    const BYTE *types = path->pathdata.Types;
+    INT count = path->pathdata.Count, edge_count = 0, active_count, next_edge = 0;
+    INT i, j, x, y, sample, figure_start = 0, sum, winding;
+    struct raster_crossing *crossings, crossing;
+    struct raster_edge *edges, **active;
+    INT *partial, *run;
+    REAL sample_y;
+
+    edges = heap_alloc(count * sizeof(*edges));
+    active = heap_alloc(count * sizeof(*active));
+    crossings = heap_alloc(count * sizeof(*crossings));
+    partial = heap_alloc_zero((area->Width + 1) * sizeof(*partial));
+    run = heap_alloc_zero((area->Width + 1) * sizeof(*run));
+    if (!edges || !active || !crossings || !partial || !run)
+    {
+        heap_free(edges);
+        heap_free(active);
+        heap_free(crossings);
+        heap_free(partial);
+        heap_free(run);
+        return OutOfMemory;
+    }
+
+    /* Every figure is implicitly closed when filling. */
+    for (i = 0; i < count; i++)
+    {
+        if (i + 1 == count || (types[i + 1] & PathPointTypePathTypeMask) == PathPointTypeStart)
+        {
+            add_raster_edge(edges, &edge_count, &points[i], &points[figure_start]);
+            figure_start = i + 1;
+        }
+        else
+            add_raster_edge(edges, &edge_count, &points[i], &points[i + 1]);
+    }
+    qsort(edges, edge_count, sizeof(*edges), compare_raster_edges);
+
+    for (i = 0; i < edge_count; i++)
+    {
+        edges[i].x -= area->X;
+        edges[i].ymin -= area->Y;
+        edges[i].ymax -= area->Y;
+    }
+
+    active_count = 0;
+    for (y = 0; y < area->Height; y++)
+    {
+        for (sample = 0; sample < RASTER_SUBSAMPLES; sample++)
+        {
+            sample_y = y + (sample + 0.5f) / RASTER_SUBSAMPLES;
+
+            /* Update the active edge list and find the crossings, sorted by x. */
+            for (i = 0, j = 0; i < active_count; i++)
+                if (active[i]->ymax > sample_y) active[j++] = active[i];
+            active_count = j;
+            for (; next_edge < edge_count && edges[next_edge].ymin <= sample_y; next_edge++)
+                if (edges[next_edge].ymax > sample_y) active[active_count++] = &edges[next_edge];
+
+            for (i = 0; i < active_count; i++)
+            {
+                crossing.x = active[i]->x + (sample_y - active[i]->ymin) * active[i]->dxdy;
+                crossing.winding = active[i]->winding;
+                for (j = i; j > 0 && crossings[j - 1].x > crossing.x; j--)
+                    crossings[j] = crossings[j - 1];
+                crossings[j] = crossing;
+            }
+
+            for (i = 0, winding = 0; i + 1 < active_count; i++)
+            {
+                winding += crossings[i].winding;
+                if (path->fill == FillModeAlternate ? (i & 1) == 0 : winding != 0)
+                    add_raster_span(partial, run, area->Width, crossings[i].x, crossings[i + 1].x);
+            }
+        }
+
+        for (x = 0, sum = 0; x < area->Width; x++)
+        {
+            sum += run[x];
+            coverage[y * area->Width + x] = min(sum + partial[x], 255);
+        }
+        memset(partial, 0, (area->Width + 1) * sizeof(*partial));
+        memset(run, 0, (area->Width + 1) * sizeof(*run));
+    }
+
+    heap_free(edges);
+    heap_free(active);
+    heap_free(crossings);
+    heap_free(partial);
+    heap_free(run);
+    return Ok;
+}
+
+/* Scales the alpha of each pixel by its coverage. */
+static void apply_coverage(DWORD *pixels, const BYTE *coverage, INT count)
+{
+    INT i = 0;
+    DWORD alpha;
+
+#ifdef __SSE2__
+    const __m128i round = _mm_set1_epi32(128);
+    const __m128i color_mask = _mm_set1_epi32(0x00ffffff);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i *)(pixels + i));
+        __m128i c = _mm_setr_epi32(coverage[i], coverage[i + 1], coverage[i + 2], coverage[i + 3]);
+        __m128i a;
+
+        /* alpha * coverage fits in the low 16 bits of each lane */
+        a = _mm_add_epi32(_mm_madd_epi16(_mm_srli_epi32(p, 24), c), round);
+        a = _mm_srli_epi32(_mm_add_epi32(a, _mm_srli_epi32(a, 8)), 8);
+        p = _mm_or_si128(_mm_and_si128(p, color_mask), _mm_slli_epi32(a, 24));
+        _mm_storeu_si128((__m128i *)(pixels + i), p);
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        alpha = (pixels[i] >> 24) * coverage[i] + 128;
+        alpha = (alpha + (alpha >> 8)) >> 8;
+        pixels[i] = (pixels[i] & 0x00ffffff) | (alpha << 24);
+    }
+}
+
+static GpStatus antialias_fill_path(GpGraphics *graphics, GpBrush *brush, GpPath *path)
+{
+    GpMatrix world_to_device;
+    GpRectF graphics_bounds;
+    GpPath *flat_path;
+    GpRect area;
+    REAL min_x, min_y, max_x, max_y, offset;
+    BYTE *coverage = NULL;
+    DWORD *pixels = NULL;
+    GpStatus stat;
+    INT i;
+
+    /* Without a pixel offset, pixel centers are on integer coordinates. */
+    offset = (graphics->pixeloffset == PixelOffsetModeHalf ||
+              graphics->pixeloffset == PixelOffsetModeHighQuality) ? 0.0f : 0.5f;
+
+    stat = GdipClonePath(path, &flat_path);
+    if (stat != Ok)
+        return stat;
+
+    gdi_transform_acquire(graphics);
+
+    stat = get_graphics_device_bounds(graphics, &graphics_bounds);
+
+    if (stat == Ok)
+        stat = get_graphics_transform(graphics, WineCoordinateSpaceGdiDevice,
+            CoordinateSpaceWorld, &world_to_device);
+
+    if (stat == Ok)
+    {
+        GdipTranslateMatrix(&world_to_device, offset, offset, MatrixOrderAppend);
+        stat = GdipTransformPath(flat_path, &world_to_device);
+    }
+
+    if (stat == Ok)
+        stat = GdipFlattenPath(flat_path, NULL, 0.25);
+
+    if (stat == Ok && flat_path->pathdata.Count)
+    {
+        min_x = max_x = flat_path->pathdata.Points[0].X;
+        min_y = max_y = flat_path->pathdata.Points[0].Y;
+        for (i = 1; i < flat_path->pathdata.Count; i++)
+        {
+            min_x = min(min_x, flat_path->pathdata.Points[i].X);
+            max_x = max(max_x, flat_path->pathdata.Points[i].X);
+            min_y = min(min_y, flat_path->pathdata.Points[i].Y);
+            max_y = max(max_y, flat_path->pathdata.Points[i].Y);
+        }
+
+        min_x = max(min_x, floorf(graphics_bounds.X));
+        min_y = max(min_y, floorf(graphics_bounds.Y));
+        max_x = min(max_x, ceilf(graphics_bounds.X + graphics_bounds.Width));
+        max_y = min(max_y, ceilf(graphics_bounds.Y + graphics_bounds.Height));
+
+        area.X = floorf(min_x);
+        area.Y = floorf(min_y);
+        area.Width = ceilf(max_x) - area.X;
+        area.Height = ceilf(max_y) - area.Y;
+
+        if (area.Width > 0 && area.Height > 0)
+        {
+            coverage = heap_alloc(area.Width * area.Height);
+            pixels = heap_alloc_zero(area.Width * area.Height * sizeof(*pixels));
+            if (!coverage || !pixels)
+                stat = OutOfMemory;
+
+            if (stat == Ok)
+                stat = rasterize_path(flat_path, &area, coverage);
+
+            if (stat == Ok)
+                stat = brush_fill_pixels(graphics, brush, pixels, &area, area.Width);
+
+            if (stat == Ok)
+            {
+                apply_coverage(pixels, coverage, area.Width * area.Height);
+                stat = alpha_blend_pixels(graphics, area.X, area.Y, (BYTE *)pixels, area.Width,
+                    area.Height, area.Width * sizeof(*pixels), PixelFormat32bppARGB);
+            }
+
+            heap_free(coverage);
+            heap_free(pixels);
+        }
+    }
+
+    gdi_transform_release(graphics);
+    GdipDeletePath(flat_path);
+
+    return stat;
+}
+
 static GpStatus SOFTWARE_GdipFillPath(GpGraphics *graphics, GpBrush *brush, GpPath *path)
 {
     GpStatus stat;
@@ -4327,6 +4755,9 @@ static GpStatus SOFTWARE_GdipFillPath(GpGraphics *graphics, GpBrush *brush, GpPa
     if (!brush_can_fill_pixels(brush))
         return NotImplemented;
 
+    if (is_antialiased(graphics))
+        return antialias_fill_path(graphics, brush, path);
+
     /* FIXME: This could probably be done more efficiently without regions. */
 
     stat = GdipCreateRegionPath(path, &rgn);
@@ -6660,6 +6660,54 @@ static void test_GdipFillRectanglesOnBitmapTextureBrush(void)
     GdipFree(src_img_data);
 }
 
+static void test_GdipFillRectangleAntialias(void)
+{
+    GpGraphics *graphics;
+    GpSolidFill *brush;
+    GpBitmap *bitmap;
+    GpStatus status;
+    ARGB color;
+
+    status = GdipCreateBitmapFromScan0(16, 16, 0, PixelFormat32bppARGB, NULL, &bitmap);
+    expect(Ok, status);
+    status = GdipGetImageGraphicsContext((GpImage *)bitmap, &graphics);
+    expect(Ok, status);
+    status = GdipSetSmoothingMode(graphics, SmoothingModeAntiAlias);
+    expect(Ok, status);
+    status = GdipSetPixelOffsetMode(graphics, PixelOffsetModeHalf);
+    expect(Ok, status);
+    status = GdipCreateSolidFill(0xff0000ff, &brush);
+    expect(Ok, status);
+
+    status = GdipFillRectangle(graphics, (GpBrush *)brush, 2.0, 2.0, 4.5, 4.0);
+    expect(Ok, status);
+
+    status = GdipBitmapGetPixel(bitmap, 3, 3, &color);
+    expect(Ok, status);
+    expect(0xff0000ff, color);
+    status = GdipBitmapGetPixel(bitmap, 2, 5, &color);
+    expect(Ok, status);
+    expect(0xff0000ff, color);
+    /* The right edge covers half of the pixel. */
+    status = GdipBitmapGetPixel(bitmap, 6, 3, &color);
+    expect(Ok, status);
+    ok((color & 0xffffff) == 0xff && (color >> 24) > 0x40 && (color >> 24) < 0xc0,
+        "Unexpected color %08lx.\n", color);
+    status = GdipBitmapGetPixel(bitmap, 7, 3, &color);
+    expect(Ok, status);
+    expect(0, color);
+    status = GdipBitmapGetPixel(bitmap, 3, 6, &color);
+    expect(Ok, status);
+    expect(0, color);
+    status = GdipBitmapGetPixel(bitmap, 1, 1, &color);
+    expect(Ok, status);
+    expect(0, color);
+
+    GdipDeleteBrush((GpBrush *)brush);
+    GdipDeleteGraphics(graphics);
+    GdipDisposeImage((GpImage *)bitmap);
+}
+
 static void test_GdipDrawImagePointsRectOnMemoryDC(void)
 {
     ARGB color[6] = {0,0,0,0,0,0};
@@ -7319,6 +7367,7 @@ START_TEST(graphics)
     test_GdipFillRectanglesOnMemoryDCSolidBrush();
     test_GdipFillRectanglesOnMemoryDCTextureBrush();
     test_GdipFillRectanglesOnBitmapTextureBrush();
+    test_GdipFillRectangleAntialias();
     test_GdipDrawImagePointsRectOnMemoryDC();
     test_container_rects();
     test_GdipGraphicsSetAbort();
@@ -44,6 +44,7 @@
 #include "initguid.h"
 
 #include "d3d11_4.h"
+#include "wine/mfinternal.h"
 
 DEFINE_GUID(DMOVideoFormat_RGB24,D3DFMT_R8G8B8,0x524f,0x11ce,0x9f,0x53,0x00,0x20,0xaf,0x0b,0xa7,0x70);
 DEFINE_GUID(DMOVideoFormat_RGB32,D3DFMT_X8R8G8B8,0x524f,0x11ce,0x9f,0x53,0x00,0x20,0xaf,0x0b,0xa7,0x70);
@@ -4122,6 +4123,22 @@ static void test_h264_decoder(void)
     ok(ret == 0, "got %lu%% diff\n", ret);
     IMFCollection_Release(output_samples);
 
+    if (!strcmp(winetest_platform, "wine"))
+    {
+        UINT64 copy_stats;
+
+        /* Wine exposes how many decoded frames had to be copied. The first frame is decoded
+         * into the sample given to the format change ProcessOutput, it is copied back when
+         * that sample is released, and copied again into the next output sample. */
+        hr = IMFTransform_GetAttributes(transform, &attributes);
+        ok(hr == S_OK, "GetAttributes returned %#lx\n", hr);
+        hr = IMFAttributes_GetUINT64(attributes, &MFT_WINE_OUTPUT_COPY_STATS, &copy_stats);
+        ok(hr == S_OK, "GetUINT64 returned %#lx\n", hr);
+        ok(copy_stats >> 32 == 1, "got %u output samples\n", (UINT)(copy_stats >> 32));
+        ok((UINT32)copy_stats == 2, "got %u copies\n", (UINT32)copy_stats);
+        IMFAttributes_Release(attributes);
+    }
+
     /* we can change it, but only with the correct frame size */
     hr = MFCreateMediaType(&media_type);
     ok(hr == S_OK, "MFCreateMediaType returned %#lx\n", hr);
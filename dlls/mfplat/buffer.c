@@ -172,7 +172,8 @@ static ULONG WINAPI memory_buffer_Release(IMFMediaBuffer *iface)
             clear_attributes_object(&buffer->dxgi_surface.attributes);
         }
         DeleteCriticalSection(&buffer->cs);
-        free(buffer->_2d.linear_buffer);
+        if (buffer->_2d.linear_buffer != buffer->data)
+            free(buffer->_2d.linear_buffer);
         _aligned_free(buffer->data);
         free(buffer);
     }
@@ -290,6 +291,12 @@ static HRESULT WINAPI memory_1d_2d_buffer_QueryInterface(IMFMediaBuffer *iface,
     return S_OK;
 }
 
+static BOOL memory_2d_buffer_is_linear(const struct buffer *buffer)
+{
+    return buffer->_2d.pitch > 0 && buffer->_2d.pitch == buffer->_2d.width
+            && buffer->_2d.plane_size <= buffer->max_length;
+}
+
 static HRESULT WINAPI memory_1d_2d_buffer_Lock(IMFMediaBuffer *iface, BYTE **data, DWORD *max_length, DWORD *current_length)
 {
     struct buffer *buffer = impl_from_IMFMediaBuffer(iface);
@@ -307,6 +314,11 @@ static HRESULT WINAPI memory_1d_2d_buffer_Lock(IMFMediaBuffer *iface, BYTE **dat
 
     if (!buffer->_2d.linear_buffer && buffer->_2d.locks)
         hr = MF_E_INVALIDREQUEST;
+    else if (!buffer->_2d.linear_buffer && memory_2d_buffer_is_linear(buffer))
+    {
+        /* Rows are already packed, the buffer memory can be returned directly. */
+        buffer->_2d.linear_buffer = buffer->data;
+    }
     else if (!buffer->_2d.linear_buffer)
     {
         if (!(buffer->_2d.linear_buffer = malloc(buffer->_2d.plane_size)))
@@ -342,10 +354,12 @@ static HRESULT WINAPI memory_1d_2d_buffer_Unlock(IMFMediaBuffer *iface)
 
     if (buffer->_2d.linear_buffer && !--buffer->_2d.locks)
     {
-        copy_image(buffer, buffer->data, buffer->_2d.pitch, buffer->_2d.linear_buffer, buffer->_2d.width,
-                buffer->_2d.width, buffer->_2d.height);
-
-        free(buffer->_2d.linear_buffer);
+        if (buffer->_2d.linear_buffer != buffer->data)
+        {
+            copy_image(buffer, buffer->data, buffer->_2d.pitch, buffer->_2d.linear_buffer, buffer->_2d.width,
+                    buffer->_2d.width, buffer->_2d.height);
+            free(buffer->_2d.linear_buffer);
+        }
         buffer->_2d.linear_buffer = NULL;
     }
 
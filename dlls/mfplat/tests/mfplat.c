@@ -6469,6 +6469,49 @@ static void test_MFCreate2DMediaBuffer(void)
         IMF2DBuffer_Release(_2dbuffer);
         IMFMediaBuffer_Release(buffer);
     }
+
+    /* Nested linear locks, with pitch matching the plane stride. */
+    hr = pMFCreate2DMediaBuffer(1920, 1080, MAKEFOURCC('N','V','1','2'), FALSE, &buffer);
+    ok(hr == S_OK, "Failed to create a buffer, hr %#lx.\n", hr);
+
+    hr = IMFMediaBuffer_QueryInterface(buffer, &IID_IMF2DBuffer, (void **)&_2dbuffer);
+    ok(hr == S_OK, "Failed to get interface, hr %#lx.\n", hr);
+
+    hr = IMFMediaBuffer_Lock(buffer, &data, &max_length, &length);
+    ok(hr == S_OK, "Failed to lock buffer, hr %#lx.\n", hr);
+    ok(length == 1920 * 1080 * 3 / 2, "Unexpected length %lu.\n", length);
+    for (i = 0; i < length; i++)
+        data[i] = i % 251;
+
+    hr = IMFMediaBuffer_Lock(buffer, &data2, NULL, NULL);
+    ok(hr == S_OK, "Failed to lock buffer, hr %#lx.\n", hr);
+    ok(data2 == data, "Unexpected pointer.\n");
+
+    hr = IMFMediaBuffer_Unlock(buffer);
+    ok(hr == S_OK, "Failed to unlock buffer, hr %#lx.\n", hr);
+
+    /* Still locked */
+    hr = IMF2DBuffer_Lock2D(_2dbuffer, &data2, &pitch);
+    ok(hr == MF_E_UNEXPECTED, "Unexpected hr %#lx.\n", hr);
+
+    hr = IMFMediaBuffer_Unlock(buffer);
+    ok(hr == S_OK, "Failed to unlock buffer, hr %#lx.\n", hr);
+
+    hr = IMF2DBuffer_Lock2D(_2dbuffer, &data, &pitch);
+    ok(hr == S_OK, "Failed to lock buffer, hr %#lx.\n", hr);
+    ok(pitch == 1920, "Unexpected pitch %ld.\n", pitch);
+    for (i = 0; i < length; i++)
+        if (data[i] != i % 251) break;
+    ok(i == length, "Unexpected data at offset %d.\n", i);
+
+    hr = IMF2DBuffer_Unlock2D(_2dbuffer);
+    ok(hr == S_OK, "Failed to unlock buffer, hr %#lx.\n", hr);
+
+    hr = IMF2DBuffer_Unlock2D(_2dbuffer);
+    ok(hr == HRESULT_FROM_WIN32(ERROR_WAS_UNLOCKED), "Unexpected hr %#lx.\n", hr);
+
+    IMF2DBuffer_Release(_2dbuffer);
+    IMFMediaBuffer_Release(buffer);
 }
 
 static void test_MFCreateMediaBufferFromMediaType(void)
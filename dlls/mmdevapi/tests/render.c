@@ -772,6 +772,108 @@ static void test_event(void)
     CloseHandle(event);
 }
 
+/* Feed an event driven stream the way low latency clients do. */
+static void test_event_buffers(void)
+{
+    UINT32 bufsize, pad, frames, i;
+    IAudioRenderClient *arc;
+    WAVEFORMATEX *pwfx;
+    IAudioClient *ac;
+    HANDLE event;
+    BYTE *buf;
+    HRESULT hr;
+    DWORD r;
+
+    hr = IMMDevice_Activate(dev, &IID_IAudioClient, CLSCTX_INPROC_SERVER,
+            NULL, (void**)&ac);
+    ok(hr == S_OK, "Activation failed with %08lx\n", hr);
+    if(hr != S_OK)
+        return;
+
+    hr = IAudioClient_GetMixFormat(ac, &pwfx);
+    ok(hr == S_OK, "GetMixFormat failed: %08lx\n", hr);
+
+    hr = IAudioClient_Initialize(ac, AUDCLNT_SHAREMODE_SHARED,
+            AUDCLNT_STREAMFLAGS_EVENTCALLBACK, 0, 0, pwfx, NULL);
+    ok(hr == S_OK, "Initialize failed: %08lx\n", hr);
+    CoTaskMemFree(pwfx);
+    if(hr != S_OK)
+    {
+        IAudioClient_Release(ac);
+        return;
+    }
+
+    event = CreateEventW(NULL, FALSE, FALSE, NULL);
+    ok(event != NULL, "CreateEvent failed\n");
+
+    hr = IAudioClient_SetEventHandle(ac, event);
+    ok(hr == S_OK, "SetEventHandle failed: %08lx\n", hr);
+
+    hr = IAudioClient_GetBufferSize(ac, &bufsize);
+    ok(hr == S_OK, "GetBufferSize failed: %08lx\n", hr);
+
+    hr = IAudioClient_GetService(ac, &IID_IAudioRenderClient, (void**)&arc);
+    ok(hr == S_OK, "GetService failed: %08lx\n", hr);
+
+    /* Releasing nothing gives the buffer back unchanged. */
+    hr = IAudioRenderClient_GetBuffer(arc, bufsize / 2, &buf);
+    ok(hr == S_OK, "GetBuffer failed: %08lx\n", hr);
+    ok(buf != NULL, "NULL buffer returned\n");
+
+    hr = IAudioRenderClient_GetBuffer(arc, bufsize / 2, &buf);
+    ok(hr == AUDCLNT_E_OUT_OF_ORDER, "GetBuffer gave wrong error: %08lx\n", hr);
+
+    hr = IAudioRenderClient_ReleaseBuffer(arc, 0, 0);
+    ok(hr == S_OK, "ReleaseBuffer failed: %08lx\n", hr);
+
+    hr = IAudioClient_GetCurrentPadding(ac, &pad);
+    ok(hr == S_OK, "GetCurrentPadding failed: %08lx\n", hr);
+    ok(pad == 0, "Got padding %u\n", pad);
+
+    hr = IAudioRenderClient_GetBuffer(arc, bufsize, &buf);
+    ok(hr == S_OK, "GetBuffer failed: %08lx\n", hr);
+    ok(buf != NULL, "NULL buffer returned\n");
+
+    hr = IAudioRenderClient_ReleaseBuffer(arc, bufsize, AUDCLNT_BUFFERFLAGS_SILENT);
+    ok(hr == S_OK, "ReleaseBuffer failed: %08lx\n", hr);
+
+    hr = IAudioClient_GetCurrentPadding(ac, &pad);
+    ok(hr == S_OK, "GetCurrentPadding failed: %08lx\n", hr);
+    ok(pad == bufsize, "Expected padding %u, got %u\n", bufsize, pad);
+
+    hr = IAudioClient_Start(ac);
+    ok(hr == S_OK, "Start failed: %08lx\n", hr);
+
+    for (i = 0; i < 10; ++i)
+    {
+        r = WaitForSingleObject(event, 1000);
+        ok(r == WAIT_OBJECT_0, "Wait(event) gave %lx\n", r);
+
+        hr = IAudioClient_GetCurrentPadding(ac, &pad);
+        ok(hr == S_OK, "GetCurrentPadding failed: %08lx\n", hr);
+        ok(pad <= bufsize, "Got padding %u, buffer size %u\n", pad, bufsize);
+
+        if (!(frames = bufsize - pad))
+            continue;
+
+        hr = IAudioRenderClient_GetBuffer(arc, frames, &buf);
+        ok(hr == S_OK, "GetBuffer failed: %08lx\n", hr);
+        hr = IAudioRenderClient_ReleaseBuffer(arc, frames, AUDCLNT_BUFFERFLAGS_SILENT);
+        ok(hr == S_OK, "ReleaseBuffer failed: %08lx\n", hr);
+
+        hr = IAudioClient_GetCurrentPadding(ac, &pad);
+        ok(hr == S_OK, "GetCurrentPadding failed: %08lx\n", hr);
+        ok(pad <= bufsize, "Got padding %u, buffer size %u\n", pad, bufsize);
+    }
+
+    hr = IAudioClient_Stop(ac);
+    ok(hr == S_OK, "Stop failed: %08lx\n", hr);
+
+    IAudioRenderClient_Release(arc);
+    IAudioClient_Release(ac);
+    CloseHandle(event);
+}
+
 static void test_padding(void)
 {
     HRESULT hr;
@@ -2404,6 +2506,7 @@ START_TEST(render)
         trace("Please redirect output to a file.\n");
     }
     test_event();
+    test_event_buffers();
     test_padding();
     test_clock(1);
     test_clock(0);
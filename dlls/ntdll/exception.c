@@ -305,6 +305,25 @@ static RTL_CRITICAL_SECTION_DEBUG dynamic_unwind_debug =
 };
 static RTL_CRITICAL_SECTION dynamic_unwind_section = { &dynamic_unwind_debug, -1, 0, 0, 0, 0 };
 
+/* cache of recently used module function tables, to avoid walking the module list
+ * and parsing the PE headers for every frame that gets unwound */
+struct function_table_cache_entry
+{
+    ULONG_PTR             base;
+    ULONG_PTR             end;
+    RUNTIME_FUNCTION     *table;
+    ULONG                 count;
+    LDR_DATA_TABLE_ENTRY *module;
+};
+
+#define FUNCTION_TABLE_CACHE_SIZE 16
+
+static struct function_table_cache_entry function_table_cache[FUNCTION_TABLE_CACHE_SIZE];
+static LONG function_table_cache_hint;  /* index of the last hit */
+static unsigned int function_table_cache_next;  /* next entry to replace */
+static LONG function_table_cache_generation;  /* incremented when a module is unloaded */
+static RTL_SRWLOCK function_table_cache_lock = RTL_SRWLOCK_INIT;
+
 static ULONG_PTR get_runtime_function_end( RUNTIME_FUNCTION *func, ULONG_PTR addr )
 {
 #ifdef __x86_64__
@@ -553,25 +572,96 @@ static RUNTIME_FUNCTION *find_function_info( ULONG_PTR pc, ULONG_PTR base,
     return NULL;
 }
 
+/* helper for lookup_function_info() */
+static BOOL find_cached_function_table( ULONG_PTR pc, struct function_table_cache_entry *ret )
+{
+    unsigned int i, pos = ReadNoFence( &function_table_cache_hint );
+    BOOL found = FALSE;
+
+    RtlAcquireSRWLockShared( &function_table_cache_lock );
+    for (i = 0; i < FUNCTION_TABLE_CACHE_SIZE; i++, pos = (pos + 1) % FUNCTION_TABLE_CACHE_SIZE)
+    {
+        if (pc < function_table_cache[pos].base || pc >= function_table_cache[pos].end) continue;
+        *ret = function_table_cache[pos];
+        WriteNoFence( &function_table_cache_hint, pos );
+        found = TRUE;
+        break;
+    }
+    RtlReleaseSRWLockShared( &function_table_cache_lock );
+    return found;
+}
+
+/* helper for lookup_function_info() */
+static void add_cached_function_table( const struct function_table_cache_entry *entry, LONG generation )
+{
+    RtlAcquireSRWLockExclusive( &function_table_cache_lock );
+    /* the module may have been unloaded since it was looked up, don't cache it then */
+    if (generation == function_table_cache_generation)
+    {
+        WriteNoFence( &function_table_cache_hint, function_table_cache_next );
+        function_table_cache[function_table_cache_next] = *entry;
+        function_table_cache_next = (function_table_cache_next + 1) % FUNCTION_TABLE_CACHE_SIZE;
+    }
+    RtlReleaseSRWLockExclusive( &function_table_cache_lock );
+}
+
+/**********************************************************************
+ *           flush_function_table_cache
+ *
+ * Remove a module that is being unloaded from the function table cache.
+ */
+void flush_function_table_cache( void *base )
+{
+    unsigned int i;
+
+    RtlAcquireSRWLockExclusive( &function_table_cache_lock );
+    for (i = 0; i < FUNCTION_TABLE_CACHE_SIZE; i++)
+        if (function_table_cache[i].base == (ULONG_PTR)base)
+            memset( &function_table_cache[i], 0, sizeof(function_table_cache[i]) );
+    function_table_cache_generation++;
+    RtlReleaseSRWLockExclusive( &function_table_cache_lock );
+}
+
 /**********************************************************************
  *           lookup_function_info
  */
 RUNTIME_FUNCTION *lookup_function_info( ULONG_PTR pc, ULONG_PTR *base, LDR_DATA_TABLE_ENTRY **module )
 {
+    struct function_table_cache_entry cache;
     RUNTIME_FUNCTION *func = NULL;
     struct dynamic_unwind_entry *entry;
+    LONG generation;
     ULONG size;
 
     /* PE module or wine module */
-    if (!LdrFindEntryForAddress( (void *)pc, module ))
+    generation = ReadAcquire( &function_table_cache_generation );
+    if (find_cached_function_table( pc, &cache ))
+    {
+        *module = cache.module;
+        *base = cache.base;
+        /* lookup in function table */
+        if (cache.table) func = find_function_info( pc, cache.base, cache.table, cache.count );
+    }
+    else if (!LdrFindEntryForAddress( (void *)pc, module ))
     {
         *base = (ULONG_PTR)(*module)->DllBase;
         if ((func = RtlImageDirectoryEntryToData( (*module)->DllBase, TRUE,
                                                   IMAGE_DIRECTORY_ENTRY_EXCEPTION, &size )))
         {
+            cache.table = func;
+            cache.count = size / sizeof(*func);
             /* lookup in function table */
             func = find_function_info( pc, (ULONG_PTR)(*module)->DllBase, func, size/sizeof(*func) );
         }
+        else
+        {
+            cache.table = NULL;
+            cache.count = 0;
+        }
+        cache.base   = *base;
+        cache.end    = *base + (*module)->SizeOfImage;
+        cache.module = *module;
+        add_cached_function_table( &cache, generation );
     }
     else
     {
@@ -60,6 +60,9 @@ extern void (WINAPI *pWow64PrepareForException)( EXCEPTION_RECORD *rec, CONTEXT
 
 #if defined(__x86_64__) || defined(__arm__) || defined(__aarch64__)
 extern RUNTIME_FUNCTION *lookup_function_info( ULONG_PTR pc, ULONG_PTR *base, LDR_DATA_TABLE_ENTRY **module ) DECLSPEC_HIDDEN;
+extern void flush_function_table_cache( void *base ) DECLSPEC_HIDDEN;
+#else
+static inline void flush_function_table_cache( void *base ) { }
 #endif
 
 /* debug helpers */
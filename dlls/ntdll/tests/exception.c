@@ -2750,6 +2750,53 @@ static void test_dynamic_unwind(void)
     pRtlDeleteGrowableFunctionTable( growable_table );
 }
 
+static void test_module_unwind(void)
+{
+    RUNTIME_FUNCTION *func, *func2;
+    ULONG_PTR base, pc;
+    HMODULE hmod;
+    unsigned int i;
+
+    hmod = LoadLibraryA( "msxml3.dll" );
+    ok( hmod != NULL, "Failed to load library.\n" );
+    pc = (ULONG_PTR)GetProcAddress( hmod, "DllGetClassObject" );
+    ok( pc != 0, "DllGetClassObject not found.\n" );
+
+    base = 0xdeadbeef;
+    func = pRtlLookupFunctionEntry( pc, &base, NULL );
+    if (!func)
+    {
+        skip( "No exception data found.\n" );
+        FreeLibrary( hmod );
+        return;
+    }
+    ok( base == (ULONG_PTR)hmod, "Got base %Ix, expected %p.\n", base, hmod );
+    ok( pc >= base + func->BeginAddress, "Got function %lx-%lx for offset %Ix.\n",
+        func->BeginAddress, func->EndAddress, pc - base );
+
+    /* repeated lookups return the same entry */
+    for (i = 0; i < 16; i++)
+    {
+        base = 0xdeadbeef;
+        func2 = pRtlLookupFunctionEntry( pc, &base, NULL );
+        ok( func2 == func, "%u: Got function %p, expected %p.\n", i, func2, func );
+        ok( base == (ULONG_PTR)hmod, "%u: Got base %Ix, expected %p.\n", i, base, hmod );
+    }
+
+    FreeLibrary( hmod );
+    if (GetModuleHandleA( "msxml3.dll" ))
+    {
+        skip( "Library was not unloaded.\n" );
+        return;
+    }
+
+    /* the function table of the unloaded module must not be used anymore */
+    base = 0xdeadbeef;
+    func = pRtlLookupFunctionEntry( pc, &base, NULL );
+    ok( !func, "Got function %p.\n", func );
+    ok( !base || broken(base == 0xdeadbeef), "Got base %Ix.\n", base );
+}
+
 static int termination_handler_called;
 static void WINAPI termination_handler(ULONG flags, ULONG64 frame)
 {
@@ -11189,6 +11236,8 @@ START_TEST(exception)
       test_dynamic_unwind();
     else
       win_skip( "Dynamic unwind functions not found\n" );
+    if (pRtlLookupFunctionEntry)
+      test_module_unwind();
     test_extended_context();
     test_copy_context();
     test_unwind_from_apc();
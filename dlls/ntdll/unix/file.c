@@ -3952,6 +3952,9 @@ NTSTATUS open_unix_file( HANDLE *handle, const char *unix_name, ACCESS_MASK acce
         wine_server_add_data( req, unix_name, strlen(unix_name) );
         status = wine_server_call( req );
         *handle = wine_server_ptr_handle( reply->handle );
+        /* the server sends the unix fd along with the reply to save a get_handle_fd request */
+        if (!status && reply->fd_type != FD_TYPE_INVALID)
+            server_cache_handle_fd( *handle, reply->fd_type, reply->fd_access, reply->fd_options );
     }
     SERVER_END_REQ;
     free( objattr );
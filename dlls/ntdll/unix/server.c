@@ -90,7 +90,7 @@ WINE_DEFAULT_DEBUG_CHANNEL(server);
 #define SOCKETNAME "socket"        /* name of the socket file */
 #define LOCKNAME   "lock"          /* name of the lock file */
 
-static const char *server_dir;
+const char *server_dir = NULL;
 
 unsigned int supported_machines_count = 0;
 USHORT supported_machines[8] = { 0 };
@@ -103,7 +103,7 @@ sigset_t server_block_set;  /* signals to block during server calls */
 static int fd_socket = -1;  /* socket to exchange file descriptors with the server */
 static int initial_cwd = -1;
 static pid_t server_pid;
-static pthread_mutex_t fd_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t fd_socket_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /* atomically exchange a 64-bit value */
 static inline LONG64 interlocked_xchg64( LONG64 *dest, LONG64 val )
@@ -976,6 +976,11 @@ static int receive_fd( obj_handle_t *handle )
 /***********************************************************************/
 /* fd cache support */
 
+/* A cache entry is either unset (0), holds a cached fd (or error status), or is
+ * reserved (fd field 0, options holding a reservation token) while a thread is
+ * retrieving the fd from the server or closing the handle. Entries are only
+ * ever filled through a reservation, so that a concurrent close can invalidate
+ * an fd that is still in flight without requiring a global lock. */
 union fd_cache_entry
 {
     LONG64 data;
@@ -992,9 +997,21 @@ C_ASSERT( sizeof(union fd_cache_entry) == sizeof(LONG64) );
 
 #define FD_CACHE_BLOCK_SIZE  (65536 / sizeof(union fd_cache_entry))
 #define FD_CACHE_ENTRIES     128
+#define FD_CACHE_TOKEN_MASK  0xffffff
 
 static union fd_cache_entry *fd_cache[FD_CACHE_ENTRIES];
 static union fd_cache_entry fd_cache_initial_block[FD_CACHE_BLOCK_SIZE];
+static LONG fd_cache_token;
+
+/* fds received from the server on behalf of another thread */
+struct received_fd
+{
+    struct received_fd *next;
+    obj_handle_t        handle;
+    int                 fd;
+};
+
+static struct received_fd *received_fds;  /* protected by fd_socket_mutex */
 
 static inline unsigned int handle_to_index( HANDLE handle, unsigned int *entry )
 {
@@ -1004,21 +1021,26 @@ static inline unsigned int handle_to_index( HANDLE handle, unsigned int *entry )
 }
 
 
+static inline unsigned int next_fd_cache_token(void)
+{
+    unsigned int token = InterlockedIncrement( &fd_cache_token ) & FD_CACHE_TOKEN_MASK;
+    return token ? token : 1;
+}
+
+
 /***********************************************************************
- *           add_fd_to_cache
+ *           get_fd_cache_entry
  *
- * Caller must hold fd_cache_mutex.
+ * Return the cache entry of a handle, allocating its block if needed.
  */
-static BOOL add_fd_to_cache( HANDLE handle, int fd, enum server_fd_type type,
-                            unsigned int access, unsigned int options )
+static union fd_cache_entry *get_fd_cache_entry( HANDLE handle )
 {
     unsigned int entry, idx = handle_to_index( handle, &entry );
-    union fd_cache_entry cache;
 
     if (entry >= FD_CACHE_ENTRIES)
     {
         FIXME( "too many allocated handles, not caching %p\n", handle );
-        return FALSE;
+        return NULL;
     }
 
     if (!fd_cache[entry])  /* do we need to allocate a new block of entries? */
@@ -1028,19 +1050,74 @@ static BOOL add_fd_to_cache( HANDLE handle, int fd, enum server_fd_type type,
         {
             void *ptr = anon_mmap_alloc( FD_CACHE_BLOCK_SIZE * sizeof(union fd_cache_entry),
                                          PROT_READ | PROT_WRITE );
-            if (ptr == MAP_FAILED) return FALSE;
-            fd_cache[entry] = ptr;
+            if (ptr == MAP_FAILED) return NULL;
+            if (InterlockedCompareExchangePointer( (void **)&fd_cache[entry], ptr, NULL ))
+                munmap( ptr, FD_CACHE_BLOCK_SIZE * sizeof(union fd_cache_entry) );  /* lost the race */
         }
     }
+    return &fd_cache[entry][idx];
+}
+
+
+/***********************************************************************
+ *           reserve_fd_cache_entry
+ *
+ * Reserve an unset cache entry while the fd is being retrieved.
+ * Returns the reservation token, or 0 if the entry is not available.
+ */
+static unsigned int reserve_fd_cache_entry( HANDLE handle )
+{
+    union fd_cache_entry *ptr, reserved;
+
+    if (!(ptr = get_fd_cache_entry( handle ))) return 0;
+
+    reserved.data = 0;
+    reserved.s.options = next_fd_cache_token();
+    if (InterlockedCompareExchange64( &ptr->data, reserved.data, 0 )) return 0;
+    return reserved.s.options;
+}
+
+
+/***********************************************************************
+ *           release_fd_cache_entry
+ *
+ * Release a reservation that didn't get filled.
+ */
+static void release_fd_cache_entry( HANDLE handle, unsigned int token )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+    union fd_cache_entry reserved;
+
+    if (!token) return;
+    reserved.data = 0;
+    reserved.s.options = token;
+    InterlockedCompareExchange64( &fd_cache[entry][idx].data, 0, reserved.data );
+}
+
+
+/***********************************************************************
+ *           add_fd_to_cache
+ *
+ * Fill a reserved cache entry. Fails if the reservation was revoked by a
+ * concurrent close of the handle.
+ */
+static BOOL add_fd_to_cache( HANDLE handle, unsigned int token, int fd, enum server_fd_type type,
+                             unsigned int access, unsigned int options )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+    union fd_cache_entry cache, reserved;
+
+    if (!token) return FALSE;
 
+    reserved.data = 0;
+    reserved.s.options = token;
     /* store fd+1 so that 0 can be used as the unset value */
     cache.s.fd = fd + 1;
     cache.s.type = type;
     cache.s.access = access;
     cache.s.options = options;
-    cache.data = interlocked_xchg64( &fd_cache[entry][idx].data, cache.data );
-    assert( !cache.s.fd );
-    return TRUE;
+    return InterlockedCompareExchange64( &fd_cache[entry][idx].data, cache.data,
+                                         reserved.data ) == reserved.data;
 }
 
 
@@ -1056,7 +1133,7 @@ static inline NTSTATUS get_cached_fd( HANDLE handle, int *fd, enum server_fd_typ
     if (entry >= FD_CACHE_ENTRIES || !fd_cache[entry]) return STATUS_INVALID_HANDLE;
 
     cache.data = InterlockedCompareExchange64( &fd_cache[entry][idx].data, 0, 0 );
-    if (!cache.data) return STATUS_INVALID_HANDLE;
+    if (!cache.s.fd) return STATUS_INVALID_HANDLE;  /* unset or reserved */
 
     /* if fd type is invalid, fd stores an error value */
     if (cache.s.type == FD_TYPE_INVALID) return cache.s.fd - 1;
@@ -1071,19 +1148,73 @@ static inline NTSTATUS get_cached_fd( HANDLE handle, int *fd, enum server_fd_typ
 
 /***********************************************************************
  *           remove_fd_from_cache
+ *
+ * Remove the cached fd of a handle that is about to be closed. The entry stays
+ * reserved until release_fd_cache_entry() is called with the returned token,
+ * so that no fd retrieved before the close can be cached for the handle.
  */
-static int remove_fd_from_cache( HANDLE handle )
+static int remove_fd_from_cache( HANDLE handle, unsigned int *token )
 {
     unsigned int entry, idx = handle_to_index( handle, &entry );
+    union fd_cache_entry cache;
     int fd = -1;
 
-    if (entry < FD_CACHE_ENTRIES && fd_cache[entry])
+    /* without a block no reservation can be in flight, see reserve_fd_cache_entry() */
+    *token = 0;
+    if (entry >= FD_CACHE_ENTRIES || !fd_cache[entry]) return -1;
+
+    cache.data = 0;
+    cache.s.options = next_fd_cache_token();
+    *token = cache.s.options;
+    cache.data = interlocked_xchg64( &fd_cache[entry][idx].data, cache.data );
+    if (cache.s.fd && cache.s.type != FD_TYPE_INVALID) fd = cache.s.fd - 1;
+
+    return fd;
+}
+
+
+/***********************************************************************
+ *           receive_handle_fd
+ *
+ * Receive the fd sent by the server for a given handle. The server sends the
+ * fd before the request reply, so it is already queued on the socket; but the
+ * socket is shared between threads, and fds meant for other threads are kept
+ * aside until their owner picks them up.
+ * Signals must be blocked by the caller.
+ */
+static int receive_handle_fd( HANDLE handle )
+{
+    obj_handle_t fd_handle, wanted = wine_server_obj_handle( handle );
+    struct received_fd *received, **prev;
+    int fd;
+
+    mutex_lock( &fd_socket_mutex );
+    for (prev = &received_fds; (received = *prev); prev = &received->next)
     {
-        union fd_cache_entry cache;
-        cache.data = interlocked_xchg64( &fd_cache[entry][idx].data, 0 );
-        if (cache.s.type != FD_TYPE_INVALID) fd = cache.s.fd - 1;
+        if (received->handle != wanted) continue;
+        *prev = received->next;
+        fd = received->fd;
+        free( received );
+        goto done;
     }
-
+    for (;;)
+    {
+        fd = receive_fd( &fd_handle );
+        if (fd_handle == wanted) break;
+        if (fd == -1) continue;
+        if (!(received = malloc( sizeof(*received) )))
+        {
+            ERR( "out of memory, dropping fd for handle %04x\n", fd_handle );
+            close( fd );
+            continue;
+        }
+        received->handle = fd_handle;
+        received->fd     = fd;
+        received->next   = received_fds;
+        received_fds = received;
+    }
+done:
+    mutex_unlock( &fd_socket_mutex );
     return fd;
 }
 
@@ -1097,9 +1228,8 @@ int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
                         int *needs_close, enum server_fd_type *type, unsigned int *options )
 {
     sigset_t sigset;
-    obj_handle_t fd_handle;
     int ret, fd = -1;
-    unsigned int access = 0;
+    unsigned int token, access = 0;
 
     *unix_fd = -1;
     *needs_close = 0;
@@ -1108,35 +1238,32 @@ int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
     ret = get_cached_fd( handle, &fd, type, &access, options );
     if (ret != STATUS_INVALID_HANDLE) goto done;
 
-    server_enter_uninterrupted_section( &fd_cache_mutex, &sigset );
-    ret = get_cached_fd( handle, &fd, type, &access, options );
-    if (ret == STATUS_INVALID_HANDLE)
+    pthread_sigmask( SIG_BLOCK, &server_block_set, &sigset );
+    token = reserve_fd_cache_entry( handle );
+    SERVER_START_REQ( get_handle_fd )
     {
-        SERVER_START_REQ( get_handle_fd )
+        req->handle = wine_server_obj_handle( handle );
+        if (!(ret = wine_server_call( req )))
         {
-            req->handle = wine_server_obj_handle( handle );
-            if (!(ret = wine_server_call( req )))
+            if (type) *type = reply->type;
+            if (options) *options = reply->options;
+            access = reply->access;
+            if ((fd = receive_handle_fd( handle )) != -1)
             {
-                if (type) *type = reply->type;
-                if (options) *options = reply->options;
-                access = reply->access;
-                if ((fd = receive_fd( &fd_handle )) != -1)
-                {
-                    assert( wine_server_ptr_handle(fd_handle) == handle );
-                    *needs_close = (!reply->cacheable ||
-                                    !add_fd_to_cache( handle, fd, reply->type,
-                                                      reply->access, reply->options ));
-                }
-                else ret = STATUS_TOO_MANY_OPENED_FILES;
-            }
-            else if (reply->cacheable)
-            {
-                add_fd_to_cache( handle, ret, FD_TYPE_INVALID, 0, 0 );
+                *needs_close = (!reply->cacheable ||
+                                !add_fd_to_cache( handle, token, fd, reply->type,
+                                                  reply->access, reply->options ));
             }
+            else ret = STATUS_TOO_MANY_OPENED_FILES;
+        }
+        else if (reply->cacheable)
+        {
+            add_fd_to_cache( handle, token, ret, FD_TYPE_INVALID, 0, 0 );
         }
-        SERVER_END_REQ;
     }
-    server_leave_uninterrupted_section( &fd_cache_mutex, &sigset );
+    SERVER_END_REQ;
+    if (*needs_close || ret) release_fd_cache_entry( handle, token );
+    pthread_sigmask( SIG_SETMASK, &sigset, NULL );
 
 done:
     if (!ret && ((access & wanted_access) != wanted_access))
@@ -1149,6 +1276,29 @@ done:
 }
 
 
+/***********************************************************************
+ *           server_cache_handle_fd
+ *
+ * Receive and cache the fd that the server sent along with a newly created handle.
+ */
+void server_cache_handle_fd( HANDLE handle, enum server_fd_type type, unsigned int access,
+                             unsigned int options )
+{
+    sigset_t sigset;
+    unsigned int token;
+    int fd;
+
+    pthread_sigmask( SIG_BLOCK, &server_block_set, &sigset );
+    token = reserve_fd_cache_entry( handle );
+    if ((fd = receive_handle_fd( handle )) != -1 && !add_fd_to_cache( handle, token, fd, type, access, options ))
+    {
+        release_fd_cache_entry( handle, token );
+        close( fd );
+    }
+    pthread_sigmask( SIG_SETMASK, &sigset, NULL );
+}
+
+
 /***********************************************************************
  *           wine_server_fd_to_handle
  */
@@ -1752,7 +1902,7 @@ NTSTATUS WINAPI NtDuplicateObject( HANDLE source_process, HANDLE source, HANDLE
                                    ACCESS_MASK access, ULONG attributes, ULONG options )
 {
     sigset_t sigset;
-    unsigned int ret;
+    unsigned int ret, token = 0;
     int fd = -1;
 
     if (dest) *dest = 0;
@@ -1778,12 +1928,12 @@ NTSTATUS WINAPI NtDuplicateObject( HANDLE source_process, HANDLE source, HANDLE
         return result.dup_handle.status;
     }
 
-    server_enter_uninterrupted_section( &fd_cache_mutex, &sigset );
+    pthread_sigmask( SIG_BLOCK, &server_block_set, &sigset );
 
     /* always remove the cached fd; if the server request fails we'll just
      * retrieve it again */
     if (options & DUPLICATE_CLOSE_SOURCE)
-        fd = remove_fd_from_cache( source );
+        fd = remove_fd_from_cache( source, &token );
 
     SERVER_START_REQ( dup_handle )
     {
@@ -1800,7 +1950,8 @@ NTSTATUS WINAPI NtDuplicateObject( HANDLE source_process, HANDLE source, HANDLE
     }
     SERVER_END_REQ;
 
-    server_leave_uninterrupted_section( &fd_cache_mutex, &sigset );
+    release_fd_cache_entry( source, token );
+    pthread_sigmask( SIG_SETMASK, &sigset, NULL );
 
     if (fd != -1) close( fd );
     return ret;
@@ -1833,17 +1984,17 @@ NTSTATUS WINAPI NtClose( HANDLE handle )
 {
     sigset_t sigset;
     HANDLE port;
-    unsigned int ret;
+    unsigned int ret, token;
     int fd;
 
     if (HandleToLong( handle ) >= ~5 && HandleToLong( handle ) <= ~0)
         return STATUS_SUCCESS;
 
-    server_enter_uninterrupted_section( &fd_cache_mutex, &sigset );
+    pthread_sigmask( SIG_BLOCK, &server_block_set, &sigset );
 
     /* always remove the cached fd; if the server request fails we'll just
      * retrieve it again */
-    fd = remove_fd_from_cache( handle );
+    fd = remove_fd_from_cache( handle, &token );
 
     SERVER_START_REQ( close_handle )
     {
@@ -1852,7 +2003,8 @@ NTSTATUS WINAPI NtClose( HANDLE handle )
     }
     SERVER_END_REQ;
 
-    server_leave_uninterrupted_section( &fd_cache_mutex, &sigset );
+    release_fd_cache_entry( handle, token );
+    pthread_sigmask( SIG_SETMASK, &sigset, NULL );
 
     if (fd != -1) close( fd );
 
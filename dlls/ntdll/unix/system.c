@@ -2460,12 +2460,90 @@ static void read_dev_urandom( void *buf, ULONG len )
     else WARN( "can't open /dev/urandom\n" );
 }
 
+/* cached copy of the server process list, only transferred again when its generation changes */
+static struct
+{
+    unsigned int generation;
+    unsigned int process_count;
+    unsigned int total_thread_count;
+    unsigned int total_name_len;
+    data_size_t  info_size;
+    char        *data;
+} process_list;
+
+static pthread_mutex_t process_list_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* refresh the cached process list; process_list_mutex must be held */
+static unsigned int update_process_list(void)
+{
+    data_size_t size = max( process_list.info_size, 4096 ), pos = 0;
+    unsigned int generation, process_count, total_thread_count, total_name_len, info_size, i;
+    char *buffer;
+    unsigned int ret;
+
+    for (;;)
+    {
+        if (!(buffer = malloc( size ))) return STATUS_NO_MEMORY;
+
+        SERVER_START_REQ( list_processes )
+        {
+            req->generation = process_list.generation;
+            wine_server_set_reply( req, buffer, size );
+            ret = wine_server_call( req );
+            generation = reply->generation;
+            process_count = reply->process_count;
+            total_thread_count = reply->total_thread_count;
+            total_name_len = reply->total_name_len;
+            info_size = reply->info_size;
+        }
+        SERVER_END_REQ;
+
+        if (ret != STATUS_INFO_LENGTH_MISMATCH) break;
+        free( buffer );
+        if (generation == process_list.generation) size = process_count * sizeof(unsigned int);
+        else size = info_size + info_size / 8;  /* leave room for new processes */
+    }
+
+    if (ret)
+    {
+        free( buffer );
+        return ret;
+    }
+
+    if (generation != process_list.generation)
+    {
+        free( process_list.data );
+        process_list.generation = generation;
+        process_list.process_count = process_count;
+        process_list.total_thread_count = total_thread_count;
+        process_list.total_name_len = total_name_len;
+        process_list.info_size = info_size;
+        process_list.data = buffer;
+        return STATUS_SUCCESS;
+    }
+
+    /* unchanged list, update the handle counts */
+    for (i = 0; i < process_count; i++)
+    {
+        struct process_info *server_process;
+
+        pos = (pos + 7) & ~7;
+        server_process = (struct process_info *)(process_list.data + pos);
+        server_process->handle_count = ((unsigned int *)buffer)[i];
+        pos += sizeof(*server_process) + server_process->name_len;
+        pos = (pos + 7) & ~7;
+        pos += server_process->thread_count * sizeof(struct thread_info);
+    }
+    free( buffer );
+    return STATUS_SUCCESS;
+}
+
 static unsigned int get_system_process_info( SYSTEM_INFORMATION_CLASS class, void *info, ULONG size, ULONG *len )
 {
     unsigned int process_count, total_thread_count, total_name_len, i, j;
     unsigned int thread_info_size;
     unsigned int pos = 0;
-    char *buffer = NULL;
+    const char *buffer;
     unsigned int ret;
 
 C_ASSERT( sizeof(struct thread_info) <= sizeof(SYSTEM_THREAD_INFORMATION) );
@@ -2477,28 +2555,18 @@ C_ASSERT( sizeof(struct process_info) <= sizeof(SYSTEM_PROCESS_INFORMATION) );
         thread_info_size = sizeof(SYSTEM_THREAD_INFORMATION);
 
     *len = 0;
-    if (size && !(buffer = malloc( size ))) return STATUS_NO_MEMORY;
 
-    SERVER_START_REQ( list_processes )
-    {
-        wine_server_set_reply( req, buffer, size );
-        ret = wine_server_call( req );
-        total_thread_count = reply->total_thread_count;
-        total_name_len = reply->total_name_len;
-        process_count = reply->process_count;
-    }
-    SERVER_END_REQ;
+    mutex_lock( &process_list_mutex );
 
-    if (ret)
+    if ((ret = update_process_list()))
     {
-        if (ret == STATUS_INFO_LENGTH_MISMATCH)
-            *len = sizeof(SYSTEM_PROCESS_INFORMATION) * process_count
-                  + (total_name_len + process_count) * sizeof(WCHAR)
-                  + total_thread_count * thread_info_size;
-
-        free( buffer );
+        mutex_unlock( &process_list_mutex );
         return ret;
     }
+    buffer = process_list.data;
+    process_count = process_list.process_count;
+    total_thread_count = process_list.total_thread_count;
+    total_name_len = process_list.total_name_len;
 
     for (i = 0; i < process_count; i++)
     {
@@ -2578,8 +2646,16 @@ C_ASSERT( sizeof(struct process_info) <= sizeof(SYSTEM_PROCESS_INFORMATION) );
         }
     }
 
-    if (*len > size) ret = STATUS_INFO_LENGTH_MISMATCH;
-    free( buffer );
+    mutex_unlock( &process_list_mutex );
+
+    if (*len > size)
+    {
+        /* leave some room for processes that may get created before the next call */
+        *len = max( *len, sizeof(SYSTEM_PROCESS_INFORMATION) * process_count
+                          + (total_name_len + process_count) * sizeof(WCHAR)
+                          + total_thread_count * thread_info_size );
+        ret = STATUS_INFO_LENGTH_MISMATCH;
+    }
     return ret;
 }
 
@@ -25,6 +25,7 @@
 #include "config.h"
 
 #include <assert.h>
+#include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <stdarg.h>
@@ -54,6 +55,12 @@
 #ifdef HAVE_LIBPROCSTAT_H
 # include <libprocstat.h>
 #endif
+#ifdef HAVE_LINUX_USERFAULTFD_H
+# include <linux/fs.h>
+# include <linux/userfaultfd.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+#endif
 #include <unistd.h>
 #include <dlfcn.h>
 #ifdef HAVE_VALGRIND_VALGRIND_H
@@ -127,6 +134,7 @@ struct file_view
 #define VPROT_SYSTEM           0x0200  /* system view (underlying mmap not under our control) */
 #define VPROT_PLACEHOLDER      0x0400
 #define VPROT_FREE_PLACEHOLDER 0x0800
+#define VPROT_KERNEL_WATCH     0x1000  /* write watches of the view are tracked by the kernel */
 
 /* Conversion from VPROT_* to Win32 flags */
 static const BYTE VIRTUAL_Win32Flags[16] =
@@ -1217,6 +1225,16 @@ static inline BOOL is_write_watch_range( const void *addr, size_t size )
 }
 
 
+/***********************************************************************
+ *           is_kernel_write_watch_range
+ */
+static inline BOOL is_kernel_write_watch_range( const void *addr, size_t size )
+{
+    struct file_view *view = find_view( addr, size );
+    return view && (view->protect & VPROT_KERNEL_WATCH);
+}
+
+
 /***********************************************************************
  *           find_view_range
  *
@@ -1780,6 +1798,194 @@ static void commit_arm64ec_map( struct file_view *view )
 }
 
 
+#if defined(HAVE_LINUX_USERFAULTFD_H) && defined(UFFD_FEATURE_WP_ASYNC) && defined(PAGEMAP_SCAN)
+
+static BOOL use_kernel_writewatch;  /* whether write watches are tracked by the kernel */
+static int uffd_fd = -1;
+static int pagemap_fd = -1;
+
+/***********************************************************************
+ *           kernel_writewatch_init
+ *
+ * Check if the kernel can track write watches for us, using asynchronous
+ * userfaultfd write protection combined with the PAGEMAP_SCAN ioctl. This
+ * avoids taking a page fault on the first write to every watched page.
+ */
+static void kernel_writewatch_init(void)
+{
+    struct uffdio_api api;
+
+    if ((uffd_fd = syscall( __NR_userfaultfd, UFFD_USER_MODE_ONLY | O_CLOEXEC | O_NONBLOCK )) == -1) return;
+
+    memset( &api, 0, sizeof(api) );
+    api.api = UFFD_API;
+    api.features = UFFD_FEATURE_WP_ASYNC | UFFD_FEATURE_WP_UNPOPULATED;
+    if (ioctl( uffd_fd, UFFDIO_API, &api ) == -1 || api.api != UFFD_API) goto failed;
+    if ((pagemap_fd = open( "/proc/self/pagemap", O_RDONLY | O_CLOEXEC )) == -1) goto failed;
+
+    TRACE( "using kernel write watches\n" );
+    use_kernel_writewatch = TRUE;
+    return;
+
+failed:
+    close( uffd_fd );
+    uffd_fd = -1;
+}
+
+
+static ULONG_PTR kernel_get_write_watches( void *base, size_t size, void **addresses,
+                                           ULONG_PTR count, BOOL reset );
+
+/***********************************************************************
+ *           kernel_writewatch_fallback
+ *
+ * Stop tracking the write watches of a view with the kernel, and use page
+ * protections instead. Pages already written keep being reported as such.
+ * virtual_mutex must be held by caller.
+ */
+static void kernel_writewatch_fallback( struct file_view *view )
+{
+    char *base = view->base, *end = base + view->size;
+    struct uffdio_range range;
+    void *addresses[64];
+    ULONG_PTR i, count;
+
+    set_page_vprot_bits( view->base, view->size, VPROT_WRITEWATCH, 0 );
+    while (base < end && (count = kernel_get_write_watches( base, end - base, addresses,
+                                                            ARRAY_SIZE(addresses), FALSE )))
+    {
+        for (i = 0; i < count; i++) set_page_vprot_bits( addresses[i], page_size, 0, VPROT_WRITEWATCH );
+        base = (char *)addresses[count - 1] + page_size;
+    }
+
+    range.start = (UINT_PTR)view->base;
+    range.len   = view->size;
+    ioctl( uffd_fd, UFFDIO_UNREGISTER, &range );
+    view->protect &= ~VPROT_KERNEL_WATCH;
+}
+
+
+/***********************************************************************
+ *           kernel_writewatch_register_range
+ *
+ * Register a newly mapped range of a write watch view with the kernel. If that
+ * fails, the whole view falls back to write watches based on page protections.
+ * virtual_mutex must be held by caller.
+ */
+static void kernel_writewatch_register_range( struct file_view *view, void *base, size_t size )
+{
+    struct uffdio_register reg;
+    struct uffdio_writeprotect wp;
+
+    if (!use_kernel_writewatch || !(view->protect & VPROT_WRITEWATCH)) return;
+    /* a view that fell back to page protections isn't registered again piecemeal */
+    if (!(view->protect & VPROT_KERNEL_WATCH) && (view->base != base || view->size != size)) return;
+
+#ifdef MADV_NOHUGEPAGE
+    madvise( base, size, MADV_NOHUGEPAGE );  /* watches are reported with page granularity */
+#endif
+    reg.range.start = (UINT_PTR)base;
+    reg.range.len   = size;
+    reg.mode        = UFFDIO_REGISTER_MODE_WP;
+    if (ioctl( uffd_fd, UFFDIO_REGISTER, &reg ) == -1)
+    {
+        WARN( "failed to register %p-%p: %s\n", base, (char *)base + size, strerror( errno ));
+        goto fallback;
+    }
+    wp.range = reg.range;
+    wp.mode  = UFFDIO_WRITEPROTECT_MODE_WP;
+    if (ioctl( uffd_fd, UFFDIO_WRITEPROTECT, &wp ) == -1)
+    {
+        WARN( "failed to write-protect %p-%p: %s\n", base, (char *)base + size, strerror( errno ));
+        ioctl( uffd_fd, UFFDIO_UNREGISTER, &reg.range );
+        goto fallback;
+    }
+
+    /* the pages no longer need to be write-protected on our side */
+    view->protect |= VPROT_KERNEL_WATCH;
+    set_page_vprot_bits( base, size, 0, VPROT_WRITEWATCH );
+    mprotect_range( base, size, 0, 0 );
+    return;
+
+fallback:
+    if (view->protect & VPROT_KERNEL_WATCH) kernel_writewatch_fallback( view );
+    /* the new range hasn't been written yet */
+    set_page_vprot_bits( base, size, VPROT_WRITEWATCH, 0 );
+    mprotect_range( view->base, view->size, 0, 0 );
+}
+
+
+/***********************************************************************
+ *           kernel_get_write_watches
+ *
+ * Retrieve the written pages of a range from the kernel, optionally resetting them.
+ * Returns the number of addresses stored.
+ */
+static ULONG_PTR kernel_get_write_watches( void *base, size_t size, void **addresses,
+                                           ULONG_PTR count, BOOL reset )
+{
+    struct page_region regions[64];
+    struct pm_scan_arg arg;
+    ULONG_PTR addr, pos = 0;
+    int i, ret;
+
+    memset( &arg, 0, sizeof(arg) );
+    arg.size          = sizeof(arg);
+    arg.start         = (UINT_PTR)base;
+    arg.end           = (UINT_PTR)base + size;
+    arg.vec           = (UINT_PTR)regions;
+    arg.vec_len       = ARRAY_SIZE(regions);
+    arg.flags         = reset ? PM_SCAN_WP_MATCHING | PM_SCAN_CHECK_WPASYNC : 0;
+    arg.category_mask = PAGE_IS_WRITTEN;
+    arg.return_mask   = PAGE_IS_WRITTEN;
+
+    while (pos < count)
+    {
+        arg.max_pages = count - pos;
+        if ((ret = ioctl( pagemap_fd, PAGEMAP_SCAN, &arg )) == -1)
+        {
+            ERR( "PAGEMAP_SCAN failed for %p-%p: %s\n", base, (char *)base + size, strerror( errno ));
+            break;
+        }
+        for (i = 0; i < ret; i++)
+            for (addr = regions[i].start; addr < regions[i].end && pos < count; addr += page_size)
+                addresses[pos++] = (void *)addr;
+        if (arg.walk_end >= arg.end) break;
+        arg.start = arg.walk_end;
+    }
+    return pos;
+}
+
+
+/***********************************************************************
+ *           kernel_reset_write_watches
+ */
+static void kernel_reset_write_watches( void *base, size_t size )
+{
+    struct pm_scan_arg arg;
+
+    memset( &arg, 0, sizeof(arg) );
+    arg.size          = sizeof(arg);
+    arg.start         = (UINT_PTR)base;
+    arg.end           = (UINT_PTR)base + size;
+    arg.flags         = PM_SCAN_WP_MATCHING | PM_SCAN_CHECK_WPASYNC;
+    arg.category_mask = PAGE_IS_WRITTEN;
+    arg.return_mask   = PAGE_IS_WRITTEN;
+    if (ioctl( pagemap_fd, PAGEMAP_SCAN, &arg ) == -1)
+        ERR( "PAGEMAP_SCAN failed for %p-%p: %s\n", base, (char *)base + size, strerror( errno ));
+}
+
+#else  /* defined(HAVE_LINUX_USERFAULTFD_H) && defined(UFFD_FEATURE_WP_ASYNC) && defined(PAGEMAP_SCAN) */
+
+static void kernel_writewatch_init(void) { }
+static void kernel_writewatch_register_range( struct file_view *view, void *base, size_t size ) { }
+static ULONG_PTR kernel_get_write_watches( void *base, size_t size, void **addresses,
+                                           ULONG_PTR count, BOOL reset ) { return 0; }
+static void kernel_reset_write_watches( void *base, size_t size ) { }
+
+#endif  /* defined(HAVE_LINUX_USERFAULTFD_H) && defined(UFFD_FEATURE_WP_ASYNC) && defined(PAGEMAP_SCAN) */
+
+
 /***********************************************************************
  *           update_write_watches
  */
@@ -1800,6 +2006,11 @@ static void update_write_watches( void *base, size_t size, size_t accessed_size
  */
 static void reset_write_watches( void *base, SIZE_T size )
 {
+    if (is_kernel_write_watch_range( base, size ))
+    {
+        kernel_reset_write_watches( base, size );
+        return;
+    }
     set_page_vprot_bits( base, size, VPROT_WRITEWATCH, 0 );
     mprotect_range( base, size, 0, 0 );
 }
@@ -1982,7 +2193,11 @@ static NTSTATUS map_view( struct file_view **view_ret, void *base, size_t size,
 
         view->protect = vprot | VPROT_PLACEHOLDER;
         set_vprot( view, base, size, vprot );
-        if (vprot & VPROT_WRITEWATCH) reset_write_watches( base, size );
+        if (vprot & VPROT_WRITEWATCH)
+        {
+            kernel_writewatch_register_range( view, base, size );
+            reset_write_watches( base, size );
+        }
         *view_ret = view;
         return STATUS_SUCCESS;
     }
@@ -2042,6 +2257,7 @@ static NTSTATUS map_view( struct file_view **view_ret, void *base, size_t size,
 done:
     status = create_view( view_ret, ptr, size, vprot );
     if (status != STATUS_SUCCESS) unmap_area( ptr, size );
+    else kernel_writewatch_register_range( *view_ret, ptr, size );
     return status;
 }
 
@@ -2169,6 +2385,8 @@ static NTSTATUS decommit_pages( struct file_view *view, size_t start, size_t siz
     if (anon_mmap_fixed( (char *)view->base + start, size, PROT_NONE, 0 ) != MAP_FAILED)
     {
         set_page_vprot_bits( (char *)view->base + start, size, 0, VPROT_COMMITTED );
+        /* the new mapping is no longer registered for kernel write watches */
+        kernel_writewatch_register_range( view, (char *)view->base + start, size );
         return STATUS_SUCCESS;
     }
     return STATUS_NO_MEMORY;
@@ -2564,6 +2782,241 @@ static void update_arm64x_mapping( struct file_view *view, IMAGE_NT_HEADERS *nt,
 
 #endif  /* __aarch64__ */
 
+/* image section whose file data isn't page-aligned */
+struct image_range
+{
+    UINT  rva;         /* start of the range in the view */
+    UINT  size;        /* page-aligned size of the range */
+    UINT  file_size;   /* size of the data in the file */
+    off_t offset;      /* position of the data in the file */
+};
+
+/* header of the converted image cache files */
+struct image_cache_header
+{
+    char      magic[8];
+    ULONGLONG dev;
+    ULONGLONG ino;
+    ULONGLONG file_size;
+    ULONGLONG mtime;
+    ULONGLONG mtime_nsec;
+    ULONGLONG ctime;
+    ULONGLONG ctime_nsec;
+    ULONGLONG map_size;
+};
+
+#define IMAGE_CACHE_MAX_SIZE (256 * 1024 * 1024)  /* disk space used by all the cache files */
+
+struct image_cache_entry
+{
+    char      name[64];
+    time_t    mtime;
+    ULONGLONG size;
+};
+
+static int compare_image_cache_entries( const void *a, const void *b )
+{
+    const struct image_cache_entry *entry1 = a, *entry2 = b;
+    if (entry1->mtime != entry2->mtime) return entry1->mtime < entry2->mtime ? -1 : 1;
+    return strcmp( entry1->name, entry2->name );
+}
+
+/***********************************************************************
+ *           trim_image_cache
+ *
+ * Delete the least recently used image cache files to make room for a new one of
+ * the specified size. Views mapping them are not affected.
+ */
+static void trim_image_cache( ULONGLONG new_size )
+{
+    struct image_cache_entry *entries = NULL, *new_entries;
+    unsigned int i, count = 0, capacity = 0;
+    ULONGLONG total = new_size;
+    struct dirent *de;
+    struct stat st;
+    DIR *dir;
+
+    if (!(dir = opendir( server_dir ))) return;
+    while ((de = readdir( dir )))
+    {
+        if (strncmp( de->d_name, "image-", 6 ) || strlen( de->d_name ) >= sizeof(entries->name)) continue;
+        if (fstatat( dirfd( dir ), de->d_name, &st, AT_SYMLINK_NOFOLLOW ) == -1 || !S_ISREG( st.st_mode ))
+            continue;
+        if (count == capacity)
+        {
+            capacity = max( 16, capacity * 2 );
+            if (!(new_entries = realloc( entries, capacity * sizeof(*entries) ))) break;
+            entries = new_entries;
+        }
+        strcpy( entries[count].name, de->d_name );
+        entries[count].mtime = st.st_mtime;
+        entries[count].size = (ULONGLONG)st.st_blocks * 512;  /* the files are sparse */
+        total += entries[count++].size;
+    }
+
+    if (total > IMAGE_CACHE_MAX_SIZE)
+    {
+        qsort( entries, count, sizeof(*entries), compare_image_cache_entries );
+        for (i = 0; i < count && total > IMAGE_CACHE_MAX_SIZE; i++)
+        {
+            if (unlinkat( dirfd( dir ), entries[i].name, 0 ) == -1) continue;
+            TRACE_(module)( "removed image cache %s\n", entries[i].name );
+            total -= entries[i].size;
+        }
+    }
+    closedir( dir );
+    free( entries );
+}
+
+/***********************************************************************
+ *           open_image_cache
+ *
+ * Open the converted copy of an image, creating it if needed. The cache file stores
+ * the data of the unaligned sections at their virtual address, so that they can be
+ * mapped directly and paged in by the kernel.
+ */
+static int open_image_cache( int fd, const struct stat *st, SIZE_T map_size,
+                             const struct image_range *ranges, unsigned int count )
+{
+    static const char magic[8] = "WINEIM2";
+    static const size_t chunk_size = 0x40000;
+    struct image_cache_header header, cached;
+    struct stat cache_st;
+    char *name, *tmp_name, *buffer = NULL;
+    unsigned int i;
+    size_t pos;
+    ssize_t ret;
+    void *ptr;
+    int cache_fd;
+
+    if (!server_dir) return -1;
+    for (i = 0; i < count; i++) if (ranges[i].rva < page_size) return -1;  /* overlaps the cache header */
+
+    if (!(name = malloc( 2 * (strlen( server_dir ) + 64) ))) return -1;
+    tmp_name = name + strlen( server_dir ) + 64;
+    sprintf( name, "%s/image-%lx-%lx", server_dir, (unsigned long)st->st_dev, (unsigned long)st->st_ino );
+
+    memset( &header, 0, sizeof(header) );
+    memcpy( header.magic, magic, sizeof(magic) );
+    header.dev       = st->st_dev;
+    header.ino       = st->st_ino;
+    header.file_size = st->st_size;
+    header.mtime     = st->st_mtime;
+    header.ctime     = st->st_ctime;
+    /* a file rewritten in place within the same second must not match */
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    header.mtime_nsec = st->st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    header.mtime_nsec = st->st_mtimespec.tv_nsec;
+#endif
+#ifdef HAVE_STRUCT_STAT_ST_CTIM
+    header.ctime_nsec = st->st_ctim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_CTIMESPEC)
+    header.ctime_nsec = st->st_ctimespec.tv_nsec;
+#endif
+    header.map_size  = map_size;
+
+    if ((cache_fd = open( name, O_RDONLY | O_CLOEXEC )) != -1)
+    {
+        if (pread( cache_fd, &cached, sizeof(cached), 0 ) == sizeof(cached) &&
+            !memcmp( &cached, &header, sizeof(header) ) &&
+            !fstat( cache_fd, &cache_st ) && cache_st.st_size >= map_size)
+        {
+#ifdef HAVE_FUTIMENS
+            futimens( cache_fd, NULL );  /* keep it from being trimmed */
+#endif
+            goto done;
+        }
+        close( cache_fd );
+    }
+
+    /* create a new one and replace the existing file, views mapping it keep the old data */
+
+    if (map_size > IMAGE_CACHE_MAX_SIZE / 4)
+    {
+        free( name );
+        return -1;
+    }
+    trim_image_cache( map_size );
+    strcpy( tmp_name, name );
+    sprintf( tmp_name + strlen( tmp_name ), ".%x", getpid() );
+    if ((cache_fd = open( tmp_name, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600 )) == -1) goto failed;
+    if (!(buffer = malloc( chunk_size ))) goto failed;
+    if (ftruncate( cache_fd, map_size ) == -1) goto failed;
+    for (i = 0; i < count; i++)
+    {
+        for (pos = 0; pos < ranges[i].file_size; pos += ret)
+        {
+            ret = pread( fd, buffer, min( chunk_size, ranges[i].file_size - pos ), ranges[i].offset + pos );
+            if (ret == -1) goto failed;
+            if (!ret) break;  /* the rest of the section is past the end of file */
+            if (pwrite( cache_fd, buffer, ret, ranges[i].rva + pos ) != ret) goto failed;
+        }
+    }
+    if (pwrite( cache_fd, &header, sizeof(header), 0 ) != sizeof(header)) goto failed;
+    if (rename( tmp_name, name ) == -1) goto failed;
+    TRACE_(module)( "created image cache %s\n", name );
+
+done:
+    /* make sure that the cache is not on a noexec file system */
+    if ((ptr = mmap( NULL, page_size, PROT_READ | PROT_EXEC, MAP_PRIVATE, cache_fd, 0 )) != MAP_FAILED)
+    {
+        munmap( ptr, page_size );
+        free( buffer );
+        free( name );
+        return cache_fd;
+    }
+    WARN_(module)( "cannot map %s, noexec file system?\n", name );
+    close( cache_fd );
+    free( buffer );
+    free( name );
+    return -1;
+
+failed:
+    WARN_(module)( "failed to create image cache %s\n", name );
+    if (cache_fd != -1)
+    {
+        close( cache_fd );
+        unlink( tmp_name );
+    }
+    free( buffer );
+    free( name );
+    return -1;
+}
+
+
+/***********************************************************************
+ *           map_unaligned_sections
+ *
+ * Map the sections whose file data isn't page-aligned, either from the converted image
+ * cache, or by reading the data into memory. virtual_mutex must be held by caller.
+ */
+static NTSTATUS map_unaligned_sections( struct file_view *view, int fd, const struct stat *st,
+                                        const struct image_range *ranges, unsigned int count,
+                                        BOOL removable )
+{
+    const unsigned int vprot = VPROT_COMMITTED | VPROT_READ | VPROT_WRITECOPY;
+    NTSTATUS status = STATUS_SUCCESS;
+    unsigned int i;
+    int cache_fd;
+
+    /* the file may go away on removable media, don't keep a copy of it */
+    if (!removable && (cache_fd = open_image_cache( fd, st, view->size, ranges, count )) != -1)
+    {
+        for (i = 0; i < count && !status; i++)
+            status = map_file_into_view( view, cache_fd, ranges[i].rva, ranges[i].size,
+                                         ranges[i].rva, vprot, FALSE );
+        close( cache_fd );
+        return status;
+    }
+
+    for (i = 0; i < count && !status; i++)
+        status = map_file_into_view( view, fd, ranges[i].rva, ranges[i].file_size,
+                                     ranges[i].offset, vprot, removable );
+    return status;
+}
+
+
 /***********************************************************************
  *           map_image_into_view
  *
@@ -2579,6 +3032,8 @@ static NTSTATUS map_image_into_view( struct file_view *view, const WCHAR *filena
     IMAGE_SECTION_HEADER sections[96];
     IMAGE_SECTION_HEADER *sec;
     IMAGE_DATA_DIRECTORY *imports;
+    struct image_range unaligned[ARRAY_SIZE( sections )];
+    unsigned int unaligned_count = 0;
     NTSTATUS status = STATUS_CONFLICTING_ADDRESSES;
     int i;
     off_t pos;
@@ -2702,10 +3157,24 @@ static NTSTATUS map_image_into_view( struct file_view *view, const WCHAR *filena
 
         if (!sec->PointerToRawData || !file_size) continue;
 
+        end = file_start + file_size;
+        if (sec->PointerToRawData < st.st_size &&
+            end <= ((st.st_size + sector_align) & ~sector_align) &&
+            end >= file_start && (file_start & page_mask))
+        {
+            /* not aligned properly, these get mapped once all the sections are known */
+            struct image_range *range = &unaligned[unaligned_count++];
+
+            range->rva       = sec->VirtualAddress;
+            range->size      = min( ROUND_SIZE( 0, file_size ), map_size );
+            range->file_size = file_size;
+            range->offset    = file_start;
+            continue;
+        }
+
         /* Note: if the section is not aligned properly map_file_into_view will magically
          *       fall back to read(), so we don't need to check anything here.
          */
-        end = file_start + file_size;
         if (sec->PointerToRawData >= st.st_size ||
             end > ((st.st_size + sector_align) & ~sector_align) ||
             end < file_start ||
@@ -2729,6 +3198,12 @@ static NTSTATUS map_image_into_view( struct file_view *view, const WCHAR *filena
         }
     }
 
+    if (unaligned_count && map_unaligned_sections( view, fd, &st, unaligned, unaligned_count, removable ))
+    {
+        ERR_(module)( "Could not map %s unaligned sections\n", debugstr_w(filename) );
+        return status;
+    }
+
 #ifdef __aarch64__
     if (machine == IMAGE_FILE_MACHINE_AMD64 ||
         (!machine && main_image_info.Machine == IMAGE_FILE_MACHINE_AMD64))
@@ -3073,6 +3548,8 @@ void virtual_init(void)
     pthread_mutex_init( &virtual_mutex, &attr );
     pthread_mutexattr_destroy( &attr );
 
+    kernel_writewatch_init();
+
     if (preload_info && *preload_info)
         for (i = 0; (*preload_info)[i].size; i++)
             mmap_add_reserved_area( (*preload_info)[i].addr, (*preload_info)[i].size );
@@ -5547,12 +6024,17 @@ NTSTATUS WINAPI NtGetWriteWatch( HANDLE process, ULONG flags, PVOID base, SIZE_T
         char *addr = base;
         char *end = addr + size;
 
-        while (pos < *count && addr < end)
+        if (is_kernel_write_watch_range( base, size ))
+            pos = kernel_get_write_watches( base, size, addresses, *count, flags & WRITE_WATCH_FLAG_RESET );
+        else
         {
-            if (!(get_page_vprot( addr ) & VPROT_WRITEWATCH)) addresses[pos++] = addr;
-            addr += page_size;
+            while (pos < *count && addr < end)
+            {
+                if (!(get_page_vprot( addr ) & VPROT_WRITEWATCH)) addresses[pos++] = addr;
+                addr += page_size;
+            }
+            if (flags & WRITE_WATCH_FLAG_RESET) reset_write_watches( base, addr - (char *)base );
         }
-        if (flags & WRITE_WATCH_FLAG_RESET) reset_write_watches( base, addr - (char *)base );
         *count = pos;
         *granularity = page_size;
     }
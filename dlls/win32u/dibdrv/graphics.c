@@ -55,6 +55,7 @@ struct cached_font
     LOGFONTW              lf;
     XFORM                 xform;
     UINT                  aa_flags;
+    UINT                  shared_hash;
     struct cached_glyph **glyphs[GLYPH_NBTYPES][GLYPH_CACHE_PAGES];
 };
 
@@ -62,6 +63,54 @@ static struct list font_cache = LIST_INIT( font_cache );
 
 static pthread_mutex_t font_cache_lock = PTHREAD_MUTEX_INITIALIZER;
 
+/*
+ * Shared glyph cache
+ *
+ * An optional set-associative cache of glyph bitmaps in a named section, shared
+ * by all processes of the session. It sits below the per-process font cache:
+ * glyphs missing from a cached_font are looked up here before being rasterized,
+ * and newly rasterized glyphs are added to it. Entries are protected by a
+ * sequence count, so readers never block and a process dying in the middle of
+ * an update only loses that entry. The least recently used way of a set is
+ * replaced.
+ */
+
+#define SHARED_GLYPH_CACHE_MAGIC      0x43474853  /* 'SHGC' */
+#define SHARED_GLYPH_CACHE_SETS       2048
+#define SHARED_GLYPH_CACHE_WAYS       4
+#define SHARED_GLYPH_CACHE_MAX_SIZE   2048  /* largest glyph bitmap that is shared */
+
+struct shared_glyph_key
+{
+    LOGFONTW              lf;
+    XFORM                 xform;
+    UINT                  aa_flags;
+    UINT                  type;
+    UINT                  index;
+};
+
+struct shared_glyph_entry
+{
+    LONG                  seq;       /* odd while the entry is being written */
+    LONG                  last_use;
+    UINT                  hash;
+    UINT                  size;
+    struct shared_glyph_key key;     /* aa_flags is 0 for unused entries */
+    GLYPHMETRICS          metrics;
+    BYTE                  bits[SHARED_GLYPH_CACHE_MAX_SIZE];
+};
+
+struct shared_glyph_cache
+{
+    LONG                  magic;
+    LONG                  clock;
+    struct shared_glyph_entry entries[SHARED_GLYPH_CACHE_SETS * SHARED_GLYPH_CACHE_WAYS];
+};
+
+static struct shared_glyph_cache *shared_glyph_cache;
+static BOOL shared_glyph_cache_disabled;
+static LONG shared_glyph_hits, shared_glyph_misses;
+
 
 static BOOL brush_rect( dibdrv_physdev *pdev, dib_brush *brush, const RECT *rect, HRGN clip )
 {
@@ -551,12 +600,182 @@ static int font_cache_cmp( const struct cached_font *p1, const struct cached_fon
     return ret;
 }
 
+static UINT shared_glyph_hash( const void *data, SIZE_T size, UINT hash )
+{
+    const BYTE *ptr = data;
+
+    while (size--) hash = (hash ^ *ptr++) * 16777619;
+    return hash;
+}
+
+/***********************************************************************
+ *           init_shared_glyph_cache
+ *
+ * Open or create the shared glyph cache of the session.
+ */
+void init_shared_glyph_cache(void)
+{
+    static const WCHAR nameW[] =
+        {'\\','B','a','s','e','N','a','m','e','d','O','b','j','e','c','t','s',
+         '\\','_','_','w','i','n','e','_','g','l','y','p','h','_','c','a','c','h','e'};
+    OBJECT_ATTRIBUTES attr;
+    UNICODE_STRING name;
+    LARGE_INTEGER size;
+    SIZE_T view_size = 0;
+    HANDLE handle;
+    void *ptr = NULL;
+    LONG magic;
+
+    name.Buffer = (WCHAR *)nameW;
+    name.Length = name.MaximumLength = sizeof(nameW);
+    InitializeObjectAttributes( &attr, &name, OBJ_OPENIF, 0, NULL );
+    size.QuadPart = sizeof(*shared_glyph_cache);
+
+    if (NtCreateSection( &handle, SECTION_ALL_ACCESS, &attr, &size, PAGE_READWRITE, SEC_COMMIT, 0 ) < 0)
+        return;
+    if (NtMapViewOfSection( handle, GetCurrentProcess(), &ptr, 0, 0, NULL, &view_size,
+                            ViewShare, 0, PAGE_READWRITE ) < 0 || view_size < sizeof(*shared_glyph_cache))
+    {
+        if (ptr) NtUnmapViewOfSection( GetCurrentProcess(), ptr );
+        NtClose( handle );
+        return;
+    }
+
+    /* a new section is zero-filled, which is a valid empty cache */
+    magic = InterlockedCompareExchange( ptr, SHARED_GLYPH_CACHE_MAGIC, 0 );
+    if (magic && magic != SHARED_GLYPH_CACHE_MAGIC)
+    {
+        WARN( "incompatible shared glyph cache\n" );
+        NtUnmapViewOfSection( GetCurrentProcess(), ptr );
+        NtClose( handle );
+        return;
+    }
+
+    /* the section handle is kept open so that the cache outlives this process */
+    TRACE( "using shared glyph cache at %p\n", ptr );
+    shared_glyph_cache = ptr;
+}
+
+/***********************************************************************
+ *           disable_shared_glyph_cache
+ *
+ * Stop using the shared cache once the process has its own set of fonts,
+ * since the same LOGFONT could then select a different face.
+ */
+void disable_shared_glyph_cache(void)
+{
+    shared_glyph_cache_disabled = TRUE;
+}
+
+static BOOL use_shared_glyph_cache(void)
+{
+    return shared_glyph_cache && !shared_glyph_cache_disabled;
+}
+
+static void init_shared_glyph_key( struct shared_glyph_key *key, const struct cached_font *font,
+                                   UINT index, UINT flags )
+{
+    key->lf = font->lf;
+    key->xform = font->xform;
+    key->aa_flags = font->aa_flags;
+    key->type = (flags & ETO_GLYPH_INDEX) ? GLYPH_INDEX : GLYPH_WCHAR;
+    key->index = index;
+}
+
+static void update_shared_glyph_stats( LONG *counter )
+{
+    LONG count = InterlockedIncrement( counter );
+
+    if (TRACE_ON(dib) && !(count % 4096))
+        TRACE( "shared glyph cache: %d hits, %d misses\n", (int)shared_glyph_hits, (int)shared_glyph_misses );
+}
+
+static struct cached_glyph *get_shared_glyph( const struct cached_font *font, UINT index, UINT flags )
+{
+    struct shared_glyph_entry *entry;
+    struct cached_glyph *glyph;
+    struct shared_glyph_key key;
+    UINT i, hash, size;
+    LONG seq;
+
+    init_shared_glyph_key( &key, font, index, flags );
+    hash = shared_glyph_hash( &key.type, sizeof(key.type) + sizeof(key.index), font->shared_hash );
+    entry = shared_glyph_cache->entries + (hash % SHARED_GLYPH_CACHE_SETS) * SHARED_GLYPH_CACHE_WAYS;
+
+    for (i = 0; i < SHARED_GLYPH_CACHE_WAYS; i++, entry++)
+    {
+        seq = ReadAcquire( &entry->seq );
+        if (seq & 1) continue;
+        if (entry->hash != hash || memcmp( &entry->key, &key, sizeof(key) )) continue;
+        if ((size = entry->size) > SHARED_GLYPH_CACHE_MAX_SIZE) continue;
+        if (!(glyph = malloc( FIELD_OFFSET( struct cached_glyph, bits[size] )))) return NULL;
+        glyph->metrics = entry->metrics;
+        memcpy( glyph->bits, entry->bits, size );
+
+        /* make sure that the entry wasn't replaced while it was copied */
+        MemoryBarrier();
+        if (entry->seq != seq)
+        {
+            free( glyph );
+            continue;
+        }
+        entry->last_use = InterlockedIncrement( &shared_glyph_cache->clock );
+        update_shared_glyph_stats( &shared_glyph_hits );
+        return glyph;
+    }
+
+    update_shared_glyph_stats( &shared_glyph_misses );
+    return NULL;
+}
+
+static void put_shared_glyph( const struct cached_font *font, UINT index, UINT flags,
+                              const struct cached_glyph *glyph, UINT size )
+{
+    struct shared_glyph_entry *entry, *victim = NULL;
+    struct shared_glyph_key key;
+    UINT i, hash;
+    LONG seq;
+
+    if (size > SHARED_GLYPH_CACHE_MAX_SIZE) return;
+
+    init_shared_glyph_key( &key, font, index, flags );
+    hash = shared_glyph_hash( &key.type, sizeof(key.type) + sizeof(key.index), font->shared_hash );
+    entry = shared_glyph_cache->entries + (hash % SHARED_GLYPH_CACHE_SETS) * SHARED_GLYPH_CACHE_WAYS;
+
+    for (i = 0; i < SHARED_GLYPH_CACHE_WAYS; i++, entry++)
+    {
+        if (ReadAcquire( &entry->seq ) & 1) continue;
+        if (!entry->key.aa_flags)
+        {
+            victim = entry;
+            break;
+        }
+        if (entry->hash == hash && !memcmp( &entry->key, &key, sizeof(key) )) return;
+        if (!victim || entry->last_use - victim->last_use < 0) victim = entry;
+    }
+    if (!victim) return;
+
+    seq = ReadAcquire( &victim->seq );
+    if ((seq & 1) || InterlockedCompareExchange( &victim->seq, seq + 1, seq ) != seq) return;
+
+    victim->hash = hash;
+    victim->size = size;
+    victim->key = key;
+    victim->metrics = glyph->metrics;
+    memcpy( victim->bits, glyph->bits, size );
+    victim->last_use = InterlockedIncrement( &shared_glyph_cache->clock );
+    WriteRelease( &victim->seq, seq + 2 );
+}
+
 static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
 {
     struct cached_font font, *ptr, *last_unused = NULL;
     UINT i = 0, j, k;
 
     NtGdiExtGetObjectW( hfont, sizeof(font.lf), &font.lf );
+    /* clear anything after the face name, it's part of the shared cache key */
+    for (j = 0; j < LF_FACESIZE && font.lf.lfFaceName[j]; j++);
+    if (j < LF_FACESIZE) memset( font.lf.lfFaceName + j, 0, (LF_FACESIZE - j) * sizeof(WCHAR) );
     font.xform = dc->xformWorld2Vport;
     font.xform.eDx = font.xform.eDy = 0;  /* unused, would break hashing */
     if (dc->attr->graphics_mode == GM_COMPATIBLE)
@@ -568,6 +787,9 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
     font.lf.lfWidth = abs( font.lf.lfWidth );
     font.aa_flags = aa_flags;
     font.hash = font_cache_hash( &font );
+    font.shared_hash = shared_glyph_hash( &font.lf, sizeof(font.lf), 2166136261u );
+    font.shared_hash = shared_glyph_hash( &font.xform, sizeof(font.xform), font.shared_hash );
+    font.shared_hash = shared_glyph_hash( &font.aa_flags, sizeof(font.aa_flags), font.shared_hash );
 
     pthread_mutex_lock( &font_cache_lock );
     LIST_FOR_EACH_ENTRY( ptr, &font_cache, struct cached_font, entry )
@@ -754,6 +976,9 @@ static struct cached_glyph *cache_glyph_bitmap( DC *dc, struct cached_font *font
     GLYPHMETRICS metrics;
     struct cached_glyph *glyph;
 
+    if (use_shared_glyph_cache() && (glyph = get_shared_glyph( font, index, flags )))
+        return add_cached_glyph( font, index, flags, glyph );
+
     if (flags & ETO_GLYPH_INDEX) ggo_flags |= GGO_GLYPH_INDEX;
     indices[0] = index;
     for (i = 0; i < ARRAY_SIZE( indices ); i++)
@@ -804,6 +1029,7 @@ static struct cached_glyph *cache_glyph_bitmap( DC *dc, struct cached_font *font
 
 done:
     glyph->metrics = metrics;
+    if (use_shared_glyph_cache()) put_shared_glyph( font, index, flags, glyph, size );
     return add_cached_glyph( font, index, flags, glyph );
 }
 
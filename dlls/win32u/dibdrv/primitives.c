@@ -23,6 +23,9 @@
 #endif
 
 #include <assert.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "ntgdi_private.h"
 #include "dibdrv.h"
@@ -256,6 +259,18 @@ static inline void memset_32( DWORD *start, DWORD val, DWORD size )
 #endif
 }
 
+static inline void do_rop_32_row( DWORD *ptr, DWORD and, DWORD xor, int len )
+{
+#ifdef __SSE2__
+    __m128i and_vec = _mm_set1_epi32( and ), xor_vec = _mm_set1_epi32( xor );
+
+    for (; len >= 4; len -= 4, ptr += 4)
+        _mm_storeu_si128( (__m128i *)ptr,
+                          _mm_xor_si128( _mm_and_si128( _mm_loadu_si128( (__m128i *)ptr ), and_vec ), xor_vec ));
+#endif
+    while (len-- > 0) do_rop_32( ptr++, and, xor );
+}
+
 static inline void memset_16( WORD *start, WORD val, DWORD size )
 {
 #if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
@@ -270,8 +285,8 @@ static inline void memset_16( WORD *start, WORD val, DWORD size )
 
 static void solid_rects_32(const dib_info *dib, int num, const RECT *rc, DWORD and, DWORD xor)
 {
-    DWORD *ptr, *start;
-    int x, y, i;
+    DWORD *start;
+    int y, i;
 
     for(i = 0; i < num; i++, rc++)
     {
@@ -280,8 +295,7 @@ static void solid_rects_32(const dib_info *dib, int num, const RECT *rc, DWORD a
         start = get_pixel_ptr_32(dib, rc->left, rc->top);
         if (and)
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 4)
-                for(x = rc->left, ptr = start; x < rc->right; x++)
-                    do_rop_32(ptr++, and, xor);
+                do_rop_32_row( start, and, xor, rc->right - rc->left );
         else
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 4)
                 memset_32( start, xor, rc->right - rc->left );
@@ -2219,6 +2233,18 @@ static inline BOOL bit_fields_match(const dib_info *d1, const dib_info *d2)
            d1->blue_mask  == d2->blue_mask;
 }
 
+#ifdef __SSE2__
+static inline __m128i expand_888_to_8888( const BYTE *src )
+{
+    const __m128i v = _mm_loadu_si128( (const __m128i *)src );
+
+    return _mm_or_si128( _mm_or_si128( _mm_and_si128( v, _mm_set_epi32( 0, 0, 0, 0xffffff )),
+                                       _mm_and_si128( _mm_slli_si128( v, 1 ), _mm_set_epi32( 0, 0, 0xffffff, 0 ))),
+                         _mm_or_si128( _mm_and_si128( _mm_slli_si128( v, 2 ), _mm_set_epi32( 0, 0xffffff, 0, 0 )),
+                                       _mm_and_si128( _mm_slli_si128( v, 3 ), _mm_set_epi32( 0xffffff, 0, 0, 0 ))));
+}
+#endif
+
 static void convert_to_8888(dib_info *dst, const dib_info *src, const RECT *src_rect, BOOL dither)
 {
     DWORD *dst_start = get_pixel_ptr_32(dst, 0, 0), *dst_pixel, src_val;
@@ -2291,7 +2317,13 @@ static void convert_to_8888(dib_info *dst, const dib_info *src, const RECT *src_
         {
             dst_pixel = dst_start;
             src_pixel = src_start;
-            for(x = src_rect->left; x < src_rect->right; x++)
+            x = src_rect->left;
+#ifdef __SSE2__
+            /* Four pixels at a time; the 16-byte load needs two pixels of slack. */
+            for(; x + 6 <= src_rect->right; x += 4, src_pixel += 12, dst_pixel += 4)
+                _mm_storeu_si128( (__m128i *)dst_pixel, expand_888_to_8888( src_pixel ));
+#endif
+            for(; x < src_rect->right; x++)
             {
                 RGBQUAD rgb;
                 rgb.rgbBlue  = *src_pixel++;
@@ -4682,35 +4714,151 @@ static inline DWORD blend_rgb( BYTE dst_r, BYTE dst_g, BYTE dst_b, DWORD src, BL
             blend_color( dst_r, src >> 16, blend.SourceConstantAlpha ) << 16);
 }
 
+#ifdef __SSE2__
+/* The SSE2 versions of the blend functions work on four pixels at a time,
+ * with each channel widened to 16 bits, and give the same results as the
+ * scalar ones above. */
+
+/* v / 255, rounded down, for v <= 65279; above that the 16-bit sum wraps.
+ * Callers pass at most 255 * 255 + 127. */
+static inline __m128i div255_epu16( __m128i v )
+{
+    return _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( v, _mm_set1_epi16( 1 )), _mm_srli_epi16( v, 8 )), 8 );
+}
+
+static inline __m128i broadcast_alpha_epu16( __m128i v )
+{
+    return _mm_shufflehi_epi16( _mm_shufflelo_epi16( v, _MM_SHUFFLE(3, 3, 3, 3) ), _MM_SHUFFLE(3, 3, 3, 3) );
+}
+
+/* Computes c0 | c1 << 8 | c2 << 16 | c3 << 24 for each pixel, letting
+ * channels that overflow spill into the next one like the scalar code. */
+static inline __m128i pack_channels_epu16( __m128i lo, __m128i hi )
+{
+    const __m128i mask_16 = _mm_set1_epi32( 0xffff ), mask_32 = _mm_set_epi32( 0, ~0, 0, ~0 );
+
+    lo = _mm_or_si128( _mm_and_si128( lo, mask_16 ), _mm_slli_epi32( _mm_srli_epi32( lo, 16 ), 8 ));
+    lo = _mm_or_si128( _mm_and_si128( lo, mask_32 ), _mm_slli_epi64( _mm_srli_epi64( lo, 32 ), 16 ));
+    hi = _mm_or_si128( _mm_and_si128( hi, mask_16 ), _mm_slli_epi32( _mm_srli_epi32( hi, 16 ), 8 ));
+    hi = _mm_or_si128( _mm_and_si128( hi, mask_32 ), _mm_slli_epi64( _mm_srli_epi64( hi, 32 ), 16 ));
+    return _mm_unpacklo_epi64( _mm_shuffle_epi32( lo, _MM_SHUFFLE(2, 0, 2, 0) ),
+                               _mm_shuffle_epi32( hi, _MM_SHUFFLE(2, 0, 2, 0) ));
+}
+
+static inline __m128i blend_argb_epu16( __m128i dst, __m128i src_lo, __m128i src_hi )
+{
+    const __m128i zero = _mm_setzero_si128(), c127 = _mm_set1_epi16( 127 ), c255 = _mm_set1_epi16( 255 );
+    __m128i dst_lo = _mm_unpacklo_epi8( dst, zero ), dst_hi = _mm_unpackhi_epi8( dst, zero );
+
+    dst_lo = _mm_mullo_epi16( dst_lo, _mm_sub_epi16( c255, broadcast_alpha_epu16( src_lo )));
+    dst_hi = _mm_mullo_epi16( dst_hi, _mm_sub_epi16( c255, broadcast_alpha_epu16( src_hi )));
+    dst_lo = div255_epu16( _mm_add_epi16( dst_lo, c127 ));
+    dst_hi = div255_epu16( _mm_add_epi16( dst_hi, c127 ));
+    return pack_channels_epu16( _mm_add_epi16( src_lo, dst_lo ), _mm_add_epi16( src_hi, dst_hi ));
+}
+
+static inline __m128i blend_argb_sse2( __m128i dst, __m128i src )
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    return blend_argb_epu16( dst, _mm_unpacklo_epi8( src, zero ), _mm_unpackhi_epi8( src, zero ));
+}
+
+static inline __m128i blend_argb_alpha_sse2( __m128i dst, __m128i src, DWORD alpha )
+{
+    const __m128i zero = _mm_setzero_si128(), c127 = _mm_set1_epi16( 127 ), alpha_vec = _mm_set1_epi16( alpha );
+    __m128i src_lo = _mm_unpacklo_epi8( src, zero ), src_hi = _mm_unpackhi_epi8( src, zero );
+
+    src_lo = div255_epu16( _mm_add_epi16( _mm_mullo_epi16( src_lo, alpha_vec ), c127 ));
+    src_hi = div255_epu16( _mm_add_epi16( _mm_mullo_epi16( src_hi, alpha_vec ), c127 ));
+    return blend_argb_epu16( dst, src_lo, src_hi );
+}
+
+static inline __m128i blend_argb_constant_alpha_sse2( __m128i dst, __m128i src, DWORD alpha )
+{
+    const __m128i zero = _mm_setzero_si128(), c127 = _mm_set1_epi16( 127 );
+    const __m128i alpha_vec = _mm_set1_epi16( alpha ), inv_alpha_vec = _mm_set1_epi16( 255 - alpha );
+    __m128i lo, hi;
+
+    lo = _mm_add_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( src, zero ), alpha_vec ),
+                        _mm_mullo_epi16( _mm_unpacklo_epi8( dst, zero ), inv_alpha_vec ));
+    hi = _mm_add_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( src, zero ), alpha_vec ),
+                        _mm_mullo_epi16( _mm_unpackhi_epi8( dst, zero ), inv_alpha_vec ));
+    lo = div255_epu16( _mm_add_epi16( lo, c127 ));
+    hi = div255_epu16( _mm_add_epi16( hi, c127 ));
+    return _mm_packus_epi16( lo, hi );
+}
+#endif
+
+static void blend_row_8888( DWORD *dst, const DWORD *src, int len, BLENDFUNCTION blend, BOOL src_alpha )
+{
+    DWORD alpha = blend.SourceConstantAlpha;
+    int x = 0;
+
+    if (blend.AlphaFormat & AC_SRC_ALPHA)
+    {
+        if (alpha == 255)
+        {
+#ifdef __SSE2__
+            for (; x + 4 <= len; x += 4)
+            {
+                __m128i d = _mm_loadu_si128( (__m128i *)&dst[x] ), s = _mm_loadu_si128( (const __m128i *)&src[x] );
+                _mm_storeu_si128( (__m128i *)&dst[x], blend_argb_sse2( d, s ));
+            }
+#endif
+            for (; x < len; x++) dst[x] = blend_argb( dst[x], src[x] );
+        }
+        else
+        {
+#ifdef __SSE2__
+            for (; x + 4 <= len; x += 4)
+            {
+                __m128i d = _mm_loadu_si128( (__m128i *)&dst[x] ), s = _mm_loadu_si128( (const __m128i *)&src[x] );
+                _mm_storeu_si128( (__m128i *)&dst[x], blend_argb_alpha_sse2( d, s, alpha ));
+            }
+#endif
+            for (; x < len; x++) dst[x] = blend_argb_alpha( dst[x], src[x], alpha );
+        }
+    }
+    else if (src_alpha)
+    {
+#ifdef __SSE2__
+        for (; x + 4 <= len; x += 4)
+        {
+            __m128i d = _mm_loadu_si128( (__m128i *)&dst[x] ), s = _mm_loadu_si128( (const __m128i *)&src[x] );
+            _mm_storeu_si128( (__m128i *)&dst[x], blend_argb_constant_alpha_sse2( d, s, alpha ));
+        }
+#endif
+        for (; x < len; x++) dst[x] = blend_argb_constant_alpha( dst[x], src[x], alpha );
+    }
+    else
+    {
+#ifdef __SSE2__
+        const __m128i opaque = _mm_set1_epi32( 0xff000000 );
+
+        for (; x + 4 <= len; x += 4)
+        {
+            __m128i d = _mm_loadu_si128( (__m128i *)&dst[x] ), s = _mm_loadu_si128( (const __m128i *)&src[x] );
+            s = _mm_or_si128( s, opaque );
+            _mm_storeu_si128( (__m128i *)&dst[x], blend_argb_constant_alpha_sse2( d, s, alpha ));
+        }
+#endif
+        for (; x < len; x++) dst[x] = blend_argb_no_src_alpha( dst[x], src[x], alpha );
+    }
+}
+
 static void blend_rects_8888(const dib_info *dst, int num, const RECT *rc,
                              const dib_info *src, const POINT *offset, BLENDFUNCTION blend)
 {
-    int i, x, y;
+    int i, y;
 
     for (i = 0; i < num; i++, rc++)
     {
         DWORD *src_ptr = get_pixel_ptr_32( src, rc->left + offset->x, rc->top + offset->y );
         DWORD *dst_ptr = get_pixel_ptr_32( dst, rc->left, rc->top );
 
-        if (blend.AlphaFormat & AC_SRC_ALPHA)
-        {
-            if (blend.SourceConstantAlpha == 255)
-                for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-                    for (x = 0; x < rc->right - rc->left; x++)
-                        dst_ptr[x] = blend_argb( dst_ptr[x], src_ptr[x] );
-            else
-                for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-                    for (x = 0; x < rc->right - rc->left; x++)
-                        dst_ptr[x] = blend_argb_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
-        }
-        else if (src->compression == BI_RGB)
-            for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-                for (x = 0; x < rc->right - rc->left; x++)
-                    dst_ptr[x] = blend_argb_constant_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
-        else
-            for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-                for (x = 0; x < rc->right - rc->left; x++)
-                    dst_ptr[x] = blend_argb_no_src_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+        for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
+            blend_row_8888( dst_ptr, src_ptr, rc->right - rc->left, blend, src->compression == BI_RGB );
     }
 }
 
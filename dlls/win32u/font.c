@@ -194,6 +194,7 @@ static const WCHAR font_assoc_keyW[] =
 static UINT font_smoothing = GGO_BITMAP;
 static UINT subpixel_orientation = GGO_GRAY4_BITMAP;
 static BOOL antialias_fakes = TRUE;
+static BOOL shared_glyph_cache;
 static struct font_gamma_ramp font_gamma_ramp;
 
 static void add_face_to_cache( struct gdi_font_face *face );
@@ -4810,6 +4811,13 @@ static UINT init_font_options(void)
         antialias_fakes = (wcschr( valsW, *(const WCHAR *)info->Data ) != NULL);
     }
 
+    if (query_reg_ascii_value( wine_fonts_key, "SharedGlyphCache",
+                               info, sizeof(value_buffer) ) && info->Type == REG_SZ)
+    {
+        static const WCHAR valsW[] = {'y','Y','t','T','1',0};
+        shared_glyph_cache = (wcschr( valsW, *(const WCHAR *)info->Data ) != NULL);
+    }
+
     if ((key = reg_open_hkcu_key( "Control Panel\\Desktop" )))
     {
         /* FIXME: handle vertical orientations even though Windows doesn't */
@@ -6837,6 +6845,8 @@ UINT font_init(void)
         load_font_list_from_cache();
     }
 
+    font_funcs->publish_face_cache();
+    if (shared_glyph_cache) init_shared_glyph_cache();
     reorder_font_list();
     load_gdi_font_subst();
     load_gdi_font_replacements();
@@ -6852,8 +6862,11 @@ UINT font_init(void)
 INT WINAPI NtGdiAddFontResourceW( const WCHAR *str, ULONG size, ULONG files, DWORD flags,
                                   DWORD tid, void *dv )
 {
+    INT ret;
+
     if (!font_funcs) return 1;
-    return add_font_resource( str, flags );
+    if ((ret = add_font_resource( str, flags ))) disable_shared_glyph_cache();
+    return ret;
 }
 
 /***********************************************************************
@@ -6884,6 +6897,7 @@ HANDLE WINAPI NtGdiAddFontMemResourceEx( void *ptr, DWORD size, void *dv, ULONG
         free( copy );
         return NULL;
     }
+    disable_shared_glyph_cache();
 
     /* FIXME: is the handle only for use in RemoveFontMemResourceEx or should it be a true handle?
      * For now return something unique but quite random
@@ -6920,8 +6934,11 @@ BOOL WINAPI NtGdiRemoveFontMemResourceEx( HANDLE handle )
 BOOL WINAPI NtGdiRemoveFontResourceW( const WCHAR *str, ULONG size, ULONG files, DWORD flags,
                                       DWORD tid, void *dv )
 {
+    BOOL ret;
+
     if (!font_funcs) return TRUE;
-    return remove_font_resource( str, flags );
+    if ((ret = remove_font_resource( str, flags ))) disable_shared_glyph_cache();
+    return ret;
 }
 
 /***********************************************************************
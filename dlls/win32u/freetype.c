@@ -1292,16 +1292,333 @@ static void unix_face_destroy( struct unix_face *This )
     free( This );
 }
 
+/****************************************
+ *   Face cache
+ *
+ * Parsing the names and properties of every installed font file is most of
+ * the font initialization time, and it used to be repeated by every process.
+ * The first process of a session records the results of its scans and
+ * publishes them in a named section, which later processes map read-only
+ * and look up by file name and face index. Entries are checked against the
+ * size, modification and status change times of the file, so updated fonts
+ * are parsed again.
+ */
+
+#define FACE_CACHE_MAGIC         0x32434657  /* 'WFC2' */
+#define FACE_CACHE_BUCKET_COUNT  1021
+
+struct face_cache_header
+{
+    LONG      magic;          /* set last, once the cache is complete */
+    UINT      size;
+    LCID      lcid;           /* the face names depend on the system locale */
+    UINT      count;
+    UINT      buckets[FACE_CACHE_BUCKET_COUNT];
+};
+
+struct face_cache_entry
+{
+    UINT      next;           /* offset of the next entry in the same bucket */
+    UINT      size;
+    UINT      hash;
+    UINT      face_index;
+    UINT      allow_bitmap;
+    UINT      num_faces;      /* 0 if the face couldn't be loaded */
+    ULONGLONG file_size;
+    LONGLONG  file_mtime;     /* in nanoseconds */
+    LONGLONG  file_ctime;
+    BOOL      scalable;
+    DWORD     ntm_flags;
+    DWORD     font_version;
+    FONTSIGNATURE fs;
+    struct bitmap_font_size bitmap_size;
+    USHORT    name_lens[4];   /* family, second, style and full names, in WCHARs, 0 if not present */
+    USHORT    unix_name_len;
+    /* WCHAR  names[]; */
+    /* char   unix_name[]; */
+};
+
+static const struct face_cache_header *face_cache;
+static char *face_cache_records;  /* entries recorded for publishing */
+static SIZE_T face_cache_records_size, face_cache_records_capacity;
+static BOOL face_cache_recording;
+
+static const WCHAR face_cache_nameW[] =
+    {'\\','B','a','s','e','N','a','m','e','d','O','b','j','e','c','t','s',
+     '\\','_','_','w','i','n','e','_','f','o','n','t','_','f','a','c','e','_','c','a','c','h','e'};
+
+static UINT face_cache_hash( const char *unix_name, UINT face_index )
+{
+    UINT hash = 2166136261u;
+
+    while (*unix_name) hash = (hash ^ (unsigned char)*unix_name++) * 16777619;
+    return (hash ^ face_index) * 16777619;
+}
+
+static const WCHAR *face_cache_entry_names( const struct face_cache_entry *entry )
+{
+    return (const WCHAR *)(entry + 1);
+}
+
+static const char *face_cache_entry_unix_name( const struct face_cache_entry *entry )
+{
+    const WCHAR *names = face_cache_entry_names( entry );
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(entry->name_lens); i++) names += entry->name_lens[i];
+    return (const char *)names;
+}
+
+static void open_face_cache(void)
+{
+    OBJECT_ATTRIBUTES attr;
+    UNICODE_STRING name;
+    SIZE_T size = 0;
+    HANDLE handle;
+    void *ptr = NULL;
+
+    name.Buffer = (WCHAR *)face_cache_nameW;
+    name.Length = name.MaximumLength = sizeof(face_cache_nameW);
+    InitializeObjectAttributes( &attr, &name, 0, 0, NULL );
+
+    if (NtOpenSection( &handle, SECTION_MAP_READ | SECTION_QUERY, &attr ))
+    {
+        face_cache_recording = TRUE;
+        return;
+    }
+    if (!NtMapViewOfSection( handle, GetCurrentProcess(), &ptr, 0, 0, NULL, &size, ViewShare, 0, PAGE_READONLY ))
+    {
+        const struct face_cache_header *header = ptr;
+
+        /* the section handle is kept open so that the cache outlives this process */
+        if (size >= sizeof(*header) && ReadAcquire( &header->magic ) == FACE_CACHE_MAGIC &&
+            header->size <= size && header->lcid == system_lcid)
+        {
+            TRACE( "using face cache with %u entries\n", header->count );
+            face_cache = header;
+            return;
+        }
+        NtUnmapViewOfSection( GetCurrentProcess(), ptr );
+    }
+    NtClose( handle );
+}
+
+static void get_face_cache_file_times( const struct stat *st, LONGLONG *mtime, LONGLONG *ctime )
+{
+    /* a font replaced in place within the same second must not match */
+    *mtime = (LONGLONG)st->st_mtime * 1000000000;
+    *ctime = (LONGLONG)st->st_ctime * 1000000000;
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    *mtime += st->st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    *mtime += st->st_mtimespec.tv_nsec;
+#endif
+#ifdef HAVE_STRUCT_STAT_ST_CTIM
+    *ctime += st->st_ctim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_CTIMESPEC)
+    *ctime += st->st_ctimespec.tv_nsec;
+#endif
+}
+
+static const struct face_cache_entry *find_cached_face( const char *unix_name, UINT face_index, UINT flags,
+                                                       const struct stat *st )
+{
+    const struct face_cache_entry *entry;
+    LONGLONG mtime, ctime;
+    UINT hash, offset;
+
+    if (!face_cache) return NULL;
+
+    get_face_cache_file_times( st, &mtime, &ctime );
+    hash = face_cache_hash( unix_name, face_index );
+    for (offset = face_cache->buckets[hash % FACE_CACHE_BUCKET_COUNT]; offset; offset = entry->next)
+    {
+        if (offset > face_cache->size - sizeof(*entry)) break;
+        entry = (const struct face_cache_entry *)((const char *)face_cache + offset);
+        if (entry->hash != hash || entry->face_index != face_index) continue;
+        if (entry->allow_bitmap != !!(flags & ADDFONT_ALLOW_BITMAP)) continue;
+        if (strcmp( face_cache_entry_unix_name( entry ), unix_name )) continue;
+        if (entry->file_size != st->st_size || entry->file_mtime != mtime || entry->file_ctime != ctime)
+            return NULL;
+        return entry;
+    }
+    return NULL;
+}
+
+static void record_face( const char *unix_name, UINT face_index, UINT flags, const struct stat *st,
+                         const struct unix_face *face )
+{
+    const WCHAR *names[4] = {NULL};
+    struct face_cache_entry *entry;
+    SIZE_T size, unix_name_len;
+    unsigned int i;
+    WCHAR *ptr;
+    char *records;
+
+    if (!face_cache_recording) return;
+
+    unix_name_len = strlen( unix_name ) + 1;
+    if (unix_name_len > USHRT_MAX) return;
+    if (face)
+    {
+        names[0] = face->family_name;
+        names[1] = face->second_name;
+        names[2] = face->style_name;
+        names[3] = face->full_name;
+    }
+
+    size = sizeof(*entry) + unix_name_len;
+    for (i = 0; i < ARRAY_SIZE(names); i++)
+    {
+        if (names[i]) size += (lstrlenW( names[i] ) + 1) * sizeof(WCHAR);
+    }
+    size = (size + 7) & ~7;
+
+    if (face_cache_records_size + size > face_cache_records_capacity)
+    {
+        SIZE_T capacity = max( face_cache_records_capacity * 2, face_cache_records_size + size );
+        capacity = max( capacity, 64 * 1024 );
+        if (!(records = realloc( face_cache_records, capacity ))) return;
+        face_cache_records = records;
+        face_cache_records_capacity = capacity;
+    }
+
+    entry = (struct face_cache_entry *)(face_cache_records + face_cache_records_size);
+    memset( entry, 0, size );
+    entry->size = size;
+    entry->hash = face_cache_hash( unix_name, face_index );
+    entry->face_index = face_index;
+    entry->allow_bitmap = !!(flags & ADDFONT_ALLOW_BITMAP);
+    entry->file_size = st->st_size;
+    get_face_cache_file_times( st, &entry->file_mtime, &entry->file_ctime );
+    if (face)
+    {
+        entry->num_faces = face->num_faces;
+        entry->scalable = face->scalable;
+        entry->ntm_flags = face->ntm_flags;
+        entry->font_version = face->font_version;
+        entry->fs = face->fs;
+        entry->bitmap_size = face->size;
+    }
+
+    ptr = (WCHAR *)(entry + 1);
+    for (i = 0; i < ARRAY_SIZE(names); i++)
+    {
+        if (!names[i]) continue;
+        entry->name_lens[i] = lstrlenW( names[i] ) + 1;
+        memcpy( ptr, names[i], entry->name_lens[i] * sizeof(WCHAR) );
+        ptr += entry->name_lens[i];
+    }
+    entry->unix_name_len = unix_name_len;
+    memcpy( ptr, unix_name, unix_name_len );
+
+    face_cache_records_size += size;
+}
+
+static int add_cached_face( const struct face_cache_entry *entry, const WCHAR *file, DWORD face_index,
+                            DWORD flags, DWORD *num_faces )
+{
+    const WCHAR *names[4], *ptr = face_cache_entry_names( entry );
+    unsigned int i;
+    int ret;
+
+    if (!entry->num_faces) return 0;
+
+    for (i = 0; i < ARRAY_SIZE(names); i++)
+    {
+        names[i] = entry->name_lens[i] ? ptr : NULL;
+        ptr += entry->name_lens[i];
+    }
+
+    if (names[0] && names[0][0] == '.') return 0;
+
+    if (!HIWORD( flags )) flags |= ADDFONT_AA_FLAGS( default_aa_flags );
+
+    ret = add_gdi_face( names[0], names[1], names[2], names[3], file, NULL, 0, face_index, entry->fs,
+                        entry->ntm_flags, entry->font_version, flags,
+                        entry->scalable ? NULL : &entry->bitmap_size );
+
+    if (num_faces) *num_faces = entry->num_faces;
+    return ret;
+}
+
+/*************************************************************
+ * freetype_publish_face_cache
+ *
+ * Publish the faces scanned by this process if no cache was found at startup.
+ */
+static void freetype_publish_face_cache(void)
+{
+    struct face_cache_header *header;
+    struct face_cache_entry *entry;
+    OBJECT_ATTRIBUTES attr;
+    UNICODE_STRING name;
+    LARGE_INTEGER section_size;
+    SIZE_T size = 0, offset;
+    HANDLE handle;
+    void *ptr = NULL;
+    UINT bucket;
+
+    if (!face_cache_recording) return;
+    face_cache_recording = FALSE;
+    if (!face_cache_records_size) goto done;
+
+    name.Buffer = (WCHAR *)face_cache_nameW;
+    name.Length = name.MaximumLength = sizeof(face_cache_nameW);
+    InitializeObjectAttributes( &attr, &name, 0, 0, NULL );
+    section_size.QuadPart = sizeof(*header) + face_cache_records_size;
+
+    /* if another process created the cache in the meantime, leave it alone */
+    if (NtCreateSection( &handle, SECTION_ALL_ACCESS, &attr, &section_size, PAGE_READWRITE, SEC_COMMIT, 0 ))
+        goto done;
+    if (NtMapViewOfSection( handle, GetCurrentProcess(), &ptr, 0, 0, NULL, &size, ViewShare, 0, PAGE_READWRITE ))
+    {
+        NtClose( handle );
+        goto done;
+    }
+
+    header = ptr;
+    header->size = section_size.QuadPart;
+    header->lcid = system_lcid;
+    memcpy( header + 1, face_cache_records, face_cache_records_size );
+
+    for (offset = sizeof(*header); offset < header->size; offset += entry->size)
+    {
+        entry = (struct face_cache_entry *)((char *)header + offset);
+        bucket = entry->hash % FACE_CACHE_BUCKET_COUNT;
+        entry->next = header->buckets[bucket];
+        header->buckets[bucket] = offset;
+        header->count++;
+    }
+    TRACE( "published face cache with %u entries\n", header->count );
+
+    WriteRelease( &header->magic, FACE_CACHE_MAGIC );
+    face_cache = header;
+
+done:
+    free( face_cache_records );
+    face_cache_records = NULL;
+    face_cache_records_size = face_cache_records_capacity = 0;
+}
+
 static int add_unix_face( const char *unix_name, const WCHAR *file, void *data_ptr, SIZE_T data_size,
                           DWORD face_index, DWORD flags, DWORD *num_faces )
 {
+    const struct face_cache_entry *cached;
     struct unix_face *unix_face;
+    struct stat st;
+    BOOL have_stat;
     int ret;
 
     if (num_faces) *num_faces = 0;
 
-    if (!(unix_face = unix_face_create( unix_name, data_ptr, data_size, face_index, flags )))
-        return 0;
+    have_stat = unix_name && !stat( unix_name, &st );
+    if (have_stat && (cached = find_cached_face( unix_name, face_index, flags, &st )))
+        return add_cached_face( cached, file, face_index, flags, num_faces );
+
+    unix_face = unix_face_create( unix_name, data_ptr, data_size, face_index, flags );
+    if (have_stat) record_face( unix_name, face_index, flags, &st, unix_face );
+    if (!unix_face) return 0;
 
     if (unix_face->family_name[0] == '.') /* Ignore fonts with names beginning with a dot */
     {
@@ -4232,6 +4549,7 @@ static const struct font_backend_funcs font_funcs =
     fontconfig_enum_family_fallbacks,
     freetype_add_font,
     freetype_add_mem_font,
+    freetype_publish_face_cache,
     freetype_load_font,
     freetype_get_font_data,
     freetype_get_aa_flags,
@@ -4253,6 +4571,7 @@ const struct font_backend_funcs *init_freetype_lib(void)
     init_fontconfig();
 #endif
     NtQueryDefaultLocale( FALSE, &system_lcid );
+    open_face_cache();
     return &font_funcs;
 }
 
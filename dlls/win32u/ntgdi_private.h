@@ -221,6 +221,10 @@ extern UINT set_dib_dc_color_table( HDC hdc, UINT startpos, UINT entries,
 extern void dibdrv_set_window_surface( DC *dc, struct window_surface *surface ) DECLSPEC_HIDDEN;
 extern struct opengl_funcs *dibdrv_get_wgl_driver(void) DECLSPEC_HIDDEN;
 
+/* dibdrv/graphics.c */
+extern void init_shared_glyph_cache(void) DECLSPEC_HIDDEN;
+extern void disable_shared_glyph_cache(void) DECLSPEC_HIDDEN;
+
 /* driver.c */
 extern const struct gdi_dc_funcs null_driver DECLSPEC_HIDDEN;
 extern const struct gdi_dc_funcs dib_driver DECLSPEC_HIDDEN;
@@ -319,6 +323,7 @@ struct font_backend_funcs
     BOOL  (*enum_family_fallbacks)( UINT pitch_and_family, int index, WCHAR buffer[LF_FACESIZE] );
     INT   (*add_font)( const WCHAR *file, UINT flags );
     INT   (*add_mem_font)( void *ptr, SIZE_T size, UINT flags );
+    void  (*publish_face_cache)(void);
 
     BOOL  (*load_font)( struct gdi_font *gdi_font );
     UINT  (*get_font_data)( struct gdi_font *gdi_font, UINT table, UINT offset, void *buf, UINT count );
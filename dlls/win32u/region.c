@@ -99,6 +99,10 @@ SOFTWARE.
 #endif
 
 #include <assert.h>
+#include <pthread.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "ntgdi_private.h"
 #include "ntuser_private.h"
 #include "wine/debug.h"
@@ -122,6 +126,65 @@ static inline BOOL overlapping( const RECT *r1, const RECT *r2 )
             r1->bottom > r2->top && r1->top < r2->bottom);
 }
 
+/*
+ * Rectangle arrays of recently destroyed regions are kept in a small pool, since
+ * every region operation builds its result in a fresh array and releases the
+ * array of the destination region it replaces.
+ */
+#define RECT_POOL_SIZE       8
+#define RECT_POOL_MAX_RECTS  4096
+
+static struct
+{
+    RECT *rects;
+    INT   size;
+} rect_pool[RECT_POOL_SIZE];
+static unsigned int rect_pool_count;
+static pthread_mutex_t rect_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* allocate an array of at least *size rectangles, returning its real size in *size */
+static RECT *alloc_rects( INT *size )
+{
+    unsigned int i, best = RECT_POOL_SIZE;
+    RECT *rects = NULL;
+
+    if (*size <= RECT_POOL_MAX_RECTS)
+    {
+        pthread_mutex_lock( &rect_pool_lock );
+        for (i = 0; i < rect_pool_count; i++)
+        {
+            if (rect_pool[i].size < *size) continue;
+            if (best == RECT_POOL_SIZE || rect_pool[i].size < rect_pool[best].size) best = i;
+        }
+        if (best != RECT_POOL_SIZE)
+        {
+            rects = rect_pool[best].rects;
+            *size = rect_pool[best].size;
+            rect_pool[best] = rect_pool[--rect_pool_count];
+        }
+        pthread_mutex_unlock( &rect_pool_lock );
+        if (rects) return rects;
+    }
+    return malloc( *size * sizeof(RECT) );
+}
+
+static void free_rects( RECT *rects, INT size )
+{
+    if (rects && size <= RECT_POOL_MAX_RECTS)
+    {
+        pthread_mutex_lock( &rect_pool_lock );
+        if (rect_pool_count < RECT_POOL_SIZE)
+        {
+            rect_pool[rect_pool_count].rects = rects;
+            rect_pool[rect_pool_count].size = size;
+            rect_pool_count++;
+            rects = NULL;
+        }
+        pthread_mutex_unlock( &rect_pool_lock );
+    }
+    free( rects );
+}
+
 static BOOL grow_region( WINEREGION *rgn, int size )
 {
     RECT *new_rects;
@@ -130,7 +193,7 @@ static BOOL grow_region( WINEREGION *rgn, int size )
 
     if (rgn->rects == rgn->rects_buf)
     {
-        new_rects = malloc( size * sizeof(RECT) );
+        new_rects = alloc_rects( &size );
         if (!new_rects) return FALSE;
         memcpy( new_rects, rgn->rects, rgn->numRects * sizeof(RECT) );
     }
@@ -164,6 +227,29 @@ static inline void empty_region( WINEREGION *reg )
     reg->extents.left = reg->extents.top = reg->extents.right = reg->extents.bottom = 0;
 }
 
+/* check whether two bands of count rectangles span the same horizontal ranges */
+static inline BOOL bands_match( const RECT *band1, const RECT *band2, int count )
+{
+#ifdef __SSE2__
+    const __m128i mask = _mm_set_epi32( 0, -1, 0, -1 );  /* left and right */
+    const __m128i zero = _mm_setzero_si128();
+    __m128i diff;
+
+    for (; count >= 2; count -= 2, band1 += 2, band2 += 2)
+    {
+        diff = _mm_or_si128( _mm_xor_si128( _mm_loadu_si128( (const __m128i *)band1 ),
+                                            _mm_loadu_si128( (const __m128i *)band2 ) ),
+                             _mm_xor_si128( _mm_loadu_si128( (const __m128i *)(band1 + 1) ),
+                                            _mm_loadu_si128( (const __m128i *)(band2 + 1) ) ) );
+        diff = _mm_and_si128( diff, mask );
+        if (_mm_movemask_epi8( _mm_cmpeq_epi32( diff, zero ) ) != 0xffff) return FALSE;
+    }
+#endif
+    for (; count; count--, band1++, band2++)
+        if (band1->left != band2->left || band1->right != band2->right) return FALSE;
+    return TRUE;
+}
+
 static inline BOOL is_in_rect( const RECT *rect, int x, int y )
 {
     return (rect->right > x && rect->left <= x && rect->bottom > y && rect->top <= y);
@@ -408,7 +494,7 @@ static BOOL init_region( WINEREGION *pReg, INT n )
     if (n > RGN_DEFAULT_RECTS)
     {
         if (n > INT_MAX / sizeof(RECT)) return FALSE;
-        if (!(pReg->rects = malloc( n * sizeof( RECT ) )))
+        if (!(pReg->rects = alloc_rects( &n )))
             return FALSE;
     }
     else
@@ -425,7 +511,7 @@ static BOOL init_region( WINEREGION *pReg, INT n )
 static void destroy_region( WINEREGION *pReg )
 {
     if (pReg->rects != pReg->rects_buf)
-        free( pReg->rects );
+        free_rects( pReg->rects, pReg->size );
 }
 
 /***********************************************************************
@@ -1459,24 +1545,15 @@ static INT REGION_Coalesce (
 	     * cover the most area possible. I.e. two rects in a band must
 	     * have some horizontal space between them.
 	     */
-	    do
+	    if (!bands_match( pPrevRect, pCurRect, curNumRects ))
 	    {
-		if ((pPrevRect->left != pCurRect->left) ||
-		    (pPrevRect->right != pCurRect->right))
-		{
-		    /*
-		     * The bands don't line up so they can't be coalesced.
-		     */
-		    return (curStart);
-		}
-		pPrevRect++;
-		pCurRect++;
-		prevNumRects -= 1;
-	    } while (prevNumRects != 0);
+		/*
+		 * The bands don't line up so they can't be coalesced.
+		 */
+		return (curStart);
+	    }
 
 	    pReg->numRects -= curNumRects;
-	    pCurRect -= curNumRects;
-	    pPrevRect -= curNumRects;
 
 	    /*
 	     * The bands may be merged, so set the bottom of each rect
@@ -1848,6 +1925,53 @@ static BOOL REGION_IntersectO(WINEREGION *pReg,  RECT *r1, RECT *r1End,
     return TRUE;
 }
 
+/***********************************************************************
+ *	     REGION_ClipRegion
+ *
+ * Intersect a region with a single rectangle. This is the common case of
+ * clipping a visible region to a window or paint rectangle, and only needs
+ * one pass over the bands of the region instead of a full REGION_RegionOp.
+ * The result is identical to that of REGION_IntersectO.
+ */
+static BOOL REGION_ClipRegion( WINEREGION *dst, WINEREGION *src, const RECT *rect )
+{
+    WINEREGION newReg;
+    RECT *r = src->rects, *rEnd = src->rects + src->numRects, *bandEnd;
+    INT prevBand = 0, curBand, left, right, top, bottom;
+    RECT clip = *rect;
+
+    if (clip.left <= src->extents.left && clip.right >= src->extents.right &&
+        clip.top <= src->extents.top && clip.bottom >= src->extents.bottom)
+        return REGION_CopyRegion( dst, src );
+
+    if (!init_region( &newReg, src->numRects )) return FALSE;
+
+    while (r != rEnd && r->bottom <= clip.top) r++;
+    while (r != rEnd && r->top < clip.bottom)
+    {
+        top = max( r->top, clip.top );
+        bottom = min( r->bottom, clip.bottom );
+        curBand = newReg.numRects;
+        for (bandEnd = r; bandEnd != rEnd && bandEnd->top == r->top; bandEnd++)
+        {
+            left = max( bandEnd->left, clip.left );
+            right = min( bandEnd->right, clip.right );
+            if (left < right && !add_rect( &newReg, left, top, right, bottom ))
+            {
+                destroy_region( &newReg );
+                return FALSE;
+            }
+        }
+        if (newReg.numRects != curBand)
+            prevBand = REGION_Coalesce( &newReg, prevBand, curBand );
+        r = bandEnd;
+    }
+
+    REGION_compact( &newReg );
+    move_rects( dst, &newReg );
+    return TRUE;
+}
+
 /***********************************************************************
  *	     REGION_IntersectRegion
  */
@@ -1858,6 +1982,14 @@ static BOOL REGION_IntersectRegion(WINEREGION *newReg, WINEREGION *reg1,
     if ( (!(reg1->numRects)) || (!(reg2->numRects))  ||
 	(!overlapping(&reg1->extents, &reg2->extents)))
 	newReg->numRects = 0;
+    else if (reg2->numRects == 1)
+    {
+	if (!REGION_ClipRegion( newReg, reg1, &reg2->extents )) return FALSE;
+    }
+    else if (reg1->numRects == 1)
+    {
+	if (!REGION_ClipRegion( newReg, reg2, &reg1->extents )) return FALSE;
+    }
     else
 	if (!REGION_RegionOp (newReg, reg1, reg2, REGION_IntersectO, NULL, NULL)) return FALSE;
 
@@ -1960,6 +2092,32 @@ static BOOL REGION_UnionO (WINEREGION *pReg, RECT *r1, RECT *r1End,
 #undef MERGERECT
 }
 
+/***********************************************************************
+ *	     REGION_AppendRegion
+ *
+ *      Union of two regions where all of the upper region lies above the
+ *      lower one. The bands of both regions can be copied as they are; only
+ *      the last band of the upper region and the first band of the lower
+ *      one may need coalescing.
+ */
+static BOOL REGION_AppendRegion( WINEREGION *newReg, WINEREGION *upper, WINEREGION *lower )
+{
+    WINEREGION reg;
+    INT prevBand = upper->numRects - 1;
+
+    if (!init_region( &reg, upper->numRects + lower->numRects )) return FALSE;
+
+    memcpy( reg.rects, upper->rects, upper->numRects * sizeof(RECT) );
+    memcpy( reg.rects + upper->numRects, lower->rects, lower->numRects * sizeof(RECT) );
+    reg.numRects = upper->numRects + lower->numRects;
+
+    while (prevBand > 0 && reg.rects[prevBand - 1].top == reg.rects[prevBand].top) prevBand--;
+    REGION_Coalesce( &reg, prevBand, upper->numRects );
+
+    move_rects( newReg, &reg );
+    return TRUE;
+}
+
 /***********************************************************************
  *	     REGION_UnionRegion
  */
@@ -2017,7 +2175,18 @@ static BOOL REGION_UnionRegion(WINEREGION *newReg, WINEREGION *reg1, WINEREGION
 	return ret;
     }
 
-    if ((ret = REGION_RegionOp (newReg, reg1, reg2, REGION_UnionO, REGION_UnionNonO, REGION_UnionNonO)))
+    /*
+     * The regions don't share any band, e.g. when a region is built from
+     * rectangles in top to bottom order
+     */
+    if (reg1->extents.bottom <= reg2->extents.top)
+        ret = REGION_AppendRegion( newReg, reg1, reg2 );
+    else if (reg2->extents.bottom <= reg1->extents.top)
+        ret = REGION_AppendRegion( newReg, reg2, reg1 );
+    else
+        ret = REGION_RegionOp (newReg, reg1, reg2, REGION_UnionO, REGION_UnionNonO, REGION_UnionNonO);
+
+    if (ret)
     {
         newReg->extents.left = min(reg1->extents.left, reg2->extents.left);
         newReg->extents.top = min(reg1->extents.top, reg2->extents.top);
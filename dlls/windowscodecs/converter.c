@@ -31,6 +31,10 @@
 #include "wine/heap.h"
 #include "wine/debug.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
 struct FormatConverter;
@@ -77,6 +81,7 @@ typedef struct FormatConverter {
     LONG ref;
     IWICBitmapSource *source;
     const struct pixelformatinfo *dst_format, *src_format;
+    const struct pixelformat_conversion *conversion; /* direct conversion, if any */
     WICBitmapDitherType dither;
     double alpha_threshold;
     IWICPalette *palette;
@@ -132,6 +137,514 @@ static void to_sRGB(BYTE *bgr)
 }
 #endif
 
+/* Direct conversions
+ *
+ * The common format pairs are converted one row at a time straight from the
+ * source format, without going through an intermediate 32bppBGRA buffer.
+ * Conversions that keep the pixel size work in place in the caller's buffer,
+ * the others read the source in bands through a bounded temporary buffer.
+ * Large frames are split in tiles of rows converted on the thread pool. */
+
+#define CONVERT_BAND_SIZE (256 * 1024)
+#define CONVERT_THREAD_BAND_SIZE (4 * 1024 * 1024)
+#define CONVERT_THREAD_PIXELS (1024 * 1024)
+#define CONVERT_MAX_THREADS 8
+
+typedef void (*convert_row_func)(const BYTE *src, BYTE *dst, UINT width);
+
+struct pixelformat_conversion {
+    enum pixelformat src_format, dst_format;
+    UINT src_bpp, dst_bpp;
+    convert_row_func convert_row;
+};
+
+/* Converting to 8bppGray goes through to_sRGB_component() for every pixel.
+ * The table holds the result for each 1/4096 wide range of linear values,
+ * or -1 if the result changes within the range. */
+#define SRGB_TABLE_BITS 12
+
+static short srgb_table[(1 << SRGB_TABLE_BITS) + 1];
+static UINT unpremultiply_table[256];
+static INIT_ONCE conversion_tables_once = INIT_ONCE_STATIC_INIT;
+
+static inline BYTE linear_to_srgb_byte(float f)
+{
+    return (BYTE)floorf(to_sRGB_component(f) * 255.0f + 0.51f);
+}
+
+static BOOL WINAPI init_conversion_tables(INIT_ONCE *once, void *param, void **context)
+{
+    UINT i;
+
+    for (i = 0; i < 1 << SRGB_TABLE_BITS; i++)
+    {
+        float start = (float)i / (1 << SRGB_TABLE_BITS);
+        float end = nextafterf((float)(i + 1) / (1 << SRGB_TABLE_BITS), 0.0f);
+        BYTE value = linear_to_srgb_byte(start);
+
+        srgb_table[i] = value == linear_to_srgb_byte(end) ? value : -1;
+    }
+    srgb_table[i] = linear_to_srgb_byte(1.0f);
+
+    /* x * 255 / alpha == (x * 255 * unpremultiply_table[alpha]) >> 24 for all x < 256 */
+    for (i = 1; i < 256; i++)
+        unpremultiply_table[i] = ((1 << 24) + i - 1) / i;
+
+    return TRUE;
+}
+
+static inline BYTE lookup_srgb_byte(float f)
+{
+    if (f >= 0.0f && f <= 1.0f)
+    {
+        short value = srgb_table[(UINT)(f * (1 << SRGB_TABLE_BITS))];
+        if (value >= 0) return value;
+    }
+    return linear_to_srgb_byte(f);
+}
+
+static inline BYTE rgb_to_gray(BYTE r, BYTE g, BYTE b)
+{
+    return lookup_srgb_byte((r * 0.2126f + g * 0.7152f + b * 0.0722f) / 255.0f);
+}
+
+static void convert_24_to_32(const BYTE *src, BYTE *dst, UINT width)
+{
+    DWORD *dstpixel = (DWORD *)dst, in[3];
+    UINT x;
+
+    /* four pixels from three dwords */
+    for (x = 0; x + 4 <= width; x += 4, src += 12)
+    {
+        memcpy(in, src, sizeof(in));
+        *dstpixel++ = 0xff000000 | in[0];
+        *dstpixel++ = 0xff000000 | in[0] >> 24 | in[1] << 8;
+        *dstpixel++ = 0xff000000 | in[1] >> 16 | in[2] << 16;
+        *dstpixel++ = 0xff000000 | in[2] >> 8;
+    }
+    for (; x < width; x++, src += 3)
+        *dstpixel++ = 0xff000000 | src[2] << 16 | src[1] << 8 | src[0];
+}
+
+static void convert_24_to_32_swap(const BYTE *src, BYTE *dst, UINT width)
+{
+    DWORD *dstpixel = (DWORD *)dst;
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 3)
+        *dstpixel++ = 0xff000000 | src[0] << 16 | src[1] << 8 | src[2];
+}
+
+static void convert_32_to_24(const BYTE *src, BYTE *dst, UINT width)
+{
+    const DWORD *srcpixel = (const DWORD *)src;
+    DWORD out[3];
+    UINT x;
+
+    /* four pixels to three dwords */
+    for (x = 0; x + 4 <= width; x += 4, srcpixel += 4, dst += 12)
+    {
+        out[0] = (srcpixel[0] & 0xffffff) | srcpixel[1] << 24;
+        out[1] = (srcpixel[1] >> 8 & 0xffff) | srcpixel[2] << 16;
+        out[2] = (srcpixel[2] >> 16 & 0xff) | srcpixel[3] << 8;
+        memcpy(dst, out, sizeof(out));
+    }
+    for (src = (const BYTE *)srcpixel; x < width; x++, src += 4)
+    {
+        *dst++ = src[0];
+        *dst++ = src[1];
+        *dst++ = src[2];
+    }
+}
+
+static void convert_32_to_24_swap(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4)
+    {
+        *dst++ = src[2];
+        *dst++ = src[1];
+        *dst++ = src[0];
+    }
+}
+
+static void convert_32_set_alpha(const BYTE *src, BYTE *dst, UINT width)
+{
+    const DWORD *srcpixel = (const DWORD *)src;
+    DWORD *dstpixel = (DWORD *)dst;
+    UINT x = 0;
+
+#ifdef __SSE2__
+    const __m128i alpha = _mm_set1_epi32(0xff000000);
+
+    for (; x + 4 <= width; x += 4)
+        _mm_storeu_si128((__m128i *)(dstpixel + x),
+                _mm_or_si128(_mm_loadu_si128((const __m128i *)(srcpixel + x)), alpha));
+#endif
+    for (; x < width; x++)
+        dstpixel[x] = srcpixel[x] | 0xff000000;
+}
+
+static void convert_32_swap(const BYTE *src, BYTE *dst, UINT width)
+{
+    const DWORD *srcpixel = (const DWORD *)src;
+    DWORD *dstpixel = (DWORD *)dst;
+    UINT x = 0;
+
+#ifdef __SSE2__
+    const __m128i mask = _mm_set1_epi32(0x00ff00ff);
+
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(srcpixel + x));
+        __m128i rb = _mm_and_si128(v, mask);
+
+        rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+        _mm_storeu_si128((__m128i *)(dstpixel + x), _mm_or_si128(_mm_andnot_si128(mask, v), rb));
+    }
+#endif
+    for (; x < width; x++)
+    {
+        DWORD v = srcpixel[x];
+        dstpixel[x] = (v & 0xff00ff00) | (v & 0xff) << 16 | (v >> 16 & 0xff);
+    }
+}
+
+static void convert_32_premultiply(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x = 0, alpha, t;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128(), round = _mm_set1_epi16(127), one = _mm_set1_epi16(1);
+    const __m128i color_mask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    const __m128i alpha_one = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+
+    /* (c * alpha + 127) / 255, computed as (t + 1 + (t >> 8)) >> 8, with
+     * the alpha channel itself multiplied by 255 to keep it unchanged */
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + 4 * x)), lo, hi, a;
+
+        lo = _mm_unpacklo_epi8(v, zero);
+        a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xff), 0xff);
+        lo = _mm_add_epi16(_mm_mullo_epi16(lo, _mm_or_si128(_mm_and_si128(a, color_mask), alpha_one)), round);
+        lo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(lo, one), _mm_srli_epi16(lo, 8)), 8);
+
+        hi = _mm_unpackhi_epi8(v, zero);
+        a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xff), 0xff);
+        hi = _mm_add_epi16(_mm_mullo_epi16(hi, _mm_or_si128(_mm_and_si128(a, color_mask), alpha_one)), round);
+        hi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(hi, one), _mm_srli_epi16(hi, 8)), 8);
+
+        _mm_storeu_si128((__m128i *)(dst + 4 * x), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (src += 4 * x, dst += 4 * x; x < width; x++, src += 4, dst += 4)
+    {
+        alpha = src[3];
+        t = src[0] * alpha + 127;
+        dst[0] = (t + 1 + (t >> 8)) >> 8;
+        t = src[1] * alpha + 127;
+        dst[1] = (t + 1 + (t >> 8)) >> 8;
+        t = src[2] * alpha + 127;
+        dst[2] = (t + 1 + (t >> 8)) >> 8;
+        dst[3] = alpha;
+    }
+}
+
+static void convert_32_unpremultiply(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x, alpha, scale;
+
+    for (x = 0; x < width; x++, src += 4, dst += 4)
+    {
+        alpha = src[3];
+        if (alpha != 0 && alpha != 255)
+        {
+            scale = unpremultiply_table[alpha];
+            dst[0] = (UINT64)(src[0] * 255) * scale >> 24;
+            dst[1] = (UINT64)(src[1] * 255) * scale >> 24;
+            dst[2] = (UINT64)(src[2] * 255) * scale >> 24;
+        }
+        else
+        {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
+        dst[3] = alpha;
+    }
+}
+
+static void convert_gray_to_24(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++)
+    {
+        *dst++ = src[x];
+        *dst++ = src[x];
+        *dst++ = src[x];
+    }
+}
+
+static void convert_gray_to_32(const BYTE *src, BYTE *dst, UINT width)
+{
+    DWORD *dstpixel = (DWORD *)dst;
+    UINT x = 0;
+
+#ifdef __SSE2__
+    const __m128i alpha = _mm_set1_epi8(0xff);
+
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i gray = _mm_loadu_si128((const __m128i *)(src + x));
+        __m128i gg = _mm_unpacklo_epi8(gray, gray), ga = _mm_unpacklo_epi8(gray, alpha);
+
+        _mm_storeu_si128((__m128i *)(dstpixel + x), _mm_unpacklo_epi16(gg, ga));
+        _mm_storeu_si128((__m128i *)(dstpixel + x + 4), _mm_unpackhi_epi16(gg, ga));
+        gg = _mm_unpackhi_epi8(gray, gray);
+        ga = _mm_unpackhi_epi8(gray, alpha);
+        _mm_storeu_si128((__m128i *)(dstpixel + x + 8), _mm_unpacklo_epi16(gg, ga));
+        _mm_storeu_si128((__m128i *)(dstpixel + x + 12), _mm_unpackhi_epi16(gg, ga));
+    }
+#endif
+    for (; x < width; x++)
+        dstpixel[x] = 0xff000000 | src[x] * 0x010101;
+}
+
+static void convert_bgr24_to_gray(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 3)
+        dst[x] = rgb_to_gray(src[2], src[1], src[0]);
+}
+
+static void convert_rgb24_to_gray(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 3)
+        dst[x] = rgb_to_gray(src[0], src[1], src[2]);
+}
+
+static void convert_bgr32_to_gray(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4)
+        dst[x] = rgb_to_gray(src[2], src[1], src[0]);
+}
+
+static void convert_rgb32_to_gray(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4)
+        dst[x] = rgb_to_gray(src[0], src[1], src[2]);
+}
+
+static void convert_grayfloat_to_gray(const BYTE *src, BYTE *dst, UINT width)
+{
+    const float *srcpixel = (const float *)src;
+    UINT x;
+
+    for (x = 0; x < width; x++)
+        dst[x] = lookup_srgb_byte(srcpixel[x]);
+}
+
+static void convert_grayfloat_to_24(const BYTE *src, BYTE *dst, UINT width)
+{
+    const float *srcpixel = (const float *)src;
+    UINT x;
+
+    for (x = 0; x < width; x++)
+    {
+        BYTE gray = lookup_srgb_byte(srcpixel[x]);
+        *dst++ = gray;
+        *dst++ = gray;
+        *dst++ = gray;
+    }
+}
+
+static const struct pixelformat_conversion conversions[] = {
+    {format_8bppGray, format_24bppBGR, 8, 24, convert_gray_to_24},
+    {format_8bppGray, format_24bppRGB, 8, 24, convert_gray_to_24},
+    {format_8bppGray, format_32bppBGR, 8, 32, convert_gray_to_32},
+    {format_8bppGray, format_32bppBGRA, 8, 32, convert_gray_to_32},
+    {format_8bppGray, format_32bppPBGRA, 8, 32, convert_gray_to_32},
+    {format_8bppGray, format_32bppRGB, 8, 32, convert_gray_to_32},
+    {format_8bppGray, format_32bppRGBA, 8, 32, convert_gray_to_32},
+    {format_8bppGray, format_32bppPRGBA, 8, 32, convert_gray_to_32},
+    {format_24bppBGR, format_8bppGray, 24, 8, convert_bgr24_to_gray},
+    {format_24bppBGR, format_32bppBGR, 24, 32, convert_24_to_32},
+    {format_24bppBGR, format_32bppBGRA, 24, 32, convert_24_to_32},
+    {format_24bppBGR, format_32bppPBGRA, 24, 32, convert_24_to_32},
+    {format_24bppBGR, format_32bppRGB, 24, 32, convert_24_to_32_swap},
+    {format_24bppBGR, format_32bppRGBA, 24, 32, convert_24_to_32_swap},
+    {format_24bppBGR, format_32bppPRGBA, 24, 32, convert_24_to_32_swap},
+    {format_24bppRGB, format_8bppGray, 24, 8, convert_rgb24_to_gray},
+    {format_24bppRGB, format_32bppBGR, 24, 32, convert_24_to_32_swap},
+    {format_24bppRGB, format_32bppBGRA, 24, 32, convert_24_to_32_swap},
+    {format_24bppRGB, format_32bppPBGRA, 24, 32, convert_24_to_32_swap},
+    {format_24bppRGB, format_32bppRGB, 24, 32, convert_24_to_32},
+    {format_24bppRGB, format_32bppRGBA, 24, 32, convert_24_to_32},
+    {format_24bppRGB, format_32bppPRGBA, 24, 32, convert_24_to_32},
+    {format_32bppGrayFloat, format_8bppGray, 32, 8, convert_grayfloat_to_gray},
+    {format_32bppGrayFloat, format_24bppBGR, 32, 24, convert_grayfloat_to_24},
+    {format_32bppBGR, format_8bppGray, 32, 8, convert_bgr32_to_gray},
+    {format_32bppBGR, format_24bppBGR, 32, 24, convert_32_to_24},
+    {format_32bppBGR, format_24bppRGB, 32, 24, convert_32_to_24_swap},
+    {format_32bppBGR, format_32bppBGRA, 32, 32, convert_32_set_alpha},
+    {format_32bppBGR, format_32bppPBGRA, 32, 32, convert_32_set_alpha},
+    {format_32bppRGB, format_32bppRGBA, 32, 32, convert_32_set_alpha},
+    {format_32bppRGB, format_32bppPRGBA, 32, 32, convert_32_set_alpha},
+    {format_32bppBGRA, format_8bppGray, 32, 8, convert_bgr32_to_gray},
+    {format_32bppBGRA, format_24bppBGR, 32, 24, convert_32_to_24},
+    {format_32bppBGRA, format_24bppRGB, 32, 24, convert_32_to_24_swap},
+    {format_32bppBGRA, format_32bppRGB, 32, 32, convert_32_swap},
+    {format_32bppBGRA, format_32bppRGBA, 32, 32, convert_32_swap},
+    {format_32bppBGRA, format_32bppPBGRA, 32, 32, convert_32_premultiply},
+    {format_32bppRGBA, format_8bppGray, 32, 8, convert_rgb32_to_gray},
+    {format_32bppRGBA, format_24bppBGR, 32, 24, convert_32_to_24_swap},
+    {format_32bppRGBA, format_32bppBGR, 32, 32, convert_32_swap},
+    {format_32bppRGBA, format_32bppBGRA, 32, 32, convert_32_swap},
+    {format_32bppRGBA, format_32bppPRGBA, 32, 32, convert_32_premultiply},
+    {format_32bppPBGRA, format_8bppGray, 32, 8, convert_bgr32_to_gray},
+    {format_32bppPBGRA, format_24bppBGR, 32, 24, convert_32_to_24},
+    {format_32bppPBGRA, format_24bppRGB, 32, 24, convert_32_to_24_swap},
+    {format_32bppPBGRA, format_32bppBGRA, 32, 32, convert_32_unpremultiply},
+    {format_32bppPRGBA, format_32bppRGBA, 32, 32, convert_32_unpremultiply},
+};
+
+static const struct pixelformat_conversion *get_conversion(enum pixelformat src, enum pixelformat dst)
+{
+    UINT i;
+
+    for (i = 0; i < ARRAY_SIZE(conversions); i++)
+        if (conversions[i].src_format == src && conversions[i].dst_format == dst) return &conversions[i];
+
+    return NULL;
+}
+
+struct convert_context {
+    convert_row_func convert_row;
+    const BYTE *src;
+    BYTE *dst;
+    UINT src_stride, dst_stride;
+    UINT width, rows, tile_rows;
+    LONG next_tile;
+};
+
+static void convert_tiles(struct convert_context *ctx)
+{
+    UINT tiles = (ctx->rows + ctx->tile_rows - 1) / ctx->tile_rows, tile, y, end;
+
+    while ((tile = InterlockedIncrement(&ctx->next_tile) - 1) < tiles)
+    {
+        end = min((tile + 1) * ctx->tile_rows, ctx->rows);
+        for (y = tile * ctx->tile_rows; y < end; y++)
+            ctx->convert_row(ctx->src + y * ctx->src_stride, ctx->dst + y * ctx->dst_stride, ctx->width);
+    }
+}
+
+static void CALLBACK convert_work_callback(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work)
+{
+    convert_tiles(context);
+}
+
+static void convert_rows(struct convert_context *ctx, TP_WORK *work, UINT threads)
+{
+    UINT i;
+
+    ctx->next_tile = 0;
+    if (!work)
+    {
+        ctx->tile_rows = ctx->rows;
+        convert_tiles(ctx);
+        return;
+    }
+
+    ctx->tile_rows = (ctx->rows + threads * 4 - 1) / (threads * 4);
+    for (i = 1; i < threads; i++) SubmitThreadpoolWork(work);
+    convert_tiles(ctx);
+    WaitForThreadpoolWorkCallbacks(work, FALSE);
+}
+
+static HRESULT copypixels_direct(struct FormatConverter *This, const WICRect *prc,
+    UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
+{
+    const struct pixelformat_conversion *conversion = This->conversion;
+    struct convert_context ctx;
+    UINT threads = 1, band_size = CONVERT_BAND_SIZE, band_rows, y;
+    TP_WORK *work = NULL;
+    BYTE *srcdata = NULL;
+    SYSTEM_INFO info;
+    WICRect rc;
+    HRESULT hr;
+
+    InitOnceExecuteOnce(&conversion_tables_once, init_conversion_tables, NULL, NULL);
+
+    ctx.convert_row = conversion->convert_row;
+    ctx.width = prc->Width;
+    ctx.src_stride = prc->Width * conversion->src_bpp / 8;
+    ctx.dst_stride = cbStride;
+
+    if (cbStride < prc->Width * conversion->dst_bpp / 8 ||
+        cbStride * (prc->Height - 1) + prc->Width * conversion->dst_bpp / 8 > cbBufferSize)
+        return E_INVALIDARG;
+
+    if ((UINT64)prc->Width * prc->Height >= CONVERT_THREAD_PIXELS)
+    {
+        GetSystemInfo(&info);
+        threads = min(info.dwNumberOfProcessors, CONVERT_MAX_THREADS);
+        if (threads > 1 && (work = CreateThreadpoolWork(convert_work_callback, &ctx, NULL)))
+            band_size = CONVERT_THREAD_BAND_SIZE;
+    }
+
+    if (conversion->src_bpp == conversion->dst_bpp)
+    {
+        hr = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+        if (SUCCEEDED(hr))
+        {
+            ctx.src = ctx.dst = pbBuffer;
+            ctx.src_stride = cbStride;
+            ctx.rows = prc->Height;
+            convert_rows(&ctx, work, threads);
+        }
+        goto done;
+    }
+
+    band_rows = max(1, min((UINT)prc->Height, band_size / ctx.src_stride));
+    if (!(srcdata = HeapAlloc(GetProcessHeap(), 0, band_rows * ctx.src_stride)))
+    {
+        hr = E_OUTOFMEMORY;
+        goto done;
+    }
+
+    rc.X = prc->X;
+    rc.Width = prc->Width;
+    for (y = 0, hr = S_OK; y < (UINT)prc->Height && SUCCEEDED(hr); y += band_rows)
+    {
+        rc.Y = prc->Y + y;
+        rc.Height = min(band_rows, (UINT)prc->Height - y);
+        hr = IWICBitmapSource_CopyPixels(This->source, &rc, ctx.src_stride, ctx.src_stride * rc.Height, srcdata);
+        if (SUCCEEDED(hr))
+        {
+            ctx.src = srcdata;
+            ctx.dst = pbBuffer + y * cbStride;
+            ctx.rows = rc.Height;
+            convert_rows(&ctx, work, threads);
+        }
+    }
+
+done:
+    if (work) CloseThreadpoolWork(work);
+    HeapFree(GetProcessHeap(), 0, srcdata);
+    return hr;
+}
+
 static inline FormatConverter *impl_from_IWICFormatConverter(IWICFormatConverter *iface)
 {
     return CONTAINING_RECORD(iface, FormatConverter, IWICFormatConverter_iface);
@@ -1666,6 +2179,9 @@ static HRESULT WINAPI FormatConverter_CopyPixels(IWICFormatConverter *iface,
             prc = &rc;
         }
 
+        if (This->conversion && prc->Width > 0 && prc->Height > 0)
+            return copypixels_direct(This, prc, cbStride, cbBufferSize, pbBuffer);
+
         return This->dst_format->copy_function(This, prc, cbStride, cbBufferSize,
             pbBuffer, This->src_format->format);
     }
@@ -1758,6 +2274,7 @@ static HRESULT WINAPI FormatConverter_Initialize(IWICFormatConverter *iface,
         IWICBitmapSource_AddRef(source);
         This->src_format = srcinfo;
         This->dst_format = dstinfo;
+        This->conversion = get_conversion(srcinfo->format, dstinfo->format);
         This->dither = dither;
         This->alpha_threshold = alpha_threshold;
         This->palette = palette;
@@ -1844,6 +2361,7 @@ HRESULT FormatConverter_CreateInstance(REFIID iid, void** ppv)
     This->ref = 1;
     This->source = NULL;
     This->palette = NULL;
+    This->conversion = NULL;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": FormatConverter.lock");
 
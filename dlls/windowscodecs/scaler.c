@@ -18,6 +18,7 @@
  */
 
 #include <stdarg.h>
+#include <math.h>
 
 #define COBJMACROS
 
@@ -29,8 +30,26 @@
 
 #include "wine/debug.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
+/* The filtered modes work on formats with 8 bits per channel, using
+ * separable fixed point filters. Weights have FILTER_BITS fractional bits,
+ * horizontally filtered rows are kept as 16-bit values with ROW_BITS
+ * fractional bits so that the vertical pass fits in 32-bit sums. */
+#define FILTER_BITS 14
+#define ROW_BITS 6
+
+struct scaler_filter
+{
+    UINT taps;      /* number of source pixels weighted for each destination pixel */
+    UINT *start;    /* first source pixel for each destination pixel */
+    SHORT *weights; /* taps weights for each destination pixel */
+};
+
 typedef struct BitmapScaler {
     IWICBitmapScaler IWICBitmapScaler_iface;
     LONG ref;
@@ -42,6 +61,12 @@ typedef struct BitmapScaler {
     UINT bpp;
     void (*fn_get_required_source_rect)(struct BitmapScaler*,UINT,UINT,WICRect*);
     void (*fn_copy_scanline)(struct BitmapScaler*,UINT,UINT,UINT,BYTE**,UINT,UINT,BYTE*);
+    struct scaler_filter filter_x, filter_y; /* filter_y.taps is 0 for nearest neighbor */
+    SHORT *rows;            /* ring of filter_y.taps horizontally filtered source rows */
+    UINT *row_index;        /* source row held by each ring entry, or ~0u */
+    UINT row_x, row_width;  /* destination span the ring entries were filtered for */
+    const SHORT **window;   /* ring entries used for the current destination row */
+    BYTE *src_bits;         /* source rows fetched from the source bitmap */
     CRITICAL_SECTION lock; /* must be held when initialized */
 } BitmapScaler;
 
@@ -55,6 +80,24 @@ static inline BitmapScaler *impl_from_IMILBitmapScaler(IMILBitmapScaler *iface)
     return CONTAINING_RECORD(iface, BitmapScaler, IMILBitmapScaler_iface);
 }
 
+static void free_filters(BitmapScaler *This)
+{
+    HeapFree(GetProcessHeap(), 0, This->filter_x.start);
+    HeapFree(GetProcessHeap(), 0, This->filter_x.weights);
+    HeapFree(GetProcessHeap(), 0, This->filter_y.start);
+    HeapFree(GetProcessHeap(), 0, This->filter_y.weights);
+    HeapFree(GetProcessHeap(), 0, This->rows);
+    HeapFree(GetProcessHeap(), 0, This->row_index);
+    HeapFree(GetProcessHeap(), 0, This->window);
+    HeapFree(GetProcessHeap(), 0, This->src_bits);
+    memset(&This->filter_x, 0, sizeof(This->filter_x));
+    memset(&This->filter_y, 0, sizeof(This->filter_y));
+    This->rows = NULL;
+    This->row_index = NULL;
+    This->window = NULL;
+    This->src_bits = NULL;
+}
+
 static HRESULT WINAPI BitmapScaler_QueryInterface(IWICBitmapScaler *iface, REFIID iid,
     void **ppv)
 {
@@ -106,6 +149,7 @@ static ULONG WINAPI BitmapScaler_Release(IWICBitmapScaler *iface)
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
         if (This->source) IWICBitmapSource_Release(This->source);
+        free_filters(This);
         HeapFree(GetProcessHeap(), 0, This);
     }
 
@@ -203,6 +247,334 @@ static void NearestNeighbor_CopyScanline(BitmapScaler *This,
     }
 }
 
+static double filter_linear(double x)
+{
+    x = fabs(x);
+    return x < 1.0 ? 1.0 - x : 0.0;
+}
+
+/* Catmull-Rom spline */
+static double filter_cubic(double x)
+{
+    x = fabs(x);
+    if (x < 1.0) return (1.5 * x - 2.5) * x * x + 1.0;
+    if (x < 2.0) return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+    return 0.0;
+}
+
+/* Returns the source pixels with a non-zero weight for destination pixel i. */
+static void get_filter_span(UINT i, double scale, double radius, BOOL box, INT *first, INT *last)
+{
+    double center;
+
+    if (box)
+    {
+        *first = floor(i * scale);
+        *last = ceil((i + 1) * scale) - 1;
+    }
+    else
+    {
+        center = (i + 0.5) * scale - 0.5;
+        *first = floor(center - radius) + 1;
+        *last = ceil(center + radius) - 1;
+    }
+}
+
+static HRESULT init_filter(struct scaler_filter *filter, UINT src_size, UINT dst_size,
+    WICBitmapInterpolationMode mode)
+{
+    double scale = (double)src_size / dst_size, radius = 0.0, width = 1.0;
+    double (*kernel)(double) = NULL;
+    INT first, last;
+    UINT i, j, taps = 1;
+    double *w;
+
+    /* Linear and Cubic sample the source around each destination pixel,
+     * HighQualityCubic widens the kernel when shrinking so that every source
+     * pixel contributes, and Fant averages the covered source area. */
+    switch (mode)
+    {
+    case WICBitmapInterpolationModeLinear:
+        kernel = filter_linear;
+        radius = 1.0;
+        break;
+    case WICBitmapInterpolationModeHighQualityCubic:
+        if (scale > 1.0) width = scale;
+        /* fall-through */
+    case WICBitmapInterpolationModeCubic:
+        kernel = filter_cubic;
+        radius = 2.0 * width;
+        break;
+    default:
+        break;
+    }
+
+    for (i = 0; i < dst_size; i++)
+    {
+        get_filter_span(i, scale, radius, !kernel, &first, &last);
+        taps = max(taps, last - first + 1);
+    }
+    taps = min(taps, src_size);
+
+    filter->taps = taps;
+    filter->start = HeapAlloc(GetProcessHeap(), 0, dst_size * sizeof(*filter->start));
+    filter->weights = HeapAlloc(GetProcessHeap(), 0, dst_size * taps * sizeof(*filter->weights));
+    w = HeapAlloc(GetProcessHeap(), 0, taps * sizeof(*w));
+    if (!filter->start || !filter->weights || !w)
+    {
+        HeapFree(GetProcessHeap(), 0, w);
+        return E_OUTOFMEMORY;
+    }
+
+    for (i = 0; i < dst_size; i++)
+    {
+        SHORT *weights = filter->weights + i * taps;
+        double center = (i + 0.5) * scale - 0.5, sum = 0.0;
+        INT start, index, total = 0;
+        UINT peak = 0;
+
+        get_filter_span(i, scale, radius, !kernel, &first, &last);
+        start = min(max(first, 0), (INT)(src_size - taps));
+        memset(w, 0, taps * sizeof(*w));
+
+        /* pixels outside of the source repeat its edges */
+        for (index = first; index <= last; index++)
+        {
+            INT pos = min(max(index, 0), (INT)src_size - 1) - start;
+            double weight;
+
+            if (kernel) weight = kernel((index - center) / width);
+            else weight = min((i + 1) * scale, index + 1) - max(i * scale, index);
+
+            w[min(pos, (INT)taps - 1)] += weight;
+            sum += weight;
+        }
+
+        for (j = 0; j < taps; j++)
+        {
+            weights[j] = floor(w[j] * (1 << FILTER_BITS) / sum + 0.5);
+            total += weights[j];
+            if (abs(weights[j]) > abs(weights[peak])) peak = j;
+        }
+        weights[peak] += (1 << FILTER_BITS) - total;
+        filter->start[i] = start;
+    }
+
+    HeapFree(GetProcessHeap(), 0, w);
+    return S_OK;
+}
+
+static HRESULT init_filters(BitmapScaler *This)
+{
+    UINT channels = This->bpp / 8, i;
+    HRESULT hr;
+
+    hr = init_filter(&This->filter_x, This->src_width, This->width, This->mode);
+    if (SUCCEEDED(hr))
+        hr = init_filter(&This->filter_y, This->src_height, This->height, This->mode);
+    if (FAILED(hr)) return hr;
+
+    This->rows = HeapAlloc(GetProcessHeap(), 0,
+        This->filter_y.taps * This->width * channels * sizeof(*This->rows));
+    This->row_index = HeapAlloc(GetProcessHeap(), 0, This->filter_y.taps * sizeof(*This->row_index));
+    This->window = HeapAlloc(GetProcessHeap(), 0, This->filter_y.taps * sizeof(*This->window));
+    This->src_bits = HeapAlloc(GetProcessHeap(), 0, This->filter_y.taps * This->src_width * channels);
+    if (!This->rows || !This->row_index || !This->window || !This->src_bits)
+        return E_OUTOFMEMORY;
+
+    for (i = 0; i < This->filter_y.taps; i++) This->row_index[i] = ~0u;
+    This->row_x = This->row_width = 0;
+    return S_OK;
+}
+
+static BOOL is_filter_format(const WICPixelFormatGUID *format)
+{
+    static const WICPixelFormatGUID *formats[] =
+    {
+        &GUID_WICPixelFormat8bppGray,
+        &GUID_WICPixelFormat24bppBGR,
+        &GUID_WICPixelFormat24bppRGB,
+        &GUID_WICPixelFormat32bppBGR,
+        &GUID_WICPixelFormat32bppBGRA,
+        &GUID_WICPixelFormat32bppPBGRA,
+        &GUID_WICPixelFormat32bppRGB,
+        &GUID_WICPixelFormat32bppRGBA,
+        &GUID_WICPixelFormat32bppPRGBA,
+    };
+    UINT i;
+
+    for (i = 0; i < ARRAY_SIZE(formats); i++)
+        if (IsEqualGUID(format, formats[i])) return TRUE;
+    return FALSE;
+}
+
+/* Horizontal pass: filters one source row into 16-bit values. */
+static void filter_row(const BitmapScaler *This, const BYTE *src, UINT src_x,
+    UINT dst_x, UINT dst_width, SHORT *row)
+{
+    const struct scaler_filter *filter = &This->filter_x;
+    UINT channels = This->bpp / 8, taps = filter->taps, i, j, c;
+
+#ifdef __SSE2__
+    if (channels == 4)
+    {
+        const __m128i zero = _mm_setzero_si128(), round = _mm_set1_epi32(1 << (FILTER_BITS - ROW_BITS - 1));
+
+        for (i = 0; i < dst_width; i++, row += 4)
+        {
+            const SHORT *weights = filter->weights + (dst_x + i) * taps;
+            const BYTE *p = src + (filter->start[dst_x + i] - src_x) * 4;
+            __m128i sum = round, px;
+
+            /* two source pixels at a time, channels interleaved for madd */
+            for (j = 0; j + 1 < taps; j += 2, p += 8)
+            {
+                px = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)p), zero);
+                px = _mm_unpacklo_epi16(px, _mm_srli_si128(px, 8));
+                sum = _mm_add_epi32(sum, _mm_madd_epi16(px,
+                    _mm_set1_epi32(((UINT)(USHORT)weights[j + 1] << 16) | (USHORT)weights[j])));
+            }
+            if (j < taps)
+            {
+                px = _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(const int *)p), zero);
+                px = _mm_unpacklo_epi16(px, zero);
+                sum = _mm_add_epi32(sum, _mm_madd_epi16(px, _mm_set1_epi32((USHORT)weights[j])));
+            }
+            sum = _mm_srai_epi32(sum, FILTER_BITS - ROW_BITS);
+            _mm_storel_epi64((__m128i *)row, _mm_packs_epi32(sum, sum));
+        }
+        return;
+    }
+#endif
+
+    for (i = 0; i < dst_width; i++)
+    {
+        const SHORT *weights = filter->weights + (dst_x + i) * taps;
+        const BYTE *p = src + (filter->start[dst_x + i] - src_x) * channels;
+        int sum[4] = {0};
+
+        for (j = 0; j < taps; j++, p += channels)
+            for (c = 0; c < channels; c++)
+                sum[c] += p[c] * weights[j];
+
+        for (c = 0; c < channels; c++)
+            *row++ = (sum[c] + (1 << (FILTER_BITS - ROW_BITS - 1))) >> (FILTER_BITS - ROW_BITS);
+    }
+}
+
+/* Vertical pass: combines the rows in This->window into one destination row. */
+static void filter_column(const BitmapScaler *This, UINT dst_y, UINT count, BYTE *dst)
+{
+    const struct scaler_filter *filter = &This->filter_y;
+    const SHORT *weights = filter->weights + dst_y * filter->taps;
+    const SHORT **rows = This->window;
+    UINT taps = filter->taps, i = 0, j;
+    int sum;
+
+#ifdef __SSE2__
+    {
+        const __m128i zero = _mm_setzero_si128(), round = _mm_set1_epi32(1 << (FILTER_BITS + ROW_BITS - 1));
+
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i lo = round, hi = round, a, b, w;
+
+            for (j = 0; j + 1 < taps; j += 2)
+            {
+                a = _mm_loadu_si128((const __m128i *)(rows[j] + i));
+                b = _mm_loadu_si128((const __m128i *)(rows[j + 1] + i));
+                w = _mm_set1_epi32(((UINT)(USHORT)weights[j + 1] << 16) | (USHORT)weights[j]);
+                lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+                hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+            }
+            if (j < taps)
+            {
+                a = _mm_loadu_si128((const __m128i *)(rows[j] + i));
+                w = _mm_set1_epi32((USHORT)weights[j]);
+                lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, zero), w));
+                hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, zero), w));
+            }
+            lo = _mm_srai_epi32(lo, FILTER_BITS + ROW_BITS);
+            hi = _mm_srai_epi32(hi, FILTER_BITS + ROW_BITS);
+            _mm_storel_epi64((__m128i *)(dst + i), _mm_packus_epi16(_mm_packs_epi32(lo, hi), zero));
+        }
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        sum = 1 << (FILTER_BITS + ROW_BITS - 1);
+        for (j = 0; j < taps; j++)
+            sum += rows[j][i] * weights[j];
+        sum >>= FILTER_BITS + ROW_BITS;
+        dst[i] = min(max(sum, 0), 255);
+    }
+}
+
+/* Produces the destination rows one at a time, keeping a window of
+ * horizontally filtered source rows between rows and calls, so the source is
+ * read in bands and each source row is only requested once when the caller
+ * goes from top to bottom. */
+static HRESULT filter_copy_pixels(BitmapScaler *This, const WICRect *dest_rect,
+    UINT stride, BYTE *buffer)
+{
+    const struct scaler_filter *filter_x = &This->filter_x, *filter_y = &This->filter_y;
+    UINT channels = This->bpp / 8, row_size = dest_rect->Width * channels;
+    UINT src_x, src_stride, y, i, j, count;
+    WICRect rect;
+    HRESULT hr;
+
+    if (!dest_rect->Width || !dest_rect->Height) return S_OK;
+
+    src_x = filter_x->start[dest_rect->X];
+    src_stride = (filter_x->start[dest_rect->X + dest_rect->Width - 1] + filter_x->taps - src_x) * channels;
+
+    if (This->row_x != dest_rect->X || This->row_width != dest_rect->Width)
+    {
+        for (i = 0; i < filter_y->taps; i++) This->row_index[i] = ~0u;
+        This->row_x = dest_rect->X;
+        This->row_width = dest_rect->Width;
+    }
+
+    for (y = 0; y < dest_rect->Height; y++)
+    {
+        UINT dst_y = dest_rect->Y + y, start = filter_y->start[dst_y];
+
+        for (j = 0; j < filter_y->taps; j += count)
+        {
+            count = 1;
+            if (This->row_index[(start + j) % filter_y->taps] == start + j) continue;
+
+            while (j + count < filter_y->taps &&
+                   This->row_index[(start + j + count) % filter_y->taps] != start + j + count)
+                count++;
+
+            rect.X = src_x;
+            rect.Y = start + j;
+            rect.Width = src_stride / channels;
+            rect.Height = count;
+            hr = IWICBitmapSource_CopyPixels(This->source, &rect, src_stride, src_stride * count, This->src_bits);
+            if (FAILED(hr)) return hr;
+
+            for (i = 0; i < count; i++)
+            {
+                UINT slot = (start + j + i) % filter_y->taps;
+
+                filter_row(This, This->src_bits + i * src_stride, src_x, dest_rect->X, dest_rect->Width,
+                    This->rows + slot * This->width * channels);
+                This->row_index[slot] = start + j + i;
+            }
+        }
+
+        for (j = 0; j < filter_y->taps; j++)
+            This->window[j] = This->rows + ((start + j) % filter_y->taps) * This->width * channels;
+
+        filter_column(This, dst_y, row_size, buffer + stride * y);
+    }
+
+    return S_OK;
+}
+
 static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
@@ -257,6 +629,12 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
         goto end;
     }
 
+    if (This->filter_y.taps)
+    {
+        hr = filter_copy_pixels(This, &dest_rect, cbStride, pbBuffer);
+        goto end;
+    }
+
     /* MSDN recommends calling CopyPixels once for each scanline from top to
      * bottom, and claims codecs optimize for this. Ideally, when called in this
      * way, we should avoid requesting a scanline from the source more than
@@ -347,25 +725,46 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
         hr = get_pixelformat_bpp(&src_pixelformat, &This->bpp);
     }
 
+    if (SUCCEEDED(hr))
+    {
+        if ((This->bpp % 8) == 0)
+        {
+            IWICBitmapSource_AddRef(pISource);
+            This->source = pISource;
+        }
+        else
+        {
+            hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
+                pISource, &This->source);
+            src_pixelformat = GUID_WICPixelFormat32bppBGRA;
+            This->bpp = 32;
+        }
+    }
+
     if (SUCCEEDED(hr))
     {
         switch (mode)
         {
+        case WICBitmapInterpolationModeLinear:
+        case WICBitmapInterpolationModeCubic:
+        case WICBitmapInterpolationModeFant:
+        case WICBitmapInterpolationModeHighQualityCubic:
+            if (is_filter_format(&src_pixelformat))
+            {
+                hr = init_filters(This);
+                if (FAILED(hr))
+                {
+                    free_filters(This);
+                    IWICBitmapSource_Release(This->source);
+                    This->source = NULL;
+                }
+                break;
+            }
+            /* fall-through */
         default:
-            FIXME("unsupported mode %i\n", mode);
+            FIXME("unsupported mode %i for format %s\n", mode, debugstr_guid(&src_pixelformat));
             /* fall-through */
         case WICBitmapInterpolationModeNearestNeighbor:
-            if ((This->bpp % 8) == 0)
-            {
-                IWICBitmapSource_AddRef(pISource);
-                This->source = pISource;
-            }
-            else
-            {
-                hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
-                    pISource, &This->source);
-                This->bpp = 32;
-            }
             This->fn_get_required_source_rect = NearestNeighbor_GetRequiredSourceRect;
             This->fn_copy_scanline = NearestNeighbor_CopyScanline;
             break;
@@ -527,6 +926,12 @@ HRESULT BitmapScaler_Create(IWICBitmapScaler **scaler)
     This->src_height = 0;
     This->mode = 0;
     This->bpp = 0;
+    memset(&This->filter_x, 0, sizeof(This->filter_x));
+    memset(&This->filter_y, 0, sizeof(This->filter_y));
+    This->rows = NULL;
+    This->row_index = NULL;
+    This->window = NULL;
+    This->src_bits = NULL;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": BitmapScaler.lock");
 
@@ -19,6 +19,7 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <assert.h>
 #include <math.h>
 
@@ -1315,6 +1316,101 @@ static void test_bitmap_scaler(void)
     IWICBitmap_Release(bitmap);
 }
 
+static void test_bitmap_scaler_modes(void)
+{
+    static const WICBitmapInterpolationMode modes[] =
+    {
+        WICBitmapInterpolationModeLinear,
+        WICBitmapInterpolationModeCubic,
+        WICBitmapInterpolationModeFant,
+        WICBitmapInterpolationModeHighQualityCubic,
+    };
+    static const BYTE gray[] = { 0, 200 };
+    static const BYTE edge[] = { 0, 0, 0, 0, 0, 0, 0, 255 };
+    IWICBitmapScaler *scaler;
+    IWICBitmap *bitmap;
+    BYTE bits[4 * 4 * 4], buf[7 * 3 * 4];
+    unsigned int i, j;
+    HRESULT hr;
+
+    for (i = 0; i < sizeof(bits); i += 4)
+    {
+        bits[i] = 0x10;
+        bits[i + 1] = 0x80;
+        bits[i + 2] = 0xf0;
+        bits[i + 3] = 0xff;
+    }
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 4, 4, &GUID_WICPixelFormat32bppBGRA,
+        16, sizeof(bits), bits, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#lx.\n", hr);
+
+    for (i = 0; i < ARRAY_SIZE(modes); i++)
+    {
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "Failed to create bitmap scaler, hr %#lx.\n", hr);
+
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 7, 3, modes[i]);
+        ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#lx.\n", hr);
+
+        memset(buf, 0, sizeof(buf));
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 7 * 4, sizeof(buf), buf);
+        ok(hr == S_OK, "Failed to copy pixels, hr %#lx.\n", hr);
+        for (j = 0; j < sizeof(buf); j += 4)
+        {
+            ok(buf[j] == 0x10 && buf[j + 1] == 0x80 && buf[j + 2] == 0xf0 && buf[j + 3] == 0xff,
+                "mode %u: unexpected pixel %u: %02x %02x %02x %02x.\n", modes[i], j / 4,
+                buf[j], buf[j + 1], buf[j + 2], buf[j + 3]);
+        }
+
+        IWICBitmapScaler_Release(scaler);
+    }
+
+    IWICBitmap_Release(bitmap);
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 2, 1, &GUID_WICPixelFormat8bppGray,
+        2, sizeof(gray), (BYTE *)gray, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#lx.\n", hr);
+
+    for (i = 0; i < ARRAY_SIZE(modes); i++)
+    {
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "Failed to create bitmap scaler, hr %#lx.\n", hr);
+
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 1, 1, modes[i]);
+        ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#lx.\n", hr);
+
+        buf[0] = 0;
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 1, 1, buf);
+        ok(hr == S_OK, "Failed to copy pixels, hr %#lx.\n", hr);
+        ok(abs(buf[0] - 100) <= 1, "mode %u: unexpected pixel %u.\n", modes[i], buf[0]);
+
+        IWICBitmapScaler_Release(scaler);
+    }
+
+    IWICBitmap_Release(bitmap);
+
+    /* HighQualityCubic widens its kernel when shrinking, so the last pixel contributes. */
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 8, 1, &GUID_WICPixelFormat8bppGray,
+        8, sizeof(edge), (BYTE *)edge, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#lx.\n", hr);
+
+    hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+    ok(hr == S_OK, "Failed to create bitmap scaler, hr %#lx.\n", hr);
+
+    hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 1, 1,
+        WICBitmapInterpolationModeHighQualityCubic);
+    ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#lx.\n", hr);
+
+    buf[0] = 0;
+    hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 1, 1, buf);
+    ok(hr == S_OK, "Failed to copy pixels, hr %#lx.\n", hr);
+    ok(buf[0] > 0 && buf[0] < 255, "Unexpected pixel %u.\n", buf[0]);
+
+    IWICBitmapScaler_Release(scaler);
+    IWICBitmap_Release(bitmap);
+}
+
 static LONG obj_refcount(void *obj)
 {
     IUnknown_AddRef((IUnknown *)obj);
@@ -1485,6 +1581,7 @@ START_TEST(bitmap)
     test_CreateBitmapFromHBITMAP();
     test_clipper();
     test_bitmap_scaler();
+    test_bitmap_scaler_modes();
 
     IWICImagingFactory_Release(factory);
 
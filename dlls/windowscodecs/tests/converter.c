@@ -1795,6 +1795,125 @@ static const struct setting png_interlace_settings[] = {
     {NULL}
 };
 
+static void test_converter_large(void)
+{
+    static const UINT width = 601, height = 407;
+    IWICBitmapSource *converted;
+    IWICBitmap *bitmap;
+    BYTE *bits, *buf, *src, *dst;
+    UINT x, y, stride = width * 4, mismatches = 0;
+    WICRect rc;
+    HRESULT hr;
+
+    bits = HeapAlloc(GetProcessHeap(), 0, stride * height);
+    buf = HeapAlloc(GetProcessHeap(), 0, stride * height);
+
+    for (y = 0; y < height; y++)
+        for (x = 0; x < stride; x++)
+            bits[y * stride + x] = x * 7 + y * 13;
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, width, height, &GUID_WICPixelFormat32bppBGRA,
+            stride, stride * height, bits, &bitmap);
+    ok(hr == S_OK, "CreateBitmapFromMemory error %#lx\n", hr);
+
+    /* same pixel size, converted directly in the output buffer */
+    hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppPBGRA, (IWICBitmapSource *)bitmap, &converted);
+    ok(hr == S_OK, "WICConvertBitmapSource error %#lx\n", hr);
+    hr = IWICBitmapSource_CopyPixels(converted, NULL, stride, stride * height, buf);
+    ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+    for (x = 0; x < stride * height; x++)
+    {
+        BYTE alpha = bits[x | 3];
+        BYTE expect = (x & 3) == 3 ? alpha : (bits[x] * alpha + 127) / 255;
+        if (abs(buf[x] - expect) > ((x & 3) == 3 ? 0 : 1)) mismatches++;
+    }
+    ok(!mismatches, "got %u mismatches\n", mismatches);
+    IWICBitmapSource_Release(converted);
+
+    /* converted through a temporary buffer, with a sub rectangle */
+    hr = WICConvertBitmapSource(&GUID_WICPixelFormat24bppBGR, (IWICBitmapSource *)bitmap, &converted);
+    ok(hr == S_OK, "WICConvertBitmapSource error %#lx\n", hr);
+    rc.X = 3;
+    rc.Y = 5;
+    rc.Width = width - 7;
+    rc.Height = height - 9;
+    hr = IWICBitmapSource_CopyPixels(converted, &rc, width * 3, width * 3 * rc.Height, buf);
+    ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+    mismatches = 0;
+    for (y = 0; y < rc.Height; y++)
+    {
+        src = bits + (rc.Y + y) * stride + rc.X * 4;
+        dst = buf + y * width * 3;
+        for (x = 0; x < rc.Width; x++)
+            if (memcmp(dst + x * 3, src + x * 4, 3)) mismatches++;
+    }
+    ok(!mismatches, "got %u mismatches\n", mismatches);
+    IWICBitmapSource_Release(converted);
+
+    IWICBitmap_Release(bitmap);
+    HeapFree(GetProcessHeap(), 0, buf);
+    HeapFree(GetProcessHeap(), 0, bits);
+}
+
+static void test_converter_threaded(void)
+{
+    static const WICPixelFormatGUID *formats[] = {&GUID_WICPixelFormat32bppPBGRA, &GUID_WICPixelFormat24bppBGR};
+    static const UINT width = 1280, height = 1024, band = 64;
+    IWICBitmapSource *converted;
+    UINT i, x, y, stride, mismatches;
+    BYTE *bits, *buf, *ref;
+    IWICBitmap *bitmap;
+    WICRect rc;
+    HRESULT hr;
+
+    bits = HeapAlloc(GetProcessHeap(), 0, width * 4 * height);
+    buf = HeapAlloc(GetProcessHeap(), 0, width * 4 * height);
+    ref = HeapAlloc(GetProcessHeap(), 0, width * 4 * height);
+
+    for (y = 0; y < height; y++)
+        for (x = 0; x < width * 4; x++)
+            bits[y * width * 4 + x] = x * 7 + y * 13;
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, width, height, &GUID_WICPixelFormat32bppBGRA,
+            width * 4, width * 4 * height, bits, &bitmap);
+    ok(hr == S_OK, "CreateBitmapFromMemory error %#lx\n", hr);
+
+    for (i = 0; i < ARRAY_SIZE(formats); i++)
+    {
+        winetest_push_context("%u", i);
+
+        hr = WICConvertBitmapSource(formats[i], (IWICBitmapSource *)bitmap, &converted);
+        ok(hr == S_OK, "WICConvertBitmapSource error %#lx\n", hr);
+        stride = i ? width * 3 : width * 4;
+
+        /* the whole frame is large enough to be converted on several threads */
+        hr = IWICBitmapSource_CopyPixels(converted, NULL, stride, stride * height, buf);
+        ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+
+        /* small bands are converted on the calling thread only */
+        rc.X = 0;
+        rc.Width = width;
+        rc.Height = band;
+        for (rc.Y = 0; rc.Y < height; rc.Y += band)
+        {
+            hr = IWICBitmapSource_CopyPixels(converted, &rc, stride, stride * band, ref + rc.Y * stride);
+            ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+        }
+
+        for (x = 0, mismatches = 0; x < stride * height; x++)
+            if (buf[x] != ref[x]) mismatches++;
+        ok(!mismatches, "got %u mismatches\n", mismatches);
+
+        IWICBitmapSource_Release(converted);
+        winetest_pop_context();
+    }
+
+    IWICBitmap_Release(bitmap);
+    HeapFree(GetProcessHeap(), 0, ref);
+    HeapFree(GetProcessHeap(), 0, buf);
+    HeapFree(GetProcessHeap(), 0, bits);
+}
+
 static void test_converter_8bppIndexed(void)
 {
     HRESULT hr;
@@ -2060,6 +2179,8 @@ START_TEST(converter)
     test_converter_4bppGray();
     test_converter_8bppGray();
     test_converter_8bppIndexed();
+    test_converter_large();
+    test_converter_threaded();
 
     test_encoder(&testdata_8bppIndexed, &CLSID_WICGifEncoder,
                  &testdata_8bppIndexed, &CLSID_WICGifDecoder, "GIF encoder 8bppIndexed");
@@ -436,6 +436,14 @@ static HRESULT adapter_vk_create_device(struct wined3d *wined3d, const struct wi
 #undef VK_DEVICE_EXT_PFN
 #undef VK_DEVICE_PFN
 
+#define MAP_DEVICE_FUNCTION(core_pfn, ext_pfn) \
+    if (!device_vk->vk_info.vk_ops.core_pfn) \
+        device_vk->vk_info.vk_ops.core_pfn = (void *)VK_CALL(vkGetDeviceProcAddr(vk_device, #ext_pfn));
+    MAP_DEVICE_FUNCTION(vkCreateDescriptorUpdateTemplate, vkCreateDescriptorUpdateTemplateKHR)
+    MAP_DEVICE_FUNCTION(vkDestroyDescriptorUpdateTemplate, vkDestroyDescriptorUpdateTemplateKHR)
+    MAP_DEVICE_FUNCTION(vkUpdateDescriptorSetWithTemplate, vkUpdateDescriptorSetWithTemplateKHR)
+#undef MAP_DEVICE_FUNCTION
+
     if (!wined3d_allocator_init(&device_vk->allocator,
             adapter_vk->memory_properties.memoryTypeCount, &wined3d_allocator_vk_ops))
     {
@@ -444,10 +452,13 @@ static HRESULT adapter_vk_create_device(struct wined3d *wined3d, const struct wi
         goto fail;
     }
 
+    wined3d_device_vk_create_pipeline_cache(device_vk, adapter_vk);
+
     if (FAILED(hr = wined3d_device_init(&device_vk->d, wined3d, adapter->ordinal, device_type, focus_window,
             flags, surface_alignment, levels, level_count, vk_info->supported, device_parent)))
     {
         WARN("Failed to initialize device, hr %#lx.\n", hr);
+        wined3d_device_vk_destroy_pipeline_cache(device_vk);
         wined3d_allocator_cleanup(&device_vk->allocator);
         goto fail;
     }
@@ -470,6 +481,7 @@ static void adapter_vk_destroy_device(struct wined3d_device *device)
     const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
 
     wined3d_device_cleanup(&device_vk->d);
+    wined3d_device_vk_destroy_pipeline_cache(device_vk);
     wined3d_allocator_cleanup(&device_vk->allocator);
 
     wined3d_lock_cleanup(&device_vk->allocator_cs);
@@ -1142,6 +1154,24 @@ void adapter_vk_copy_bo_address(struct wined3d_context *context,
     if (dst_bo && (!(dst_bo->memory_type & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) || (!(map_flags & WINED3D_MAP_DISCARD)
             && dst_bo->command_buffer_id > context_vk->completed_command_buffer_id)))
     {
+        struct wined3d_bo_vk *ring_bo;
+        VkDeviceSize ring_offset;
+
+        /* Small uploads from system memory go through the context's upload
+         * ring instead of a dedicated staging bo. */
+        if (!src_bo && wined3d_context_vk_get_command_buffer(context_vk)
+                && (dst_ptr = wined3d_context_vk_upload_ring_alloc(context_vk, size, &ring_bo, &ring_offset)))
+        {
+            for (i = 0; i < range_count; ++i)
+                memcpy(dst_ptr + ranges[i].offset, src->addr + ranges[i].offset, ranges[i].size);
+
+            staging.buffer_object = &ring_bo->b;
+            staging.addr = (uint8_t *)(uintptr_t)ring_offset;
+            adapter_vk_copy_bo_address(context, dst, &staging, range_count, ranges);
+
+            return;
+        }
+
         if (!(wined3d_context_vk_create_bo(context_vk, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, &staging_bo)))
         {
@@ -1733,7 +1763,8 @@ static void adapter_vk_draw_primitive(struct wined3d_device *device,
     if (!(vk_command_buffer = wined3d_context_vk_apply_draw_state(context_vk,
             state, indirect_vk, parameters->indexed)))
     {
-        ERR("Failed to apply draw state.\n");
+        if (!context_vk->shaders_pending)
+            ERR("Failed to apply draw state.\n");
         context_release(&context_vk->c);
         return;
     }
@@ -1818,7 +1849,8 @@ static void adapter_vk_dispatch_compute(struct wined3d_device *device,
 
     if (!(vk_command_buffer = wined3d_context_vk_apply_compute_state(context_vk, state, indirect_vk)))
     {
-        ERR("Failed to apply compute state.\n");
+        if (!context_vk->shaders_pending)
+            ERR("Failed to apply compute state.\n");
         context_release(&context_vk->c);
         return;
     }
@@ -2390,6 +2422,8 @@ static bool wined3d_adapter_vk_init_device_extensions(struct wined3d_adapter_vk
         {VK_KHR_SHADER_DRAW_PARAMETERS_EXTENSION_NAME,      VK_API_VERSION_1_1, true},
         {VK_KHR_SWAPCHAIN_EXTENSION_NAME,                   ~0u,                true},
         {VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME,            VK_API_VERSION_1_2},
+        {VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME,  VK_API_VERSION_1_3},
+        {VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME,  VK_API_VERSION_1_1},
     };
 
     static const struct
@@ -2402,6 +2436,8 @@ static bool wined3d_adapter_vk_init_device_extensions(struct wined3d_adapter_vk
         {VK_EXT_TRANSFORM_FEEDBACK_EXTENSION_NAME,           WINED3D_VK_EXT_TRANSFORM_FEEDBACK},
         {VK_KHR_SAMPLER_MIRROR_CLAMP_TO_EDGE_EXTENSION_NAME, WINED3D_VK_KHR_SAMPLER_MIRROR_CLAMP_TO_EDGE},
         {VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME,             WINED3D_VK_EXT_HOST_QUERY_RESET},
+        {VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME,   WINED3D_VK_EXT_PIPELINE_CREATION_FEEDBACK},
+        {VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME,   WINED3D_VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE},
     };
 
     if ((vr = VK_CALL(vkEnumerateDeviceExtensionProperties(physical_device, NULL, &count, NULL))) < 0)
@@ -2472,6 +2508,8 @@ static bool wined3d_adapter_vk_init_device_extensions(struct wined3d_adapter_vk
             }
         }
     }
+    if (vk_info->api_version >= VK_API_VERSION_1_1)
+        vk_info->supported[WINED3D_VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE] = TRUE;
 
 done:
     if (success)
@@ -2521,6 +2559,8 @@ static BOOL wined3d_adapter_vk_init(struct wined3d_adapter_vk *adapter_vk,
     else
         VK_CALL(vkGetPhysicalDeviceProperties(adapter_vk->physical_device, &properties2.properties));
     adapter_vk->device_limits = properties2.properties.limits;
+    memcpy(adapter_vk->pipeline_cache_uuid, properties2.properties.pipelineCacheUUID,
+            sizeof(adapter_vk->pipeline_cache_uuid));
 
     VK_CALL(vkGetPhysicalDeviceMemoryProperties(adapter_vk->physical_device, &adapter_vk->memory_properties));
 
@@ -26,6 +26,7 @@
 #include "wined3d_vk.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 
 VkCompareOp vk_compare_op_from_wined3d(enum wined3d_cmp_func op)
 {
@@ -1304,6 +1305,8 @@ static void wined3d_context_vk_destroy_pipeline_layout(struct wine_rb_entry *ent
     vk_info = context_vk->vk_info;
     device_vk = wined3d_device_vk(context_vk->c.device);
 
+    if (layout->vk_update_template)
+        VK_CALL(vkDestroyDescriptorUpdateTemplate(device_vk->vk_device, layout->vk_update_template, NULL));
     VK_CALL(vkDestroyPipelineLayout(device_vk->vk_device, layout->vk_pipeline_layout, NULL));
     VK_CALL(vkDestroyDescriptorSetLayout(device_vk->vk_device, layout->vk_set_layout, NULL));
     heap_free(layout->key.bindings);
@@ -1572,6 +1575,7 @@ static void wined3d_context_vk_destroy_render_pass(struct wine_rb_entry *entry,
 
 static void wined3d_shader_descriptor_writes_vk_cleanup(struct wined3d_shader_descriptor_writes_vk *writes)
 {
+    heap_free(writes->data);
     heap_free(writes->writes);
 }
 
@@ -1715,6 +1719,9 @@ void wined3d_context_vk_cleanup(struct wined3d_context_vk *context_vk)
         VK_CALL(vkDestroyFramebuffer(device_vk->vk_device, context_vk->vk_framebuffer, NULL));
     if (context_vk->vk_so_counter_bo.vk_buffer)
         wined3d_context_vk_destroy_bo(context_vk, &context_vk->vk_so_counter_bo);
+    if (context_vk->upload_ring.map_ptr)
+        wined3d_context_vk_destroy_bo(context_vk, &context_vk->upload_ring.bo);
+    heap_free(context_vk->upload_ring.regions);
     wined3d_context_vk_cleanup_resources(context_vk, VK_NULL_HANDLE);
     /* Destroy the command pool after cleaning up resources. In particular,
      * this needs to happen after all command buffers are freed, because
@@ -1906,6 +1913,7 @@ void wined3d_context_vk_submit_command_buffer(struct wined3d_context_vk *context
     {
         wined3d_context_vk_wait_command_buffer(context_vk, buffer->id - 1);
         context_vk->completed_command_buffer_id = 0;
+        context_vk->upload_ring.region_count = 0;
         buffer->id = 1;
     }
     context_vk->retired_bo_size = 0;
@@ -1944,6 +1952,132 @@ void wined3d_context_vk_wait_command_buffer(struct wined3d_context_vk *context_v
     ERR("Failed to find fence for command buffer with id 0x%s.\n", wine_dbgstr_longlong(id));
 }
 
+static bool wined3d_context_vk_init_upload_ring(struct wined3d_context_vk *context_vk)
+{
+    struct wined3d_upload_ring_vk *ring = &context_vk->upload_ring;
+    struct wined3d_bo_address addr;
+
+    if (ring->map_ptr)
+        return true;
+    if (ring->unavailable)
+        return false;
+
+    if (!wined3d_context_vk_create_bo(context_vk, WINED3D_UPLOAD_RING_SIZE_VK, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &ring->bo))
+    {
+        WARN("Failed to create upload ring bo.\n");
+        ring->unavailable = true;
+        return false;
+    }
+
+    addr.buffer_object = &ring->bo.b;
+    addr.addr = NULL;
+    if (!(ring->map_ptr = wined3d_context_map_bo_address(&context_vk->c,
+            &addr, WINED3D_UPLOAD_RING_SIZE_VK, WINED3D_MAP_WRITE | WINED3D_MAP_NOOVERWRITE)))
+    {
+        WARN("Failed to map upload ring bo.\n");
+        wined3d_context_vk_destroy_bo(context_vk, &ring->bo);
+        ring->unavailable = true;
+        return false;
+    }
+    /* The ring is never unmapped; the mapping is released when the bo is
+     * destroyed. */
+
+    TRACE("Created upload ring bo %p, map_ptr %p.\n", &ring->bo, ring->map_ptr);
+
+    return true;
+}
+
+static void wined3d_context_vk_upload_ring_reclaim(struct wined3d_context_vk *context_vk)
+{
+    struct wined3d_upload_ring_vk *ring = &context_vk->upload_ring;
+    SIZE_T i;
+
+    for (i = 0; i < ring->region_count; ++i)
+    {
+        if (ring->regions[i].command_buffer_id > context_vk->completed_command_buffer_id)
+            break;
+        ring->tail = ring->regions[i].end;
+    }
+
+    if (!(ring->region_count -= i))
+        ring->head = ring->tail = 0;
+    else if (i)
+        memmove(ring->regions, &ring->regions[i], ring->region_count * sizeof(*ring->regions));
+}
+
+/* Returns a pointer to "size" bytes of host-coherent staging memory that
+ * remain valid until the current command buffer completes. The caller must
+ * have a current command buffer, and is responsible for recording the
+ * transfer from "bo" at "offset" into it. Returns NULL when the request
+ * doesn't fit, in which case the caller should fall back to a dedicated
+ * staging bo. */
+void *wined3d_context_vk_upload_ring_alloc(struct wined3d_context_vk *context_vk, VkDeviceSize size,
+        struct wined3d_bo_vk **bo, VkDeviceSize *offset)
+{
+    struct wined3d_upload_ring_vk *ring = &context_vk->upload_ring;
+    uint64_t command_buffer_id = context_vk->current_command_buffer.id;
+    struct wined3d_upload_region_vk *region;
+    VkDeviceSize start;
+
+    if (!size || size > WINED3D_UPLOAD_RING_MAX_ALLOC_VK || !wined3d_context_vk_init_upload_ring(context_vk))
+        goto fallback;
+
+    wined3d_context_vk_upload_ring_reclaim(context_vk);
+
+    start = (ring->head + WINED3D_UPLOAD_RING_ALIGNMENT_VK - 1)
+            & ~(VkDeviceSize)(WINED3D_UPLOAD_RING_ALIGNMENT_VK - 1);
+    if (ring->region_count && ring->head <= ring->tail)
+    {
+        /* Wrapped; the free space is [head, tail). */
+        if (start + size > ring->tail)
+            goto fallback;
+    }
+    else if (start + size > WINED3D_UPLOAD_RING_SIZE_VK)
+    {
+        /* The free space is [head, end) and [0, tail). */
+        if (size > ring->tail)
+            goto fallback;
+        start = 0;
+    }
+
+    if (ring->region_count && ring->regions[ring->region_count - 1].command_buffer_id == command_buffer_id)
+    {
+        region = &ring->regions[ring->region_count - 1];
+    }
+    else
+    {
+        if (!wined3d_array_reserve((void **)&ring->regions, &ring->regions_size,
+                ring->region_count + 1, sizeof(*ring->regions)))
+            goto fallback;
+        region = &ring->regions[ring->region_count++];
+        region->command_buffer_id = command_buffer_id;
+    }
+    ring->head = region->end = start + size;
+
+    wined3d_context_vk_reference_bo(context_vk, &ring->bo);
+    ring->staged_bytes += size;
+
+    *bo = &ring->bo;
+    *offset = start;
+    return ring->map_ptr + start;
+
+fallback:
+    ring->fallback_bytes += size;
+    return NULL;
+}
+
+void wined3d_context_vk_report_upload_stats(struct wined3d_context_vk *context_vk)
+{
+    struct wined3d_upload_ring_vk *ring = &context_vk->upload_ring;
+
+    if (ring->staged_bytes || ring->fallback_bytes)
+        TRACE_(d3d_perf)("Staged %s bytes through the upload ring, %s bytes through dedicated bos.\n",
+                wine_dbgstr_longlong(ring->staged_bytes), wine_dbgstr_longlong(ring->fallback_bytes));
+    ring->staged_bytes = 0;
+    ring->fallback_bytes = 0;
+}
+
 void wined3d_context_vk_image_barrier(struct wined3d_context_vk *context_vk,
         VkCommandBuffer vk_command_buffer, VkPipelineStageFlags src_stage_mask, VkPipelineStageFlags dst_stage_mask,
         VkAccessFlags src_access_mask, VkAccessFlags dst_access_mask, VkImageLayout old_layout,
@@ -3179,6 +3313,17 @@ static bool wined3d_shader_descriptor_writes_vk_add_sampler_write(struct wined3d
     return true;
 }
 
+static void wined3d_descriptor_info_vk_from_write(union wined3d_descriptor_info_vk *info,
+        const VkWriteDescriptorSet *write)
+{
+    if (write->pBufferInfo)
+        info->buffer = *write->pBufferInfo;
+    else if (write->pImageInfo)
+        info->image = *write->pImageInfo;
+    else
+        info->buffer_view = *write->pTexelBufferView;
+}
+
 static bool wined3d_context_vk_update_descriptors(struct wined3d_context_vk *context_vk,
         VkCommandBuffer vk_command_buffer, const struct wined3d_state *state, enum wined3d_pipeline pipeline)
 {
@@ -3188,6 +3333,7 @@ static bool wined3d_context_vk_update_descriptors(struct wined3d_context_vk *con
     const struct wined3d_vk_info *vk_info = context_vk->vk_info;
     const struct wined3d_shader_resource_binding *binding;
     struct wined3d_shader_resource_bindings *bindings;
+    VkDescriptorUpdateTemplate vk_update_template;
     VkDescriptorSetLayout vk_set_layout;
     VkPipelineLayout vk_pipeline_layout;
     VkPipelineBindPoint vk_bind_point;
@@ -3201,6 +3347,7 @@ static bool wined3d_context_vk_update_descriptors(struct wined3d_context_vk *con
             vk_bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
             vk_set_layout = context_vk->graphics.vk_set_layout;
             vk_pipeline_layout = context_vk->graphics.vk_pipeline_layout;
+            vk_update_template = context_vk->graphics.vk_update_template;
             break;
 
         case WINED3D_PIPELINE_COMPUTE:
@@ -3208,6 +3355,7 @@ static bool wined3d_context_vk_update_descriptors(struct wined3d_context_vk *con
             vk_bind_point = VK_PIPELINE_BIND_POINT_COMPUTE;
             vk_set_layout = context_vk->compute.vk_set_layout;
             vk_pipeline_layout = context_vk->compute.vk_pipeline_layout;
+            vk_update_template = context_vk->compute.vk_update_template;
             break;
 
         default:
@@ -3264,7 +3412,24 @@ static bool wined3d_context_vk_update_descriptors(struct wined3d_context_vk *con
         }
     }
 
-    VK_CALL(vkUpdateDescriptorSets(device_vk->vk_device, writes->count, writes->writes, 0, NULL));
+    /* Every binding in the set layout gets exactly one write, and binding
+     * indices are allocated sequentially, so the writes can be packed into
+     * the layout's update template. */
+    if (vk_update_template && writes->count == bindings->count)
+    {
+        if (!wined3d_array_reserve((void **)&writes->data, &writes->data_size,
+                writes->count, sizeof(*writes->data)))
+            return false;
+
+        for (i = 0; i < writes->count; ++i)
+            wined3d_descriptor_info_vk_from_write(&writes->data[writes->writes[i].dstBinding], &writes->writes[i]);
+        VK_CALL(vkUpdateDescriptorSetWithTemplate(device_vk->vk_device,
+                vk_descriptor_set, vk_update_template, writes->data));
+    }
+    else
+    {
+        VK_CALL(vkUpdateDescriptorSets(device_vk->vk_device, writes->count, writes->writes, 0, NULL));
+    }
     VK_CALL(vkCmdBindDescriptorSets(vk_command_buffer, vk_bind_point,
             vk_pipeline_layout, 0, 1, &vk_descriptor_set, 0, NULL));
 
@@ -3290,6 +3455,60 @@ static VkResult wined3d_context_vk_create_vk_descriptor_set_layout(struct wined3
     return vr;
 }
 
+static VkDescriptorUpdateTemplate wined3d_context_vk_create_vk_descriptor_update_template(
+        struct wined3d_device_vk *device_vk, const struct wined3d_vk_info *vk_info,
+        const struct wined3d_pipeline_layout_key_vk *key, VkDescriptorSetLayout vk_set_layout)
+{
+    VkDescriptorUpdateTemplateEntry *entries;
+    VkDescriptorUpdateTemplateCreateInfo desc;
+    VkDescriptorUpdateTemplate vk_template;
+    VkResult vr;
+    SIZE_T i;
+
+    if (!vk_info->supported[WINED3D_VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE] || !key->binding_count)
+        return VK_NULL_HANDLE;
+
+    if (!(entries = heap_calloc(key->binding_count, sizeof(*entries))))
+        return VK_NULL_HANDLE;
+
+    for (i = 0; i < key->binding_count; ++i)
+    {
+        /* The template data is indexed by binding index. */
+        if (key->bindings[i].binding != i || key->bindings[i].descriptorCount != 1)
+        {
+            heap_free(entries);
+            return VK_NULL_HANDLE;
+        }
+
+        entries[i].dstBinding = i;
+        entries[i].dstArrayElement = 0;
+        entries[i].descriptorCount = 1;
+        entries[i].descriptorType = key->bindings[i].descriptorType;
+        entries[i].offset = i * sizeof(union wined3d_descriptor_info_vk);
+        entries[i].stride = sizeof(union wined3d_descriptor_info_vk);
+    }
+
+    desc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+    desc.pNext = NULL;
+    desc.flags = 0;
+    desc.descriptorUpdateEntryCount = key->binding_count;
+    desc.pDescriptorUpdateEntries = entries;
+    desc.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+    desc.descriptorSetLayout = vk_set_layout;
+    desc.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    desc.pipelineLayout = VK_NULL_HANDLE;
+    desc.set = 0;
+
+    if ((vr = VK_CALL(vkCreateDescriptorUpdateTemplate(device_vk->vk_device, &desc, NULL, &vk_template))) < 0)
+    {
+        WARN("Failed to create descriptor update template, vr %s.\n", wined3d_debug_vkresult(vr));
+        vk_template = VK_NULL_HANDLE;
+    }
+    heap_free(entries);
+
+    return vk_template;
+}
+
 struct wined3d_pipeline_layout_vk *wined3d_context_vk_get_pipeline_layout(
         struct wined3d_context_vk *context_vk, VkDescriptorSetLayoutBinding *bindings, SIZE_T binding_count)
 {
@@ -3339,9 +3558,14 @@ struct wined3d_pipeline_layout_vk *wined3d_context_vk_get_pipeline_layout(
         goto fail;
     }
 
+    layout->vk_update_template = wined3d_context_vk_create_vk_descriptor_update_template(device_vk,
+            vk_info, &key, layout->vk_set_layout);
+
     if (wine_rb_put(&context_vk->pipeline_layouts, &layout->key, &layout->entry) == -1)
     {
         ERR("Failed to insert pipeline layout.\n");
+        if (layout->vk_update_template)
+            VK_CALL(vkDestroyDescriptorUpdateTemplate(device_vk->vk_device, layout->vk_update_template, NULL));
         VK_CALL(vkDestroyPipelineLayout(device_vk->vk_device, layout->vk_pipeline_layout, NULL));
         VK_CALL(vkDestroyDescriptorSetLayout(device_vk->vk_device, layout->vk_set_layout, NULL));
         goto fail;
@@ -3359,8 +3583,11 @@ static VkPipeline wined3d_context_vk_get_graphics_pipeline(struct wined3d_contex
 {
     struct wined3d_device_vk *device_vk = wined3d_device_vk(context_vk->c.device);
     const struct wined3d_vk_info *vk_info = context_vk->vk_info;
+    VkPipelineCreationFeedback feedback = {0}, stage_feedback[WINED3D_SHADER_TYPE_GRAPHICS_COUNT];
+    VkPipelineCreationFeedbackCreateInfo feedback_desc;
     struct wined3d_graphics_pipeline_vk *pipeline_vk;
     struct wined3d_graphics_pipeline_key_vk *key;
+    VkGraphicsPipelineCreateInfo pipeline_desc;
     struct wine_rb_entry *entry;
     VkResult vr;
 
@@ -3372,13 +3599,25 @@ static VkPipeline wined3d_context_vk_get_graphics_pipeline(struct wined3d_contex
         return VK_NULL_HANDLE;
     pipeline_vk->key = *key;
 
-    if ((vr = VK_CALL(vkCreateGraphicsPipelines(device_vk->vk_device,
-            VK_NULL_HANDLE, 1, &key->pipeline_desc, NULL, &pipeline_vk->vk_pipeline))) < 0)
+    pipeline_desc = key->pipeline_desc;
+    if (vk_info->supported[WINED3D_VK_EXT_PIPELINE_CREATION_FEEDBACK])
+    {
+        feedback_desc.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+        feedback_desc.pNext = NULL;
+        feedback_desc.pPipelineCreationFeedback = &feedback;
+        feedback_desc.pipelineStageCreationFeedbackCount = pipeline_desc.stageCount;
+        feedback_desc.pPipelineStageCreationFeedbacks = stage_feedback;
+        pipeline_desc.pNext = &feedback_desc;
+    }
+
+    if ((vr = VK_CALL(vkCreateGraphicsPipelines(device_vk->vk_device, device_vk->pipeline_cache.vk_pipeline_cache,
+            1, &pipeline_desc, NULL, &pipeline_vk->vk_pipeline))) < 0)
     {
         WARN("Failed to create graphics pipeline, vr %s.\n", wined3d_debug_vkresult(vr));
         heap_free(pipeline_vk);
         return VK_NULL_HANDLE;
     }
+    wined3d_device_vk_pipeline_created(device_vk, &feedback);
 
     if (wine_rb_put(&context_vk->graphics_pipelines, &pipeline_vk->key, &pipeline_vk->entry) == -1)
         ERR("Failed to insert pipeline.\n");
@@ -3592,12 +3831,16 @@ VkCommandBuffer wined3d_context_vk_apply_draw_state(struct wined3d_context_vk *c
 
     if (!context_vk->sample_count)
         context_vk->sample_count = VK_SAMPLE_COUNT_1_BIT;
+    context_vk->shaders_pending = 0;
     if (context_vk->c.shader_update_mask & ~(1u << WINED3D_SHADER_TYPE_COMPUTE))
     {
         device_vk->d.shader_backend->shader_select(device_vk->d.shader_priv, &context_vk->c, state);
         if (!context_vk->graphics.vk_pipeline_layout)
         {
-            ERR("No pipeline layout set.\n");
+            if (context_vk->shaders_pending)
+                TRACE("Shaders are still being compiled, skipping draw.\n");
+            else
+                ERR("No pipeline layout set.\n");
             return VK_NULL_HANDLE;
         }
         context_vk->c.update_shader_resource_bindings = 1;
@@ -3780,12 +4023,16 @@ VkCommandBuffer wined3d_context_vk_apply_compute_state(struct wined3d_context_vk
     if (wined3d_context_is_compute_state_dirty(&context_vk->c, STATE_COMPUTE_SHADER))
         context_vk->c.shader_update_mask |= 1u << WINED3D_SHADER_TYPE_COMPUTE;
 
+    context_vk->shaders_pending = 0;
     if (context_vk->c.shader_update_mask & (1u << WINED3D_SHADER_TYPE_COMPUTE))
     {
         device_vk->d.shader_backend->shader_select_compute(device_vk->d.shader_priv, &context_vk->c, state);
         if (!context_vk->compute.vk_pipeline)
         {
-            ERR("No compute pipeline set.\n");
+            if (context_vk->shaders_pending)
+                TRACE("Shader is still being compiled, skipping dispatch.\n");
+            else
+                ERR("No compute pipeline set.\n");
             return VK_NULL_HANDLE;
         }
         context_vk->c.update_compute_shader_resource_bindings = 1;
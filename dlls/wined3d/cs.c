@@ -24,6 +24,8 @@ WINE_DECLARE_DEBUG_CHANNEL(d3d_sync);
 WINE_DECLARE_DEBUG_CHANNEL(fps);
 
 #define WINED3D_INITIAL_CS_SIZE 4096
+#define WINED3D_CS_CHUNK_SIZE_MIN 0x1000u
+#define WINED3D_CS_CHUNK_SIZE_MAX 0x100000u
 
 struct wined3d_deferred_upload
 {
@@ -40,14 +42,23 @@ struct wined3d_deferred_query_issue
     unsigned int flags;
 };
 
+/* Deferred contexts record packets into a list of chunks. Recording a command
+ * list hands the chunks over to it without copying them, and the CS thread
+ * executes them in place. */
+struct wined3d_cs_chunk
+{
+    struct wined3d_cs_chunk *next;
+    SIZE_T size, capacity;
+    BYTE data[1];
+};
+
 struct wined3d_command_list
 {
     LONG refcount;
 
     struct wined3d_device *device;
 
-    SIZE_T data_size;
-    void *data;
+    struct wined3d_cs_chunk *chunks;
 
     SIZE_T resource_count;
     struct wined3d_resource **resources;
@@ -3188,7 +3199,7 @@ static void wined3d_cs_queue_submit(struct wined3d_cs_queue *queue, struct wined
     InterlockedExchange((LONG *)&queue->head, queue->head + packet_size);
 
     if (InterlockedCompareExchange(&cs->waiting_for_event, FALSE, TRUE))
-        SetEvent(cs->event);
+        RtlWakeAddressSingle(&cs->waiting_for_event);
 }
 
 static void wined3d_cs_mt_submit(struct wined3d_device_context *context, enum wined3d_cs_queue_id queue_id)
@@ -3255,6 +3266,7 @@ static void *wined3d_cs_queue_require_space(struct wined3d_cs_queue *queue, size
 
         TRACE("Waiting for free space. Head %lu, tail %lu, packet size %Iu.\n",
                 head, tail, packet_size);
+        YieldProcessor();
     }
 
     packet = (struct wined3d_cs_packet *)&queue->data[head];
@@ -3314,6 +3326,8 @@ static void poll_queries(struct wined3d_cs *cs)
 
 static void wined3d_cs_wait_event(struct wined3d_cs *cs)
 {
+    static const LONG waiting = TRUE;
+
     InterlockedExchange(&cs->waiting_for_event, TRUE);
 
     /* The main thread might have enqueued a command and blocked on it after
@@ -3321,14 +3335,18 @@ static void wined3d_cs_wait_event(struct wined3d_cs *cs)
      * "waiting_for_event" was set.
      *
      * Likewise, we can race with the main thread when resetting
-     * "waiting_for_event", in which case we would need to call
-     * WaitForSingleObject() because the main thread called SetEvent(). */
+     * "waiting_for_event", in which case the main thread has already reset
+     * it and the wait below returns immediately.
+     *
+     * Waiting on the address rather than on an event object avoids a server
+     * round trip for both the wait and the wake-up. */
     if (!(wined3d_cs_queue_is_empty(cs, &cs->queue[WINED3D_CS_QUEUE_DEFAULT])
             && wined3d_cs_queue_is_empty(cs, &cs->queue[WINED3D_CS_QUEUE_MAP]))
             && InterlockedCompareExchange(&cs->waiting_for_event, FALSE, TRUE))
         return;
 
-    WaitForSingleObject(cs->event, INFINITE);
+    while (*(volatile LONG *)&cs->waiting_for_event)
+        RtlWaitOnAddress(&cs->waiting_for_event, &waiting, sizeof(waiting), NULL);
 }
 
 static void wined3d_cs_command_lock(const struct wined3d_cs *cs)
@@ -3377,34 +3395,38 @@ static inline bool wined3d_cs_execute_next(struct wined3d_cs *cs, struct wined3d
 static void wined3d_cs_exec_execute_command_list(struct wined3d_cs *cs, const void *data)
 {
     const struct wined3d_cs_execute_command_list *op = data;
-    SIZE_T start = 0, end = op->list->data_size;
-    const BYTE *cs_data = op->list->data;
+    const struct wined3d_cs_chunk *chunk;
     struct wined3d_cs_queue *queue;
+    SIZE_T start;
 
     TRACE("Executing command list %p.\n", op->list);
 
     queue = &cs->queue[WINED3D_CS_QUEUE_MAP];
-    while (start < end)
+    for (chunk = op->list->chunks; chunk; chunk = chunk->next)
     {
-        const struct wined3d_cs_packet *packet;
-        enum wined3d_cs_op opcode;
+        for (start = 0; start < chunk->size;)
+        {
+            const struct wined3d_cs_packet *packet;
+            enum wined3d_cs_op opcode;
 
-        while (!wined3d_cs_queue_is_empty(cs, queue))
-            wined3d_cs_execute_next(cs, queue);
+            while (!wined3d_cs_queue_is_empty(cs, queue))
+                wined3d_cs_execute_next(cs, queue);
 
-        packet = wined3d_next_cs_packet(cs_data, &start, WINED3D_CS_QUEUE_MASK);
-        opcode = *(const enum wined3d_cs_op *)packet->data;
+            packet = wined3d_next_cs_packet(chunk->data, &start, ~(SIZE_T)0);
+            opcode = *(const enum wined3d_cs_op *)packet->data;
 
-        if (opcode >= WINED3D_CS_OP_STOP)
-            ERR("Invalid opcode %#x.\n", opcode);
-        else
-            wined3d_cs_op_handlers[opcode](cs, packet->data);
-        TRACE("%s executed.\n", debug_cs_op(opcode));
+            if (opcode >= WINED3D_CS_OP_STOP)
+                ERR("Invalid opcode %#x.\n", opcode);
+            else
+                wined3d_cs_op_handlers[opcode](cs, packet->data);
+            TRACE("%s executed.\n", debug_cs_op(opcode));
+        }
     }
 }
 
 static DWORD WINAPI wined3d_cs_run(void *ctx)
 {
+    unsigned int spin_limit = WINED3D_CS_SPIN_COUNT;
     struct wined3d_cs_queue *queue;
     unsigned int spin_count = 0;
     struct wined3d_cs *cs = ctx;
@@ -3438,16 +3460,27 @@ static DWORD WINAPI wined3d_cs_run(void *ctx)
             if (wined3d_cs_queue_is_empty(cs, queue))
             {
                 YieldProcessor();
-                if (++spin_count >= WINED3D_CS_SPIN_COUNT)
+                if (++spin_count >= spin_limit)
                 {
                     if (list_empty(&cs->query_poll_list))
+                    {
+                        /* Spinning didn't pay off; spin less next time. */
+                        spin_limit = max(spin_limit / 2, WINED3D_CS_SPIN_COUNT_MIN);
                         wined3d_cs_wait_event(cs);
+                        spin_count = 0;
+                    }
                     else
+                    {
                         Sleep(0);
+                    }
                 }
                 continue;
             }
         }
+        /* New commands arrived while spinning, which is cheaper than
+         * sleeping and waking up again; spin a little longer next time. */
+        if (spin_count && spin_count < spin_limit)
+            spin_limit = min(spin_limit * 2, WINED3D_CS_SPIN_COUNT_MAX);
         spin_count = 0;
 
         run = wined3d_cs_execute_next(cs, queue);
@@ -3501,12 +3534,6 @@ struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device,
     {
         cs->c.ops = &wined3d_cs_mt_ops;
 
-        if (!(cs->event = CreateEventW(NULL, FALSE, FALSE, NULL)))
-        {
-            ERR("Failed to create command stream event.\n");
-            heap_free(cs->data);
-            goto fail;
-        }
         if (!(cs->present_event = CreateEventW(NULL, FALSE, FALSE, NULL)))
         {
             ERR("Failed to create command stream present event.\n");
@@ -3519,7 +3546,6 @@ struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device,
         {
             ERR("Failed to get wined3d module handle.\n");
             CloseHandle(cs->present_event);
-            CloseHandle(cs->event);
             heap_free(cs->data);
             goto fail;
         }
@@ -3529,7 +3555,6 @@ struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device,
             ERR("Failed to create wined3d command stream thread.\n");
             FreeLibrary(cs->wined3d_module);
             CloseHandle(cs->present_event);
-            CloseHandle(cs->event);
             heap_free(cs->data);
             goto fail;
         }
@@ -3553,8 +3578,6 @@ void wined3d_cs_destroy(struct wined3d_cs *cs)
         CloseHandle(cs->thread);
         if (!CloseHandle(cs->present_event))
             ERR("Closing present event failed.\n");
-        if (!CloseHandle(cs->event))
-            ERR("Closing event failed.\n");
     }
 
     wined3d_state_destroy(cs->c.state);
@@ -4045,12 +4068,33 @@ static void wined3d_cs_packet_incref_objects(struct wined3d_cs_packet *packet)
     }
 }
 
+static void wined3d_cs_chunks_decref_objects(const struct wined3d_cs_chunk *chunk)
+{
+    SIZE_T offset;
+
+    for (; chunk; chunk = chunk->next)
+    {
+        for (offset = 0; offset < chunk->size;)
+            wined3d_cs_packet_decref_objects(wined3d_next_cs_packet(chunk->data, &offset, ~(SIZE_T)0));
+    }
+}
+
+static void wined3d_cs_chunks_free(struct wined3d_cs_chunk *chunk)
+{
+    struct wined3d_cs_chunk *next;
+
+    for (; chunk; chunk = next)
+    {
+        next = chunk->next;
+        heap_free(chunk);
+    }
+}
+
 struct wined3d_deferred_context
 {
     struct wined3d_device_context c;
 
-    SIZE_T data_size, data_capacity;
-    void *data;
+    struct wined3d_cs_chunk *chunks, *current_chunk;
 
     SIZE_T resource_count, resources_capacity;
     struct wined3d_resource **resources;
@@ -4080,8 +4124,9 @@ static void *wined3d_deferred_context_require_space(struct wined3d_device_contex
         size_t size, enum wined3d_cs_queue_id queue_id)
 {
     struct wined3d_deferred_context *deferred = wined3d_deferred_context_from_context(context);
+    struct wined3d_cs_chunk *chunk = deferred->current_chunk;
+    size_t header_size, packet_size, capacity;
     struct wined3d_cs_packet *packet;
-    size_t header_size, packet_size;
 
     if (queue_id != WINED3D_CS_QUEUE_DEFAULT)
         return NULL;
@@ -4090,11 +4135,25 @@ static void *wined3d_deferred_context_require_space(struct wined3d_device_contex
     packet_size = offsetof(struct wined3d_cs_packet, data[size]);
     packet_size = (packet_size + header_size - 1) & ~(header_size - 1);
 
-    if (!wined3d_array_reserve(&deferred->data, &deferred->data_capacity, deferred->data_size + packet_size, 1))
-        return NULL;
+    if (!chunk || chunk->capacity - chunk->size < packet_size)
+    {
+        capacity = chunk ? min(chunk->capacity * 2, WINED3D_CS_CHUNK_SIZE_MAX) : WINED3D_CS_CHUNK_SIZE_MIN;
+        capacity = max(capacity, packet_size);
+        if (!(chunk = heap_alloc(offsetof(struct wined3d_cs_chunk, data[capacity]))))
+            return NULL;
+        chunk->next = NULL;
+        chunk->size = 0;
+        chunk->capacity = capacity;
 
-    packet = (struct wined3d_cs_packet *)((BYTE *)deferred->data + deferred->data_size);
-    TRACE("size was %Iu, adding %Iu\n", (size_t)deferred->data_size, packet_size);
+        if (deferred->current_chunk)
+            deferred->current_chunk->next = chunk;
+        else
+            deferred->chunks = chunk;
+        deferred->current_chunk = chunk;
+    }
+
+    packet = (struct wined3d_cs_packet *)&chunk->data[chunk->size];
+    TRACE("size was %Iu, adding %Iu\n", (size_t)chunk->size, packet_size);
     packet->size = packet_size - header_size;
     return &packet->data;
 }
@@ -4102,10 +4161,11 @@ static void *wined3d_deferred_context_require_space(struct wined3d_device_contex
 static void wined3d_deferred_context_submit(struct wined3d_device_context *context, enum wined3d_cs_queue_id queue_id)
 {
     struct wined3d_deferred_context *deferred = wined3d_deferred_context_from_context(context);
+    struct wined3d_cs_chunk *chunk = deferred->current_chunk;
     struct wined3d_cs_packet *packet;
 
     assert(queue_id == WINED3D_CS_QUEUE_DEFAULT);
-    packet = wined3d_next_cs_packet(deferred->data, &deferred->data_size, ~(SIZE_T)0);
+    packet = wined3d_next_cs_packet(chunk->data, &chunk->size, ~(SIZE_T)0);
     wined3d_cs_packet_incref_objects(packet);
 }
 
@@ -4326,8 +4386,7 @@ HRESULT CDECL wined3d_deferred_context_create(struct wined3d_device *device, str
 void CDECL wined3d_deferred_context_destroy(struct wined3d_device_context *context)
 {
     struct wined3d_deferred_context *deferred = wined3d_deferred_context_from_context(context);
-    const struct wined3d_cs_packet *packet;
-    SIZE_T i, offset = 0;
+    SIZE_T i;
 
     TRACE("context %p.\n", context);
 
@@ -4360,14 +4419,10 @@ void CDECL wined3d_deferred_context_destroy(struct wined3d_device_context *conte
         wined3d_query_decref(deferred->queries[i].query);
     heap_free(deferred->queries);
 
-    while (offset < deferred->data_size)
-    {
-        packet = wined3d_next_cs_packet(deferred->data, &offset, ~(SIZE_T)0);
-        wined3d_cs_packet_decref_objects(packet);
-    }
+    wined3d_cs_chunks_decref_objects(deferred->chunks);
+    wined3d_cs_chunks_free(deferred->chunks);
 
     wined3d_state_destroy(deferred->c.state);
-    heap_free(deferred->data);
     heap_free(deferred);
 }
 
@@ -4384,8 +4439,7 @@ HRESULT CDECL wined3d_deferred_context_record_command_list(struct wined3d_device
     memory = heap_alloc(sizeof(*object) + deferred->resource_count * sizeof(*object->resources)
             + deferred->upload_count * sizeof(*object->uploads)
             + deferred->command_list_count * sizeof(*object->command_lists)
-            + deferred->query_count * sizeof(*object->queries)
-            + deferred->data_size);
+            + deferred->query_count * sizeof(*object->queries));
 
     if (!memory)
     {
@@ -4424,11 +4478,11 @@ HRESULT CDECL wined3d_deferred_context_record_command_list(struct wined3d_device
     memcpy(object->queries, deferred->queries, deferred->query_count * sizeof(*object->queries));
     /* Transfer our references to the queries to the command list. */
 
-    object->data = memory;
-    object->data_size = deferred->data_size;
-    memcpy(object->data, deferred->data, deferred->data_size);
+    object->chunks = deferred->chunks;
+    /* Transfer the recorded packets to the command list. */
 
-    deferred->data_size = 0;
+    deferred->chunks = NULL;
+    deferred->current_chunk = NULL;
     deferred->resource_count = 0;
     deferred->upload_count = 0;
     deferred->command_list_count = 0;
@@ -4458,6 +4512,8 @@ static void wined3d_command_list_destroy_object(void *object)
 
     TRACE("list %p.\n", list);
 
+    wined3d_cs_chunks_free(list->chunks);
+
     for (i = 0; i < list->upload_count; ++i)
         HeapFree(list->upload_heap, 0, list->uploads[i].sysmem);
 
@@ -4486,8 +4542,7 @@ ULONG CDECL wined3d_command_list_decref(struct wined3d_command_list *list)
 {
     unsigned int refcount = InterlockedDecrement(&list->refcount);
     struct wined3d_device *device = list->device;
-    const struct wined3d_cs_packet *packet;
-    SIZE_T i, offset;
+    SIZE_T i;
 
     TRACE("%p decreasing refcount to %u.\n", list, refcount);
 
@@ -4502,12 +4557,7 @@ ULONG CDECL wined3d_command_list_decref(struct wined3d_command_list *list)
         for (i = 0; i < list->query_count; ++i)
             wined3d_query_decref(list->queries[i].query);
 
-        offset = 0;
-        while (offset < list->data_size)
-        {
-            packet = wined3d_next_cs_packet(list->data, &offset, ~(SIZE_T)0);
-            wined3d_cs_packet_decref_objects(packet);
-        }
+        wined3d_cs_chunks_decref_objects(list->chunks);
 
         wined3d_mutex_lock();
         wined3d_cs_destroy_object(device->cs, wined3d_command_list_destroy_object, list);
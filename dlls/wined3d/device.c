@@ -626,6 +626,218 @@ static bool wined3d_null_image_vk_init(struct wined3d_image_vk *image, struct wi
     return true;
 }
 
+static const char wined3d_vk_pipeline_cache_type[] = "vkpipelinecache";
+
+/* Pipelines created since the last save, and minimum time between saves,
+ * before the pipeline cache is written out during rendering. */
+#define WINED3D_VK_PIPELINE_CACHE_SAVE_COUNT 32
+#define WINED3D_VK_PIPELINE_CACHE_SAVE_INTERVAL 30000
+
+static void *wined3d_device_vk_load_pipeline_cache_data(const struct wined3d_pipeline_cache_vk *cache,
+        size_t *size)
+{
+    const VkPipelineCacheHeaderVersionOne *header;
+    char path[MAX_PATH];
+    LARGE_INTEGER file_size;
+    void *data = NULL;
+    DWORD read;
+    HANDLE file;
+
+    if (!wined3d_get_cache_file_path(wined3d_vk_pipeline_cache_type,
+            cache->uuid, sizeof(cache->uuid), path, sizeof(path)))
+        return NULL;
+
+    if ((file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+            NULL, OPEN_EXISTING, 0, NULL)) == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < sizeof(*header)
+            || file_size.QuadPart > 256 * 1024 * 1024)
+        goto fail;
+
+    if (!(data = heap_alloc(file_size.QuadPart)))
+        goto fail;
+    if (!ReadFile(file, data, file_size.QuadPart, &read, NULL) || read != file_size.QuadPart)
+        goto fail;
+
+    /* Drivers are supposed to ignore incompatible data, but not all of them
+     * do, so make sure the cache was written by a compatible driver. */
+    header = data;
+    if (header->headerSize < sizeof(*header) || header->headerSize > read
+            || header->headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+            || memcmp(header->pipelineCacheUUID, cache->uuid, sizeof(cache->uuid)))
+    {
+        WARN("Ignoring incompatible pipeline cache %s.\n", debugstr_a(path));
+        goto fail;
+    }
+
+    CloseHandle(file);
+    TRACE("Loaded %lu bytes of pipeline cache data from %s.\n", read, debugstr_a(path));
+    *size = read;
+    return data;
+
+fail:
+    heap_free(data);
+    CloseHandle(file);
+    return NULL;
+}
+
+static void wined3d_pipeline_cache_vk_trace_stats(const struct wined3d_pipeline_cache_vk *cache)
+{
+    TRACE_(d3d_perf)("%u pipelines created, %u found in the pipeline cache, %s ms spent in creation.\n",
+            cache->created_count, cache->hit_count, wine_dbgstr_longlong(cache->create_time / 1000000));
+}
+
+/* The pipeline cache is internally synchronised, so this may run on a thread
+ * pool thread while pipelines are being created. */
+static void wined3d_device_vk_write_pipeline_cache(struct wined3d_device_vk *device_vk)
+{
+    const struct wined3d_pipeline_cache_vk *cache = &device_vk->pipeline_cache;
+    const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
+    char path[MAX_PATH], tmp_path[MAX_PATH + 16];
+    void *data = NULL;
+    DWORD written;
+    HANDLE file;
+    size_t size;
+    VkResult vr;
+
+    if (!wined3d_get_cache_file_path(wined3d_vk_pipeline_cache_type,
+            cache->uuid, sizeof(cache->uuid), path, sizeof(path)))
+        return;
+
+    if ((vr = VK_CALL(vkGetPipelineCacheData(device_vk->vk_device, cache->vk_pipeline_cache, &size, NULL))) < 0
+            || !size || !(data = heap_alloc(size)))
+        goto done;
+    /* If the cache grew in the meantime, the data would be incomplete. */
+    if ((vr = VK_CALL(vkGetPipelineCacheData(device_vk->vk_device,
+            cache->vk_pipeline_cache, &size, data))) != VK_SUCCESS)
+        goto done;
+
+    /* Write to a temporary file first, other processes may be reading the cache. */
+    sprintf(tmp_path, "%s.%lx", path, GetCurrentProcessId());
+    if ((file = CreateFileA(tmp_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL)) == INVALID_HANDLE_VALUE)
+        goto done;
+    if (!WriteFile(file, data, size, &written, NULL) || written != size)
+    {
+        CloseHandle(file);
+        DeleteFileA(tmp_path);
+        goto done;
+    }
+    CloseHandle(file);
+
+    if (!MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING))
+        DeleteFileA(tmp_path);
+    else
+        TRACE("Saved %Iu bytes of pipeline cache data to %s.\n", size, debugstr_a(path));
+
+done:
+    if (vr < 0)
+        WARN("Failed to get pipeline cache data, vr %s.\n", wined3d_debug_vkresult(vr));
+    heap_free(data);
+}
+
+static void CALLBACK wined3d_device_vk_save_pipeline_cache_cb(TP_CALLBACK_INSTANCE *instance,
+        void *ctx, TP_WORK *work)
+{
+    wined3d_device_vk_write_pipeline_cache(ctx);
+}
+
+/* Write the pipeline cache out on the thread pool, so that rendering isn't
+ * blocked by the file I/O. */
+static void wined3d_device_vk_save_pipeline_cache(struct wined3d_device_vk *device_vk)
+{
+    struct wined3d_pipeline_cache_vk *cache = &device_vk->pipeline_cache;
+
+    cache->save_time = GetTickCount64();
+    cache->unsaved_count = 0;
+
+    wined3d_pipeline_cache_vk_trace_stats(cache);
+
+    if (!cache->save_work && !(cache->save_work = CreateThreadpoolWork(wined3d_device_vk_save_pipeline_cache_cb,
+            device_vk, NULL)))
+    {
+        ERR("Failed to create thread pool work, error %lu.\n", GetLastError());
+        return;
+    }
+    SubmitThreadpoolWork(cache->save_work);
+}
+
+void wined3d_device_vk_create_pipeline_cache(struct wined3d_device_vk *device_vk,
+        const struct wined3d_adapter_vk *adapter_vk)
+{
+    struct wined3d_pipeline_cache_vk *cache = &device_vk->pipeline_cache;
+    const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
+    VkPipelineCacheCreateInfo cache_desc;
+    VkResult vr;
+
+    memcpy(cache->uuid, adapter_vk->pipeline_cache_uuid, sizeof(cache->uuid));
+    cache->save_time = GetTickCount64();
+
+    cache_desc.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cache_desc.pNext = NULL;
+    cache_desc.flags = 0;
+    cache_desc.initialDataSize = 0;
+    cache_desc.pInitialData = wined3d_device_vk_load_pipeline_cache_data(cache, &cache_desc.initialDataSize);
+
+    vr = VK_CALL(vkCreatePipelineCache(device_vk->vk_device, &cache_desc, NULL, &cache->vk_pipeline_cache));
+    if (vr < 0 && cache_desc.pInitialData)
+    {
+        WARN("Failed to create pipeline cache from saved data, vr %s.\n", wined3d_debug_vkresult(vr));
+        cache_desc.initialDataSize = 0;
+        cache_desc.pInitialData = NULL;
+        vr = VK_CALL(vkCreatePipelineCache(device_vk->vk_device, &cache_desc, NULL, &cache->vk_pipeline_cache));
+    }
+    if (vr < 0)
+    {
+        WARN("Failed to create pipeline cache, vr %s.\n", wined3d_debug_vkresult(vr));
+        cache->vk_pipeline_cache = VK_NULL_HANDLE;
+    }
+
+    heap_free((void *)cache_desc.pInitialData);
+}
+
+void wined3d_device_vk_destroy_pipeline_cache(struct wined3d_device_vk *device_vk)
+{
+    struct wined3d_pipeline_cache_vk *cache = &device_vk->pipeline_cache;
+    const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
+
+    if (!cache->vk_pipeline_cache)
+        return;
+
+    if (cache->save_work)
+    {
+        WaitForThreadpoolWorkCallbacks(cache->save_work, FALSE);
+        CloseThreadpoolWork(cache->save_work);
+        cache->save_work = NULL;
+    }
+    if (cache->unsaved_count)
+    {
+        wined3d_pipeline_cache_vk_trace_stats(cache);
+        wined3d_device_vk_write_pipeline_cache(device_vk);
+    }
+    VK_CALL(vkDestroyPipelineCache(device_vk->vk_device, cache->vk_pipeline_cache, NULL));
+    cache->vk_pipeline_cache = VK_NULL_HANDLE;
+}
+
+void wined3d_device_vk_pipeline_created(struct wined3d_device_vk *device_vk,
+        const VkPipelineCreationFeedback *feedback)
+{
+    struct wined3d_pipeline_cache_vk *cache = &device_vk->pipeline_cache;
+
+    ++cache->created_count;
+    ++cache->unsaved_count;
+    if (feedback && (feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT))
+    {
+        if (feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT)
+            ++cache->hit_count;
+        cache->create_time += feedback->duration;
+    }
+
+    if (cache->vk_pipeline_cache && cache->unsaved_count >= WINED3D_VK_PIPELINE_CACHE_SAVE_COUNT
+            && GetTickCount64() - cache->save_time >= WINED3D_VK_PIPELINE_CACHE_SAVE_INTERVAL)
+        wined3d_device_vk_save_pipeline_cache(device_vk);
+}
+
 bool wined3d_device_vk_create_null_resources(struct wined3d_device_vk *device_vk,
         struct wined3d_context_vk *context_vk)
 {
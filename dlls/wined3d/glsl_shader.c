@@ -121,6 +121,51 @@ struct constant_heap
     unsigned int size;
 };
 
+struct glsl_program_binary_key
+{
+    uint64_t source_hash;
+    uint32_t source_size;
+};
+
+/* Index entry for a record in the program binary cache file. The binary
+ * itself is only read from the file when a program is linked. */
+struct glsl_program_binary
+{
+    struct wine_rb_entry entry;
+    struct glsl_program_binary_key key;
+    GLenum format;
+    GLsizei size;
+    DWORD offset;
+};
+
+/* On-disk format of the program binary cache: a header, followed by records
+ * of program binaries, each padded to 8 bytes. */
+struct glsl_program_binary_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t padding;
+};
+
+struct glsl_program_binary_record
+{
+    uint64_t source_hash;
+    uint32_t source_size;
+    uint32_t format;
+    uint32_t size;
+    uint32_t padding;
+};
+
+struct glsl_program_binary_cache
+{
+    BOOL initialised;
+    char path[MAX_PATH];
+    struct wine_rb_tree binaries;
+    HANDLE file;
+    BOOL full;
+    unsigned int hit_count, miss_count;
+};
+
 /* GLSL shader private data */
 struct shader_glsl_priv
 {
@@ -138,6 +183,8 @@ struct shader_glsl_priv
     struct wine_rb_tree ffp_fragment_shaders;
     BOOL ffp_proj_control;
     BOOL legacy_lighting;
+
+    struct glsl_program_binary_cache binary_cache;
 };
 
 struct glsl_vs_program
@@ -634,6 +681,425 @@ void shader_glsl_validate_link(const struct wined3d_gl_info *gl_info, GLuint pro
     print_glsl_info_log(gl_info, program, TRUE);
 }
 
+static const char glsl_program_binary_cache_type[] = "glprog";
+static const char glsl_program_binary_cache_magic[8] = "WINEGLP";
+#define GLSL_PROGRAM_BINARY_CACHE_VERSION 1
+#define GLSL_PROGRAM_BINARY_CACHE_MAX_SIZE (256 * 1024 * 1024)
+
+static uint64_t glsl_hash_data(uint64_t hash, const void *data, size_t size)
+{
+    const BYTE *ptr = data;
+    size_t i;
+
+    /* 64-bit FNV-1a. */
+    for (i = 0; i < size; ++i)
+    {
+        hash ^= ptr[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+static int glsl_program_binary_compare(const void *key, const struct wine_rb_entry *entry)
+{
+    const struct glsl_program_binary *binary = WINE_RB_ENTRY_VALUE(entry, const struct glsl_program_binary, entry);
+    const struct glsl_program_binary_key *k = key;
+    int ret;
+
+    if ((ret = wined3d_uint64_compare(k->source_hash, binary->key.source_hash)))
+        return ret;
+    return wined3d_uint32_compare(k->source_size, binary->key.source_size);
+}
+
+static void glsl_free_program_binary(struct wine_rb_entry *entry, void *context)
+{
+    heap_free(WINE_RB_ENTRY_VALUE(entry, struct glsl_program_binary, entry));
+}
+
+/* A later record for the same key replaces the earlier one, e.g. after the
+ * driver rejected a binary. Returns TRUE if the key wasn't indexed yet. */
+static BOOL glsl_program_binary_cache_add(struct glsl_program_binary_cache *cache,
+        const struct glsl_program_binary_key *key, GLenum format, GLsizei size, DWORD offset)
+{
+    struct glsl_program_binary *binary;
+    struct wine_rb_entry *entry;
+    BOOL ret = FALSE;
+
+    if ((entry = wine_rb_get(&cache->binaries, key)))
+    {
+        binary = WINE_RB_ENTRY_VALUE(entry, struct glsl_program_binary, entry);
+    }
+    else
+    {
+        if (!(binary = heap_alloc(sizeof(*binary))))
+            return FALSE;
+        binary->key = *key;
+        wine_rb_put(&cache->binaries, &binary->key, &binary->entry);
+        ret = TRUE;
+    }
+    binary->format = format;
+    binary->size = size;
+    binary->offset = offset;
+
+    return ret;
+}
+
+static void glsl_program_binary_write_header(HANDLE file)
+{
+    struct glsl_program_binary_header header;
+    DWORD written;
+
+    memcpy(header.magic, glsl_program_binary_cache_magic, sizeof(header.magic));
+    header.version = GLSL_PROGRAM_BINARY_CACHE_VERSION;
+    header.padding = 0;
+    WriteFile(file, &header, sizeof(header), &written, NULL);
+}
+
+static DWORD glsl_program_binary_record_size(GLsizei size)
+{
+    return sizeof(struct glsl_program_binary_record) + ((size + 7) & ~7u);
+}
+
+static BOOL glsl_program_binary_read(HANDLE file, DWORD offset, void *data, DWORD size)
+{
+    DWORD read;
+
+    return SetFilePointer(file, offset, NULL, FILE_BEGIN) != INVALID_SET_FILE_POINTER
+            && ReadFile(file, data, size, &read, NULL) && read == size;
+}
+
+/* Returns the record of "binary", padded to its size in the file. Other
+ * processes may have replaced the cache file or appended to it since the
+ * record was indexed, so check that it's still the same record. */
+static struct glsl_program_binary_record *glsl_program_binary_cache_read(
+        const struct glsl_program_binary_cache *cache, const struct glsl_program_binary *binary)
+{
+    struct glsl_program_binary_record *record;
+
+    if (!(record = heap_alloc_zero(glsl_program_binary_record_size(binary->size))))
+        return NULL;
+    if (!glsl_program_binary_read(cache->file, binary->offset, record, sizeof(*record) + binary->size)
+            || record->source_hash != binary->key.source_hash || record->source_size != binary->key.source_size
+            || record->format != binary->format || record->size != binary->size)
+    {
+        heap_free(record);
+        return NULL;
+    }
+
+    return record;
+}
+
+/* Binaries are appended to the file as programs are linked, and read back
+ * when they're looked up. */
+static HANDLE glsl_program_binary_cache_open(const char *path)
+{
+    HANDLE file;
+
+    if ((file = CreateFileA(path, GENERIC_READ | FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE
+            | FILE_SHARE_DELETE, NULL, OPEN_ALWAYS, 0, NULL)) == INVALID_HANDLE_VALUE)
+        WARN("Failed to open program binary cache %s, error %lu.\n", debugstr_a(path), GetLastError());
+    else if (GetLastError() != ERROR_ALREADY_EXISTS)
+        glsl_program_binary_write_header(file);
+
+    return file;
+}
+
+/* Replace the cache file with one containing each indexed binary once. */
+static void glsl_program_binary_cache_rewrite(struct glsl_program_binary_cache *cache)
+{
+    struct glsl_program_binary_record *record;
+    struct glsl_program_binary *binary;
+    char tmp_path[MAX_PATH + 16];
+    DWORD size, written, offset;
+    unsigned int count = 0;
+    BOOL ret = TRUE;
+    HANDLE file;
+
+    /* Write to a temporary file first, other processes may be reading the cache. */
+    sprintf(tmp_path, "%s.%lx", cache->path, GetCurrentProcessId());
+    if ((file = CreateFileA(tmp_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL)) == INVALID_HANDLE_VALUE)
+        return;
+    glsl_program_binary_write_header(file);
+    WINE_RB_FOR_EACH_ENTRY(binary, &cache->binaries, struct glsl_program_binary, entry)
+    {
+        size = glsl_program_binary_record_size(binary->size);
+        if (!(record = glsl_program_binary_cache_read(cache, binary)))
+        {
+            ret = FALSE;
+            break;
+        }
+        ret = WriteFile(file, record, size, &written, NULL) && written == size;
+        heap_free(record);
+        if (!ret)
+            break;
+        ++count;
+    }
+    CloseHandle(file);
+    if (!ret)
+    {
+        DeleteFileA(tmp_path);
+        return;
+    }
+
+    CloseHandle(cache->file);
+    if (!MoveFileExA(tmp_path, cache->path, MOVEFILE_REPLACE_EXISTING))
+    {
+        DeleteFileA(tmp_path);
+    }
+    else
+    {
+        TRACE("Compacted program binary cache %s to %u binaries.\n", debugstr_a(cache->path), count);
+        offset = sizeof(struct glsl_program_binary_header);
+        WINE_RB_FOR_EACH_ENTRY(binary, &cache->binaries, struct glsl_program_binary, entry)
+        {
+            binary->offset = offset;
+            offset += glsl_program_binary_record_size(binary->size);
+        }
+    }
+    cache->file = glsl_program_binary_cache_open(cache->path);
+}
+
+static BOOL glsl_program_binary_cache_load(struct glsl_program_binary_cache *cache)
+{
+    struct glsl_program_binary_header header;
+    struct glsl_program_binary_record record;
+    unsigned int count = 0, record_count = 0;
+    struct glsl_program_binary_key key;
+    LARGE_INTEGER file_size;
+    DWORD offset, end;
+
+    if ((cache->file = glsl_program_binary_cache_open(cache->path)) == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    /* An oversized cache is truncated to the records in the first
+     * GLSL_PROGRAM_BINARY_CACHE_MAX_SIZE bytes when it's rewritten below. */
+    if (!GetFileSizeEx(cache->file, &file_size)
+            || !glsl_program_binary_read(cache->file, 0, &header, sizeof(header)))
+        return TRUE;
+
+    if (memcmp(header.magic, glsl_program_binary_cache_magic, sizeof(header.magic))
+            || header.version != GLSL_PROGRAM_BINARY_CACHE_VERSION)
+    {
+        WARN("Ignoring incompatible program binary cache %s.\n", debugstr_a(cache->path));
+        CloseHandle(cache->file);
+        DeleteFileA(cache->path);
+        return (cache->file = glsl_program_binary_cache_open(cache->path)) != INVALID_HANDLE_VALUE;
+    }
+
+    /* Only index the records, and read the binaries when they're needed.
+     * Records are appended as programs are linked; a truncated record at the
+     * end of the file is simply ignored. */
+    end = min(file_size.QuadPart, GLSL_PROGRAM_BINARY_CACHE_MAX_SIZE);
+    offset = sizeof(header);
+    while (end - offset >= sizeof(record) && glsl_program_binary_read(cache->file, offset, &record, sizeof(record)))
+    {
+        if (record.size > end - offset - sizeof(record))
+            break;
+        key.source_hash = record.source_hash;
+        key.source_size = record.source_size;
+        if (glsl_program_binary_cache_add(cache, &key, record.format, record.size, offset))
+            ++count;
+        ++record_count;
+        offset += min(end - offset, glsl_program_binary_record_size(record.size));
+    }
+
+    TRACE("Indexed %u program binaries in %s.\n", count, debugstr_a(cache->path));
+
+    /* Concurrent processes may have appended the same binaries, and records
+     * of programs rejected by the driver are superseded but never removed
+     * from the file. */
+    if (count != record_count || offset != file_size.QuadPart)
+        glsl_program_binary_cache_rewrite(cache);
+
+    return TRUE;
+}
+
+/* Write the record with a single call, so that records appended by
+ * concurrent processes don't interleave. */
+static void glsl_program_binary_cache_write(struct glsl_program_binary_cache *cache,
+        const struct glsl_program_binary_key *key, GLenum format, const void *data, GLsizei size)
+{
+    DWORD written, record_size = glsl_program_binary_record_size(size);
+    struct glsl_program_binary_record *record;
+    LARGE_INTEGER file_size;
+
+    if (cache->full)
+        return;
+
+    /* Other processes append to the file as well, so check its current size.
+     * The record may still end up at a later offset, which is detected when
+     * it's read back. */
+    if (!GetFileSizeEx(cache->file, &file_size)
+            || file_size.QuadPart + record_size > GLSL_PROGRAM_BINARY_CACHE_MAX_SIZE)
+    {
+        TRACE("Program binary cache %s is full.\n", debugstr_a(cache->path));
+        cache->full = TRUE;
+        return;
+    }
+
+    if (!(record = heap_alloc_zero(record_size)))
+        return;
+    record->source_hash = key->source_hash;
+    record->source_size = key->source_size;
+    record->format = format;
+    record->size = size;
+    memcpy(record + 1, data, size);
+    if (WriteFile(cache->file, record, record_size, &written, NULL) && written == record_size)
+        glsl_program_binary_cache_add(cache, key, format, size, file_size.QuadPart);
+    else
+        WARN("Failed to write program binary, error %lu.\n", GetLastError());
+    heap_free(record);
+}
+
+/* Context activation is done by the caller. */
+static BOOL glsl_program_binary_cache_init(struct glsl_program_binary_cache *cache,
+        const struct wined3d_gl_info *gl_info)
+{
+    static const GLenum strings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION_ARB};
+    uint64_t driver_hash = 0xcbf29ce484222325ull;
+    const char *str;
+    GLint count = 0;
+    unsigned int i;
+
+    if (cache->initialised)
+        return !!cache->path[0];
+    cache->initialised = TRUE;
+
+    if (!gl_info->supported[ARB_GET_PROGRAM_BINARY])
+        return FALSE;
+    gl_info->gl_ops.gl.p_glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &count);
+    if (!count)
+    {
+        TRACE("No program binary formats supported.\n");
+        return FALSE;
+    }
+
+    /* Binaries are only valid for the driver that created them. Key the
+     * cache file on the driver's identification strings, so that a driver
+     * update starts a new cache. */
+    for (i = 0; i < ARRAY_SIZE(strings); ++i)
+    {
+        if ((str = (const char *)gl_info->gl_ops.gl.p_glGetString(strings[i])))
+            driver_hash = glsl_hash_data(driver_hash, str, strlen(str) + 1);
+    }
+
+    if (!wined3d_get_cache_file_path(glsl_program_binary_cache_type,
+            (const uint8_t *)&driver_hash, sizeof(driver_hash), cache->path, sizeof(cache->path)))
+    {
+        cache->path[0] = 0;
+        return FALSE;
+    }
+
+    if (!glsl_program_binary_cache_load(cache))
+    {
+        cache->path[0] = 0;
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* Context activation is done by the caller. The key covers the source of
+ * all attached shader objects, and "link_state", which should describe any
+ * other state affecting the link. */
+static BOOL shader_glsl_get_program_binary_key(const struct wined3d_gl_info *gl_info, GLuint program,
+        const void *link_state, size_t link_state_size, struct glsl_program_binary_key *key)
+{
+    uint64_t hashes[WINED3D_SHADER_TYPE_COUNT + 1], hash;
+    GLint shader_count, source_size, i, j;
+    GLuint shaders[ARRAY_SIZE(hashes)];
+    char *source;
+
+    GL_EXTCALL(glGetProgramiv(program, GL_ATTACHED_SHADERS, &shader_count));
+    if (shader_count <= 0 || shader_count > ARRAY_SIZE(shaders))
+        return FALSE;
+    GL_EXTCALL(glGetAttachedShaders(program, shader_count, NULL, shaders));
+
+    key->source_size = 0;
+    for (i = 0; i < shader_count; ++i)
+    {
+        GL_EXTCALL(glGetShaderiv(shaders[i], GL_SHADER_SOURCE_LENGTH, &source_size));
+        if (source_size <= 0 || !(source = heap_alloc(source_size)))
+            return FALSE;
+        GL_EXTCALL(glGetShaderSource(shaders[i], source_size, NULL, source));
+        hash = glsl_hash_data(0xcbf29ce484222325ull, source, source_size);
+        heap_free(source);
+
+        /* The order of attached shaders is implementation defined. */
+        for (j = i; j > 0 && hashes[j - 1] > hash; --j)
+            hashes[j] = hashes[j - 1];
+        hashes[j] = hash;
+        key->source_size += source_size;
+    }
+
+    hash = glsl_hash_data(0xcbf29ce484222325ull, hashes, shader_count * sizeof(*hashes));
+    key->source_hash = glsl_hash_data(hash, link_state, link_state_size);
+
+    return TRUE;
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_link_program(const struct wined3d_gl_info *gl_info, struct shader_glsl_priv *priv,
+        GLuint program, const void *link_state, size_t link_state_size)
+{
+    struct glsl_program_binary_cache *cache = &priv->binary_cache;
+    struct glsl_program_binary_record *record;
+    struct glsl_program_binary_key key;
+    struct glsl_program_binary *binary;
+    struct wine_rb_entry *entry;
+    GLint status, size;
+    GLenum format;
+    void *data;
+
+    if (!glsl_program_binary_cache_init(cache, gl_info)
+            || !shader_glsl_get_program_binary_key(gl_info, program, link_state, link_state_size, &key))
+    {
+        GL_EXTCALL(glLinkProgram(program));
+        shader_glsl_validate_link(gl_info, program);
+        return;
+    }
+
+    if ((entry = wine_rb_get(&cache->binaries, &key)))
+    {
+        binary = WINE_RB_ENTRY_VALUE(entry, struct glsl_program_binary, entry);
+        if (!(record = glsl_program_binary_cache_read(cache, binary)))
+        {
+            TRACE("Failed to read cached binary for program %u.\n", program);
+        }
+        else
+        {
+            GL_EXTCALL(glProgramBinary(program, record->format, record + 1, record->size));
+            heap_free(record);
+            GL_EXTCALL(glGetProgramiv(program, GL_LINK_STATUS, &status));
+            if (status)
+            {
+                TRACE("Loaded GLSL program %u from the program binary cache.\n", program);
+                ++cache->hit_count;
+                return;
+            }
+            WARN("Failed to load cached binary for program %u, relinking.\n", program);
+        }
+        wine_rb_remove(&cache->binaries, entry);
+        heap_free(binary);
+    }
+
+    GL_EXTCALL(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    GL_EXTCALL(glLinkProgram(program));
+    shader_glsl_validate_link(gl_info, program);
+    ++cache->miss_count;
+
+    GL_EXTCALL(glGetProgramiv(program, GL_LINK_STATUS, &status));
+    GL_EXTCALL(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size));
+    checkGLcall("query program binary length");
+    if (!status || size <= 0 || !(data = heap_alloc(size)))
+        return;
+    GL_EXTCALL(glGetProgramBinary(program, size, &size, &format, data));
+    checkGLcall("glGetProgramBinary");
+    glsl_program_binary_cache_write(cache, &key, format, data, size);
+    heap_free(data);
+}
+
 static BOOL shader_glsl_use_layout_qualifier(const struct wined3d_gl_info *gl_info)
 {
     /* Layout qualifiers were introduced in GLSL 1.40. The Nvidia Legacy GPU
@@ -10178,8 +10644,7 @@ static HRESULT shader_glsl_compile_compute_shader(struct shader_glsl_priv *priv,
     list_add_head(&shader->linked_programs, &entry->cs.shader_entry);
 
     TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    shader_glsl_link_program(gl_info, priv, program_id, NULL, 0);
 
     GL_EXTCALL(glUseProgram(program_id));
     checkGLcall("glUseProgram");
@@ -10509,8 +10974,18 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
 
     /* Link the program */
     TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    if (gshader && gshader->u.gs.so_desc)
+    {
+        /* The transform feedback varyings aren't covered by the binary cache key. */
+        GL_EXTCALL(glLinkProgram(program_id));
+        shader_glsl_validate_link(gl_info, program_id);
+    }
+    else
+    {
+        BOOL dual_source = state->blend_state && state->blend_state->dual_source;
+
+        shader_glsl_link_program(gl_info, priv, program_id, &dual_source, sizeof(dual_source));
+    }
 
     shader_glsl_init_vs_uniform_locations(gl_info, priv, program_id, &entry->vs,
             vshader ? vshader->limits->constant_float : 0);
@@ -11096,6 +11571,8 @@ static HRESULT shader_glsl_alloc(struct wined3d_device *device, const struct win
     }
 
     wine_rb_init(&priv->program_lookup, glsl_program_key_compare);
+    wine_rb_init(&priv->binary_cache.binaries, glsl_program_binary_compare);
+    priv->binary_cache.file = INVALID_HANDLE_VALUE;
 
     priv->next_constant_version = 1;
     priv->vertex_pipe = vertex_pipe;
@@ -11126,6 +11603,12 @@ static void shader_glsl_free(struct wined3d_device *device, struct wined3d_conte
 {
     struct shader_glsl_priv *priv = device->shader_priv;
 
+    if (priv->binary_cache.hit_count || priv->binary_cache.miss_count)
+        TRACE("Program binary cache: %u hits, %u misses.\n",
+                priv->binary_cache.hit_count, priv->binary_cache.miss_count);
+    if (priv->binary_cache.file != INVALID_HANDLE_VALUE)
+        CloseHandle(priv->binary_cache.file);
+    wine_rb_destroy(&priv->binary_cache.binaries, glsl_free_program_binary, NULL);
     wine_rb_destroy(&priv->program_lookup, NULL, NULL);
     constant_heap_free(&priv->pconst_heap);
     constant_heap_free(&priv->vconst_heap);
@@ -67,6 +67,19 @@ struct shader_spirv_compile_arguments
     } u;
 };
 
+struct shader_spirv_compile_job_vk
+{
+    TP_WORK *work;
+    struct wined3d_device_vk *device_vk;
+    struct wined3d_shader_desc shader_desc;
+    enum wined3d_shader_type shader_type;
+    struct shader_spirv_compile_arguments args;
+    struct shader_spirv_resource_bindings bindings;
+
+    VkShaderModule vk_module;
+    LONG done;
+};
+
 struct shader_spirv_graphics_program_variant_vk
 {
     struct shader_spirv_compile_arguments compile_args;
@@ -74,6 +87,7 @@ struct shader_spirv_graphics_program_variant_vk
     size_t binding_base;
 
     VkShaderModule vk_module;
+    struct shader_spirv_compile_job_vk *job;
 };
 
 struct shader_spirv_graphics_program_vk
@@ -86,10 +100,13 @@ struct shader_spirv_graphics_program_vk
 
 struct shader_spirv_compute_program_vk
 {
+    struct shader_spirv_compile_job_vk *job;
+    bool compile_failed;
     VkShaderModule vk_module;
     VkPipeline vk_pipeline;
     VkPipelineLayout vk_pipeline_layout;
     VkDescriptorSetLayout vk_set_layout;
+    VkDescriptorUpdateTemplate vk_update_template;
 
     struct vkd3d_shader_scan_descriptor_info descriptor_info;
 };
@@ -228,7 +245,7 @@ static void shader_spirv_init_shader_interface_vk(struct wined3d_shader_spirv_sh
     iface->vkd3d_interface.uav_counter_count = b->uav_counter_count;
 }
 
-static VkShaderModule shader_spirv_compile_shader(struct wined3d_context_vk *context_vk,
+static VkShaderModule shader_spirv_compile_shader(struct wined3d_device_vk *device_vk,
         const struct wined3d_shader_desc *shader_desc, enum wined3d_shader_type shader_type,
         const struct shader_spirv_compile_arguments *args, const struct shader_spirv_resource_bindings *bindings,
         const struct wined3d_stream_output_desc *so_desc)
@@ -238,7 +255,6 @@ static VkShaderModule shader_spirv_compile_shader(struct wined3d_context_vk *con
     VkShaderModuleCreateInfo shader_create_info;
     struct vkd3d_shader_compile_info info;
     const struct wined3d_vk_info *vk_info;
-    struct wined3d_device_vk *device_vk;
     struct vkd3d_shader_code spirv;
     VkShaderModule module;
     char *messages;
@@ -282,7 +298,6 @@ static VkShaderModule shader_spirv_compile_shader(struct wined3d_context_vk *con
         return VK_NULL_HANDLE;
     }
 
-    device_vk = wined3d_device_vk(context_vk->c.device);
     vk_info = &device_vk->vk_info;
 
     shader_create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -302,10 +317,85 @@ static VkShaderModule shader_spirv_compile_shader(struct wined3d_context_vk *con
     return module;
 }
 
+static void CALLBACK shader_spirv_compile_job_cb(TP_CALLBACK_INSTANCE *instance, void *ctx, TP_WORK *work)
+{
+    struct shader_spirv_compile_job_vk *job = ctx;
+
+    job->vk_module = shader_spirv_compile_shader(job->device_vk, &job->shader_desc,
+            job->shader_type, &job->args, &job->bindings, NULL);
+    InterlockedExchange(&job->done, 1);
+}
+
+/* Compile a shader variant on the thread pool. The shader byte code has to
+ * stay valid until the job is finished with shader_spirv_compile_job_finish(). */
+static struct shader_spirv_compile_job_vk *shader_spirv_compile_job_create(struct wined3d_device_vk *device_vk,
+        const struct wined3d_shader *shader, enum wined3d_shader_type shader_type,
+        const struct shader_spirv_compile_arguments *args, const struct shader_spirv_resource_bindings *bindings)
+{
+    struct shader_spirv_compile_job_vk *job;
+
+    if (!(job = heap_alloc_zero(sizeof(*job))))
+        return NULL;
+
+    job->device_vk = device_vk;
+    job->shader_desc.byte_code = shader->byte_code;
+    job->shader_desc.byte_code_size = shader->byte_code_size;
+    job->shader_type = shader_type;
+    if (args)
+        job->args = *args;
+
+    if (bindings->binding_count && !(job->bindings.bindings = heap_calloc(bindings->binding_count,
+            sizeof(*job->bindings.bindings))))
+    {
+        heap_free(job);
+        return NULL;
+    }
+    memcpy(job->bindings.bindings, bindings->bindings, bindings->binding_count * sizeof(*bindings->bindings));
+    job->bindings.bindings_size = job->bindings.binding_count = bindings->binding_count;
+    memcpy(job->bindings.uav_counters, bindings->uav_counters,
+            bindings->uav_counter_count * sizeof(*bindings->uav_counters));
+    job->bindings.uav_counter_count = bindings->uav_counter_count;
+
+    if (!(job->work = CreateThreadpoolWork(shader_spirv_compile_job_cb, job, NULL)))
+    {
+        ERR("Failed to create thread pool work, error %lu.\n", GetLastError());
+        heap_free(job->bindings.bindings);
+        heap_free(job);
+        return NULL;
+    }
+    SubmitThreadpoolWork(job->work);
+
+    TRACE("Submitted %s shader %p compile job %p.\n", debug_shader_type(shader_type), shader, job);
+
+    return job;
+}
+
+static bool shader_spirv_compile_job_done(const struct shader_spirv_compile_job_vk *job)
+{
+    return InterlockedCompareExchange((LONG *)&job->done, 0, 0);
+}
+
+/* Wait for the job to complete, free it, and return the compiled module. */
+static VkShaderModule shader_spirv_compile_job_finish(struct shader_spirv_compile_job_vk *job)
+{
+    VkShaderModule vk_module;
+
+    WaitForThreadpoolWorkCallbacks(job->work, FALSE);
+    CloseThreadpoolWork(job->work);
+
+    vk_module = job->vk_module;
+    heap_free(job->bindings.bindings);
+    heap_free(job);
+
+    return vk_module;
+}
+
 static struct shader_spirv_graphics_program_variant_vk *shader_spirv_find_graphics_program_variant_vk(
         struct shader_spirv_priv *priv, struct wined3d_context_vk *context_vk, struct wined3d_shader *shader,
-        const struct wined3d_state *state, const struct shader_spirv_resource_bindings *bindings)
+        const struct wined3d_state *state, const struct shader_spirv_resource_bindings *bindings, bool *pending)
 {
+    bool skip_draws = wined3d_settings.async_shader_compile == WINED3D_ASYNC_SHADER_COMPILE_SKIP_DRAWS;
+    struct wined3d_device_vk *device_vk = wined3d_device_vk(context_vk->c.device);
     enum wined3d_shader_type shader_type = shader->reg_maps.shader_version.type;
     struct shader_spirv_graphics_program_variant_vk *variant_vk;
     size_t binding_base = bindings->binding_base[shader_type];
@@ -315,6 +405,8 @@ static struct shader_spirv_graphics_program_variant_vk *shader_spirv_find_graphi
     struct wined3d_shader_desc shader_desc;
     size_t variant_count, i;
 
+    *pending = false;
+
     shader_spirv_compile_arguments_init(&args, &context_vk->c, shader, state, context_vk->sample_count);
     if (bindings->so_stage == shader_type)
         so_desc = state->shader[WINED3D_SHADER_TYPE_GEOMETRY]->u.gs.so_desc;
@@ -326,9 +418,22 @@ static struct shader_spirv_graphics_program_variant_vk *shader_spirv_find_graphi
     for (i = 0; i < variant_count; ++i)
     {
         variant_vk = &program_vk->variants[i];
-        if (variant_vk->so_desc == so_desc && variant_vk->binding_base == binding_base
-                && !memcmp(&variant_vk->compile_args, &args, sizeof(args)))
-            return variant_vk;
+        if (variant_vk->so_desc != so_desc || variant_vk->binding_base != binding_base
+                || memcmp(&variant_vk->compile_args, &args, sizeof(args)))
+            continue;
+
+        if (variant_vk->job)
+        {
+            if (skip_draws && !shader_spirv_compile_job_done(variant_vk->job))
+            {
+                *pending = true;
+                return NULL;
+            }
+            variant_vk->vk_module = shader_spirv_compile_job_finish(variant_vk->job);
+            variant_vk->job = NULL;
+        }
+
+        return variant_vk->vk_module ? variant_vk : NULL;
     }
 
     if (!wined3d_array_reserve((void **)&program_vk->variants, &program_vk->variants_size,
@@ -338,11 +443,25 @@ static struct shader_spirv_graphics_program_variant_vk *shader_spirv_find_graphi
     variant_vk = &program_vk->variants[variant_count];
     variant_vk->compile_args = args;
     variant_vk->binding_base = binding_base;
+    variant_vk->vk_module = VK_NULL_HANDLE;
+    variant_vk->job = NULL;
+
+    /* Stream output variants are rare enough that they're always compiled
+     * synchronously; that keeps the job from referencing the geometry
+     * shader's stream output description. */
+    if (skip_draws && !so_desc)
+    {
+        if (!(variant_vk->job = shader_spirv_compile_job_create(device_vk, shader, shader_type, &args, bindings)))
+            return NULL;
+        ++program_vk->variant_count;
+        *pending = true;
+        return NULL;
+    }
 
     shader_desc.byte_code = shader->byte_code;
     shader_desc.byte_code_size = shader->byte_code_size;
 
-    if (!(variant_vk->vk_module = shader_spirv_compile_shader(context_vk, &shader_desc, shader_type, &args,
+    if (!(variant_vk->vk_module = shader_spirv_compile_shader(device_vk, &shader_desc, shader_type, &args,
             bindings, so_desc)))
         return NULL;
     ++program_vk->variant_count;
@@ -352,8 +471,9 @@ static struct shader_spirv_graphics_program_variant_vk *shader_spirv_find_graphi
 
 static struct shader_spirv_compute_program_vk *shader_spirv_find_compute_program_vk(struct shader_spirv_priv *priv,
         struct wined3d_context_vk *context_vk, struct wined3d_shader *shader,
-        const struct shader_spirv_resource_bindings *bindings)
+        const struct shader_spirv_resource_bindings *bindings, bool *pending)
 {
+    bool skip_dispatches = wined3d_settings.async_shader_compile == WINED3D_ASYNC_SHADER_COMPILE_SKIP_DRAWS;
     struct wined3d_device_vk *device_vk = wined3d_device_vk(context_vk->c.device);
     const struct wined3d_vk_info *vk_info = context_vk->vk_info;
     struct shader_spirv_compute_program_vk *program;
@@ -362,18 +482,46 @@ static struct shader_spirv_compute_program_vk *shader_spirv_find_compute_program
     struct wined3d_shader_desc shader_desc;
     VkResult vr;
 
+    *pending = false;
+
     if (!(program = shader->backend_data))
         return NULL;
 
     if (program->vk_module)
         return program;
 
+    if (program->compile_failed)
+        return NULL;
+
+    if (skip_dispatches && !program->job)
+        program->job = shader_spirv_compile_job_create(device_vk, shader, WINED3D_SHADER_TYPE_COMPUTE, NULL, bindings);
+
+    if (program->job)
+    {
+        if (skip_dispatches && !shader_spirv_compile_job_done(program->job))
+        {
+            *pending = true;
+            return NULL;
+        }
+        program->vk_module = shader_spirv_compile_job_finish(program->job);
+        program->job = NULL;
+        /* The job compiled the same variant, don't compile or submit it again. */
+        if (!program->vk_module)
+        {
+            program->compile_failed = true;
+            return NULL;
+        }
+    }
+
     shader_desc.byte_code = shader->byte_code;
     shader_desc.byte_code_size = shader->byte_code_size;
 
-    if (!(program->vk_module = shader_spirv_compile_shader(context_vk, &shader_desc, WINED3D_SHADER_TYPE_COMPUTE,
-            NULL, bindings, NULL)))
+    if (!program->vk_module && !(program->vk_module = shader_spirv_compile_shader(device_vk,
+            &shader_desc, WINED3D_SHADER_TYPE_COMPUTE, NULL, bindings, NULL)))
+    {
+        program->compile_failed = true;
         return NULL;
+    }
 
     if (!(layout = wined3d_context_vk_get_pipeline_layout(context_vk,
             bindings->vk_bindings, bindings->vk_binding_count)))
@@ -384,6 +532,7 @@ static struct shader_spirv_compute_program_vk *shader_spirv_find_compute_program
     }
     program->vk_set_layout = layout->vk_set_layout;
     program->vk_pipeline_layout = layout->vk_pipeline_layout;
+    program->vk_update_template = layout->vk_update_template;
 
     pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
     pipeline_info.pNext = NULL;
@@ -399,13 +548,14 @@ static struct shader_spirv_compute_program_vk *shader_spirv_find_compute_program
     pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
     pipeline_info.basePipelineIndex = -1;
     if ((vr = VK_CALL(vkCreateComputePipelines(device_vk->vk_device,
-            VK_NULL_HANDLE, 1, &pipeline_info, NULL, &program->vk_pipeline))) < 0)
+            device_vk->pipeline_cache.vk_pipeline_cache, 1, &pipeline_info, NULL, &program->vk_pipeline))) < 0)
     {
         ERR("Failed to create Vulkan compute pipeline, vr %s.\n", wined3d_debug_vkresult(vr));
         VK_CALL(vkDestroyShaderModule(device_vk->vk_device, program->vk_module, NULL));
         program->vk_module = VK_NULL_HANDLE;
         return NULL;
     }
+    wined3d_device_vk_pipeline_created(device_vk, NULL);
 
     return program;
 }
@@ -594,18 +744,81 @@ static enum wined3d_data_type wined3d_data_type_from_vkd3d(enum vkd3d_shader_res
     }
 }
 
+static bool shader_spirv_resource_bindings_add_shader(struct shader_spirv_resource_bindings *bindings,
+        struct wined3d_shader_resource_bindings *wined3d_bindings, enum wined3d_shader_type shader_type,
+        const struct vkd3d_shader_scan_descriptor_info *descriptor_info)
+{
+    enum vkd3d_shader_visibility shader_visibility;
+    enum wined3d_shader_descriptor_type wined3d_type;
+    VkDescriptorType vk_descriptor_type;
+    VkShaderStageFlagBits vk_stage;
+    size_t binding_idx;
+    unsigned int i;
+
+    vk_stage = vk_shader_stage_from_wined3d(shader_type);
+    shader_visibility = vkd3d_shader_visibility_from_wined3d(shader_type);
+
+    for (i = 0; i < descriptor_info->descriptor_count; ++i)
+    {
+        const struct vkd3d_shader_descriptor_info *d = &descriptor_info->descriptors[i];
+        uint32_t flags;
+
+        if (d->register_space)
+        {
+            WARN("Unsupported register space %u.\n", d->register_space);
+            return false;
+        }
+
+        if (d->resource_type == VKD3D_SHADER_RESOURCE_BUFFER)
+            flags = VKD3D_SHADER_BINDING_FLAG_BUFFER;
+        else
+            flags = VKD3D_SHADER_BINDING_FLAG_IMAGE;
+
+        vk_descriptor_type = vk_descriptor_type_from_vkd3d(d->type, d->resource_type);
+        if (!shader_spirv_resource_bindings_add_binding(bindings, d->type, vk_descriptor_type,
+                d->register_index, shader_visibility, vk_stage, flags, &binding_idx))
+            return false;
+
+        wined3d_type = wined3d_descriptor_type_from_vkd3d(d->type);
+        if (wined3d_bindings && !wined3d_shader_resource_bindings_add_binding(wined3d_bindings, shader_type,
+                wined3d_type, d->register_index, wined3d_shader_resource_type_from_vkd3d(d->resource_type),
+                wined3d_data_type_from_vkd3d(d->resource_data_type), binding_idx))
+            return false;
+
+        if (d->type == VKD3D_SHADER_DESCRIPTOR_TYPE_UAV
+                && (d->flags & VKD3D_SHADER_DESCRIPTOR_INFO_FLAG_UAV_COUNTER))
+        {
+            if (!shader_spirv_resource_bindings_add_uav_counter_binding(bindings,
+                    d->register_index, shader_visibility, vk_stage, &binding_idx))
+                return false;
+            if (wined3d_bindings && !wined3d_shader_resource_bindings_add_binding(wined3d_bindings,
+                    shader_type, WINED3D_SHADER_DESCRIPTOR_TYPE_UAV_COUNTER, d->register_index,
+                    WINED3D_SHADER_RESOURCE_BUFFER, WINED3D_DATA_UINT, binding_idx))
+                return false;
+        }
+    }
+
+    return true;
+}
+
 static bool shader_spirv_resource_bindings_init(struct shader_spirv_resource_bindings *bindings,
         struct wined3d_shader_resource_bindings *wined3d_bindings,
         const struct wined3d_state *state, uint32_t shader_mask)
 {
+    /* Vertex shader bindings come first, so that they don't depend on the
+     * other stages and shader_spirv_precompile() can compile them early. */
+    static const enum wined3d_shader_type binding_order[] =
+    {
+        WINED3D_SHADER_TYPE_VERTEX,
+        WINED3D_SHADER_TYPE_PIXEL,
+        WINED3D_SHADER_TYPE_GEOMETRY,
+        WINED3D_SHADER_TYPE_HULL,
+        WINED3D_SHADER_TYPE_DOMAIN,
+        WINED3D_SHADER_TYPE_COMPUTE,
+    };
     const struct vkd3d_shader_scan_descriptor_info *descriptor_info;
-    enum wined3d_shader_descriptor_type wined3d_type;
-    enum vkd3d_shader_visibility shader_visibility;
     enum wined3d_shader_type shader_type;
-    VkDescriptorType vk_descriptor_type;
-    VkShaderStageFlagBits vk_stage;
     struct wined3d_shader *shader;
-    size_t binding_idx;
     unsigned int i;
 
     bindings->binding_count = 0;
@@ -614,8 +827,9 @@ static bool shader_spirv_resource_bindings_init(struct shader_spirv_resource_bin
     bindings->so_stage = WINED3D_SHADER_TYPE_GEOMETRY;
     wined3d_bindings->count = 0;
 
-    for (shader_type = 0; shader_type < WINED3D_SHADER_TYPE_COUNT; ++shader_type)
+    for (i = 0; i < ARRAY_SIZE(binding_order); ++i)
     {
+        shader_type = binding_order[i];
         bindings->binding_base[shader_type] = bindings->vk_binding_count;
 
         if (!(shader_mask & (1u << shader_type)) || !(shader = state->shader[shader_type]))
@@ -632,48 +846,8 @@ static bool shader_spirv_resource_bindings_init(struct shader_spirv_resource_bin
                 bindings->so_stage = WINED3D_SHADER_TYPE_VERTEX;
         }
 
-        vk_stage = vk_shader_stage_from_wined3d(shader_type);
-        shader_visibility = vkd3d_shader_visibility_from_wined3d(shader_type);
-
-        for (i = 0; i < descriptor_info->descriptor_count; ++i)
-        {
-            const struct vkd3d_shader_descriptor_info *d = &descriptor_info->descriptors[i];
-            uint32_t flags;
-
-            if (d->register_space)
-            {
-                WARN("Unsupported register space %u.\n", d->register_space);
-                return false;
-            }
-
-            if (d->resource_type == VKD3D_SHADER_RESOURCE_BUFFER)
-                flags = VKD3D_SHADER_BINDING_FLAG_BUFFER;
-            else
-                flags = VKD3D_SHADER_BINDING_FLAG_IMAGE;
-
-            vk_descriptor_type = vk_descriptor_type_from_vkd3d(d->type, d->resource_type);
-            if (!shader_spirv_resource_bindings_add_binding(bindings, d->type, vk_descriptor_type,
-                    d->register_index, shader_visibility, vk_stage, flags, &binding_idx))
-                return false;
-
-            wined3d_type = wined3d_descriptor_type_from_vkd3d(d->type);
-            if (!wined3d_shader_resource_bindings_add_binding(wined3d_bindings, shader_type,
-                    wined3d_type, d->register_index, wined3d_shader_resource_type_from_vkd3d(d->resource_type),
-                    wined3d_data_type_from_vkd3d(d->resource_data_type), binding_idx))
-                return false;
-
-            if (d->type == VKD3D_SHADER_DESCRIPTOR_TYPE_UAV
-                    && (d->flags & VKD3D_SHADER_DESCRIPTOR_INFO_FLAG_UAV_COUNTER))
-            {
-                if (!shader_spirv_resource_bindings_add_uav_counter_binding(bindings,
-                        d->register_index, shader_visibility, vk_stage, &binding_idx))
-                    return false;
-                if (!wined3d_shader_resource_bindings_add_binding(wined3d_bindings,
-                        shader_type, WINED3D_SHADER_DESCRIPTOR_TYPE_UAV_COUNTER, d->register_index,
-                        WINED3D_SHADER_RESOURCE_BUFFER, WINED3D_DATA_UINT, binding_idx))
-                    return false;
-            }
-        }
+        if (!shader_spirv_resource_bindings_add_shader(bindings, wined3d_bindings, shader_type, descriptor_info))
+            return false;
     }
 
     return true;
@@ -718,6 +892,28 @@ static void shader_spirv_scan_shader(struct wined3d_shader *shader,
     vkd3d_shader_free_messages(messages);
 }
 
+/* Vertex and compute shaders always start at binding 0 (see
+ * shader_spirv_resource_bindings_init()), so their most common variant can be
+ * compiled ahead of the first draw using only the shader's own descriptors.
+ * The other stages depend on the preceding stages' bindings. */
+static struct shader_spirv_compile_job_vk *shader_spirv_precompile_default_variant(struct wined3d_shader *shader,
+        const struct vkd3d_shader_scan_descriptor_info *descriptor_info)
+{
+    enum wined3d_shader_type shader_type = shader->reg_maps.shader_version.type;
+    struct shader_spirv_compile_job_vk *job = NULL;
+    struct shader_spirv_resource_bindings bindings;
+
+    if (wined3d_settings.async_shader_compile == WINED3D_ASYNC_SHADER_COMPILE_DISABLED)
+        return NULL;
+
+    memset(&bindings, 0, sizeof(bindings));
+    if (shader_spirv_resource_bindings_add_shader(&bindings, NULL, shader_type, descriptor_info))
+        job = shader_spirv_compile_job_create(wined3d_device_vk(shader->device), shader, shader_type, NULL, &bindings);
+    shader_spirv_resource_bindings_cleanup(&bindings);
+
+    return job;
+}
+
 static void shader_spirv_precompile_compute(struct wined3d_shader *shader)
 {
     struct shader_spirv_compute_program_vk *program_vk;
@@ -730,10 +926,12 @@ static void shader_spirv_precompile_compute(struct wined3d_shader *shader)
     }
 
     shader_spirv_scan_shader(shader, &program_vk->descriptor_info);
+    program_vk->job = shader_spirv_precompile_default_variant(shader, &program_vk->descriptor_info);
 }
 
 static void shader_spirv_precompile(void *shader_priv, struct wined3d_shader *shader)
 {
+    struct shader_spirv_graphics_program_variant_vk *variant_vk;
     struct shader_spirv_graphics_program_vk *program_vk;
 
     TRACE("shader_priv %p, shader %p.\n", shader_priv, shader);
@@ -752,6 +950,16 @@ static void shader_spirv_precompile(void *shader_priv, struct wined3d_shader *sh
     }
 
     shader_spirv_scan_shader(shader, &program_vk->descriptor_info);
+
+    if (shader->reg_maps.shader_version.type != WINED3D_SHADER_TYPE_VERTEX || program_vk->variant_count
+            || !wined3d_array_reserve((void **)&program_vk->variants, &program_vk->variants_size,
+            1, sizeof(*program_vk->variants)))
+        return;
+
+    variant_vk = &program_vk->variants[0];
+    memset(variant_vk, 0, sizeof(*variant_vk));
+    if ((variant_vk->job = shader_spirv_precompile_default_variant(shader, &program_vk->descriptor_info)))
+        program_vk->variant_count = 1;
 }
 
 static void shader_spirv_select(void *shader_priv, struct wined3d_context *context,
@@ -765,6 +973,7 @@ static void shader_spirv_select(void *shader_priv, struct wined3d_context *conte
     struct shader_spirv_priv *priv = shader_priv;
     enum wined3d_shader_type shader_type;
     struct wined3d_shader *shader;
+    bool pending;
 
     priv->vertex_pipe->vp_enable(context, !use_vs(state));
     priv->fragment_pipe->fp_enable(context, !use_ps(state));
@@ -783,6 +992,7 @@ static void shader_spirv_select(void *shader_priv, struct wined3d_context *conte
     layout_vk = wined3d_context_vk_get_pipeline_layout(context_vk, bindings->vk_bindings, bindings->vk_binding_count);
     context_vk->graphics.vk_set_layout = layout_vk->vk_set_layout;
     context_vk->graphics.vk_pipeline_layout = layout_vk->vk_pipeline_layout;
+    context_vk->graphics.vk_update_template = layout_vk->vk_update_template;
 
     for (shader_type = 0; shader_type < ARRAY_SIZE(context_vk->graphics.vk_modules); ++shader_type)
     {
@@ -796,8 +1006,13 @@ static void shader_spirv_select(void *shader_priv, struct wined3d_context *conte
             continue;
         }
 
-        if (!(variant_vk = shader_spirv_find_graphics_program_variant_vk(priv, context_vk, shader, state, bindings)))
+        if (!(variant_vk = shader_spirv_find_graphics_program_variant_vk(priv,
+                context_vk, shader, state, bindings, &pending)))
+        {
+            if (pending)
+                context_vk->shaders_pending = 1;
             goto fail;
+        }
         context_vk->graphics.vk_modules[shader_type] = variant_vk->vk_module;
     }
 
@@ -806,6 +1021,7 @@ static void shader_spirv_select(void *shader_priv, struct wined3d_context *conte
 fail:
     context_vk->graphics.vk_set_layout = VK_NULL_HANDLE;
     context_vk->graphics.vk_pipeline_layout = VK_NULL_HANDLE;
+    context_vk->graphics.vk_update_template = VK_NULL_HANDLE;
 }
 
 static void shader_spirv_select_compute(void *shader_priv,
@@ -815,27 +1031,33 @@ static void shader_spirv_select_compute(void *shader_priv,
     struct shader_spirv_compute_program_vk *program;
     struct shader_spirv_priv *priv = shader_priv;
     struct wined3d_shader *shader;
+    bool pending = false;
 
     if (!shader_spirv_resource_bindings_init(&priv->bindings,
             &context_vk->compute.bindings, state, 1u << WINED3D_SHADER_TYPE_COMPUTE))
         ERR("Failed to initialise shader resource bindings.\n");
 
     if ((shader = state->shader[WINED3D_SHADER_TYPE_COMPUTE]))
-        program = shader_spirv_find_compute_program_vk(priv, context_vk, shader, &priv->bindings);
+        program = shader_spirv_find_compute_program_vk(priv, context_vk, shader, &priv->bindings, &pending);
     else
         program = NULL;
 
+    if (pending)
+        context_vk->shaders_pending = 1;
+
     if (program)
     {
         context_vk->compute.vk_pipeline = program->vk_pipeline;
         context_vk->compute.vk_set_layout = program->vk_set_layout;
         context_vk->compute.vk_pipeline_layout = program->vk_pipeline_layout;
+        context_vk->compute.vk_update_template = program->vk_update_template;
     }
     else
     {
         context_vk->compute.vk_pipeline = VK_NULL_HANDLE;
         context_vk->compute.vk_set_layout = VK_NULL_HANDLE;
         context_vk->compute.vk_pipeline_layout = VK_NULL_HANDLE;
+        context_vk->compute.vk_update_template = VK_NULL_HANDLE;
     }
 }
 
@@ -926,6 +1148,8 @@ static void shader_spirv_destroy_compute_vk(struct wined3d_shader *shader)
     struct wined3d_context_vk *context_vk = &device_vk->context_vk;
     struct wined3d_vk_info *vk_info = &device_vk->vk_info;
 
+    if (program->job)
+        VK_CALL(vkDestroyShaderModule(device_vk->vk_device, shader_spirv_compile_job_finish(program->job), NULL));
     shader_spirv_invalidate_contexts_compute_program(&device_vk->d, program);
     wined3d_context_vk_destroy_vk_pipeline(context_vk, program->vk_pipeline, context_vk->current_command_buffer.id);
     VK_CALL(vkDestroyShaderModule(device_vk->vk_device, program->vk_module, NULL));
@@ -955,6 +1179,11 @@ static void shader_spirv_destroy(struct wined3d_shader *shader)
     for (i = 0; i < program_vk->variant_count; ++i)
     {
         variant_vk = &program_vk->variants[i];
+        if (variant_vk->job)
+        {
+            variant_vk->vk_module = shader_spirv_compile_job_finish(variant_vk->job);
+            variant_vk->job = NULL;
+        }
         shader_spirv_invalidate_contexts_graphics_program_variant(&device_vk->d, variant_vk);
         VK_CALL(vkDestroyShaderModule(device_vk->vk_device, variant_vk->vk_module, NULL));
     }
@@ -1260,6 +1260,8 @@ static void swapchain_vk_present(struct wined3d_swapchain *swapchain, const RECT
     wined3d_texture_validate_location(swapchain->front_buffer, 0, WINED3D_LOCATION_DRAWABLE);
     wined3d_texture_invalidate_location(swapchain->front_buffer, 0, ~WINED3D_LOCATION_DRAWABLE);
 
+    wined3d_context_vk_report_upload_stats(context_vk);
+
     TRACE("Starting new frame.\n");
 
     context_release(&context_vk->c);
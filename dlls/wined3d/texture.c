@@ -4875,6 +4875,7 @@ static void wined3d_texture_vk_upload_data(struct wined3d_context *context,
     VkImageSubresourceRange vk_range;
     struct wined3d_bo_vk staging_bo;
     VkImageAspectFlags aspect_mask;
+    VkDeviceSize ring_offset;
     struct wined3d_bo_vk *src_bo;
     struct wined3d_range range;
     VkBufferImageCopy region;
@@ -4948,35 +4949,48 @@ static void wined3d_texture_vk_upload_data(struct wined3d_context *context,
                 &staging_row_pitch, &staging_slice_pitch);
         staging_size = staging_slice_pitch * src_depth;
 
-        if (!wined3d_context_vk_create_bo(context_vk, staging_size,
-                VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, &staging_bo))
+        if ((map_ptr = wined3d_context_vk_upload_ring_alloc(context_vk, staging_size, &src_bo, &ring_offset)))
         {
-            ERR("Failed to create staging bo.\n");
-            return;
-        }
+            wined3d_format_copy_data(src_format, src_bo_addr->addr + src_offset, src_row_pitch, src_slice_pitch,
+                    map_ptr, staging_row_pitch, staging_slice_pitch, src_width, src_height, src_depth);
 
-        staging_bo_addr.buffer_object = &staging_bo.b;
-        staging_bo_addr.addr = NULL;
-        if (!(map_ptr = wined3d_context_map_bo_address(context, &staging_bo_addr,
-                staging_size, WINED3D_MAP_DISCARD | WINED3D_MAP_WRITE)))
-        {
-            ERR("Failed to map staging bo.\n");
-            wined3d_context_vk_destroy_bo(context_vk, &staging_bo);
-            return;
+            src_offset = ring_offset;
+            src_row_pitch = staging_row_pitch;
+            src_slice_pitch = staging_slice_pitch;
+            vk_barrier.srcAccessMask = 0;
         }
+        else
+        {
+            if (!wined3d_context_vk_create_bo(context_vk, staging_size,
+                    VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, &staging_bo))
+            {
+                ERR("Failed to create staging bo.\n");
+                return;
+            }
 
-        wined3d_format_copy_data(src_format, src_bo_addr->addr + src_offset, src_row_pitch, src_slice_pitch,
-                map_ptr, staging_row_pitch, staging_slice_pitch, src_width, src_height, src_depth);
+            staging_bo_addr.buffer_object = &staging_bo.b;
+            staging_bo_addr.addr = NULL;
+            if (!(map_ptr = wined3d_context_map_bo_address(context, &staging_bo_addr,
+                    staging_size, WINED3D_MAP_DISCARD | WINED3D_MAP_WRITE)))
+            {
+                ERR("Failed to map staging bo.\n");
+                wined3d_context_vk_destroy_bo(context_vk, &staging_bo);
+                return;
+            }
 
-        range.offset = 0;
-        range.size = staging_size;
-        wined3d_context_unmap_bo_address(context, &staging_bo_addr, 1, &range);
+            wined3d_format_copy_data(src_format, src_bo_addr->addr + src_offset, src_row_pitch, src_slice_pitch,
+                    map_ptr, staging_row_pitch, staging_slice_pitch, src_width, src_height, src_depth);
 
-        src_bo = &staging_bo;
+            range.offset = 0;
+            range.size = staging_size;
+            wined3d_context_unmap_bo_address(context, &staging_bo_addr, 1, &range);
 
-        src_offset = 0;
-        src_row_pitch = staging_row_pitch;
-        src_slice_pitch = staging_slice_pitch;
+            src_bo = &staging_bo;
+
+            src_offset = 0;
+            src_row_pitch = staging_row_pitch;
+            src_slice_pitch = staging_slice_pitch;
+        }
     }
     else
     {
@@ -129,6 +129,8 @@ struct wined3d_settings wined3d_settings =
     .max_sm_cs = UINT_MAX,
     .renderer = WINED3D_RENDERER_AUTO,
     .shader_backend = WINED3D_SHADER_BACKEND_AUTO,
+    .shader_cache = TRUE,
+    .async_shader_compile = WINED3D_ASYNC_SHADER_COMPILE_ENABLED,
 };
 
 enum wined3d_renderer CDECL wined3d_get_renderer(void)
@@ -259,6 +261,35 @@ BOOL wined3d_get_app_name(char *app_name, unsigned int app_name_size)
     return TRUE;
 }
 
+/* Cache files are stored per application, and keyed by a driver specific
+ * UUID, in %LOCALAPPDATA%\wine\wined3d. */
+BOOL wined3d_get_cache_file_path(const char *type, const uint8_t *uuid, unsigned int uuid_size,
+        char *path, unsigned int path_size)
+{
+    char app_name[MAX_PATH];
+    unsigned int len, i;
+
+    if (!wined3d_settings.shader_cache || !wined3d_get_app_name(app_name, ARRAY_SIZE(app_name)))
+        return FALSE;
+
+    if (!(len = GetEnvironmentVariableA("LOCALAPPDATA", path, path_size)) || len >= path_size)
+        return FALSE;
+    if (len + strlen("\\wine\\wined3d\\..") + strlen(app_name) + strlen(type) + 2 * uuid_size >= path_size)
+        return FALSE;
+
+    strcpy(path + len, "\\wine");
+    CreateDirectoryA(path, NULL);
+    strcat(path, "\\wined3d");
+    CreateDirectoryA(path, NULL);
+
+    len = strlen(path);
+    len += sprintf(path + len, "\\%s.%s.", app_name, type);
+    for (i = 0; i < uuid_size; ++i)
+        len += sprintf(path + len, "%02x", uuid[i]);
+
+    return TRUE;
+}
+
 static void vkd3d_log_callback(const char *fmt, va_list args)
 {
     char buffer[1024];
@@ -474,6 +505,10 @@ static BOOL wined3d_dll_init(HINSTANCE hInstDLL)
             TRACE("Forcing all constant buffers to be write-mappable.\n");
             wined3d_settings.cb_access_map_w = TRUE;
         }
+        if (!get_config_key_dword(hkey, appkey, env, "shader_cache", &wined3d_settings.shader_cache))
+            TRACE("Setting shader cache to %#x.\n", wined3d_settings.shader_cache);
+        if (!get_config_key_dword(hkey, appkey, env, "async_shader_compile", &wined3d_settings.async_shader_compile))
+            TRACE("Setting asynchronous shader compilation to %#x.\n", wined3d_settings.async_shader_compile);
     }
 
     if (appkey) RegCloseKey( appkey );
@@ -507,6 +507,15 @@ enum wined3d_shader_backend
 #define WINED3D_CSMT_ENABLE    0x00000001
 #define WINED3D_CSMT_SERIALIZE 0x00000002
 
+enum wined3d_async_shader_compile
+{
+    WINED3D_ASYNC_SHADER_COMPILE_DISABLED,
+    /* Compile likely shader variants in the background. */
+    WINED3D_ASYNC_SHADER_COMPILE_ENABLED,
+    /* Additionally skip draws and dispatches whose shaders aren't ready yet. */
+    WINED3D_ASYNC_SHADER_COMPILE_SKIP_DRAWS,
+};
+
 /* NOTE: When adding fields to this structure, make sure to update the default
  * values in wined3d_main.c as well. */
 struct wined3d_settings
@@ -532,6 +541,8 @@ struct wined3d_settings
     enum wined3d_renderer renderer;
     enum wined3d_shader_backend shader_backend;
     BOOL cb_access_map_w;
+    unsigned int shader_cache;
+    unsigned int async_shader_compile;
 };
 
 extern struct wined3d_settings wined3d_settings DECLSPEC_HIDDEN;
@@ -3365,6 +3376,8 @@ HRESULT wined3d_init(struct wined3d *wined3d, uint32_t flags) DECLSPEC_HIDDEN;
 void wined3d_unregister_window(HWND window) DECLSPEC_HIDDEN;
 
 BOOL wined3d_get_app_name(char *app_name, unsigned int app_name_size) DECLSPEC_HIDDEN;
+BOOL wined3d_get_cache_file_path(const char *type, const uint8_t *uuid, unsigned int uuid_size,
+        char *path, unsigned int path_size) DECLSPEC_HIDDEN;
 
 enum wined3d_push_constants
 {
@@ -4440,6 +4453,8 @@ enum wined3d_cs_queue_id
 #define WINED3D_CS_QUEUE_SIZE           0x400000u
 #endif
 #define WINED3D_CS_SPIN_COUNT           2000u
+#define WINED3D_CS_SPIN_COUNT_MIN       250u
+#define WINED3D_CS_SPIN_COUNT_MAX       32000u
 #define WINED3D_CS_QUEUE_MASK           (WINED3D_CS_QUEUE_SIZE - 1)
 
 C_ASSERT(!(WINED3D_CS_QUEUE_SIZE & (WINED3D_CS_QUEUE_SIZE - 1)));
@@ -4489,7 +4504,7 @@ struct wined3d_cs
     struct list query_poll_list;
     BOOL queries_flushed;
 
-    HANDLE event, present_event;
+    HANDLE present_event;
     LONG waiting_for_event;
     LONG waiting_for_present;
     LONG pending_presents;
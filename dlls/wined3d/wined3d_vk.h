@@ -179,6 +179,10 @@ struct wined3d_device_vk;
     VK_DEVICE_PFN(vkUnmapMemory) \
     VK_DEVICE_PFN(vkUpdateDescriptorSets) \
     VK_DEVICE_PFN(vkWaitForFences) \
+    /* VK_KHR_descriptor_update_template */ \
+    VK_DEVICE_EXT_PFN(vkCreateDescriptorUpdateTemplate) \
+    VK_DEVICE_EXT_PFN(vkDestroyDescriptorUpdateTemplate) \
+    VK_DEVICE_EXT_PFN(vkUpdateDescriptorSetWithTemplate) \
     /* VK_EXT_transform_feedback */ \
     VK_DEVICE_EXT_PFN(vkCmdBeginQueryIndexedEXT) \
     VK_DEVICE_EXT_PFN(vkCmdBeginTransformFeedbackEXT) \
@@ -218,6 +222,8 @@ enum wined3d_vk_extension
     WINED3D_VK_EXT_TRANSFORM_FEEDBACK,
     WINED3D_VK_KHR_SAMPLER_MIRROR_CLAMP_TO_EDGE,
     WINED3D_VK_EXT_HOST_QUERY_RESET,
+    WINED3D_VK_EXT_PIPELINE_CREATION_FEEDBACK,
+    WINED3D_VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE,
 
     WINED3D_VK_EXT_COUNT,
 };
@@ -447,6 +453,34 @@ struct wined3d_retired_objects_vk
     SIZE_T count;
 };
 
+#define WINED3D_UPLOAD_RING_SIZE_VK        (8 * 1024 * 1024)
+#define WINED3D_UPLOAD_RING_MAX_ALLOC_VK   (WINED3D_UPLOAD_RING_SIZE_VK / 4)
+#define WINED3D_UPLOAD_RING_ALIGNMENT_VK   256
+
+struct wined3d_upload_region_vk
+{
+    uint64_t command_buffer_id;
+    VkDeviceSize end;
+};
+
+/* A persistently mapped, host-coherent staging buffer, sub-allocated
+ * linearly. Space is reclaimed once the command buffers that read it have
+ * completed. */
+struct wined3d_upload_ring_vk
+{
+    struct wined3d_bo_vk bo;
+    uint8_t *map_ptr;
+    VkDeviceSize head, tail;
+    bool unavailable;
+
+    struct wined3d_upload_region_vk *regions;
+    SIZE_T regions_size;
+    SIZE_T region_count;
+
+    uint64_t staged_bytes;
+    uint64_t fallback_bytes;
+};
+
 #define WINED3D_FB_ATTACHMENT_FLAG_DISCARDED   1
 #define WINED3D_FB_ATTACHMENT_FLAG_CLEAR_C     2
 #define WINED3D_FB_ATTACHMENT_FLAG_CLEAR_S     4
@@ -486,6 +520,7 @@ struct wined3d_pipeline_layout_vk
     struct wined3d_pipeline_layout_key_vk key;
     VkPipelineLayout vk_pipeline_layout;
     VkDescriptorSetLayout vk_set_layout;
+    VkDescriptorUpdateTemplate vk_update_template;
 };
 
 struct wined3d_graphics_pipeline_key_vk
@@ -545,10 +580,20 @@ struct wined3d_shader_resource_bindings
     SIZE_T size, count;
 };
 
+union wined3d_descriptor_info_vk
+{
+    VkDescriptorBufferInfo buffer;
+    VkDescriptorImageInfo image;
+    VkBufferView buffer_view;
+};
+
 struct wined3d_shader_descriptor_writes_vk
 {
     VkWriteDescriptorSet *writes;
     SIZE_T size, count;
+
+    union wined3d_descriptor_info_vk *data;
+    SIZE_T data_size;
 };
 
 struct wined3d_context_vk
@@ -559,7 +604,8 @@ struct wined3d_context_vk
 
     uint32_t update_compute_pipeline : 1;
     uint32_t update_stream_output : 1;
-    uint32_t padding : 30;
+    uint32_t shaders_pending : 1;
+    uint32_t padding : 29;
 
     struct
     {
@@ -568,6 +614,7 @@ struct wined3d_context_vk
         VkPipeline vk_pipeline;
         VkPipelineLayout vk_pipeline_layout;
         VkDescriptorSetLayout vk_set_layout;
+        VkDescriptorUpdateTemplate vk_update_template;
         struct wined3d_shader_resource_bindings bindings;
     } graphics;
 
@@ -576,6 +623,7 @@ struct wined3d_context_vk
         VkPipeline vk_pipeline;
         VkPipelineLayout vk_pipeline_layout;
         VkDescriptorSetLayout vk_set_layout;
+        VkDescriptorUpdateTemplate vk_update_template;
         struct wined3d_shader_resource_bindings bindings;
     } compute;
 
@@ -583,6 +631,7 @@ struct wined3d_context_vk
     struct wined3d_command_buffer_vk current_command_buffer;
     uint64_t completed_command_buffer_id;
     VkDeviceSize retired_bo_size;
+    struct wined3d_upload_ring_vk upload_ring;
 
     struct
     {
@@ -677,9 +726,12 @@ void wined3d_context_vk_image_barrier(struct wined3d_context_vk *context_vk,
         VkImageLayout new_layout, VkImage image, const VkImageSubresourceRange *range) DECLSPEC_HIDDEN;
 HRESULT wined3d_context_vk_init(struct wined3d_context_vk *context_vk,
         struct wined3d_swapchain *swapchain) DECLSPEC_HIDDEN;
+void wined3d_context_vk_report_upload_stats(struct wined3d_context_vk *context_vk) DECLSPEC_HIDDEN;
 void wined3d_context_vk_submit_command_buffer(struct wined3d_context_vk *context_vk,
         unsigned int wait_semaphore_count, const VkSemaphore *wait_semaphores, const VkPipelineStageFlags *wait_stages,
         unsigned int signal_semaphore_count, const VkSemaphore *signal_semaphores) DECLSPEC_HIDDEN;
+void *wined3d_context_vk_upload_ring_alloc(struct wined3d_context_vk *context_vk, VkDeviceSize size,
+        struct wined3d_bo_vk **bo, VkDeviceSize *offset) DECLSPEC_HIDDEN;
 void wined3d_context_vk_wait_command_buffer(struct wined3d_context_vk *context_vk, uint64_t id) DECLSPEC_HIDDEN;
 VkDescriptorSet wined3d_context_vk_create_vk_descriptor_set(struct wined3d_context_vk *context_vk,
         VkDescriptorSetLayout vk_set_layout) DECLSPEC_HIDDEN;
@@ -695,6 +747,7 @@ struct wined3d_adapter_vk
 
     VkPhysicalDeviceLimits device_limits;
     VkPhysicalDeviceMemoryProperties memory_properties;
+    uint8_t pipeline_cache_uuid[VK_UUID_SIZE];
 };
 
 static inline struct wined3d_adapter_vk *wined3d_adapter_vk(struct wined3d_adapter *adapter)
@@ -779,6 +832,19 @@ struct wined3d_uav_clear_state_vk
     struct wined3d_pipeline_layout_vk *buffer_layout;
 };
 
+struct wined3d_pipeline_cache_vk
+{
+    VkPipelineCache vk_pipeline_cache;
+    uint8_t uuid[VK_UUID_SIZE];
+
+    unsigned int created_count;
+    unsigned int hit_count;
+    unsigned int unsaved_count;
+    uint64_t create_time;
+    ULONGLONG save_time;
+    TP_WORK *save_work;
+};
+
 struct wined3d_device_vk
 {
     struct wined3d_device d;
@@ -799,6 +865,8 @@ struct wined3d_device_vk
     struct wined3d_allocator allocator;
 
     struct wined3d_uav_clear_state_vk uav_clear_state;
+
+    struct wined3d_pipeline_cache_vk pipeline_cache;
 };
 
 static inline struct wined3d_device_vk *wined3d_device_vk(struct wined3d_device *device)
@@ -823,6 +891,11 @@ static inline void wined3d_device_vk_allocator_unlock(struct wined3d_device_vk *
 
 bool wined3d_device_vk_create_null_resources(struct wined3d_device_vk *device_vk,
         struct wined3d_context_vk *context_vk) DECLSPEC_HIDDEN;
+void wined3d_device_vk_create_pipeline_cache(struct wined3d_device_vk *device_vk,
+        const struct wined3d_adapter_vk *adapter_vk) DECLSPEC_HIDDEN;
+void wined3d_device_vk_destroy_pipeline_cache(struct wined3d_device_vk *device_vk) DECLSPEC_HIDDEN;
+void wined3d_device_vk_pipeline_created(struct wined3d_device_vk *device_vk,
+        const VkPipelineCreationFeedback *feedback) DECLSPEC_HIDDEN;
 bool wined3d_device_vk_create_null_views(struct wined3d_device_vk *device_vk,
         struct wined3d_context_vk *context_vk) DECLSPEC_HIDDEN;
 void wined3d_device_vk_destroy_null_resources(struct wined3d_device_vk *device_vk,
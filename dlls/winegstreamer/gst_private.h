@@ -106,6 +106,7 @@ wg_transform_t wg_transform_create(const struct wg_format *input_format,
 void wg_transform_destroy(wg_transform_t transform);
 bool wg_transform_set_output_format(wg_transform_t transform, struct wg_format *format);
 bool wg_transform_get_status(wg_transform_t transform, bool *accepts_input);
+bool wg_transform_get_output_stats(wg_transform_t transform, UINT32 *samples, UINT32 *copies);
 HRESULT wg_transform_drain(wg_transform_t transform);
 HRESULT wg_transform_flush(wg_transform_t transform);
 
@@ -25,6 +25,7 @@
 #include "mftransform.h"
 
 #include "wine/debug.h"
+#include "wine/mfinternal.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(mfplat);
 WINE_DECLARE_DEBUG_CHANNEL(winediag);
@@ -349,12 +350,17 @@ static HRESULT WINAPI transform_GetOutputStreamInfo(IMFTransform *iface, DWORD i
 static HRESULT WINAPI transform_GetAttributes(IMFTransform *iface, IMFAttributes **attributes)
 {
     struct h264_decoder *decoder = impl_from_IMFTransform(iface);
+    UINT32 read_count, copy_count;
 
     FIXME("iface %p, attributes %p semi-stub!\n", iface, attributes);
 
     if (!attributes)
         return E_POINTER;
 
+    if (decoder->wg_transform && wg_transform_get_output_stats(decoder->wg_transform, &read_count, &copy_count))
+        IMFAttributes_SetUINT64(decoder->attributes, &MFT_WINE_OUTPUT_COPY_STATS,
+                (UINT64)read_count << 32 | copy_count);
+
     IMFAttributes_AddRef((*attributes = decoder->attributes));
     return S_OK;
 }
@@ -31,6 +31,7 @@
 #include "dmoreg.h"
 #include "gst_guids.h"
 #include "wmcodecdsp.h"
+#include "wine/mfinternal.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(quartz);
 
@@ -356,8 +357,13 @@ wg_transform_t wg_transform_create(const struct wg_format *input_format,
 
 void wg_transform_destroy(wg_transform_t transform)
 {
+    UINT32 samples, copies;
+
     TRACE("transform %#I64x.\n", transform);
 
+    if (TRACE_ON(quartz) && wg_transform_get_output_stats(transform, &samples, &copies))
+        TRACE("Read %u samples, copied %u.\n", samples, copies);
+
     WINE_UNIX_CALL(unix_wg_transform_destroy, &transform);
 }
 
@@ -413,6 +419,23 @@ bool wg_transform_get_status(wg_transform_t transform, bool *accepts_input)
     return true;
 }
 
+bool wg_transform_get_output_stats(wg_transform_t transform, UINT32 *samples, UINT32 *copies)
+{
+    struct wg_transform_get_status_params params =
+    {
+        .transform = transform,
+    };
+
+    TRACE("transform %#I64x, samples %p, copies %p.\n", transform, samples, copies);
+
+    if (WINE_UNIX_CALL(unix_wg_transform_get_status, &params))
+        return false;
+
+    *samples = params.output_samples;
+    *copies = params.output_copies;
+    return true;
+}
+
 bool wg_transform_set_output_format(wg_transform_t transform, struct wg_format *format)
 {
     struct wg_transform_set_output_format_params params =
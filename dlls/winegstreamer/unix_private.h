@@ -64,12 +64,13 @@ static inline BYTE *wg_sample_data(struct wg_sample *sample)
     return (BYTE *)(UINT_PTR)sample->data;
 }
 
-/* wg_allocator_release_sample can be used to release any sample that was requested. */
+/* wg_allocator_release_sample can be used to release any sample that was requested,
+ * it returns whether the sample data had to be copied back to the GStreamer memory. */
 typedef struct wg_sample *(*wg_allocator_request_sample_cb)(gsize size, void *context);
 extern GstAllocator *wg_allocator_create(void) DECLSPEC_HIDDEN;
 extern void wg_allocator_destroy(GstAllocator *allocator) DECLSPEC_HIDDEN;
 extern void wg_allocator_provide_sample(GstAllocator *allocator, struct wg_sample *sample) DECLSPEC_HIDDEN;
-extern void wg_allocator_release_sample(GstAllocator *allocator, struct wg_sample *sample,
+extern bool wg_allocator_release_sample(GstAllocator *allocator, struct wg_sample *sample,
         bool discard_data) DECLSPEC_HIDDEN;
 
 #endif /* __WINE_WINEGSTREAMER_UNIX_PRIVATE_H */
@@ -361,6 +361,8 @@ struct wg_transform_get_status_params
 {
     wg_transform_t transform;
     UINT32 accepts_input;
+    UINT32 output_samples;
+    UINT32 output_copies;
 };
 
 enum unix_funcs
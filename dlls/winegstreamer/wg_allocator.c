@@ -79,12 +79,13 @@ static void *get_unix_memory_data(WgMemory *memory)
     return memory->unix_map_info.data;
 }
 
-static void release_memory_sample(WgAllocator *allocator, WgMemory *memory, bool discard_data)
+static bool release_memory_sample(WgAllocator *allocator, WgMemory *memory, bool discard_data)
 {
     struct wg_sample *sample;
+    bool copied = false;
 
     if (!(sample = memory->sample))
-        return;
+        return false;
 
     while (sample->refcount > 1)
     {
@@ -97,10 +98,12 @@ static void release_memory_sample(WgAllocator *allocator, WgMemory *memory, bool
     {
         GST_WARNING("Copying %#zx bytes from sample %p, back to memory %p", memory->written, sample, memory);
         memcpy(get_unix_memory_data(memory), wg_sample_data(memory->sample), memory->written);
+        copied = true;
     }
 
     memory->sample = NULL;
     GST_INFO("Released sample %p from memory %p", sample, memory);
+    return copied;
 }
 
 static gpointer wg_allocator_map(GstMemory *gst_memory, GstMapInfo *info, gsize maxsize)
@@ -115,6 +118,19 @@ static gpointer wg_allocator_map(GstMemory *gst_memory, GstMapInfo *info, gsize
 
     pthread_mutex_lock(&allocator->mutex);
 
+    /* Memory may have been allocated before any sample was provided, for instance
+     * when the buffer pool or the decoder acquire buffers ahead of time. If it has
+     * never been mapped yet, bind it to the provided sample now, so that it can still
+     * be written to directly instead of being copied later.
+     */
+    if (!memory->sample && !memory->unix_memory && allocator->next_sample
+            && allocator->next_sample->max_size >= memory->parent.maxsize)
+    {
+        memory->sample = allocator->next_sample;
+        allocator->next_sample = NULL;
+        GST_INFO("Bound sample %p to memory %p", memory->sample, memory);
+    }
+
     if (!memory->sample)
         info->data = get_unix_memory_data(memory);
     else
@@ -303,18 +319,21 @@ void wg_allocator_provide_sample(GstAllocator *gst_allocator, struct wg_sample *
         InterlockedDecrement(&previous->refcount);
 }
 
-void wg_allocator_release_sample(GstAllocator *gst_allocator, struct wg_sample *sample,
+bool wg_allocator_release_sample(GstAllocator *gst_allocator, struct wg_sample *sample,
         bool discard_data)
 {
     WgAllocator *allocator = (WgAllocator *)gst_allocator;
+    bool copied = false;
     WgMemory *memory;
 
     GST_LOG("allocator %p, sample %p, discard_data %u", allocator, sample, discard_data);
 
     pthread_mutex_lock(&allocator->mutex);
     if ((memory = find_sample_memory(allocator, sample)))
-        release_memory_sample(allocator, memory, discard_data);
+        copied = release_memory_sample(allocator, memory, discard_data);
     else if (sample->refcount)
         GST_ERROR("Couldn't find memory for sample %p", sample);
     pthread_mutex_unlock(&allocator->mutex);
+
+    return copied;
 }
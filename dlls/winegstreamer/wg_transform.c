@@ -61,6 +61,9 @@ struct wg_transform
     GstSample *output_sample;
     bool output_caps_changed;
     GstCaps *output_caps;
+
+    UINT32 output_samples;
+    UINT32 output_copies;
 };
 
 static struct wg_transform *get_transform(wg_transform_t trans)
@@ -268,6 +271,9 @@ NTSTATUS wg_transform_destroy(void *args)
 
     gst_element_set_state(transform->container, GST_STATE_NULL);
 
+    GST_INFO("transform %p, read %u samples, copied %u.", transform,
+            transform->output_samples, transform->output_copies);
+
     if (transform->output_sample)
         gst_sample_unref(transform->output_sample);
     while ((sample = gst_atomic_queue_pop(transform->output_queue)))
@@ -684,7 +690,7 @@ static NTSTATUS copy_buffer(GstBuffer *buffer, GstCaps *caps, struct wg_sample *
 }
 
 static NTSTATUS read_transform_output_data(GstBuffer *buffer, GstCaps *caps, gsize plane_align,
-        struct wg_sample *sample)
+        struct wg_sample *sample, bool *copied)
 {
     gsize total_size;
     bool needs_copy;
@@ -715,6 +721,8 @@ static NTSTATUS read_transform_output_data(GstBuffer *buffer, GstCaps *caps, gsi
         return status;
     }
 
+    *copied = needs_copy;
+
     if (GST_BUFFER_PTS_IS_VALID(buffer))
     {
         sample->flags |= WG_SAMPLE_FLAG_HAS_PTS;
@@ -772,6 +780,13 @@ static bool get_transform_output(struct wg_transform *transform, struct wg_sampl
     return !!transform->output_sample;
 }
 
+static void release_output_sample(struct wg_transform *transform, struct wg_sample *sample, bool discard_data)
+{
+    /* data written into a sample still bound to GStreamer memory is copied back on release */
+    if (wg_allocator_release_sample(transform->allocator, sample, discard_data))
+        transform->output_copies++;
+}
+
 NTSTATUS wg_transform_read_data(void *args)
 {
     struct wg_transform_read_data_params *params = args;
@@ -782,13 +797,14 @@ NTSTATUS wg_transform_read_data(void *args)
     GstCaps *output_caps;
     bool discard_data;
     NTSTATUS status;
+    bool copied;
 
     if (!transform->output_sample && !get_transform_output(transform, sample))
     {
         sample->size = 0;
         params->result = MF_E_TRANSFORM_NEED_MORE_INPUT;
         GST_INFO("Cannot read %u bytes, no output available", sample->max_size);
-        wg_allocator_release_sample(transform->allocator, sample, false);
+        release_output_sample(transform, sample, false);
         return STATUS_SUCCESS;
     }
 
@@ -828,17 +844,21 @@ NTSTATUS wg_transform_read_data(void *args)
 
         params->result = MF_E_TRANSFORM_STREAM_CHANGE;
         GST_INFO("Format changed detected, returning no output");
-        wg_allocator_release_sample(transform->allocator, sample, false);
+        release_output_sample(transform, sample, false);
         return STATUS_SUCCESS;
     }
 
     if ((status = read_transform_output_data(output_buffer, output_caps,
-                transform->attrs.output_plane_align, sample)))
+                transform->attrs.output_plane_align, sample, &copied)))
     {
-        wg_allocator_release_sample(transform->allocator, sample, false);
+        release_output_sample(transform, sample, false);
         return status;
     }
 
+    transform->output_samples++;
+    if (copied)
+        transform->output_copies++;
+
     if (sample->flags & WG_SAMPLE_FLAG_INCOMPLETE)
         discard_data = false;
     else
@@ -863,7 +883,7 @@ NTSTATUS wg_transform_read_data(void *args)
     }
 
     params->result = S_OK;
-    wg_allocator_release_sample(transform->allocator, sample, discard_data);
+    release_output_sample(transform, sample, discard_data);
     return STATUS_SUCCESS;
 }
 
@@ -873,6 +893,8 @@ NTSTATUS wg_transform_get_status(void *args)
     struct wg_transform *transform = get_transform(params->transform);
 
     params->accepts_input = gst_atomic_queue_length(transform->input_queue) < transform->attrs.input_queue_length + 1;
+    params->output_samples = transform->output_samples;
+    params->output_copies = transform->output_copies;
     return STATUS_SUCCESS;
 }
 
@@ -77,7 +77,12 @@ struct pulse_stream
     SIZE_T tmp_buffer_bytes, held_bytes, peek_len, peek_buffer_len, pa_held_bytes;
     BYTE *local_buffer, *tmp_buffer, *peek_buffer;
     void *locked_ptr;
+    /* Render memory obtained from pa_stream_begin_write(), handed out
+     * directly to the client by GetBuffer. */
+    BYTE *direct_buffer;
     BOOL please_quit, just_started, just_underran;
+    /* Event callback render streams are fed from pa_stream write callbacks. */
+    BOOL event_driven;
     pa_usec_t mmdev_period_usec;
 
     INT64 clock_lastpos, clock_written;
@@ -368,6 +373,20 @@ static void pulse_started_callback(pa_stream *s, void *userdata)
     TRACE("%p: (Re)started playing\n", userdata);
 }
 
+static void pulse_write(struct pulse_stream *stream);
+
+static void pulse_write_callback(pa_stream *s, size_t bytes, void *userdata)
+{
+    struct pulse_stream *stream = userdata;
+
+    TRACE("%p: Server requested %lu bytes\n", userdata, (unsigned long)bytes);
+
+    /* Send whatever the client queued as soon as there is room for it,
+     * instead of waiting for the next timer tick. */
+    if (stream->started && stream->pa_held_bytes)
+        pulse_write(stream);
+}
+
 static void pulse_op_cb(pa_stream *s, int success, void *user)
 {
     TRACE("Success: %i\n", success);
@@ -1069,6 +1088,11 @@ static HRESULT pulse_stream_connect(struct pulse_stream *stream, const char *pul
     else
         pulse_name = NULL;  /* use default */
 
+    /* Let libpulse keep the clock up to date, so that the timer loop doesn't
+     * need a server round trip on every period. */
+    if (stream->event_driven)
+        flags |= PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE;
+
     if (stream->dataflow == eRender)
         ret = pa_stream_connect_playback(stream->stream, pulse_name, &attr, flags, NULL, NULL);
     else
@@ -1085,6 +1109,8 @@ static HRESULT pulse_stream_connect(struct pulse_stream *stream, const char *pul
     if (stream->dataflow == eRender) {
         pa_stream_set_underflow_callback(stream->stream, pulse_underflow_callback, stream);
         pa_stream_set_started_callback(stream->stream, pulse_started_callback, stream);
+        if (stream->event_driven)
+            pa_stream_set_write_callback(stream->stream, pulse_write_callback, stream);
     }
     return S_OK;
 }
@@ -1173,6 +1199,7 @@ static NTSTATUS pulse_create_stream(void *args)
 
     stream->share = params->share;
     stream->flags = params->flags;
+    stream->event_driven = stream->dataflow == eRender && (stream->flags & AUDCLNT_STREAMFLAGS_EVENTCALLBACK);
     hr = pulse_stream_connect(stream, params->device, stream->period_bytes);
     if (SUCCEEDED(hr)) {
         UINT32 unalign;
@@ -1247,6 +1274,8 @@ static NTSTATUS pulse_release_stream(void *args)
     }
 
     pulse_lock();
+    if (stream->direct_buffer)
+        pa_stream_cancel_write(stream->stream);
     if (PA_STREAM_IS_GOOD(pa_stream_get_state(stream->stream))) {
         pa_stream_disconnect(stream->stream);
         while (PA_STREAM_IS_GOOD(pa_stream_get_state(stream->stream)))
@@ -1414,8 +1443,13 @@ static void pulse_write(struct pulse_stream *stream)
     /* write as much data to PA as we can */
     UINT32 to_write;
     BYTE *buf = stream->local_buffer + stream->pa_offs_bytes;
-    UINT32 bytes = pa_stream_writable_size(stream->stream);
+    UINT32 bytes;
+
+    /* Nothing else may be written while the client fills server memory. */
+    if (stream->direct_buffer)
+        return;
 
+    bytes = pa_stream_writable_size(stream->stream);
     if (stream->just_underran)
     {
         /* prebuffer with silence if needed */
@@ -1581,12 +1615,15 @@ static NTSTATUS pulse_timer_loop(void *args)
 
         delay.QuadPart = -stream->mmdev_period_usec * 10;
 
-        o = pa_stream_update_timing_info(stream->stream, pulse_op_cb, &success);
-        if (o)
+        if (!stream->event_driven)
         {
-            while (pa_operation_get_state(o) == PA_OPERATION_RUNNING)
-                pulse_cond_wait();
-            pa_operation_unref(o);
+            o = pa_stream_update_timing_info(stream->stream, pulse_op_cb, &success);
+            if (o)
+            {
+                while (pa_operation_get_state(o) == PA_OPERATION_RUNNING)
+                    pulse_cond_wait();
+                pa_operation_unref(o);
+            }
         }
         err = pa_stream_get_time(stream->stream, &now);
         if (err == 0)
@@ -1868,6 +1905,32 @@ static UINT32 pulse_capture_padding(struct pulse_stream *stream)
     return stream->held_bytes / pa_frame_size(&stream->ss);
 }
 
+/* Try to give the client server memory to write into, which saves copying
+ * the data through local_buffer. That is only possible when everything the
+ * client wrote before was already sent, and the server has room for all of
+ * the requested frames. The memory isn't necessarily reachable from 32-bit
+ * code, so it isn't used for wow64 clients. */
+static BOOL pulse_begin_direct_write(struct pulse_stream *stream, size_t bytes)
+{
+    size_t size = bytes;
+    void *data;
+
+    if (zero_bits || stream->pa_held_bytes || stream->just_underran)
+        return FALSE;
+    if (pa_stream_writable_size(stream->stream) < bytes)
+        return FALSE;
+    if (pa_stream_begin_write(stream->stream, &data, &size) < 0 || !data)
+        return FALSE;
+    if (size < bytes)
+    {
+        pa_stream_cancel_write(stream->stream);
+        return FALSE;
+    }
+
+    stream->direct_buffer = data;
+    return TRUE;
+}
+
 static NTSTATUS pulse_get_render_buffer(void *args)
 {
     struct get_render_buffer_params *params = args;
@@ -1907,7 +1970,12 @@ static NTSTATUS pulse_get_render_buffer(void *args)
 
     bytes = params->frames * pa_frame_size(&stream->ss);
     wri_offs_bytes = (stream->lcl_offs_bytes + stream->held_bytes) % stream->real_bufsize_bytes;
-    if (wri_offs_bytes + bytes > stream->real_bufsize_bytes)
+    if (pulse_begin_direct_write(stream, bytes))
+    {
+        *params->data = stream->direct_buffer;
+        stream->locked = bytes;
+    }
+    else if (wri_offs_bytes + bytes > stream->real_bufsize_bytes)
     {
         if (!alloc_tmp_buffer(stream, bytes))
         {
@@ -1957,6 +2025,11 @@ static NTSTATUS pulse_release_render_buffer(void *args)
     pulse_lock();
     if (!stream->locked || !params->written_frames)
     {
+        if (stream->direct_buffer)
+        {
+            pa_stream_cancel_write(stream->stream);
+            stream->direct_buffer = NULL;
+        }
         stream->locked = 0;
         pulse_unlock();
         params->result = params->written_frames ? AUDCLNT_E_OUT_OF_ORDER : S_OK;
@@ -1971,7 +2044,9 @@ static NTSTATUS pulse_release_render_buffer(void *args)
         return STATUS_SUCCESS;
     }
 
-    if (stream->locked >= 0)
+    if (stream->direct_buffer)
+        buffer = stream->direct_buffer;
+    else if (stream->locked >= 0)
         buffer = stream->local_buffer + (stream->lcl_offs_bytes + stream->held_bytes) % stream->real_bufsize_bytes;
     else
         buffer = stream->tmp_buffer;
@@ -1980,6 +2055,26 @@ static NTSTATUS pulse_release_render_buffer(void *args)
     if (params->flags & AUDCLNT_BUFFERFLAGS_SILENT)
         silence_buffer(stream->ss.format, buffer, written_bytes);
 
+    if (stream->direct_buffer)
+    {
+        /* The data is already in server memory; commit it, and skip its
+         * place in local_buffer, where the next frames will be written. */
+        stream->direct_buffer = NULL;
+        write_buffer(stream, buffer, written_bytes);
+        stream->pa_offs_bytes += written_bytes;
+        stream->pa_offs_bytes %= stream->real_bufsize_bytes;
+        stream->held_bytes += written_bytes;
+        stream->clock_written += written_bytes;
+        stream->locked = 0;
+
+        TRACE("Released %u directly, held %lu\n", params->written_frames,
+                stream->held_bytes / pa_frame_size(&stream->ss));
+
+        pulse_unlock();
+        params->result = S_OK;
+        return STATUS_SUCCESS;
+    }
+
     if (stream->locked < 0)
         pulse_wrap_buffer(stream, buffer, written_bytes);
 
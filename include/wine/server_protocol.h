@@ -1627,7 +1627,9 @@ struct create_file_reply
 {
     struct reply_header __header;
     obj_handle_t handle;
-    char __pad_12[4];
+    int          fd_type;
+    unsigned int fd_access;
+    unsigned int fd_options;
 };
 
 
@@ -2163,7 +2165,7 @@ struct process_info
 struct list_processes_request
 {
     struct request_header __header;
-    char __pad_12[4];
+    unsigned int    generation;
 };
 struct list_processes_reply
 {
@@ -2172,7 +2174,10 @@ struct list_processes_reply
     int             process_count;
     int             total_thread_count;
     data_size_t     total_name_len;
+    unsigned int    generation;
     /* VARARG(data,process_info,info_size); */
+    /* VARARG(handle_counts,uints); */
+    char __pad_28[4];
 };
 
 
@@ -6456,7 +6461,7 @@ union generic_reply
 
 /* ### protocol_version begin ### */
 
-#define SERVER_PROTOCOL_VERSION 780
+#define SERVER_PROTOCOL_VERSION 782
 
 /* ### protocol_version end ### */
 
@@ -0,0 +1,443 @@
+/*
+ * Direct2D geometry rendering benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#define COBJMACROS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+#include "d3d11.h"
+#include "d2d1.h"
+
+#include "bench.h"
+
+#define BENCH_SIZE 1024
+#define BENCH_ICON_SIZE 24.0f
+#define BENCH_MAX_GEOMETRIES 4096
+
+struct bench_context
+{
+    ID3D11Device *device;
+    ID3D11DeviceContext *immediate_context;
+    ID3D11Query *query;
+    ID2D1Factory *factory;
+    ID2D1RenderTarget *rt;
+    ID2D1SolidColorBrush *brush;
+
+    unsigned int geometry_count;
+    ID2D1PathGeometry *geometries[BENCH_MAX_GEOMETRIES];
+};
+
+struct bench_test
+{
+    const char *name;
+    void (*run)(struct bench_context *ctx);
+};
+
+/* A small icon made of lines and curves, like the ones UI toolkits draw. */
+static ID2D1PathGeometry *create_icon(ID2D1Factory *factory, unsigned int variant)
+{
+    float s = BENCH_ICON_SIZE, bend = (variant % 7) * 0.5f;
+    ID2D1PathGeometry *geometry;
+    D2D1_BEZIER_SEGMENT bezier;
+    ID2D1GeometrySink *sink;
+    D2D1_POINT_2F point;
+
+    if (FAILED(ID2D1Factory_CreatePathGeometry(factory, &geometry)))
+        return NULL;
+    if (FAILED(ID2D1PathGeometry_Open(geometry, &sink)))
+    {
+        ID2D1PathGeometry_Release(geometry);
+        return NULL;
+    }
+
+    point.x = s * 0.5f;
+    point.y = s * 0.9f;
+    ID2D1GeometrySink_BeginFigure(sink, point, D2D1_FIGURE_BEGIN_FILLED);
+    bezier.point1.x = -s * 0.1f - bend;
+    bezier.point1.y = s * 0.5f;
+    bezier.point2.x = s * 0.1f;
+    bezier.point2.y = -s * 0.1f;
+    bezier.point3.x = s * 0.5f;
+    bezier.point3.y = s * 0.25f;
+    ID2D1GeometrySink_AddBezier(sink, &bezier);
+    bezier.point1.x = s * 0.9f;
+    bezier.point1.y = -s * 0.1f;
+    bezier.point2.x = s * 1.1f + bend;
+    bezier.point2.y = s * 0.5f;
+    bezier.point3.x = s * 0.5f;
+    bezier.point3.y = s * 0.9f;
+    ID2D1GeometrySink_AddBezier(sink, &bezier);
+    ID2D1GeometrySink_EndFigure(sink, D2D1_FIGURE_END_CLOSED);
+
+    point.x = s * 0.35f;
+    point.y = s * 0.4f;
+    ID2D1GeometrySink_BeginFigure(sink, point, D2D1_FIGURE_BEGIN_FILLED);
+    point.x = s * 0.65f;
+    ID2D1GeometrySink_AddLine(sink, point);
+    point.x = s * 0.5f;
+    point.y = s * 0.65f;
+    ID2D1GeometrySink_AddLine(sink, point);
+    ID2D1GeometrySink_EndFigure(sink, D2D1_FIGURE_END_CLOSED);
+
+    ID2D1GeometrySink_Close(sink);
+    ID2D1GeometrySink_Release(sink);
+
+    return geometry;
+}
+
+static void get_icon_transform(unsigned int i, D2D1_MATRIX_3X2_F *matrix)
+{
+    unsigned int per_row = BENCH_SIZE / (unsigned int)BENCH_ICON_SIZE;
+    float scale = 0.5f + (i % 3) * 0.25f;
+
+    matrix->_11 = scale;
+    matrix->_12 = 0.0f;
+    matrix->_21 = 0.0f;
+    matrix->_22 = scale;
+    matrix->_31 = (i % per_row) * BENCH_ICON_SIZE;
+    matrix->_32 = (i / per_row % per_row) * BENCH_ICON_SIZE;
+}
+
+static void set_icon_transform(struct bench_context *ctx, unsigned int i)
+{
+    D2D1_MATRIX_3X2_F matrix;
+
+    get_icon_transform(i, &matrix);
+    ID2D1RenderTarget_SetTransform(ctx->rt, &matrix);
+}
+
+static void test_fill(struct bench_context *ctx)
+{
+    unsigned int i;
+
+    for (i = 0; i < ctx->geometry_count; ++i)
+    {
+        set_icon_transform(ctx, i);
+        ID2D1RenderTarget_FillGeometry(ctx->rt, (ID2D1Geometry *)ctx->geometries[i],
+                (ID2D1Brush *)ctx->brush, NULL);
+    }
+}
+
+static void test_stroke(struct bench_context *ctx)
+{
+    unsigned int i;
+
+    for (i = 0; i < ctx->geometry_count; ++i)
+    {
+        set_icon_transform(ctx, i);
+        ID2D1RenderTarget_DrawGeometry(ctx->rt, (ID2D1Geometry *)ctx->geometries[i],
+                (ID2D1Brush *)ctx->brush, 1.5f, NULL);
+    }
+}
+
+/* New transformed geometries every frame, on top of the same source geometries. */
+static void test_fill_transformed(struct bench_context *ctx)
+{
+    ID2D1TransformedGeometry *geometry;
+    D2D1_MATRIX_3X2_F matrix;
+    unsigned int i;
+
+    for (i = 0; i < ctx->geometry_count; ++i)
+    {
+        get_icon_transform(i, &matrix);
+        if (FAILED(ID2D1Factory_CreateTransformedGeometry(ctx->factory,
+                (ID2D1Geometry *)ctx->geometries[i], &matrix, &geometry)))
+            continue;
+        ID2D1RenderTarget_FillGeometry(ctx->rt, (ID2D1Geometry *)geometry, (ID2D1Brush *)ctx->brush, NULL);
+        ID2D1TransformedGeometry_Release(geometry);
+    }
+}
+
+/* New path geometries every frame; nothing can be reused between frames. */
+static void test_fill_temporary(struct bench_context *ctx)
+{
+    ID2D1PathGeometry *geometry;
+    unsigned int i;
+
+    for (i = 0; i < ctx->geometry_count; ++i)
+    {
+        if (!(geometry = create_icon(ctx->factory, i)))
+            continue;
+        set_icon_transform(ctx, i);
+        ID2D1RenderTarget_FillGeometry(ctx->rt, (ID2D1Geometry *)geometry, (ID2D1Brush *)ctx->brush, NULL);
+        ID2D1PathGeometry_Release(geometry);
+    }
+}
+
+static void test_rectangles(struct bench_context *ctx)
+{
+    D2D1_RECT_F rect;
+    unsigned int i;
+
+    for (i = 0; i < ctx->geometry_count; ++i)
+    {
+        set_icon_transform(ctx, i);
+        rect.left = 2.0f;
+        rect.top = 2.0f;
+        rect.right = BENCH_ICON_SIZE - 2.0f;
+        rect.bottom = BENCH_ICON_SIZE - 2.0f;
+        ID2D1RenderTarget_FillRectangle(ctx->rt, &rect, (ID2D1Brush *)ctx->brush);
+    }
+}
+
+static const struct bench_test tests[] =
+{
+    {"fill", test_fill},
+    {"stroke", test_stroke},
+    {"fill_transformed", test_fill_transformed},
+    {"fill_temporary", test_fill_temporary},
+    {"rectangles", test_rectangles},
+};
+
+static const unsigned int default_counts[] = {16, 256, 1024};
+
+static unsigned int option_count, option_frames = 100;
+
+static const struct bench_option options[] =
+{
+    {'n', "count", "Draw count geometries per frame, from %u to %u.", 1, BENCH_MAX_GEOMETRIES, NULL, 0, &option_count},
+    {'f', "frames", "Number of timed frames, 100 by default.", 1, ~0u / sizeof(double), NULL, 0, &option_frames},
+};
+
+static const char *get_test_name(unsigned int idx)
+{
+    return tests[idx].name;
+}
+
+static const struct bench_desc bench_desc =
+{
+    "d2dbench",
+    "test,geometries,frames,total_ms,avg_frame_ms,min_frame_ms,p95_frame_ms,max_frame_ms",
+    NULL,
+    get_test_name, ARRAY_SIZE(tests), options, ARRAY_SIZE(options),
+};
+
+static BOOL create_context(struct bench_context *ctx)
+{
+    static const D3D_DRIVER_TYPE driver_types[] = {D3D_DRIVER_TYPE_HARDWARE, D3D_DRIVER_TYPE_WARP};
+    D2D1_RENDER_TARGET_PROPERTIES rt_desc;
+    D3D11_TEXTURE2D_DESC texture_desc;
+    D3D11_QUERY_DESC query_desc;
+    ID3D11Texture2D *texture;
+    IDXGISurface *surface;
+    D2D1_COLOR_F colour;
+    unsigned int i;
+    HRESULT hr;
+
+    memset(ctx, 0, sizeof(*ctx));
+
+    for (i = 0; i < ARRAY_SIZE(driver_types); ++i)
+    {
+        if (SUCCEEDED(D3D11CreateDevice(NULL, driver_types[i], NULL, D3D11_CREATE_DEVICE_BGRA_SUPPORT,
+                NULL, 0, D3D11_SDK_VERSION, &ctx->device, NULL, &ctx->immediate_context)))
+            break;
+    }
+    if (!ctx->device)
+    {
+        fprintf(stderr, "Failed to create a Direct3D 11 device.\n");
+        return FALSE;
+    }
+
+    texture_desc.Width = BENCH_SIZE;
+    texture_desc.Height = BENCH_SIZE;
+    texture_desc.MipLevels = 1;
+    texture_desc.ArraySize = 1;
+    texture_desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    texture_desc.SampleDesc.Count = 1;
+    texture_desc.SampleDesc.Quality = 0;
+    texture_desc.Usage = D3D11_USAGE_DEFAULT;
+    texture_desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+    texture_desc.CPUAccessFlags = 0;
+    texture_desc.MiscFlags = 0;
+    if (FAILED(hr = ID3D11Device_CreateTexture2D(ctx->device, &texture_desc, NULL, &texture)))
+    {
+        fprintf(stderr, "Failed to create texture, hr %#lx.\n", hr);
+        return FALSE;
+    }
+    hr = ID3D11Texture2D_QueryInterface(texture, &IID_IDXGISurface, (void **)&surface);
+    ID3D11Texture2D_Release(texture);
+    if (FAILED(hr))
+    {
+        fprintf(stderr, "Failed to get DXGI surface, hr %#lx.\n", hr);
+        return FALSE;
+    }
+
+    query_desc.Query = D3D11_QUERY_EVENT;
+    query_desc.MiscFlags = 0;
+    if (FAILED(hr = ID3D11Device_CreateQuery(ctx->device, &query_desc, &ctx->query)))
+    {
+        fprintf(stderr, "Failed to create query, hr %#lx.\n", hr);
+        IDXGISurface_Release(surface);
+        return FALSE;
+    }
+
+    if (FAILED(hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &IID_ID2D1Factory,
+            NULL, (void **)&ctx->factory)))
+    {
+        fprintf(stderr, "Failed to create factory, hr %#lx.\n", hr);
+        IDXGISurface_Release(surface);
+        return FALSE;
+    }
+
+    rt_desc.type = D2D1_RENDER_TARGET_TYPE_DEFAULT;
+    rt_desc.pixelFormat.format = DXGI_FORMAT_UNKNOWN;
+    rt_desc.pixelFormat.alphaMode = D2D1_ALPHA_MODE_PREMULTIPLIED;
+    rt_desc.dpiX = 96.0f;
+    rt_desc.dpiY = 96.0f;
+    rt_desc.usage = D2D1_RENDER_TARGET_USAGE_NONE;
+    rt_desc.minLevel = D2D1_FEATURE_LEVEL_DEFAULT;
+    hr = ID2D1Factory_CreateDxgiSurfaceRenderTarget(ctx->factory, surface, &rt_desc, &ctx->rt);
+    IDXGISurface_Release(surface);
+    if (FAILED(hr))
+    {
+        fprintf(stderr, "Failed to create render target, hr %#lx.\n", hr);
+        return FALSE;
+    }
+
+    colour.r = 0.2f;
+    colour.g = 0.4f;
+    colour.b = 0.8f;
+    colour.a = 1.0f;
+    if (FAILED(hr = ID2D1RenderTarget_CreateSolidColorBrush(ctx->rt, &colour, NULL, &ctx->brush)))
+    {
+        fprintf(stderr, "Failed to create brush, hr %#lx.\n", hr);
+        return FALSE;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(ctx->geometries); ++i)
+    {
+        if (!(ctx->geometries[i] = create_icon(ctx->factory, i)))
+        {
+            fprintf(stderr, "Failed to create geometry.\n");
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static void destroy_context(struct bench_context *ctx)
+{
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(ctx->geometries); ++i)
+    {
+        if (ctx->geometries[i])
+            ID2D1PathGeometry_Release(ctx->geometries[i]);
+    }
+    if (ctx->brush)
+        ID2D1SolidColorBrush_Release(ctx->brush);
+    if (ctx->rt)
+        ID2D1RenderTarget_Release(ctx->rt);
+    if (ctx->factory)
+        ID2D1Factory_Release(ctx->factory);
+    if (ctx->query)
+        ID3D11Query_Release(ctx->query);
+    if (ctx->immediate_context)
+        ID3D11DeviceContext_Release(ctx->immediate_context);
+    if (ctx->device)
+        ID3D11Device_Release(ctx->device);
+}
+
+/* Wait for the GPU, so that the frame time includes the work it was given. */
+static void finish_frame(struct bench_context *ctx)
+{
+    ID3D11DeviceContext_End(ctx->immediate_context, (ID3D11Asynchronous *)ctx->query);
+    while (ID3D11DeviceContext_GetData(ctx->immediate_context, (ID3D11Asynchronous *)ctx->query,
+            NULL, 0, 0) == S_FALSE)
+        Sleep(0);
+}
+
+static void run_test(struct bench_context *ctx, const struct bench_test *test,
+        unsigned int geometry_count, unsigned int frames)
+{
+    struct bench_frame_stats stats;
+    struct bench_timer timer;
+    D2D1_COLOR_F colour;
+    double *times;
+    unsigned int i;
+    HRESULT hr;
+
+    if (!(times = malloc(frames * sizeof(*times))))
+        return;
+
+    ctx->geometry_count = geometry_count;
+    colour.r = colour.g = colour.b = colour.a = 1.0f;
+
+    /* The first frame is a warm-up, and isn't timed. */
+    for (i = 0; i <= frames; ++i)
+    {
+        bench_timer_start(&timer);
+        ID2D1RenderTarget_BeginDraw(ctx->rt);
+        ID2D1RenderTarget_Clear(ctx->rt, &colour);
+        test->run(ctx);
+        if (FAILED(hr = ID2D1RenderTarget_EndDraw(ctx->rt, NULL, NULL)))
+        {
+            fprintf(stderr, "%s: EndDraw() failed, hr %#lx.\n", test->name, hr);
+            free(times);
+            return;
+        }
+        finish_frame(ctx);
+
+        if (i)
+            times[i - 1] = bench_timer_elapsed_ms(&timer);
+    }
+
+    bench_get_frame_stats(times, frames, &stats);
+    printf("%s,%u,%u,%.3f,%.3f,%.3f,%.3f,%.3f\n", test->name, geometry_count, frames, stats.total_ms,
+            stats.avg_ms, stats.min_ms, stats.p95_ms, stats.max_ms);
+    fflush(stdout);
+
+    free(times);
+}
+
+int __cdecl wmain(int argc, WCHAR *argv[])
+{
+    unsigned int selected[ARRAY_SIZE(tests)], selected_count;
+    unsigned int count_count = ARRAY_SIZE(default_counts);
+    const unsigned int *counts = default_counts;
+    struct bench_context ctx;
+    unsigned int i, j;
+    int ret;
+
+    if (!bench_parse_command_line(&bench_desc, argc, argv, selected, &selected_count, &ret))
+        return ret;
+    if (option_count)
+    {
+        counts = &option_count;
+        count_count = 1;
+    }
+
+    if (!create_context(&ctx))
+    {
+        destroy_context(&ctx);
+        return 1;
+    }
+
+    bench_print_header(&bench_desc);
+    for (i = 0; i < selected_count; ++i)
+    {
+        for (j = 0; j < count_count; ++j)
+            run_test(&ctx, &tests[selected[i]], counts[j], option_frames);
+    }
+
+    destroy_context(&ctx);
+
+    return 0;
+}
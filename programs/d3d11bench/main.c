@@ -0,0 +1,578 @@
+/*
+ * Direct3D 11 multi-threaded draw submission benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#define COBJMACROS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+#include "d3d11.h"
+
+#include "bench.h"
+
+#define BENCH_SIZE 512
+#define BENCH_GRID_SIZE 16
+#define BENCH_TRIANGLE_COUNT (BENCH_GRID_SIZE * BENCH_GRID_SIZE)
+#define BENCH_COLOUR_COUNT 16
+#define BENCH_MAX_DRAWS 1000000
+#define BENCH_MAX_THREADS MAXIMUM_WAIT_OBJECTS
+
+struct vec3
+{
+    float x, y, z;
+};
+
+struct vec4
+{
+    float x, y, z, w;
+};
+
+struct bench_worker
+{
+    struct bench_context *ctx;
+    HANDLE thread, start_event;
+    ID3D11DeviceContext *context;
+    ID3D11CommandList *list;
+    unsigned int first, count;
+    BOOL quit;
+};
+
+struct bench_context
+{
+    ID3D11Device *device;
+    ID3D11DeviceContext *immediate_context;
+    ID3D11Query *query;
+    ID3D11RenderTargetView *rtv;
+    ID3D11InputLayout *input_layout;
+    ID3D11VertexShader *vs;
+    ID3D11PixelShader *ps;
+    ID3D11Buffer *vb;
+    ID3D11Buffer *cb[BENCH_COLOUR_COUNT];
+
+    unsigned int worker_count;
+    struct bench_worker workers[BENCH_MAX_THREADS];
+    HANDLE done_events[BENCH_MAX_THREADS];
+};
+
+struct bench_test
+{
+    const char *name;
+    BOOL deferred;
+};
+
+static const DWORD vs_code[] =
+{
+#if 0
+    float4 main(float4 position : POSITION) : SV_POSITION
+    {
+        return position;
+    }
+#endif
+    0x43425844, 0x4fb19b86, 0x955fa240, 0x1a630688, 0x24eb9db4, 0x00000001, 0x000001e0, 0x00000006,
+    0x00000038, 0x00000084, 0x000000d0, 0x00000134, 0x00000178, 0x000001ac, 0x53414e58, 0x00000044,
+    0x00000044, 0xfffe0200, 0x00000020, 0x00000024, 0x00240000, 0x00240000, 0x00240000, 0x00240000,
+    0x00240000, 0xfffe0200, 0x0200001f, 0x80000005, 0x900f0000, 0x02000001, 0xc00f0000, 0x80e40000,
+    0x0000ffff, 0x50414e58, 0x00000044, 0x00000044, 0xfffe0200, 0x00000020, 0x00000024, 0x00240000,
+    0x00240000, 0x00240000, 0x00240000, 0x00240000, 0xfffe0200, 0x0200001f, 0x80000005, 0x900f0000,
+    0x02000001, 0xc00f0000, 0x80e40000, 0x0000ffff, 0x396e6f41, 0x0000005c, 0x0000005c, 0xfffe0200,
+    0x00000034, 0x00000028, 0x00240000, 0x00240000, 0x00240000, 0x00240000, 0x00240001, 0x00000000,
+    0xfffe0200, 0x0200001f, 0x80000005, 0x900f0000, 0x04000004, 0xc0030000, 0x90ff0000, 0xa0e40000,
+    0x90e40000, 0x02000001, 0xc00c0000, 0x90e40000, 0x0000ffff, 0x52444853, 0x0000003c, 0x00010040,
+    0x0000000f, 0x0300005f, 0x001010f2, 0x00000000, 0x04000067, 0x001020f2, 0x00000000, 0x00000001,
+    0x05000036, 0x001020f2, 0x00000000, 0x00101e46, 0x00000000, 0x0100003e, 0x4e475349, 0x0000002c,
+    0x00000001, 0x00000008, 0x00000020, 0x00000000, 0x00000000, 0x00000003, 0x00000000, 0x00000f0f,
+    0x49534f50, 0x4e4f4954, 0xababab00, 0x4e47534f, 0x0000002c, 0x00000001, 0x00000008, 0x00000020,
+    0x00000000, 0x00000001, 0x00000003, 0x00000000, 0x0000000f, 0x505f5653, 0x5449534f, 0x004e4f49,
+};
+
+static const DWORD ps_code[] =
+{
+#if 0
+    float4 color;
+
+    float4 main() : SV_TARGET
+    {
+        return color;
+    }
+#endif
+    0x43425844, 0xe7ffb369, 0x72bb84ee, 0x6f684dcd, 0xd367d788, 0x00000001, 0x00000158, 0x00000005,
+    0x00000034, 0x00000080, 0x000000cc, 0x00000114, 0x00000124, 0x53414e58, 0x00000044, 0x00000044,
+    0xffff0200, 0x00000014, 0x00000030, 0x00240001, 0x00300000, 0x00300000, 0x00240000, 0x00300000,
+    0x00000000, 0x00000001, 0x00000000, 0xffff0200, 0x02000001, 0x800f0800, 0xa0e40000, 0x0000ffff,
+    0x396e6f41, 0x00000044, 0x00000044, 0xffff0200, 0x00000014, 0x00000030, 0x00240001, 0x00300000,
+    0x00300000, 0x00240000, 0x00300000, 0x00000000, 0x00000001, 0x00000000, 0xffff0200, 0x02000001,
+    0x800f0800, 0xa0e40000, 0x0000ffff, 0x52444853, 0x00000040, 0x00000040, 0x00000010, 0x04000059,
+    0x00208e46, 0x00000000, 0x00000001, 0x03000065, 0x001020f2, 0x00000000, 0x06000036, 0x001020f2,
+    0x00000000, 0x00208e46, 0x00000000, 0x00000000, 0x0100003e, 0x4e475349, 0x00000008, 0x00000000,
+    0x00000008, 0x4e47534f, 0x0000002c, 0x00000001, 0x00000008, 0x00000020, 0x00000000, 0x00000000,
+    0x00000003, 0x00000000, 0x0000000f, 0x545f5653, 0x45475241, 0xabab0054,
+};
+
+static const struct bench_test tests[] =
+{
+    /* Every draw is issued on the immediate context by the main thread. */
+    {"immediate", FALSE},
+    /* The draws are split between worker threads, which record them on
+     * deferred contexts. The main thread executes the command lists. */
+    {"deferred", TRUE},
+};
+
+static const unsigned int default_draw_counts[] = {1000, 10000};
+static const unsigned int default_thread_counts[] = {1, 2, 4, 8};
+
+static unsigned int option_draws, option_threads, option_frames = 100;
+
+static const struct bench_option options[] =
+{
+    {'n', "draws", "Issue draws draw calls per frame, from %u to %u.", 1, BENCH_MAX_DRAWS, NULL, 0, &option_draws},
+    {'j', "threads", "Number of threads recording the deferred tests, from %u to %u.", 1, BENCH_MAX_THREADS,
+            NULL, 0, &option_threads},
+    {'f', "frames", "Number of timed frames, 100 by default.", 1, ~0u / sizeof(double), NULL, 0, &option_frames},
+};
+
+static const char *get_test_name(unsigned int idx)
+{
+    return tests[idx].name;
+}
+
+static const struct bench_desc bench_desc =
+{
+    "d3d11bench",
+    "test,threads,draws,frames,total_ms,avg_frame_ms,min_frame_ms,p95_frame_ms,max_frame_ms",
+    "Each draw call binds a constant buffer and draws a single triangle.",
+    get_test_name, ARRAY_SIZE(tests), options, ARRAY_SIZE(options),
+};
+
+static void set_pipeline(struct bench_context *ctx, ID3D11DeviceContext *context)
+{
+    unsigned int stride = sizeof(struct vec3), offset = 0;
+    D3D11_VIEWPORT viewport;
+
+    viewport.TopLeftX = 0.0f;
+    viewport.TopLeftY = 0.0f;
+    viewport.Width = BENCH_SIZE;
+    viewport.Height = BENCH_SIZE;
+    viewport.MinDepth = 0.0f;
+    viewport.MaxDepth = 1.0f;
+
+    ID3D11DeviceContext_IASetInputLayout(context, ctx->input_layout);
+    ID3D11DeviceContext_IASetPrimitiveTopology(context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    ID3D11DeviceContext_IASetVertexBuffers(context, 0, 1, &ctx->vb, &stride, &offset);
+    ID3D11DeviceContext_VSSetShader(context, ctx->vs, NULL, 0);
+    ID3D11DeviceContext_PSSetShader(context, ctx->ps, NULL, 0);
+    ID3D11DeviceContext_RSSetViewports(context, 1, &viewport);
+    ID3D11DeviceContext_OMSetRenderTargets(context, 1, &ctx->rtv, NULL);
+}
+
+static void record_draws(struct bench_context *ctx, ID3D11DeviceContext *context,
+        unsigned int first, unsigned int count)
+{
+    unsigned int i;
+
+    set_pipeline(ctx, context);
+    for (i = first; i < first + count; ++i)
+    {
+        ID3D11DeviceContext_PSSetConstantBuffers(context, 0, 1, &ctx->cb[i % BENCH_COLOUR_COUNT]);
+        ID3D11DeviceContext_Draw(context, 3, (i % BENCH_TRIANGLE_COUNT) * 3);
+    }
+}
+
+static DWORD WINAPI worker_thread(void *param)
+{
+    struct bench_worker *worker = param;
+    struct bench_context *ctx = worker->ctx;
+    HRESULT hr;
+
+    for (;;)
+    {
+        WaitForSingleObject(worker->start_event, INFINITE);
+        if (worker->quit)
+            break;
+
+        record_draws(ctx, worker->context, worker->first, worker->count);
+        if (FAILED(hr = ID3D11DeviceContext_FinishCommandList(worker->context, FALSE, &worker->list)))
+        {
+            fprintf(stderr, "FinishCommandList() failed, hr %#lx.\n", hr);
+            worker->list = NULL;
+        }
+        SetEvent(ctx->done_events[worker - ctx->workers]);
+    }
+
+    return 0;
+}
+
+static void destroy_workers(struct bench_context *ctx)
+{
+    struct bench_worker *worker;
+    unsigned int i;
+
+    for (i = 0; i < ctx->worker_count; ++i)
+    {
+        worker = &ctx->workers[i];
+        if (worker->thread)
+        {
+            worker->quit = TRUE;
+            SetEvent(worker->start_event);
+            WaitForSingleObject(worker->thread, INFINITE);
+            CloseHandle(worker->thread);
+        }
+        if (worker->context)
+            ID3D11DeviceContext_Release(worker->context);
+        if (worker->start_event)
+            CloseHandle(worker->start_event);
+        if (ctx->done_events[i])
+            CloseHandle(ctx->done_events[i]);
+        ctx->done_events[i] = NULL;
+    }
+    memset(ctx->workers, 0, sizeof(ctx->workers));
+    ctx->worker_count = 0;
+}
+
+static BOOL create_workers(struct bench_context *ctx, unsigned int count)
+{
+    struct bench_worker *worker;
+    HRESULT hr;
+
+    for (ctx->worker_count = 0; ctx->worker_count < count; ++ctx->worker_count)
+    {
+        worker = &ctx->workers[ctx->worker_count];
+        worker->ctx = ctx;
+
+        if (FAILED(hr = ID3D11Device_CreateDeferredContext(ctx->device, 0, &worker->context)))
+        {
+            fprintf(stderr, "Failed to create deferred context, hr %#lx.\n", hr);
+            break;
+        }
+        if (!(worker->start_event = CreateEventW(NULL, FALSE, FALSE, NULL))
+                || !(ctx->done_events[ctx->worker_count] = CreateEventW(NULL, FALSE, FALSE, NULL)))
+        {
+            fprintf(stderr, "Failed to create event, error %lu.\n", GetLastError());
+            break;
+        }
+        if (!(worker->thread = CreateThread(NULL, 0, worker_thread, worker, 0, NULL)))
+        {
+            fprintf(stderr, "Failed to create thread, error %lu.\n", GetLastError());
+            break;
+        }
+    }
+
+    if (ctx->worker_count < count)
+    {
+        /* Also clean up the partially created worker. */
+        ++ctx->worker_count;
+        destroy_workers(ctx);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static ID3D11Buffer *create_buffer(ID3D11Device *device, unsigned int bind_flags,
+        unsigned int size, const void *data)
+{
+    D3D11_SUBRESOURCE_DATA resource_data;
+    D3D11_BUFFER_DESC buffer_desc;
+    ID3D11Buffer *buffer;
+
+    buffer_desc.ByteWidth = size;
+    buffer_desc.Usage = D3D11_USAGE_IMMUTABLE;
+    buffer_desc.BindFlags = bind_flags;
+    buffer_desc.CPUAccessFlags = 0;
+    buffer_desc.MiscFlags = 0;
+    buffer_desc.StructureByteStride = 0;
+
+    resource_data.pSysMem = data;
+    resource_data.SysMemPitch = 0;
+    resource_data.SysMemSlicePitch = 0;
+
+    if (FAILED(ID3D11Device_CreateBuffer(device, &buffer_desc, &resource_data, &buffer)))
+        return NULL;
+    return buffer;
+}
+
+static BOOL create_context(struct bench_context *ctx)
+{
+    static const D3D_DRIVER_TYPE driver_types[] = {D3D_DRIVER_TYPE_HARDWARE, D3D_DRIVER_TYPE_WARP};
+    static const D3D11_INPUT_ELEMENT_DESC layout_desc[] =
+    {
+        {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+    };
+    struct vec3 vertices[BENCH_TRIANGLE_COUNT * 3], *v;
+    float cell = 2.0f / BENCH_GRID_SIZE, x, y;
+    D3D11_TEXTURE2D_DESC texture_desc;
+    D3D11_QUERY_DESC query_desc;
+    ID3D11Texture2D *texture;
+    struct vec4 colour;
+    unsigned int i;
+    HRESULT hr;
+
+    memset(ctx, 0, sizeof(*ctx));
+
+    for (i = 0; i < ARRAY_SIZE(driver_types); ++i)
+    {
+        if (SUCCEEDED(D3D11CreateDevice(NULL, driver_types[i], NULL, 0,
+                NULL, 0, D3D11_SDK_VERSION, &ctx->device, NULL, &ctx->immediate_context)))
+            break;
+    }
+    if (!ctx->device)
+    {
+        fprintf(stderr, "Failed to create a Direct3D 11 device.\n");
+        return FALSE;
+    }
+
+    texture_desc.Width = BENCH_SIZE;
+    texture_desc.Height = BENCH_SIZE;
+    texture_desc.MipLevels = 1;
+    texture_desc.ArraySize = 1;
+    texture_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    texture_desc.SampleDesc.Count = 1;
+    texture_desc.SampleDesc.Quality = 0;
+    texture_desc.Usage = D3D11_USAGE_DEFAULT;
+    texture_desc.BindFlags = D3D11_BIND_RENDER_TARGET;
+    texture_desc.CPUAccessFlags = 0;
+    texture_desc.MiscFlags = 0;
+    if (FAILED(hr = ID3D11Device_CreateTexture2D(ctx->device, &texture_desc, NULL, &texture)))
+    {
+        fprintf(stderr, "Failed to create texture, hr %#lx.\n", hr);
+        return FALSE;
+    }
+    hr = ID3D11Device_CreateRenderTargetView(ctx->device, (ID3D11Resource *)texture, NULL, &ctx->rtv);
+    ID3D11Texture2D_Release(texture);
+    if (FAILED(hr))
+    {
+        fprintf(stderr, "Failed to create render target view, hr %#lx.\n", hr);
+        return FALSE;
+    }
+
+    query_desc.Query = D3D11_QUERY_EVENT;
+    query_desc.MiscFlags = 0;
+    if (FAILED(hr = ID3D11Device_CreateQuery(ctx->device, &query_desc, &ctx->query)))
+    {
+        fprintf(stderr, "Failed to create query, hr %#lx.\n", hr);
+        return FALSE;
+    }
+
+    if (FAILED(hr = ID3D11Device_CreateVertexShader(ctx->device, vs_code, sizeof(vs_code), NULL, &ctx->vs)))
+    {
+        fprintf(stderr, "Failed to create vertex shader, hr %#lx.\n", hr);
+        return FALSE;
+    }
+    if (FAILED(hr = ID3D11Device_CreatePixelShader(ctx->device, ps_code, sizeof(ps_code), NULL, &ctx->ps)))
+    {
+        fprintf(stderr, "Failed to create pixel shader, hr %#lx.\n", hr);
+        return FALSE;
+    }
+    if (FAILED(hr = ID3D11Device_CreateInputLayout(ctx->device, layout_desc, ARRAY_SIZE(layout_desc),
+            vs_code, sizeof(vs_code), &ctx->input_layout)))
+    {
+        fprintf(stderr, "Failed to create input layout, hr %#lx.\n", hr);
+        return FALSE;
+    }
+
+    /* One small triangle in each cell of a grid covering the render target. */
+    for (i = 0, v = vertices; i < BENCH_TRIANGLE_COUNT; ++i, v += 3)
+    {
+        x = -1.0f + (i % BENCH_GRID_SIZE) * cell;
+        y = -1.0f + (i / BENCH_GRID_SIZE) * cell;
+        v[0].x = x;
+        v[0].y = y;
+        v[1].x = x + cell * 0.5f;
+        v[1].y = y + cell;
+        v[2].x = x + cell;
+        v[2].y = y;
+        v[0].z = v[1].z = v[2].z = 0.0f;
+    }
+    if (!(ctx->vb = create_buffer(ctx->device, D3D11_BIND_VERTEX_BUFFER, sizeof(vertices), vertices)))
+    {
+        fprintf(stderr, "Failed to create vertex buffer.\n");
+        return FALSE;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(ctx->cb); ++i)
+    {
+        colour.x = (i & 1) ? 1.0f : 0.25f;
+        colour.y = (i & 2) ? 1.0f : 0.25f;
+        colour.z = (i & 4) ? 1.0f : 0.25f;
+        colour.w = (i & 8) ? 1.0f : 0.5f;
+        if (!(ctx->cb[i] = create_buffer(ctx->device, D3D11_BIND_CONSTANT_BUFFER, sizeof(colour), &colour)))
+        {
+            fprintf(stderr, "Failed to create constant buffer.\n");
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static void destroy_context(struct bench_context *ctx)
+{
+    unsigned int i;
+
+    destroy_workers(ctx);
+
+    for (i = 0; i < ARRAY_SIZE(ctx->cb); ++i)
+    {
+        if (ctx->cb[i])
+            ID3D11Buffer_Release(ctx->cb[i]);
+    }
+    if (ctx->vb)
+        ID3D11Buffer_Release(ctx->vb);
+    if (ctx->input_layout)
+        ID3D11InputLayout_Release(ctx->input_layout);
+    if (ctx->ps)
+        ID3D11PixelShader_Release(ctx->ps);
+    if (ctx->vs)
+        ID3D11VertexShader_Release(ctx->vs);
+    if (ctx->query)
+        ID3D11Query_Release(ctx->query);
+    if (ctx->rtv)
+        ID3D11RenderTargetView_Release(ctx->rtv);
+    if (ctx->immediate_context)
+        ID3D11DeviceContext_Release(ctx->immediate_context);
+    if (ctx->device)
+        ID3D11Device_Release(ctx->device);
+}
+
+/* Wait for the GPU, so that the frame time includes the work it was given. */
+static void finish_frame(struct bench_context *ctx)
+{
+    ID3D11DeviceContext_End(ctx->immediate_context, (ID3D11Asynchronous *)ctx->query);
+    while (ID3D11DeviceContext_GetData(ctx->immediate_context, (ID3D11Asynchronous *)ctx->query,
+            NULL, 0, 0) == S_FALSE)
+        Sleep(0);
+}
+
+static void submit_deferred(struct bench_context *ctx, unsigned int draw_count)
+{
+    struct bench_worker *worker;
+    unsigned int i;
+
+    for (i = 0; i < ctx->worker_count; ++i)
+    {
+        worker = &ctx->workers[i];
+        worker->first = draw_count * i / ctx->worker_count;
+        worker->count = draw_count * (i + 1) / ctx->worker_count - worker->first;
+        SetEvent(worker->start_event);
+    }
+    WaitForMultipleObjects(ctx->worker_count, ctx->done_events, TRUE, INFINITE);
+
+    for (i = 0; i < ctx->worker_count; ++i)
+    {
+        worker = &ctx->workers[i];
+        if (!worker->list)
+            continue;
+        ID3D11DeviceContext_ExecuteCommandList(ctx->immediate_context, worker->list, FALSE);
+        ID3D11CommandList_Release(worker->list);
+        worker->list = NULL;
+    }
+}
+
+static void run_test(struct bench_context *ctx, const struct bench_test *test,
+        unsigned int thread_count, unsigned int draw_count, unsigned int frames)
+{
+    static const float clear_colour[] = {0.0f, 0.0f, 0.0f, 1.0f};
+    struct bench_frame_stats stats;
+    struct bench_timer timer;
+    double *times;
+    unsigned int i;
+
+    if (test->deferred && !create_workers(ctx, thread_count))
+        return;
+
+    if (!(times = malloc(frames * sizeof(*times))))
+    {
+        destroy_workers(ctx);
+        return;
+    }
+
+    /* The first frame is a warm-up, and isn't timed. */
+    for (i = 0; i <= frames; ++i)
+    {
+        bench_timer_start(&timer);
+        ID3D11DeviceContext_ClearRenderTargetView(ctx->immediate_context, ctx->rtv, clear_colour);
+        if (test->deferred)
+            submit_deferred(ctx, draw_count);
+        else
+            record_draws(ctx, ctx->immediate_context, 0, draw_count);
+        finish_frame(ctx);
+
+        if (i)
+            times[i - 1] = bench_timer_elapsed_ms(&timer);
+    }
+
+    bench_get_frame_stats(times, frames, &stats);
+    printf("%s,%u,%u,%u,%.3f,%.3f,%.3f,%.3f,%.3f\n", test->name, thread_count, draw_count, frames,
+            stats.total_ms, stats.avg_ms, stats.min_ms, stats.p95_ms, stats.max_ms);
+    fflush(stdout);
+
+    free(times);
+    destroy_workers(ctx);
+}
+
+int __cdecl wmain(int argc, WCHAR *argv[])
+{
+    unsigned int selected[ARRAY_SIZE(tests)], selected_count;
+    unsigned int thread_count_count = ARRAY_SIZE(default_thread_counts);
+    unsigned int draw_count_count = ARRAY_SIZE(default_draw_counts);
+    const unsigned int *thread_counts = default_thread_counts;
+    const unsigned int *draw_counts = default_draw_counts;
+    const struct bench_test *test;
+    struct bench_context ctx;
+    unsigned int i, j, k;
+    int ret;
+
+    if (!bench_parse_command_line(&bench_desc, argc, argv, selected, &selected_count, &ret))
+        return ret;
+    if (option_draws)
+    {
+        draw_counts = &option_draws;
+        draw_count_count = 1;
+    }
+    if (option_threads)
+    {
+        thread_counts = &option_threads;
+        thread_count_count = 1;
+    }
+
+    if (!create_context(&ctx))
+    {
+        destroy_context(&ctx);
+        return 1;
+    }
+
+    bench_print_header(&bench_desc);
+    for (i = 0; i < selected_count; ++i)
+    {
+        test = &tests[selected[i]];
+        for (j = 0; j < draw_count_count; ++j)
+        {
+            /* The immediate context is only used from the main thread. */
+            if (!test->deferred)
+            {
+                run_test(&ctx, test, 1, draw_counts[j], option_frames);
+                continue;
+            }
+            for (k = 0; k < thread_count_count; ++k)
+                run_test(&ctx, test, thread_counts[k], draw_counts[j], option_frames);
+        }
+    }
+
+    destroy_context(&ctx);
+
+    return 0;
+}
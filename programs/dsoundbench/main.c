@@ -0,0 +1,259 @@
+/*
+ * DirectSound software mixer benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#define COBJMACROS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <windows.h>
+#include <mmreg.h>
+#include "dsound.h"
+
+#include "bench.h"
+
+#define BENCH_MAX_BUFFERS 1024
+
+struct bench_test
+{
+    const char *name;
+    WORD format_tag;
+    WORD channels;
+    WORD bits;
+    DWORD rate;         /* 0 for the rate of the primary buffer */
+    DWORD flags;
+    BOOL vary;          /* vary volume, pan and frequency across buffers */
+};
+
+static const struct bench_test tests[] =
+{
+    {"pcm16_stereo_native", WAVE_FORMAT_PCM, 2, 16, 0, 0, FALSE},
+    {"pcm16_stereo_44100", WAVE_FORMAT_PCM, 2, 16, 44100, 0, FALSE},
+    {"pcm8_mono_22050", WAVE_FORMAT_PCM, 1, 8, 22050, 0, FALSE},
+    {"float_stereo_native", WAVE_FORMAT_IEEE_FLOAT, 2, 32, 0, 0, FALSE},
+    {"pcm16_volume_pan", WAVE_FORMAT_PCM, 2, 16, 0, DSBCAPS_CTRLVOLUME | DSBCAPS_CTRLPAN, TRUE},
+    {"pcm16_mono_pitch", WAVE_FORMAT_PCM, 1, 16, 22050,
+            DSBCAPS_CTRLFREQUENCY | DSBCAPS_CTRLVOLUME | DSBCAPS_CTRLPAN, TRUE},
+};
+
+static const unsigned int default_counts[] = {1, 16, 64, 128, 256};
+
+static unsigned int option_count, option_seconds = 2;
+
+static const struct bench_option options[] =
+{
+    {'n', "count", "Play count secondary buffers at once, from %u to %u.",
+            1, BENCH_MAX_BUFFERS, NULL, 0, &option_count},
+    {'s', "seconds", "Number of timed seconds per run, 2 by default.", 1, 3600, NULL, 0, &option_seconds},
+};
+
+static const char *get_test_name(unsigned int idx)
+{
+    return tests[idx].name;
+}
+
+static const struct bench_desc bench_desc =
+{
+    "dsoundbench",
+    "test,buffers,buffer_rate,primary_rate,wall_ms,cpu_ms,cpu_ms_per_s,cpu_percent",
+    "The CPU time is the one of the whole process, which is mostly the mixer thread.",
+    get_test_name, ARRAY_SIZE(tests), options, ARRAY_SIZE(options),
+};
+
+static void fill_buffer(IDirectSoundBuffer *buffer, const WAVEFORMATEX *format, unsigned int index)
+{
+    DWORD size1, size2, frames, i, c;
+    void *ptr1, *ptr2;
+    float value;
+
+    if (FAILED(IDirectSoundBuffer_Lock(buffer, 0, 0, &ptr1, &size1, &ptr2, &size2, DSBLOCK_ENTIREBUFFER)))
+        return;
+
+    /* A quiet tone, different for each buffer, so that nothing is skipped as silence. */
+    frames = size1 / format->nBlockAlign;
+    for (i = 0; i < frames; ++i)
+    {
+        value = 0.1f * sinf(2.0f * 3.14159265f * (220.0f + index * 7.0f) * i / format->nSamplesPerSec);
+        for (c = 0; c < format->nChannels; ++c)
+        {
+            BYTE *p = (BYTE *)ptr1 + i * format->nBlockAlign + c * format->wBitsPerSample / 8;
+
+            if (format->wFormatTag == WAVE_FORMAT_IEEE_FLOAT)
+                *(float *)p = value;
+            else if (format->wBitsPerSample == 16)
+                *(SHORT *)p = value * 0x7fff;
+            else
+                *p = 0x80 + (int)(value * 0x7f);
+        }
+    }
+
+    IDirectSoundBuffer_Unlock(buffer, ptr1, size1, ptr2, size2);
+}
+
+static ULONGLONG get_cpu_time(void)
+{
+    FILETIME creation, exit_time, kernel, user;
+
+    GetProcessTimes(GetCurrentProcess(), &creation, &exit_time, &kernel, &user);
+    return ((ULONGLONG)kernel.dwHighDateTime << 32 | kernel.dwLowDateTime)
+            + ((ULONGLONG)user.dwHighDateTime << 32 | user.dwLowDateTime);
+}
+
+static void run_test(IDirectSound8 *dsound, DWORD primary_rate, const struct bench_test *test,
+        unsigned int count, unsigned int seconds)
+{
+    static IDirectSoundBuffer *buffers[BENCH_MAX_BUFFERS];
+    ULONGLONG cpu_start, cpu_end;
+    struct bench_timer timer;
+    DSBUFFERDESC desc;
+    WAVEFORMATEX format;
+    unsigned int i, created;
+    double wall_ms, cpu_ms;
+    HRESULT hr;
+
+    format.wFormatTag = test->format_tag;
+    format.nChannels = test->channels;
+    format.wBitsPerSample = test->bits;
+    format.nSamplesPerSec = test->rate ? test->rate : primary_rate;
+    format.nBlockAlign = format.nChannels * format.wBitsPerSample / 8;
+    format.nAvgBytesPerSec = format.nSamplesPerSec * format.nBlockAlign;
+    format.cbSize = 0;
+
+    memset(&desc, 0, sizeof(desc));
+    desc.dwSize = sizeof(desc);
+    desc.dwFlags = DSBCAPS_GLOBALFOCUS | DSBCAPS_GETCURRENTPOSITION2 | test->flags;
+    desc.dwBufferBytes = format.nAvgBytesPerSec / 2;
+    desc.lpwfxFormat = &format;
+
+    for (created = 0; created < count; ++created)
+    {
+        if (FAILED(hr = IDirectSound8_CreateSoundBuffer(dsound, &desc, &buffers[created], NULL)))
+        {
+            fprintf(stderr, "%s: CreateSoundBuffer() failed, hr %#lx.\n", test->name, hr);
+            break;
+        }
+        fill_buffer(buffers[created], &format, created);
+
+        if (test->vary)
+        {
+            IDirectSoundBuffer_SetVolume(buffers[created], -(LONG)(created % 16) * 100);
+            IDirectSoundBuffer_SetPan(buffers[created], (LONG)(created % 21) * 500 - 5000);
+            if (test->flags & DSBCAPS_CTRLFREQUENCY)
+                IDirectSoundBuffer_SetFrequency(buffers[created], 11025 + created * 997 % 33075);
+        }
+    }
+
+    if (created == count)
+    {
+        for (i = 0; i < count; ++i)
+            IDirectSoundBuffer_Play(buffers[i], 0, 0, DSBPLAY_LOOPING);
+
+        /* Let the mixer settle before timing it. */
+        Sleep(200);
+
+        bench_timer_start(&timer);
+        cpu_start = get_cpu_time();
+        Sleep(seconds * 1000);
+        cpu_end = get_cpu_time();
+        wall_ms = bench_timer_elapsed_ms(&timer);
+
+        for (i = 0; i < count; ++i)
+            IDirectSoundBuffer_Stop(buffers[i]);
+
+        cpu_ms = (cpu_end - cpu_start) / 10000.0;
+        printf("%s,%u,%lu,%lu,%.3f,%.3f,%.3f,%.2f\n", test->name, count, format.nSamplesPerSec, primary_rate,
+                wall_ms, cpu_ms, cpu_ms * 1000.0 / wall_ms, cpu_ms * 100.0 / wall_ms);
+        fflush(stdout);
+    }
+
+    for (i = 0; i < created; ++i)
+        IDirectSoundBuffer_Release(buffers[i]);
+}
+
+int __cdecl wmain(int argc, WCHAR *argv[])
+{
+    unsigned int selected[ARRAY_SIZE(tests)], selected_count;
+    unsigned int count_count = ARRAY_SIZE(default_counts);
+    const unsigned int *counts = default_counts;
+    WAVEFORMATEXTENSIBLE format;
+    IDirectSoundBuffer *primary;
+    IDirectSound8 *dsound;
+    DSBUFFERDESC desc;
+    unsigned int i, j;
+    HRESULT hr;
+    int ret;
+
+    if (!bench_parse_command_line(&bench_desc, argc, argv, selected, &selected_count, &ret))
+        return ret;
+    if (option_count)
+    {
+        counts = &option_count;
+        count_count = 1;
+    }
+
+    if (FAILED(hr = DirectSoundCreate8(NULL, &dsound, NULL)))
+    {
+        fprintf(stderr, "Failed to create DirectSound object, hr %#lx.\n", hr);
+        return 1;
+    }
+    if (FAILED(hr = IDirectSound8_SetCooperativeLevel(dsound, GetDesktopWindow(), DSSCL_PRIORITY)))
+    {
+        fprintf(stderr, "Failed to set cooperative level, hr %#lx.\n", hr);
+        IDirectSound8_Release(dsound);
+        return 1;
+    }
+
+    /* The mixer resamples everything to the rate of the primary buffer. Ask
+     * for the usual 48 kHz; the driver may still pick something else. */
+    memset(&desc, 0, sizeof(desc));
+    desc.dwSize = sizeof(desc);
+    desc.dwFlags = DSBCAPS_PRIMARYBUFFER;
+    if (FAILED(hr = IDirectSound8_CreateSoundBuffer(dsound, &desc, &primary, NULL)))
+    {
+        fprintf(stderr, "Failed to get primary buffer, hr %#lx.\n", hr);
+        IDirectSound8_Release(dsound);
+        return 1;
+    }
+    format.Format.wFormatTag = WAVE_FORMAT_PCM;
+    format.Format.nChannels = 2;
+    format.Format.wBitsPerSample = 16;
+    format.Format.nSamplesPerSec = 48000;
+    format.Format.nBlockAlign = format.Format.nChannels * format.Format.wBitsPerSample / 8;
+    format.Format.nAvgBytesPerSec = format.Format.nSamplesPerSec * format.Format.nBlockAlign;
+    format.Format.cbSize = 0;
+    IDirectSoundBuffer_SetFormat(primary, &format.Format);
+    hr = IDirectSoundBuffer_GetFormat(primary, &format.Format, sizeof(format), NULL);
+    IDirectSoundBuffer_Release(primary);
+    if (FAILED(hr))
+    {
+        fprintf(stderr, "Failed to get primary buffer format, hr %#lx.\n", hr);
+        IDirectSound8_Release(dsound);
+        return 1;
+    }
+
+    bench_print_header(&bench_desc);
+    for (i = 0; i < selected_count; ++i)
+    {
+        for (j = 0; j < count_count; ++j)
+            run_test(dsound, format.Format.nSamplesPerSec, &tests[selected[i]], counts[j], option_seconds);
+    }
+
+    IDirectSound8_Release(dsound);
+
+    return 0;
+}
@@ -0,0 +1,197 @@
+/*
+ * Benchmark harness shared by the *bench programs
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+
+#include "bench.h"
+
+static void usage(const struct bench_desc *desc)
+{
+    const struct bench_option *option;
+    unsigned int i;
+
+    fprintf(stderr, "Usage: %s [-t test]", desc->name);
+    for (i = 0; i < desc->option_count; ++i)
+        fprintf(stderr, " [-%c %s]", (char)desc->options[i].letter, desc->options[i].arg);
+    fprintf(stderr, " [-l]\n\n");
+
+    fprintf(stderr, "  -t %-12sRun only the named test. May be given more than once.\n", "test");
+    for (i = 0; i < desc->option_count; ++i)
+    {
+        option = &desc->options[i];
+        fprintf(stderr, "  -%c %-12s", (char)option->letter, option->arg);
+        fprintf(stderr, option->description, option->min, option->max);
+        fprintf(stderr, "\n");
+    }
+    fprintf(stderr, "  -l %-12sList the available tests.\n\n", "");
+
+    fprintf(stderr, "Results are written to standard output as CSV with the columns\n%s.\n", desc->columns);
+    if (desc->notes)
+        fprintf(stderr, "%s\n", desc->notes);
+    fprintf(stderr, "\nTests:");
+    for (i = 0; i < desc->test_count; ++i)
+        fprintf(stderr, " %s", desc->get_test_name(i));
+    fprintf(stderr, "\n");
+}
+
+static BOOL parse_option_value(const struct bench_option *option, const WCHAR *arg)
+{
+    unsigned int value = _wtoi(arg), i;
+
+    if (option->values)
+    {
+        for (i = 0; i < option->value_count; ++i)
+        {
+            if (option->values[i] == value)
+                break;
+        }
+        if (i == option->value_count)
+        {
+            fprintf(stderr, "Unsupported %s %u.\n", option->arg, value);
+            return FALSE;
+        }
+    }
+    else if (value < option->min || value > option->max)
+    {
+        fprintf(stderr, "The %s must be between %u and %u.\n", option->arg, option->min, option->max);
+        return FALSE;
+    }
+
+    *option->value = value;
+    return TRUE;
+}
+
+BOOL bench_parse_command_line(const struct bench_desc *desc, int argc, WCHAR *argv[],
+        unsigned int *selected, unsigned int *selected_count, int *ret)
+{
+    const struct bench_option *option;
+    unsigned int i;
+    char name[64];
+    int arg;
+
+    *selected_count = 0;
+    *ret = 1;
+
+    for (arg = 1; arg < argc; ++arg)
+    {
+        if (!wcscmp(argv[arg], L"-l"))
+        {
+            for (i = 0; i < desc->test_count; ++i)
+                printf("%s\n", desc->get_test_name(i));
+            *ret = 0;
+            return FALSE;
+        }
+
+        if (argv[arg][0] != '-' || !argv[arg][1] || argv[arg][2] || arg + 1 == argc)
+        {
+            usage(desc);
+            return FALSE;
+        }
+
+        if (argv[arg++][1] == 't')
+        {
+            WideCharToMultiByte(CP_ACP, 0, argv[arg], -1, name, sizeof(name), NULL, NULL);
+            for (i = 0; i < desc->test_count; ++i)
+            {
+                if (!strcmp(desc->get_test_name(i), name))
+                    break;
+            }
+            if (i == desc->test_count)
+            {
+                fprintf(stderr, "Unknown test %s.\n", name);
+                return FALSE;
+            }
+            if (*selected_count < desc->test_count)
+                selected[(*selected_count)++] = i;
+            continue;
+        }
+
+        for (i = 0, option = NULL; i < desc->option_count; ++i)
+        {
+            if (desc->options[i].letter == argv[arg - 1][1])
+                option = &desc->options[i];
+        }
+        if (!option)
+        {
+            usage(desc);
+            return FALSE;
+        }
+        if (!parse_option_value(option, argv[arg]))
+            return FALSE;
+    }
+
+    if (!*selected_count)
+    {
+        for (i = 0; i < desc->test_count; ++i)
+            selected[(*selected_count)++] = i;
+    }
+
+    *ret = 0;
+    return TRUE;
+}
+
+void bench_print_header(const struct bench_desc *desc)
+{
+    printf("%s\n", desc->columns);
+    fflush(stdout);
+}
+
+void bench_timer_start(struct bench_timer *timer)
+{
+    QueryPerformanceFrequency(&timer->frequency);
+    QueryPerformanceCounter(&timer->start);
+}
+
+double bench_timer_elapsed_ms(const struct bench_timer *timer)
+{
+    LARGE_INTEGER now;
+
+    QueryPerformanceCounter(&now);
+    return (now.QuadPart - timer->start.QuadPart) * 1000.0 / timer->frequency.QuadPart;
+}
+
+unsigned int bench_default_iterations(unsigned int pixel_count)
+{
+    unsigned int iterations = (16u << 20) / pixel_count;
+
+    return min(max(iterations, 10), 10000);
+}
+
+static int __cdecl compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+void bench_get_frame_stats(double *times, unsigned int count, struct bench_frame_stats *stats)
+{
+    unsigned int i;
+
+    qsort(times, count, sizeof(*times), compare_double);
+    stats->total_ms = 0.0;
+    for (i = 0; i < count; ++i)
+        stats->total_ms += times[i];
+    stats->avg_ms = stats->total_ms / count;
+    stats->min_ms = times[0];
+    stats->p95_ms = times[(count - 1) * 95 / 100];
+    stats->max_ms = times[count - 1];
+}
@@ -0,0 +1,73 @@
+/*
+ * Benchmark harness shared by the *bench programs
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef __WINE_BENCH_H
+#define __WINE_BENCH_H
+
+#include <windef.h>
+
+/* A command line option taking a number. */
+struct bench_option
+{
+    WCHAR letter;
+    const char *arg;            /* Name of the value in the usage message. */
+    const char *description;    /* Format string, passed the minimum and maximum value. */
+    unsigned int min, max;
+    const unsigned int *values; /* If not NULL, the only values allowed. */
+    unsigned int value_count;
+    unsigned int *value;
+};
+
+struct bench_desc
+{
+    const char *name;
+    const char *columns;        /* Names of the CSV columns. */
+    const char *notes;          /* Additional usage notes, or NULL. */
+    const char *(*get_test_name)(unsigned int idx);
+    unsigned int test_count;
+    const struct bench_option *options;
+    unsigned int option_count;
+};
+
+struct bench_timer
+{
+    LARGE_INTEGER frequency, start;
+};
+
+struct bench_frame_stats
+{
+    double total_ms, avg_ms, min_ms, p95_ms, max_ms;
+};
+
+/* Parse the -t, -l and program specific options. "selected" receives the
+ * indices of the tests to run, all of them if none were named. Returns FALSE
+ * if the program should exit with the code returned in "ret". */
+BOOL bench_parse_command_line(const struct bench_desc *desc, int argc, WCHAR *argv[],
+        unsigned int *selected, unsigned int *selected_count, int *ret);
+void bench_print_header(const struct bench_desc *desc);
+
+void bench_timer_start(struct bench_timer *timer);
+double bench_timer_elapsed_ms(const struct bench_timer *timer);
+
+/* Iterations for a test processing "pixel_count" pixels per call, so that
+ * each run takes a comparable time. */
+unsigned int bench_default_iterations(unsigned int pixel_count);
+/* Sorts "times". */
+void bench_get_frame_stats(double *times, unsigned int count, struct bench_frame_stats *stats);
+
+#endif  /* __WINE_BENCH_H */
@@ -0,0 +1,475 @@
+/*
+ * GDI and DIB engine benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+
+#include "bench.h"
+
+struct bench_surface
+{
+    HDC dc;
+    HBITMAP bitmap, old_bitmap;
+    void *bits;
+    unsigned int bpp, width, height;
+};
+
+#define BENCH_WINDOW_COUNT 32
+#define BENCH_MIN_SIZE 16
+#define BENCH_MAX_SIZE 4096
+
+struct bench_context
+{
+    struct bench_surface dst;
+    struct bench_surface src;       /* Same format as dst. */
+    struct bench_surface src_argb;  /* 32 bpp, premultiplied alpha. */
+    HBRUSH brush;
+
+    /* Window clip set for the region tests, in stacking order from the bottom. */
+    unsigned int size;
+    HRGN windows[BENCH_WINDOW_COUNT];
+    HRGN visible, clip, result;
+};
+
+/* The test doesn't draw, and doesn't depend on the bit depth. */
+#define BENCH_REGION 0x1
+
+struct bench_test
+{
+    const char *name;
+    void (*run)(struct bench_context *ctx);
+    unsigned int flags;
+};
+
+static void fill_pattern(struct bench_surface *surface)
+{
+    unsigned int stride = ((surface->width * surface->bpp + 31) / 32) * 4;
+    BYTE *bits = surface->bits;
+    unsigned int i, size;
+
+    size = stride * surface->height;
+    for (i = 0; i < size; ++i)
+        bits[i] = (i * 7 + (i >> 9) * 13) & 0xff;
+}
+
+static void premultiply_argb(struct bench_surface *surface)
+{
+    DWORD *pixels = surface->bits;
+    unsigned int i, alpha;
+    BYTE *c;
+
+    for (i = 0; i < surface->width * surface->height; ++i)
+    {
+        c = (BYTE *)&pixels[i];
+        alpha = (i * 3) & 0xff;
+        c[0] = c[0] * alpha / 255;
+        c[1] = c[1] * alpha / 255;
+        c[2] = c[2] * alpha / 255;
+        c[3] = alpha;
+    }
+}
+
+static BOOL create_surface(struct bench_surface *surface, unsigned int bpp, unsigned int width, unsigned int height)
+{
+    BITMAPINFO *info;
+    unsigned int i;
+
+    if (!(info = calloc(1, FIELD_OFFSET(BITMAPINFO, bmiColors[256]))))
+        return FALSE;
+
+    info->bmiHeader.biSize = sizeof(info->bmiHeader);
+    info->bmiHeader.biWidth = width;
+    info->bmiHeader.biHeight = -(int)height;
+    info->bmiHeader.biPlanes = 1;
+    info->bmiHeader.biBitCount = bpp;
+    info->bmiHeader.biCompression = BI_RGB;
+    if (bpp <= 8)
+    {
+        info->bmiHeader.biClrUsed = 1u << bpp;
+        for (i = 0; i < info->bmiHeader.biClrUsed; ++i)
+        {
+            info->bmiColors[i].rgbRed = i * 255 / (info->bmiHeader.biClrUsed - 1);
+            info->bmiColors[i].rgbGreen = (i * 37) & 0xff;
+            info->bmiColors[i].rgbBlue = 255 - info->bmiColors[i].rgbRed;
+        }
+    }
+
+    surface->bpp = bpp;
+    surface->width = width;
+    surface->height = height;
+    surface->bitmap = CreateDIBSection(NULL, info, DIB_RGB_COLORS, &surface->bits, NULL, 0);
+    free(info);
+    if (!surface->bitmap)
+        return FALSE;
+
+    surface->dc = CreateCompatibleDC(NULL);
+    surface->old_bitmap = SelectObject(surface->dc, surface->bitmap);
+    fill_pattern(surface);
+
+    return TRUE;
+}
+
+static void destroy_surface(struct bench_surface *surface)
+{
+    if (!surface->dc)
+        return;
+    SelectObject(surface->dc, surface->old_bitmap);
+    DeleteObject(surface->bitmap);
+    DeleteDC(surface->dc);
+    memset(surface, 0, sizeof(*surface));
+}
+
+/* Lay out overlapping windows on a size x size screen, with a mix of plain and
+ * rounded frames, roughly like a cluttered desktop. */
+static BOOL create_window_regions(struct bench_context *ctx, unsigned int size)
+{
+    int x, y, w, h;
+    unsigned int i;
+
+    ctx->size = size;
+    for (i = 0; i < BENCH_WINDOW_COUNT; ++i)
+    {
+        x = (i * 37) % (size / 2);
+        y = (i * 53) % (size / 2);
+        w = size / 4 + (i * 29) % (size / 3);
+        h = size / 4 + (i * 41) % (size / 3);
+        if (i % 4 == 3)
+            ctx->windows[i] = CreateRoundRectRgn(x, y, x + w, y + h, 16, 16);
+        else
+            ctx->windows[i] = CreateRectRgn(x, y, x + w, y + h);
+        if (!ctx->windows[i])
+            return FALSE;
+    }
+
+    if (!(ctx->visible = CreateRectRgn(0, 0, 0, 0)) || !(ctx->clip = CreateRectRgn(0, 0, 0, 0))
+            || !(ctx->result = CreateRectRgn(0, 0, 0, 0)))
+        return FALSE;
+
+    /* Visible region of the bottom window. */
+    CombineRgn(ctx->visible, ctx->windows[0], 0, RGN_COPY);
+    for (i = 1; i < BENCH_WINDOW_COUNT; ++i)
+        CombineRgn(ctx->visible, ctx->visible, ctx->windows[i], RGN_DIFF);
+
+    return TRUE;
+}
+
+static void destroy_window_regions(struct bench_context *ctx)
+{
+    unsigned int i;
+
+    for (i = 0; i < BENCH_WINDOW_COUNT; ++i)
+    {
+        if (ctx->windows[i])
+            DeleteObject(ctx->windows[i]);
+    }
+    if (ctx->visible)
+        DeleteObject(ctx->visible);
+    if (ctx->clip)
+        DeleteObject(ctx->clip);
+    if (ctx->result)
+        DeleteObject(ctx->result);
+}
+
+static void bench_bitblt(struct bench_context *ctx)
+{
+    BitBlt(ctx->dst.dc, 0, 0, ctx->dst.width, ctx->dst.height, ctx->src.dc, 0, 0, SRCCOPY);
+}
+
+static void bench_bitblt_convert(struct bench_context *ctx)
+{
+    BitBlt(ctx->dst.dc, 0, 0, ctx->dst.width, ctx->dst.height, ctx->src_argb.dc, 0, 0, SRCCOPY);
+}
+
+static void bench_bitblt_rop(struct bench_context *ctx)
+{
+    BitBlt(ctx->dst.dc, 0, 0, ctx->dst.width, ctx->dst.height, ctx->src.dc, 0, 0, SRCINVERT);
+}
+
+static void bench_stretchblt(struct bench_context *ctx)
+{
+    SetStretchBltMode(ctx->dst.dc, COLORONCOLOR);
+    StretchBlt(ctx->dst.dc, 0, 0, ctx->dst.width, ctx->dst.height,
+            ctx->src.dc, 0, 0, ctx->src.width / 2, ctx->src.height / 2, SRCCOPY);
+}
+
+static void bench_stretchblt_halftone(struct bench_context *ctx)
+{
+    SetStretchBltMode(ctx->dst.dc, HALFTONE);
+    StretchBlt(ctx->dst.dc, 0, 0, ctx->dst.width / 2, ctx->dst.height / 2,
+            ctx->src.dc, 0, 0, ctx->src.width, ctx->src.height, SRCCOPY);
+}
+
+static void bench_alphablend(struct bench_context *ctx)
+{
+    BLENDFUNCTION blend = {AC_SRC_OVER, 0, 255, AC_SRC_ALPHA};
+
+    GdiAlphaBlend(ctx->dst.dc, 0, 0, ctx->dst.width, ctx->dst.height,
+            ctx->src_argb.dc, 0, 0, ctx->src_argb.width, ctx->src_argb.height, blend);
+}
+
+static void bench_alphablend_constant(struct bench_context *ctx)
+{
+    BLENDFUNCTION blend = {AC_SRC_OVER, 0, 128, 0};
+
+    GdiAlphaBlend(ctx->dst.dc, 0, 0, ctx->dst.width, ctx->dst.height,
+            ctx->src_argb.dc, 0, 0, ctx->src_argb.width, ctx->src_argb.height, blend);
+}
+
+static void bench_patblt(struct bench_context *ctx)
+{
+    PatBlt(ctx->dst.dc, 0, 0, ctx->dst.width, ctx->dst.height, PATCOPY);
+}
+
+static void bench_patblt_invert(struct bench_context *ctx)
+{
+    PatBlt(ctx->dst.dc, 0, 0, ctx->dst.width, ctx->dst.height, PATINVERT);
+}
+
+static void bench_exttextout(struct bench_context *ctx)
+{
+    static const WCHAR text[] = L"The quick brown fox jumps over the lazy dog 0123456789";
+    TEXTMETRICW tm;
+    RECT rect;
+    int y;
+
+    GetTextMetricsW(ctx->dst.dc, &tm);
+    SetRect(&rect, 0, 0, ctx->dst.width, ctx->dst.height);
+    for (y = 0; y < (int)ctx->dst.height; y += tm.tmHeight)
+        ExtTextOutW(ctx->dst.dc, 0, y, ETO_CLIPPED, &rect, text, ARRAY_SIZE(text) - 1, NULL);
+}
+
+static void bench_polygon(struct bench_context *ctx)
+{
+    int w = ctx->dst.width, h = ctx->dst.height;
+    POINT star[] =
+    {
+        {w / 2, 0}, {w * 4 / 5, h - 1}, {0, h / 3}, {w - 1, h / 3}, {w / 5, h - 1},
+    };
+
+    SetPolyFillMode(ctx->dst.dc, WINDING);
+    Polygon(ctx->dst.dc, star, ARRAY_SIZE(star));
+}
+
+static void bench_gradientfill(struct bench_context *ctx)
+{
+    TRIVERTEX vertices[] =
+    {
+        {0, 0, 0xff00, 0x0000, 0x8000, 0xff00},
+        {ctx->dst.width, ctx->dst.height, 0x0000, 0xff00, 0x4000, 0x8000},
+    };
+    GRADIENT_RECT rect = {0, 1};
+
+    GdiGradientFill(ctx->dst.dc, vertices, ARRAY_SIZE(vertices), &rect, 1, GRADIENT_FILL_RECT_H);
+}
+
+static void bench_region_visible(struct bench_context *ctx)
+{
+    unsigned int i, j;
+
+    /* Visible regions of every window, clipped by the windows above it. */
+    for (i = 0; i < BENCH_WINDOW_COUNT; ++i)
+    {
+        CombineRgn(ctx->result, ctx->windows[i], 0, RGN_COPY);
+        for (j = i + 1; j < BENCH_WINDOW_COUNT; ++j)
+            CombineRgn(ctx->result, ctx->result, ctx->windows[j], RGN_DIFF);
+    }
+}
+
+static void bench_region_union(struct bench_context *ctx)
+{
+    unsigned int i;
+
+    SetRectRgn(ctx->result, 0, 0, 0, 0);
+    for (i = 0; i < BENCH_WINDOW_COUNT; ++i)
+        CombineRgn(ctx->result, ctx->result, ctx->windows[i], RGN_OR);
+}
+
+static void bench_region_clip(struct bench_context *ctx)
+{
+    unsigned int i, step = ctx->size / 16;
+
+    /* Paint rectangles clipped against a complex visible region. */
+    for (i = 0; i < 16; ++i)
+    {
+        SetRectRgn(ctx->clip, i * step / 2, i * step, i * step / 2 + ctx->size / 3, i * step + ctx->size / 4);
+        CombineRgn(ctx->result, ctx->visible, ctx->clip, RGN_AND);
+    }
+}
+
+static void bench_region_scanlines(struct bench_context *ctx)
+{
+    unsigned int y, size = ctx->size;
+
+    /* Build a shaped window region one scanline at a time, from top to bottom. */
+    SetRectRgn(ctx->result, 0, 0, 0, 0);
+    for (y = 0; y < size; ++y)
+    {
+        unsigned int inset = (y < size / 2 ? size / 2 - y : y - size / 2) / 4;
+
+        SetRectRgn(ctx->clip, inset, y, size - inset, y + 1);
+        CombineRgn(ctx->result, ctx->result, ctx->clip, RGN_OR);
+    }
+}
+
+static const struct bench_test tests[] =
+{
+    {"bitblt",                  bench_bitblt},
+    {"bitblt_convert",          bench_bitblt_convert},
+    {"bitblt_rop",              bench_bitblt_rop},
+    {"stretchblt",              bench_stretchblt},
+    {"stretchblt_halftone",     bench_stretchblt_halftone},
+    {"alphablend",              bench_alphablend},
+    {"alphablend_constant",     bench_alphablend_constant},
+    {"patblt",                  bench_patblt},
+    {"patblt_invert",           bench_patblt_invert},
+    {"exttextout",              bench_exttextout},
+    {"polygon",                 bench_polygon},
+    {"gradientfill",            bench_gradientfill},
+    {"region_visible",          bench_region_visible,   BENCH_REGION},
+    {"region_union",            bench_region_union,     BENCH_REGION},
+    {"region_clip",             bench_region_clip,      BENCH_REGION},
+    {"region_scanlines",        bench_region_scanlines, BENCH_REGION},
+};
+
+static const unsigned int default_bpps[] = {1, 4, 8, 16, 24, 32};
+static const unsigned int default_sizes[] = {64, 256, 1024};
+
+static unsigned int option_bpp, option_size, option_iterations;
+
+static const struct bench_option options[] =
+{
+    {'b', "bpp", "Run only at the given bit depth (1, 4, 8, 16, 24 or 32).",
+            0, 0, default_bpps, ARRAY_SIZE(default_bpps), &option_bpp},
+    {'s', "size", "Run only on size x size surfaces, from %u to %u.",
+            BENCH_MIN_SIZE, BENCH_MAX_SIZE, NULL, 0, &option_size},
+    {'i', "iterations", "Use a fixed iteration count instead of one scaled to the surface size.",
+            1, ~0u, NULL, 0, &option_iterations},
+};
+
+static const char *get_test_name(unsigned int idx)
+{
+    return tests[idx].name;
+}
+
+static const struct bench_desc bench_desc =
+{
+    "gdibench",
+    "test,bpp,width,height,iterations,total_ms,us_per_op,mpixels_per_sec",
+    "Region tests don't depend on the bit depth; they run once per size and report a bpp of 0.",
+    get_test_name, ARRAY_SIZE(tests), options, ARRAY_SIZE(options),
+};
+
+static void run_test(const struct bench_test *test, unsigned int bpp, unsigned int size, unsigned int iterations)
+{
+    struct bench_context ctx = {{0}};
+    struct bench_timer timer;
+    double total_ms;
+    unsigned int i;
+
+    if (test->flags & BENCH_REGION)
+    {
+        bpp = 0;
+        if (!create_window_regions(&ctx, size))
+        {
+            fprintf(stderr, "Failed to create regions for a %ux%u screen.\n", size, size);
+            goto done;
+        }
+    }
+    else
+    {
+        if (!create_surface(&ctx.dst, bpp, size, size) || !create_surface(&ctx.src, bpp, size, size)
+                || !create_surface(&ctx.src_argb, 32, size, size))
+        {
+            fprintf(stderr, "Failed to create %ux%u %u bpp surfaces.\n", size, size, bpp);
+            goto done;
+        }
+        premultiply_argb(&ctx.src_argb);
+
+        ctx.brush = CreateSolidBrush(RGB(0x40, 0x80, 0xc0));
+        SelectObject(ctx.dst.dc, ctx.brush);
+        SelectObject(ctx.dst.dc, GetStockObject(DEFAULT_GUI_FONT));
+        SetBkMode(ctx.dst.dc, TRANSPARENT);
+        SetTextColor(ctx.dst.dc, RGB(0x10, 0x20, 0x30));
+    }
+
+    /* Warm up caches, glyphs and lazily created objects. */
+    test->run(&ctx);
+    GdiFlush();
+
+    if (!iterations)
+        iterations = bench_default_iterations(size * size);
+
+    bench_timer_start(&timer);
+    for (i = 0; i < iterations; ++i)
+        test->run(&ctx);
+    GdiFlush();
+    total_ms = bench_timer_elapsed_ms(&timer);
+
+    printf("%s,%u,%u,%u,%u,%.3f,%.3f,%.2f\n", test->name, bpp, size, size, iterations, total_ms,
+            total_ms * 1000.0 / iterations, total_ms ? (double)size * size * iterations / (total_ms * 1000.0) : 0.0);
+    fflush(stdout);
+
+done:
+    if (ctx.brush)
+    {
+        SelectObject(ctx.dst.dc, GetStockObject(WHITE_BRUSH));
+        DeleteObject(ctx.brush);
+    }
+    destroy_window_regions(&ctx);
+    destroy_surface(&ctx.src_argb);
+    destroy_surface(&ctx.src);
+    destroy_surface(&ctx.dst);
+}
+
+int __cdecl wmain(int argc, WCHAR *argv[])
+{
+    unsigned int bpp_count = ARRAY_SIZE(default_bpps), size_count = ARRAY_SIZE(default_sizes);
+    const unsigned int *bpps = default_bpps, *sizes = default_sizes;
+    unsigned int selected[ARRAY_SIZE(tests)], selected_count;
+    unsigned int i, j, k;
+    int ret;
+
+    if (!bench_parse_command_line(&bench_desc, argc, argv, selected, &selected_count, &ret))
+        return ret;
+    if (option_bpp)
+    {
+        bpps = &option_bpp;
+        bpp_count = 1;
+    }
+    if (option_size)
+    {
+        sizes = &option_size;
+        size_count = 1;
+    }
+
+    bench_print_header(&bench_desc);
+    for (i = 0; i < selected_count; ++i)
+    {
+        for (j = 0; j < bpp_count; ++j)
+        {
+            if ((tests[selected[i]].flags & BENCH_REGION) && j)
+                break;
+            for (k = 0; k < size_count; ++k)
+                run_test(&tests[selected[i]], bpps[j], sizes[k], option_iterations);
+        }
+    }
+
+    return 0;
+}
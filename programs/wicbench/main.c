@@ -0,0 +1,270 @@
+/*
+ * Windows Imaging Component benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#define COBJMACROS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+#include <wincodec.h>
+
+#include "bench.h"
+
+struct bench_format
+{
+    unsigned int bpp;
+    const WICPixelFormatGUID *guid;
+};
+
+static const struct bench_format format_gray = {8, &GUID_WICPixelFormat8bppGray};
+static const struct bench_format format_bgr = {24, &GUID_WICPixelFormat24bppBGR};
+static const struct bench_format format_bgra = {32, &GUID_WICPixelFormat32bppBGRA};
+static const struct bench_format format_pbgra = {32, &GUID_WICPixelFormat32bppPBGRA};
+
+/* Source formats for the scaler tests. */
+static const struct bench_format *formats[] = {&format_gray, &format_bgr, &format_pbgra};
+
+struct bench_context
+{
+    IWICImagingFactory *factory;
+    IWICBitmap *source;
+    const struct bench_format *format;
+    unsigned int size;
+    BYTE *buffer;           /* Large enough for the largest output of any test. */
+};
+
+struct bench_test
+{
+    const char *name;
+    void (*run)(struct bench_context *ctx, const struct bench_test *test);
+    WICBitmapInterpolationMode mode;
+    unsigned int num, denom;            /* Output size relative to the source. */
+    BOOL rows;                          /* Copy one scanline per call. */
+    const struct bench_format *from;    /* Source format of a conversion test. */
+    const WICPixelFormatGUID *to;       /* Destination format of a conversion test. */
+};
+
+static IWICBitmap *create_source(IWICImagingFactory *factory, const struct bench_format *format, unsigned int size)
+{
+    unsigned int stride = (size * format->bpp / 8 + 3) & ~3, x, y;
+    IWICBitmap *bitmap;
+    BYTE *bits;
+    HRESULT hr;
+
+    if (!(bits = malloc(stride * size)))
+        return NULL;
+
+    /* Smooth gradients with some high frequency detail. */
+    for (y = 0; y < size; ++y)
+    {
+        for (x = 0; x < stride; ++x)
+            bits[y * stride + x] = x * 112 / stride + y * 112 / size + ((x ^ y) & 0x1f);
+    }
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, size, size, format->guid, stride,
+            stride * size, bits, &bitmap);
+    free(bits);
+    return SUCCEEDED(hr) ? bitmap : NULL;
+}
+
+static void bench_scale(struct bench_context *ctx, const struct bench_test *test)
+{
+    unsigned int size = ctx->size * test->num / test->denom;
+    unsigned int stride = (size * ctx->format->bpp / 8 + 3) & ~3, y;
+    IWICBitmapScaler *scaler;
+    WICRect rect = {0, 0, size, 1};
+
+    if (FAILED(IWICImagingFactory_CreateBitmapScaler(ctx->factory, &scaler)))
+        return;
+
+    if (SUCCEEDED(IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)ctx->source, size, size, test->mode)))
+    {
+        if (!test->rows)
+        {
+            IWICBitmapScaler_CopyPixels(scaler, NULL, stride, stride * size, ctx->buffer);
+        }
+        else
+        {
+            for (y = 0; y < size; ++y)
+            {
+                rect.Y = y;
+                IWICBitmapScaler_CopyPixels(scaler, &rect, stride, stride, ctx->buffer + y * stride);
+            }
+        }
+    }
+
+    IWICBitmapScaler_Release(scaler);
+}
+
+static void bench_convert(struct bench_context *ctx, const struct bench_test *test)
+{
+    IWICFormatConverter *converter;
+    unsigned int bpp = test->to == &GUID_WICPixelFormat8bppGray ? 8 :
+            test->to == &GUID_WICPixelFormat24bppBGR ? 24 : 32;
+    unsigned int stride = (ctx->size * bpp / 8 + 3) & ~3;
+
+    if (FAILED(IWICImagingFactory_CreateFormatConverter(ctx->factory, &converter)))
+        return;
+
+    if (SUCCEEDED(IWICFormatConverter_Initialize(converter, (IWICBitmapSource *)ctx->source, test->to,
+            WICBitmapDitherTypeNone, NULL, 0.0, WICBitmapPaletteTypeCustom)))
+        IWICFormatConverter_CopyPixels(converter, NULL, stride, stride * ctx->size, ctx->buffer);
+
+    IWICFormatConverter_Release(converter);
+}
+
+static const struct bench_test tests[] =
+{
+    {"scale_nearest_down",      bench_scale, WICBitmapInterpolationModeNearestNeighbor,  1, 2},
+    {"scale_nearest_up",        bench_scale, WICBitmapInterpolationModeNearestNeighbor,  3, 2},
+    {"scale_linear_down",       bench_scale, WICBitmapInterpolationModeLinear,           1, 2},
+    {"scale_linear_up",         bench_scale, WICBitmapInterpolationModeLinear,           3, 2},
+    {"scale_linear_rows",       bench_scale, WICBitmapInterpolationModeLinear,           3, 2, TRUE},
+    {"scale_cubic_down",        bench_scale, WICBitmapInterpolationModeCubic,            1, 2},
+    {"scale_cubic_up",          bench_scale, WICBitmapInterpolationModeCubic,            3, 2},
+    {"scale_hqcubic_down",      bench_scale, WICBitmapInterpolationModeHighQualityCubic, 1, 4},
+    {"scale_fant_down",         bench_scale, WICBitmapInterpolationModeFant,             1, 4},
+    {"scale_fant_up",           bench_scale, WICBitmapInterpolationModeFant,             3, 2},
+    {"convert_bgr_bgra",        bench_convert, 0, 1, 1, FALSE, &format_bgr,   &GUID_WICPixelFormat32bppBGRA},
+    {"convert_bgra_bgr",        bench_convert, 0, 1, 1, FALSE, &format_bgra,  &GUID_WICPixelFormat24bppBGR},
+    {"convert_bgra_pbgra",      bench_convert, 0, 1, 1, FALSE, &format_bgra,  &GUID_WICPixelFormat32bppPBGRA},
+    {"convert_pbgra_bgra",      bench_convert, 0, 1, 1, FALSE, &format_pbgra, &GUID_WICPixelFormat32bppBGRA},
+    {"convert_bgra_gray",       bench_convert, 0, 1, 1, FALSE, &format_bgra,  &GUID_WICPixelFormat8bppGray},
+    {"convert_gray_bgra",       bench_convert, 0, 1, 1, FALSE, &format_gray,  &GUID_WICPixelFormat32bppBGRA},
+};
+
+static const unsigned int default_bpps[] = {8, 24, 32};
+static const unsigned int default_sizes[] = {64, 256, 1024};
+
+static unsigned int option_bpp, option_size, option_iterations;
+
+static const struct bench_option options[] =
+{
+    {'b', "bpp", "Run only with the given source format (8, 24 or 32).",
+            0, 0, default_bpps, ARRAY_SIZE(default_bpps), &option_bpp},
+    {'s', "size", "Run only on size x size source bitmaps, from %u to %u.", 4, 4096, NULL, 0, &option_size},
+    {'i', "iterations", "Use a fixed iteration count instead of one scaled to the bitmap size.",
+            1, ~0u, NULL, 0, &option_iterations},
+};
+
+static const char *get_test_name(unsigned int idx)
+{
+    return tests[idx].name;
+}
+
+static const struct bench_desc bench_desc =
+{
+    "wicbench",
+    "test,bpp,src_size,dst_size,iterations,total_ms,us_per_op,mpixels_per_sec",
+    "Scaler tests run on 8bppGray, 24bppBGR and 32bppPBGRA sources, conversion tests\n"
+            "on the source format named by the test.",
+    get_test_name, ARRAY_SIZE(tests), options, ARRAY_SIZE(options),
+};
+
+static void run_test(IWICImagingFactory *factory, const struct bench_test *test,
+        const struct bench_format *format, unsigned int size, unsigned int iterations)
+{
+    struct bench_context ctx = {0};
+    struct bench_timer timer;
+    unsigned int out_size = size * test->num / test->denom;
+    unsigned int out_bytes = out_size * 4;
+    double total_ms;
+    unsigned int i;
+
+    ctx.factory = factory;
+    ctx.format = format;
+    ctx.size = size;
+    if (!out_size || !(ctx.source = create_source(factory, format, size))
+            || !(ctx.buffer = malloc(out_bytes * out_size)))
+    {
+        fprintf(stderr, "Failed to create %ux%u %u bpp bitmaps.\n", size, size, format->bpp);
+        goto done;
+    }
+
+    /* Warm up caches and lazily loaded code. */
+    test->run(&ctx, test);
+
+    if (!iterations)
+        iterations = bench_default_iterations(size * size);
+
+    bench_timer_start(&timer);
+    for (i = 0; i < iterations; ++i)
+        test->run(&ctx, test);
+    total_ms = bench_timer_elapsed_ms(&timer);
+
+    /* Throughput is measured in output pixels. */
+    printf("%s,%u,%u,%u,%u,%.3f,%.3f,%.2f\n", test->name, format->bpp, size, out_size, iterations, total_ms,
+            total_ms * 1000.0 / iterations,
+            total_ms ? (double)out_size * out_size * iterations / (total_ms * 1000.0) : 0.0);
+    fflush(stdout);
+
+done:
+    if (ctx.source)
+        IWICBitmap_Release(ctx.source);
+    free(ctx.buffer);
+}
+
+int __cdecl wmain(int argc, WCHAR *argv[])
+{
+    unsigned int selected[ARRAY_SIZE(tests)], selected_count;
+    const unsigned int *sizes = default_sizes;
+    unsigned int size_count = ARRAY_SIZE(default_sizes);
+    const struct bench_test *test;
+    IWICImagingFactory *factory;
+    unsigned int i, j, k;
+    HRESULT hr;
+    int ret;
+
+    if (!bench_parse_command_line(&bench_desc, argc, argv, selected, &selected_count, &ret))
+        return ret;
+    if (option_size)
+    {
+        sizes = &option_size;
+        size_count = 1;
+    }
+
+    CoInitializeEx(NULL, COINIT_MULTITHREADED);
+    hr = CoCreateInstance(&CLSID_WICImagingFactory, NULL, CLSCTX_INPROC_SERVER,
+            &IID_IWICImagingFactory, (void **)&factory);
+    if (FAILED(hr))
+    {
+        fprintf(stderr, "Failed to create the imaging factory, hr %#lx.\n", hr);
+        CoUninitialize();
+        return 1;
+    }
+
+    bench_print_header(&bench_desc);
+    for (i = 0; i < selected_count; ++i)
+    {
+        test = &tests[selected[i]];
+        for (j = 0; j < ARRAY_SIZE(formats); ++j)
+        {
+            const struct bench_format *format = test->from ? test->from : formats[j];
+
+            if ((test->from && j) || (option_bpp && format->bpp != option_bpp))
+                continue;
+            for (k = 0; k < size_count; ++k)
+                run_test(factory, test, format, sizes[k], option_iterations);
+        }
+    }
+
+    IWICImagingFactory_Release(factory);
+    CoUninitialize();
+    return 0;
+}
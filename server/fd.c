@@ -2146,6 +2146,30 @@ void allow_fd_caching( struct fd *fd )
     fd->cacheable = 1;
 }
 
+/* send the unix fd of a new handle to the client so that it can be cached right away */
+/* returns the fd type, or FD_TYPE_INVALID if nothing was sent */
+int send_handle_fd( struct process *process, struct object *obj, obj_handle_t handle,
+                    unsigned int *access, unsigned int *options )
+{
+    struct fd *fd = obj->ops->get_fd( obj );
+    int type = FD_TYPE_INVALID;
+
+    if (!fd)
+    {
+        clear_error();
+        return FD_TYPE_INVALID;
+    }
+    if (fd->cacheable && fd->unix_fd != -1)
+    {
+        type = fd->fd_ops->get_fd_type( fd );
+        *access = get_handle_access( process, handle );
+        *options = fd->options;
+        if (send_client_fd( process, fd->unix_fd, handle ) == -1) type = FD_TYPE_INVALID;
+    }
+    release_object( fd );
+    return type;
+}
+
 /* check if fd is on a removable device */
 int is_fd_removable( struct fd *fd )
 {
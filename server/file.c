@@ -670,6 +670,10 @@ DECL_HANDLER(create_file)
                              req->create, req->options, req->attrs, sd )))
     {
         reply->handle = alloc_handle( current->process, file, req->access, objattr->attributes );
+        reply->fd_type = FD_TYPE_INVALID;
+        if (reply->handle)
+            reply->fd_type = send_handle_fd( current->process, file, reply->handle,
+                                             &reply->fd_access, &reply->fd_options );
         release_object( file );
     }
     if (root_fd) release_object( root_fd );
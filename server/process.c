@@ -68,6 +68,7 @@
 
 static struct list process_list = LIST_INIT(process_list);
 static int running_processes, user_processes;
+static unsigned int process_list_generation = 1;  /* changes whenever the list_processes data does */
 static struct event *shutdown_event;           /* signaled when shutdown starts */
 static struct timeout_user *shutdown_timeout;  /* timeout for server shutdown */
 static int shutdown_stage;  /* current stage in the shutdown process */
@@ -983,9 +984,16 @@ static void process_killed( struct process *process )
     wake_up( &process->obj, 0 );
 }
 
+/* mark the information returned by list_processes as modified */
+void process_list_changed(void)
+{
+    if (!++process_list_generation) process_list_generation = 1;
+}
+
 /* add a thread to a process running threads list */
 void add_process_thread( struct process *process, struct thread *thread )
 {
+    process_list_changed();
     list_add_tail( &process->thread_list, &thread->proc_entry );
     if (!process->running_threads++)
     {
@@ -1009,6 +1017,7 @@ void remove_process_thread( struct process *process, struct thread *thread )
     assert( process->running_threads > 0 );
     assert( !list_empty( &process->thread_list ));
 
+    process_list_changed();
     list_remove( &thread->proc_entry );
 
     if (!--process->running_threads)
@@ -1432,6 +1441,7 @@ DECL_HANDLER(init_process_done)
 
     process->start_time = current_time;
     current->entry_point = base + image_info->entry_point;
+    process_list_changed();
 
     init_process_tracing( process );
     generate_startup_debug_events( process );
@@ -1627,7 +1637,11 @@ DECL_HANDLER(set_process_info)
 
     if ((process = get_process_from_handle( req->handle, PROCESS_SET_INFORMATION )))
     {
-        if (req->mask & SET_PROCESS_INFO_PRIORITY) process->priority = req->priority;
+        if (req->mask & SET_PROCESS_INFO_PRIORITY)
+        {
+            process->priority = req->priority;
+            process_list_changed();
+        }
         if (req->mask & SET_PROCESS_INFO_AFFINITY) set_process_affinity( process, req->affinity );
         release_object( process );
     }
@@ -1897,6 +1911,7 @@ DECL_HANDLER(list_processes)
     reply->total_thread_count = 0;
     reply->total_name_len = 0;
     reply->info_size = 0;
+    reply->generation = process_list_generation;
 
     LIST_FOR_EACH_ENTRY( process, &process_list, struct process, entry )
     {
@@ -1909,6 +1924,23 @@ DECL_HANDLER(list_processes)
         reply->total_name_len += process->imagelen;
     }
 
+    if (req->generation == process_list_generation)
+    {
+        /* the client already has the data, only the handle counts may have changed */
+        unsigned int *handle_counts;
+
+        reply->info_size = 0;
+        if (reply->process_count * sizeof(*handle_counts) > get_reply_max_size())
+        {
+            set_error( STATUS_INFO_LENGTH_MISMATCH );
+            return;
+        }
+        if (!(handle_counts = set_reply_data_size( reply->process_count * sizeof(*handle_counts) ))) return;
+        LIST_FOR_EACH_ENTRY( process, &process_list, struct process, entry )
+            *handle_counts++ = get_handle_table_count( process );
+        return;
+    }
+
     if (reply->info_size > get_reply_max_size())
     {
         set_error( STATUS_INFO_LENGTH_MISMATCH );
@@ -104,6 +104,7 @@ extern int process_set_debugger( struct process *process, struct thread *thread
 extern void debugger_detach( struct process *process, struct debug_obj *debug_obj );
 extern int set_process_debug_flag( struct process *process, int flag );
 
+extern void process_list_changed(void);
 extern void add_process_thread( struct process *process,
                                 struct thread *thread );
 extern void remove_process_thread( struct process *process,
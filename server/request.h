@@ -1015,7 +1015,10 @@ C_ASSERT( FIELD_OFFSET(struct create_file_request, options) == 24 );
 C_ASSERT( FIELD_OFFSET(struct create_file_request, attrs) == 28 );
 C_ASSERT( sizeof(struct create_file_request) == 32 );
 C_ASSERT( FIELD_OFFSET(struct create_file_reply, handle) == 8 );
-C_ASSERT( sizeof(struct create_file_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct create_file_reply, fd_type) == 12 );
+C_ASSERT( FIELD_OFFSET(struct create_file_reply, fd_access) == 16 );
+C_ASSERT( FIELD_OFFSET(struct create_file_reply, fd_options) == 20 );
+C_ASSERT( sizeof(struct create_file_reply) == 24 );
 C_ASSERT( FIELD_OFFSET(struct open_file_object_request, access) == 12 );
 C_ASSERT( FIELD_OFFSET(struct open_file_object_request, attributes) == 16 );
 C_ASSERT( FIELD_OFFSET(struct open_file_object_request, rootdir) == 20 );
@@ -1180,12 +1183,14 @@ C_ASSERT( FIELD_OFFSET(struct get_mapping_filename_request, addr) == 16 );
 C_ASSERT( sizeof(struct get_mapping_filename_request) == 24 );
 C_ASSERT( FIELD_OFFSET(struct get_mapping_filename_reply, len) == 8 );
 C_ASSERT( sizeof(struct get_mapping_filename_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct list_processes_request, generation) == 12 );
 C_ASSERT( sizeof(struct list_processes_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct list_processes_reply, info_size) == 8 );
 C_ASSERT( FIELD_OFFSET(struct list_processes_reply, process_count) == 12 );
 C_ASSERT( FIELD_OFFSET(struct list_processes_reply, total_thread_count) == 16 );
 C_ASSERT( FIELD_OFFSET(struct list_processes_reply, total_name_len) == 20 );
-C_ASSERT( sizeof(struct list_processes_reply) == 24 );
+C_ASSERT( FIELD_OFFSET(struct list_processes_reply, generation) == 24 );
+C_ASSERT( sizeof(struct list_processes_reply) == 32 );
 C_ASSERT( FIELD_OFFSET(struct create_debug_obj_request, access) == 12 );
 C_ASSERT( FIELD_OFFSET(struct create_debug_obj_request, flags) == 16 );
 C_ASSERT( sizeof(struct create_debug_obj_request) == 24 );
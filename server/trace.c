@@ -1942,6 +1942,9 @@ static void dump_create_file_request( const struct create_file_request *req )
 static void dump_create_file_reply( const struct create_file_reply *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", fd_type=%d", req->fd_type );
+    fprintf( stderr, ", fd_access=%08x", req->fd_access );
+    fprintf( stderr, ", fd_options=%08x", req->fd_options );
 }
 
 static void dump_open_file_object_request( const struct open_file_object_request *req )
@@ -2278,6 +2281,7 @@ static void dump_get_mapping_filename_reply( const struct get_mapping_filename_r
 
 static void dump_list_processes_request( const struct list_processes_request *req )
 {
+    fprintf( stderr, " generation=%08x", req->generation );
 }
 
 static void dump_list_processes_reply( const struct list_processes_reply *req )
@@ -2286,7 +2290,9 @@ static void dump_list_processes_reply( const struct list_processes_reply *req )
     fprintf( stderr, ", process_count=%d", req->process_count );
     fprintf( stderr, ", total_thread_count=%d", req->total_thread_count );
     fprintf( stderr, ", total_name_len=%u", req->total_name_len );
+    fprintf( stderr, ", generation=%08x", req->generation );
     dump_varargs_process_info( ", data=", min(cur_size,req->info_size) );
+    dump_varargs_uints( ", handle_counts=", cur_size );
 }
 
 static void dump_create_debug_obj_request( const struct create_debug_obj_request *req )